@@ -12,6 +12,7 @@ BuildRequires:  pkgconfig(mm-ta)
 BuildRequires:  pkgconfig(mm-common)
 BuildRequires:  pkgconfig(mm-sound)
 BuildRequires:  pkgconfig(gstreamer-0.10)
+BuildRequires:  pkgconfig(gstreamer-base-0.10)
 BuildRequires:  pkgconfig(gstreamer-plugins-base-0.10)
 BuildRequires:  pkgconfig(gstreamer-interfaces-0.10)
 BuildRequires:  pkgconfig(gstreamer-app-0.10)
@@ -21,6 +22,7 @@ BuildRequires:  pkgconfig(audio-session-mgr)
 BuildRequires:  pkgconfig(iniparser)
 BuildRequires:  pkgconfig(libcrypto)
 BuildRequires:  pkgconfig(vconf)
+BuildRequires:  pkgconfig(libsoup-2.4)
 
 
 BuildRoot:  %{_tmppath}/%{name}-%{version}-build
@@ -275,6 +275,21 @@
 	<td>range</td>
 	</tr>
 	<tr>
+	<td>"streaming_prefetch_count"</td>
+	<td>int</td>
+	<td>range</td>
+	</tr>
+	<tr>
+	<td>"streaming_prefetch_buffer_size"</td>
+	<td>int</td>
+	<td>range</td>
+	</tr>
+	<tr>
+	<td>"streaming_key_cache_ttl"</td>
+	<td>int</td>
+	<td>range</td>
+	</tr>
+	<tr>
 	<td>"display_overlay"</td>
 	<td>data</td>
 	<td>N/A</td>
@@ -294,6 +309,11 @@
 	<td>string</td>
 	<td>N/A</td>
 	</tr>
+	<tr>
+	<td>"sound_fade_time"</td>
+	<td>int</td>
+	<td>range</td>
+	</tr>
 	</table></div>
 
 	@par
@@ -536,6 +556,32 @@
  * set the streaming proxy port (int)
  */
 #define MM_PLAYER_STREAMING_PROXY_PORT		"streaming_proxy_port"
+/**
+ * MM_PLAYER_STREAMING_PREFETCH_COUNT
+ *
+ * set the number of HLS segments downloaded at once (int). it's up to 3, one less than
+ * connections to a server
+ */
+#define MM_PLAYER_STREAMING_PREFETCH_COUNT	"streaming_prefetch_count"
+/**
+ * MM_PLAYER_STREAMING_PREFETCH_BUFFER_SIZE
+ *
+ * set the bytes of HLS segments downloaded ahead (int)
+ */
+#define MM_PLAYER_STREAMING_PREFETCH_BUFFER_SIZE	"streaming_prefetch_buffer_size"
+/**
+ * MM_PLAYER_STREAMING_KEY_CACHE_TTL
+ *
+ * set the seconds to reuse a downloaded HLS key, 0 for whole playback (int)
+ */
+#define MM_PLAYER_STREAMING_KEY_CACHE_TTL	"streaming_key_cache_ttl"
+/**
+ * MM_PLAYER_SOUND_FADE_TIME
+ *
+ * set the msec to fade sound out before pause and stop, and in after resume (int).
+ * Default value is 0, which doesn't fade.
+ */
+#define MM_PLAYER_SOUND_FADE_TIME		"sound_fade_time"
 /**
  * MM_PLAYER_VIDEO_CODEC
  *
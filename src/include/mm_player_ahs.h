@@ -26,15 +26,54 @@
 
 #include <glib.h>
 #include "mm_player_ahs_hls.h"
+#include "mm_player_ahs_fetch.h"
+#include "mm_player_ahs_abr.h"
 #include <gst/gst.h>
 #include <gst/app/gstappsrc.h>
 #include <gst/app/gstappsink.h>
 #include <string.h>
 #include "mm_debug.h"
 
-#define HLS_POSIX_PATH_MAX				256
-#define HLS_MANIFEST_DEFAULT_PATH 		"/opt/media/"
-#define HLS_MANIFEST_DEFAULT_FILE_NAME	HLS_MANIFEST_DEFAULT_PATH"XXXXXX"
+#define AHS_DEFAULT_PREFETCH_COUNT			3
+/* a connection is left for manifest and key requests */
+#define AHS_MAX_PREFETCH_COUNT				(AHS_FETCH_MAX_CONNS_PER_HOST - 1)
+#define AHS_DEFAULT_PREFETCH_BUFFER_SIZE	(8 * 1024 * 1024)
+#define AHS_KEY_CACHE_MAX					16
+#define AHS_DECRYPT_THREAD_COUNT			2
+
+/* AES-128 key shared by segments with same key uri */
+typedef struct
+{
+	gchar data[16];
+	gboolean ready;			/* FALSE while being downloaded */
+	guint64 time;			/* downloaded time in usec */
+}ahs_key_t;
+
+/* a media segment in prefetch window. downloaded by a prefetch thread, decrypted
+ * by a decrypt thread and pushed to appsrc by media thread in order of sequence */
+typedef struct
+{
+	gpointer ahs_player;
+
+	gchar *media_uri;
+	gchar *key_uri;
+	char iv[16];
+	gint sequence;
+	guint duration;			/* msec */
+	gboolean discontinuity;
+
+	GQueue chunks;			/* downloaded, not decrypted yet */
+	GQueue ready;			/* to be pushed */
+	gboolean started;		/* taken by a prefetch thread */
+	gboolean done;			/* download is over */
+	gboolean decrypting;	/* taken by a decrypt thread */
+	gboolean ready_done;	/* nothing more comes to ready */
+	gboolean failed;
+	gboolean cancelled;		/* freed by the last thread which has it */
+	gboolean cancelling;	/* its request is being cancelled, so it's kept */
+	gpointer decrypt;
+	GError *error;
+}ahs_segment_t;
 
 typedef struct
 {
@@ -53,11 +92,9 @@ typedef struct
 	gchar *cur_mf_uri;
 	gchar *cur_media_uri;
 	gchar *cur_key_uri;
-	gchar cur_key_data[16];
-	char cur_iv[16];
-	
-	char ahs_manifest_dmp_location[HLS_POSIX_PATH_MAX];  /* manifest file dumped location */
-	char ahs_key_dmp_location [HLS_POSIX_PATH_MAX];
+
+	/* http requests of manifest, key and media */
+	mm_player_ahs_fetch_t *fetch;
 	
 	int ahs_state;
 	GMutex* state_lock;
@@ -65,9 +102,6 @@ typedef struct
 	/* manifest/playlist download */
 	GThread *manifest_thread;
 	gboolean manifest_thread_exit;
-	GstElement *manifest_download_pipeline;
-	GstElement *manifest_download_src;
-	GstElement *manifest_download_sink;
 	GCond* manifest_start_cond;
 	GCond* manifest_update_cond;
 	GCond* manifest_eos_cond;
@@ -78,23 +112,41 @@ typedef struct
 	GThread *media_thread;
 	GMutex *media_mutex;
 	gboolean media_thread_exit;
-	GstElement *media_download_pipeline;
-	GstElement *media_download_src;
-	GstElement *media_download_sink;
-	GCond *media_eos_cond;
+	gboolean media_started;
 	GCond *media_start_cond;
 
-	/* key download */
-	GstElement *key_download_pipeline;
-	GstElement *key_download_src;
-	GstElement *key_download_sink;
-	GCond *key_eos_cond;
+	/* media prefetch */
+	GThread *prefetch_threads[AHS_MAX_PREFETCH_COUNT];
+	gint prefetch_count;			/* segments downloaded at once */
+	guint prefetch_buffer_size;		/* bytes kept in window before being pushed */
+	GMutex *prefetch_lock;
+	GCond *prefetch_cond;
+	GQueue segments;				/* window in order of sequence. head is being pushed */
+	guint prefetch_buffered;
+	gboolean prefetch_exit;
+
+	/* throughput while any segment is being downloaded */
+	gint prefetch_active;
+	guint64 prefetch_bytes;
+	guint64 prefetch_busy_time;		/* usec */
+	guint64 prefetch_busy_since;
+
+	/* decryption ahead of push. segments are decrypted in parallel */
+	GThread *decrypt_threads[AHS_DECRYPT_THREAD_COUNT];
+	guint64 decrypt_bytes;
+	guint64 decrypt_time;			/* usec */
+
+	/* keys by uri, kept for key_cache_ttl. 0 for whole session */
+	GHashTable *keys;
+	GMutex *key_lock;
+	GCond *key_cond;
+	guint key_cache_ttl;			/* sec */
 
-	guint64 seg_start_time;     /* segment start time in usec*/
-	guint64 seg_end_time;     /* segment end time usec*/
 	guint download_rate;
-	guint64 seg_size;
-	gint cache_frag_count;
+
+	/* variant of next segments is decided after each segment. used with prefetch_lock */
+	ahs_abr_t *abr;
+	guint64 pushed_duration;		/* msec of media pushed to appsrc */
 
 	gboolean hls_is_wait_for_reload;
 
@@ -111,6 +163,10 @@ gboolean __mm_player_ahs_start (mm_player_ahs_t *ahs_player);
 gboolean  __mm_player_ahs_deinitialize (mm_player_ahs_t *ahs_player);
 gboolean __mm_player_ahs_stop (mm_player_ahs_t *ahs_player);
 gboolean __mm_player_ahs_destroy (mm_player_ahs_t *ahs_player);
+gboolean __mm_player_ahs_set_prefetch (mm_player_ahs_t *ahs_player, gint count, guint buffer_size);
+gboolean __mm_player_ahs_set_key_cache_ttl (mm_player_ahs_t *ahs_player, guint ttl_sec);
+gboolean __mm_player_ahs_get_throughput (mm_player_ahs_t *ahs_player, guint *download_rate, guint *decrypt_rate);
+gint __mm_player_ahs_get_abr_log (mm_player_ahs_t *ahs_player, ahs_abr_decision_t *decisions, gint max);
 gboolean
 ahs_store_media_presentation (mm_player_ahs_t *ahs_player, unsigned char *buffer, unsigned int buffer_len);
 gboolean ahs_check_allow_cache (mm_player_ahs_t *ahs_player);
@@ -0,0 +1,106 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>,
+ * naveen cherukuri <naveen.ch@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __MM_PLAYER_AHS_ABR_H__
+#define	__MM_PLAYER_AHS_ABR_H__
+
+#include <glib.h>
+#include <string.h>
+#include "mm_debug.h"
+
+#define AHS_ABR_VARIANT_MAX				16
+#define AHS_ABR_THROUGHPUT_SAMPLES		5		/* segments in harmonic mean of throughput */
+#define AHS_ABR_STARTUP_SAMPLES			2		/* no switch before this many samples */
+#define AHS_ABR_SAFETY_FACTOR			0.8		/* part of estimated throughput a variant may use */
+#define AHS_ABR_BUFFER_LOW_MSEC			8000	/* below it, no switch up */
+#define AHS_ABR_BUFFER_HIGH_MSEC		20000	/* above it, no switch down */
+#define AHS_ABR_HOLD_SEGMENTS			3		/* segments after a switch before switching up */
+#define AHS_ABR_LOG_MAX					32
+
+/* why the variant of a decision was chosen */
+typedef enum
+{
+	AHS_ABR_REASON_KEEP = 0,		/* current one fits the estimate */
+	AHS_ABR_REASON_STARTUP,			/* not enough samples yet */
+	AHS_ABR_REASON_UP,				/* estimate allows higher one */
+	AHS_ABR_REASON_DOWN,			/* estimate can't sustain current one */
+	AHS_ABR_REASON_PANIC,			/* same as down, with buffer running out */
+	AHS_ABR_REASON_HOLD,			/* up is held by hysteresis or low buffer */
+	AHS_ABR_REASON_BUFFERED,		/* down is absorbed by full buffer */
+}ahs_abr_reason_t;
+
+/* an entry of decision log, made after each segment */
+typedef struct
+{
+	guint segment;					/* segments decided so far */
+	guint throughput;				/* last sample in bps. 0 if there was none */
+	guint estimate;					/* smoothed throughput in bps */
+	guint buffer_msec;
+	guint from_bandwidth;
+	guint to_bandwidth;
+	ahs_abr_reason_t reason;
+}ahs_abr_decision_t;
+
+typedef struct _ahs_abr ahs_abr_t;
+
+/* returns index of variant to play next and why. replaces the default algorithm */
+typedef gint (*ahs_abr_select_func) (ahs_abr_t *abr, ahs_abr_reason_t *reason);
+
+/* adaptive bitrate controller. it only sees what it's given, so a decision depends
+ * on the sequence of samples and buffer levels only, and a recorded one replays same */
+struct _ahs_abr
+{
+	/* variants in ascending order of bandwidth */
+	guint bandwidths[AHS_ABR_VARIANT_MAX];
+	gint variant_count;
+	gint current;
+
+	/* throughput of recent segments in bps */
+	guint samples[AHS_ABR_THROUGHPUT_SAMPLES];
+	gint sample_count;
+	gint sample_index;
+	guint last_sample;
+	guint estimate;
+
+	guint buffer_msec;
+	gint held;						/* segments since last switch */
+
+	ahs_abr_select_func select;
+
+	/* ring of recent decisions */
+	ahs_abr_decision_t log[AHS_ABR_LOG_MAX];
+	gint log_head;
+	gint log_count;
+	guint segment_count;
+};
+
+ahs_abr_t *__mm_player_ahs_abr_create (void);
+void __mm_player_ahs_abr_destroy (ahs_abr_t *abr);
+void __mm_player_ahs_abr_reset (ahs_abr_t *abr);
+void __mm_player_ahs_abr_set_select_func (ahs_abr_t *abr, ahs_abr_select_func select);
+gboolean __mm_player_ahs_abr_set_variants (ahs_abr_t *abr, const guint *bandwidths, gint count, gint current);
+void __mm_player_ahs_abr_add_throughput (ahs_abr_t *abr, guint rate);
+gint __mm_player_ahs_abr_decide (ahs_abr_t *abr, guint buffer_msec);
+gint __mm_player_ahs_abr_get_log (ahs_abr_t *abr, ahs_abr_decision_t *decisions, gint max);
+#endif
+
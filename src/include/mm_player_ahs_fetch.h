@@ -0,0 +1,66 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>,
+ * naveen cherukuri <naveen.ch@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __MM_PLAYER_AHS_FETCH_H__
+#define	__MM_PLAYER_AHS_FETCH_H__
+
+#include <glib.h>
+#include <gst/gst.h>
+#include <libsoup/soup.h>
+#include "mm_debug.h"
+
+#define AHS_FETCH_MAX_CONNS_PER_HOST	4
+#define AHS_FETCH_TIMEOUT_SEC			30
+#define AHS_FETCH_CHUNK_SIZE			(32 * 1024)
+#define AHS_FETCH_CHUNK_HEADROOM		32		/* room before data of a chunk, for bytes carried by decryption */
+
+/* called for each piece of response body in the fetching thread. takes the buffer,
+ * which is writable and has AHS_FETCH_CHUNK_HEADROOM bytes before its data.
+ * returning FALSE cancels the request */
+typedef gboolean (*mm_player_ahs_fetch_chunk_cb) (GstBuffer *chunk, gpointer user_data);
+
+/* one http session for all the manifest, key and media requests of a AHS session.
+ * connections are kept alive between requests and requests from several threads
+ * are queued on them */
+typedef struct
+{
+	SoupSession *session;
+
+	GMutex *lock;
+	GList *messages;		/* requests in flight */
+	gboolean cancelled;
+
+	guint64 ttfb;			/* time to first byte of last request in usec. with lock */
+}mm_player_ahs_fetch_t;
+
+mm_player_ahs_fetch_t *__mm_player_ahs_fetch_create (const gchar *user_agent);
+void __mm_player_ahs_fetch_destroy (mm_player_ahs_fetch_t *fetch);
+gboolean __mm_player_ahs_fetch_stream (mm_player_ahs_fetch_t *fetch, const gchar *uri,
+	mm_player_ahs_fetch_chunk_cb chunk_cb, gpointer user_data, GError **error);
+gboolean __mm_player_ahs_fetch_data (mm_player_ahs_fetch_t *fetch, const gchar *uri,
+	gchar **data, gsize *size, GError **error);
+guint64 __mm_player_ahs_fetch_get_ttfb (mm_player_ahs_fetch_t *fetch);
+void __mm_player_ahs_fetch_cancel (mm_player_ahs_fetch_t *fetch);
+void __mm_player_ahs_fetch_cancel_stream (mm_player_ahs_fetch_t *fetch, gpointer user_data);
+#endif
+
@@ -32,31 +32,44 @@
 #include <openssl/evp.h>
 #include <openssl/aes.h>
 
+/* aes-128 cbc decryption of a media fragment. fragments are decrypted independently */
+typedef struct
+{
+	EVP_CIPHER_CTX ctx;
+	unsigned char remained[AES_BLOCK_SIZE]; /* cipher text short of a block */
+	guint remained_len;
+	unsigned char last_block[AES_BLOCK_SIZE]; /* plain text kept till padding is known */
+	gboolean has_last_block;
+}hls_decrypt_t;
+
 typedef struct
 {
 	gchar *uri;
-	EVP_CIPHER_CTX decrypt;
 	GstM3U8Client *client;
-	GstBuffer *remained; /* remained data in aes decryption */
 	gboolean discontinuity; /* discontinuity flag */
 	GList *list_to_switch;
 	FILE *allow_cache_fd;
 }mm_player_hls_t;
-#define DEFAULT_FRAGMENTS_CACHE 2
 
 
 void * __mm_player_hls_create ();
 gboolean __mm_player_hls_destroy (void *hls_handle);
 gboolean __mm_player_hls_initialize (void *hls_handle, gchar *uri);
-gboolean hls_decryption_initialize (void *hls_handle, gchar *key_data, unsigned char *iv);
-gboolean hls_decrypt_media_fragment (void *hls_handle,GstBuffer *InBuf, GstBuffer **OutBuf);
-gboolean hls_get_next_media_fragment (void *hls_handle, gchar **media_uri, gchar **key_uri, char **iv);
-gboolean hls_switch_playlist (void *hls_handle, guint download_rate, gboolean *need_bw_switch);
+hls_decrypt_t *hls_decryption_new (gchar *key_data, unsigned char *iv);
+void hls_decryption_free (hls_decrypt_t *decrypt);
+gboolean hls_decrypt_media_fragment (hls_decrypt_t *decrypt, GstBuffer *InBuf, GstBuffer **OutBuf);
+gboolean hls_decrypt_media_fragment_end (hls_decrypt_t *decrypt, GstBuffer **OutBuf);
+gboolean hls_get_next_media_fragment (void *hls_handle, gchar **media_uri, gchar **key_uri, char **iv, guint *duration);
+gint hls_get_next_sequence (void *hls_handle);
+void hls_set_next_sequence (void *hls_handle, gint sequence);
+gint hls_get_variants (void *hls_handle, guint *bandwidths, gint max, gint *current);
+gboolean hls_can_switch (void *hls_handle);
+gboolean hls_set_variant (void *hls_handle, gint index);
 gboolean hls_playlist_update_interval (void *hls_handle, GTimeVal *next_update);
 gboolean hls_has_variant_playlist (void *hls_handle);
 gchar  *hls_get_current_playlist (mm_player_hls_t *hls_player);
 gboolean hls_set_current_playlist (mm_player_hls_t *hls_player);
-gboolean hls_parse_playlist_update_client (void *hls_handle, char* playlist);
+gboolean hls_parse_playlist_update_client (void *hls_handle, gchar* playlist);
 gboolean hls_client_is_live (void *hls_handle);
 gboolean hls_determining_next_file_load (void *hls_handle, gboolean *is_ready);
 gboolean hls_is_buffer_discontinuous (void *hls_handle);
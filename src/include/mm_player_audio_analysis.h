@@ -0,0 +1,92 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef __MM_PLAYER_AUDIO_ANALYSIS_H__
+#define __MM_PLAYER_AUDIO_ANALYSIS_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <mm_types.h>
+#include "mm_player_priv.h"
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to configure level and spectrum analysis of audio.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	interval_msec	Interval of analysis. 0 disables it.
+ * @param[in]	bands		Number of spectrum bands.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	Analyzer is attached to audiobin at once if it exists.
+ * @see		_mmplayer_get_audio_analysis
+ *
+ */
+int _mmplayer_set_audio_analysis(MMHandleType hplayer, int interval_msec, int bands);
+/**
+ * This function is to get the latest result of audio analysis.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[out]	result		Latest result.
+ * @return	This function returns zero on success, or negative value with errors.
+ *
+ */
+int _mmplayer_get_audio_analysis(MMHandleType hplayer, MMPlayerAudioAnalysis *result);
+/**
+ * This function is to attach analyzer to volume element of audiobin.
+ *
+ * @param[in]	player		Handle of player.
+ * @remarks	It does nothing if analysis is not enabled or audiobin is not created.
+ * @see		_mmplayer_detach_audio_analyzer
+ *
+ */
+void _mmplayer_attach_audio_analyzer(mm_player_t* player);
+/**
+ * This function is to detach analyzer from audiobin.
+ *
+ * @param[in]	player		Handle of player.
+ * @remarks	Analyzer is kept with its configuration, and attached again with new audiobin.
+ * @see		_mmplayer_attach_audio_analyzer
+ *
+ */
+void _mmplayer_detach_audio_analyzer(mm_player_t* player);
+/**
+ * This function is to release analyzer.
+ *
+ * @param[in]	player		Handle of player.
+ * @remarks	It should be called when streaming threads are stopped.
+ *
+ */
+void _mmplayer_release_audio_analyzer(mm_player_t* player);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
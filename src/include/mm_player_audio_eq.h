@@ -0,0 +1,65 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+#ifndef __MM_PLAYER_AUDIO_EQ_H__
+#define __MM_PLAYER_AUDIO_EQ_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <glib.h>
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL DEFINITIONS AND DECLARATIONS FOR MODULE					|
+========================================================================================*/
+/* factory name of built-in equalizer. it is used when soundalive is not available */
+#define MMPLAYER_AUDIO_EQ_FACTORY	"mmplayeraudioeq"
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to register built-in equalizer element.
+ *
+ * @return	This function returns TRUE on success, or FALSE with errors.
+ * @remarks	It should be called after gstreamer is initialized.
+ *		The element accepts same properties with soundalive(filter-action,
+ *		filter-output-mode, preset-mode, custom-eq, custom-ext) so that
+ *		sound effect functions work with both of them.
+ *		New settings are reached over a short ramp(ramp-time), and
+ *		property changes made while hold-update is TRUE are taken together.
+ * @see		MMPLAYER_AUDIO_EQ_FACTORY
+ *
+ */
+gboolean _mmplayer_audio_eq_register(void);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
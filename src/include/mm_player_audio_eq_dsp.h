@@ -0,0 +1,130 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __MM_PLAYER_AUDIO_EQ_DSP_H__
+#define __MM_PLAYER_AUDIO_EQ_DSP_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <glib.h>
+#include "mm_player_sndeffect.h"
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL DEFINITIONS AND DECLARATIONS FOR MODULE					|
+========================================================================================*/
+/* slots of biquad sections. EQ bands come first, then shelves of extension filters */
+#define MMPLAYER_AUDIO_EQ_SLOT_BASS		MM_AUDIO_FILTER_EQ_BAND_MAX
+#define MMPLAYER_AUDIO_EQ_SLOT_CLARITY		(MM_AUDIO_FILTER_EQ_BAND_MAX + 1)
+#define MMPLAYER_AUDIO_EQ_STAGE_MAX		(MM_AUDIO_FILTER_EQ_BAND_MAX + 2)
+
+/* channels of a frame are processed together in vector lanes */
+#define MMPLAYER_AUDIO_EQ_LANES			4
+
+typedef enum {
+	MMPLAYER_AUDIO_EQ_PEAKING,
+	MMPLAYER_AUDIO_EQ_LOW_SHELF,
+	MMPLAYER_AUDIO_EQ_HIGH_SHELF,
+} MMPlayerAudioEqShape;
+
+typedef struct {
+	MMPlayerAudioEqShape shape;
+	gdouble freq;
+	gdouble q;
+	gdouble gain;		/* dB. 0 means flat section */
+} MMPlayerAudioEqSection;
+
+/* normalized coefficients of biquad section. a0 is 1 */
+typedef struct {
+	gboolean active;
+	gfloat b0;
+	gfloat b1;
+	gfloat b2;
+	gfloat a1;
+	gfloat a2;
+} MMPlayerAudioEqCoef;
+
+/* kernel of biquad cascade */
+typedef enum
+{
+	MM_PLAYER_AUDIO_EQ_KERNEL_AUTO = 0,	/* best one of this build */
+	MM_PLAYER_AUDIO_EQ_KERNEL_C,
+	MM_PLAYER_AUDIO_EQ_KERNEL_SSE2,
+	MM_PLAYER_AUDIO_EQ_KERNEL_NEON,
+	MM_PLAYER_AUDIO_EQ_KERNEL_NUM
+} MMPlayerAudioEqKernel;
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to design coefficients of a biquad section.
+ *
+ * @param[in]	section		Shape, frequency, Q and gain of section.
+ * @param[in]	rate		Sampling rate.
+ * @param[out]	coef		Normalized coefficients. active is not touched.
+ * @return	This function returns TRUE if section is applied, or FALSE if it's flat
+ *		or too close to nyquist frequency.
+ *
+ */
+gboolean _mmplayer_audio_eq_design(const MMPlayerAudioEqSection *section, gint rate, MMPlayerAudioEqCoef *coef);
+/**
+ * This function is to run active sections of cascade over interleaved samples in place.
+ *
+ * @param[in]	coef		Coefficients of MMPLAYER_AUDIO_EQ_STAGE_MAX slots.
+ * @param[in,out]	state	z1 and z2 of each slot, [slot][2][lanes].
+ * @param[in]	channels	Channels of a frame.
+ * @param[in]	lanes		Channels rounded up to MMPLAYER_AUDIO_EQ_LANES.
+ * @param[in,out]	data	16 bits samples.
+ * @param[in]	frames		Number of frames.
+ * @remarks	Output is rounded and saturated. Kernels differ by one at most
+ *		because of rounding of halves.
+ *
+ */
+void _mmplayer_audio_eq_run(const MMPlayerAudioEqCoef *coef, gfloat *state, gint channels, gint lanes,
+		gint16 *data, guint frames);
+/**
+ * This function is to select kernel of cascade.
+ *
+ * @param[in]	kernel		Kernel to use. MM_PLAYER_AUDIO_EQ_KERNEL_AUTO selects by build.
+ * @return	This function returns TRUE on success, or FALSE if build doesn't have it.
+ * @remarks	It's for testing.
+ *
+ */
+gboolean _mmplayer_audio_eq_set_kernel(MMPlayerAudioEqKernel kernel);
+/**
+ * This function is to get kernel in use.
+ *
+ * @return	Kernel of this build or selected by _mmplayer_audio_eq_set_kernel().
+ *
+ */
+MMPlayerAudioEqKernel _mmplayer_audio_eq_get_kernel(void);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif	/* __MM_PLAYER_AUDIO_EQ_DSP_H__ */
@@ -0,0 +1,116 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+#ifndef __MM_PLAYER_AUDIO_FADE_H__
+#define __MM_PLAYER_AUDIO_FADE_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <gst/gst.h>
+#include "mm_player_internal.h"
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL DEFINITIONS AND DECLARATIONS FOR MODULE					|
+========================================================================================*/
+/* factory name of fade element placed after volume of audiobin */
+#define MMPLAYER_AUDIO_FADE_FACTORY	"mmplayeraudiofade"
+
+/* called on streaming thread when a fade reaches its target */
+typedef void (*MMPlayerAudioFadeDoneFunc) (GstElement *fade, gdouble gain, gpointer user_data);
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to register fade element.
+ *
+ * @return	This function returns TRUE on success, or FALSE with errors.
+ * @remarks	It should be called after gstreamer is initialized.
+ *
+ */
+gboolean _mmplayer_audio_fade_register(void);
+/**
+ * This function is to start a fade from current gain.
+ *
+ * @param[in]	fade		Fade element.
+ * @param[in]	target		Target gain. (0.0 ~ 1.0)
+ * @param[in]	duration_msec	Duration of fade.
+ * @param[in]	curve		Curve of fade.
+ * @remarks	Fade starts from the first sample of next buffer and gain is updated
+ *		every sample. Running fade is replaced.
+ * @see		_mmplayer_audio_fade_wait
+ *
+ */
+void _mmplayer_audio_fade_start(GstElement *fade, gdouble target, guint duration_msec, MMPlayerFadeCurve curve);
+/**
+ * This function is to set gain at once, cancelling running fade.
+ *
+ * @param[in]	fade		Fade element.
+ * @param[in]	gain		New gain. (0.0 ~ 1.0)
+ *
+ */
+void _mmplayer_audio_fade_set_gain(GstElement *fade, gdouble gain);
+/**
+ * This function is to wait until fade reaches its target.
+ *
+ * @param[in]	fade		Fade element.
+ * @param[in]	timeout_msec	Maximum time to wait.
+ * @return	This function returns TRUE if fade is done, or FALSE with timeout.
+ * @remarks	Fade can't progress if buffers don't flow, so timeout should be
+ *		given with some margin.
+ *
+ */
+gboolean _mmplayer_audio_fade_wait(GstElement *fade, guint timeout_msec);
+/**
+ * This function is to get when the last fade ends.
+ *
+ * @param[in]	fade		Fade element.
+ * @return	Running time right after the last faded sample, or GST_CLOCK_TIME_NONE
+ *		if it's unknown or fade is not done.
+ * @remarks	The sample is heard only when pipeline clock reaches it plus the
+ *		latency of sink.
+ * @see		_mmplayer_audio_fade_wait
+ *
+ */
+GstClockTime _mmplayer_audio_fade_get_end_time(GstElement *fade);
+/**
+ * This function is to set function called when fade is done.
+ *
+ * @param[in]	fade		Fade element.
+ * @param[in]	func		Function to be called on streaming thread.
+ * @param[in]	user_data	User data of func.
+ *
+ */
+void _mmplayer_audio_fade_set_done_func(GstElement *fade, MMPlayerAudioFadeDoneFunc func, gpointer user_data);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -66,6 +66,68 @@ int _mmplayer_release_video_capture(mm_player_t* player);
  *
  */
 int _mmplayer_do_video_capture(MMHandleType hplayer);
+/**
+ * This function is to extract video frames of given positions without display.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	positions	Array of positions to extract in msec.
+ * @param[in]	count		Number of positions.
+ * @param[in]	width		Width of extracted frame.
+ * @param[in]	height		Height of extracted frame.
+ * @param[out]	frames		Array of extracted frames. It should have room for count frames.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	It uses its own pipeline, so it can be used in any state after creating player.
+ * @see		_mmplayer_do_video_capture
+ *
+ */
+int _mmplayer_extract_video_frames(MMHandleType hplayer, const int *positions, int count, int width, int height, MMPlayerVideoCapture *frames);
+/**
+ * This function is to capture video frames continuously during playback.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	interval	Capture every Nth frame. 0 to use fps.
+ * @param[in]	fps		Capture rate when interval is 0.
+ * @param[in]	slot_count	Number of frame slots.
+ * @param[in]	callback	Callback to receive captured frames.
+ * @param[in]	user_param	User parameter of callback.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	Frames are dropped if there's no free slot or capture thread is busy.
+ * @see		_mmplayer_stop_continuous_capture
+ *
+ */
+int _mmplayer_start_continuous_capture(MMHandleType hplayer, int interval, int fps, int slot_count, mm_player_continuous_capture_callback callback, void *user_param);
+/**
+ * This function is to stop continuous capture.
+ *
+ * @param[in]	handle		Handle of player.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	It's ok to call it when continuous capture is not started.
+ * @see		_mmplayer_start_continuous_capture
+ *
+ */
+int _mmplayer_stop_continuous_capture(MMHandleType hplayer);
+/**
+ * This function is to release a slot of continuous capture.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	slot		Slot index of captured frame.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks
+ * @see		_mmplayer_start_continuous_capture
+ *
+ */
+int _mmplayer_release_captured_frame(MMHandleType hplayer, int slot);
+/**
+ * This function is to get planes of decoded video buffer.
+ *
+ * @param[in]	buffer		Raw video buffer. ST12, I420, NV12 and 32bit BGRx are supported.
+ * @param[out]	image		Planes of buffer. cs is set to MMPlayerVideoColorspace.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	Addresses of planes are valid while the buffer is alive.
+ * @see
+ *
+ */
+int _mmplayer_get_image_from_buffer(GstBuffer *buffer, MMPlayerMPlaneImage *image);
 
 #ifdef __cplusplus
 	}
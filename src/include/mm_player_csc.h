@@ -0,0 +1,100 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __MM_PLAYER_CSC_H__
+#define __MM_PLAYER_CSC_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <glib.h>
+#include "mm_player.h"
+#include "mm_player_internal.h"
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL DEFINITIONS AND DECLARATIONS FOR MODULE					|
+========================================================================================*/
+/* parameters of one pass conversion for capture */
+typedef struct
+{
+	MMPlayerMPlaneImage *src;			/* NV12 tiled, NV12, I420 or BGRx frame */
+	MMPlayerVideoColorspace dst_fmt;
+	int dst_w;
+	int dst_h;
+	unsigned char *dst;
+} MMPlayerCscParam;
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to get size of converted image.
+ *
+ * @param[in]	fmt		I420, NV12, BGRA8888 or RGB888.
+ * @param[in]	width		Width of image.
+ * @param[in]	height		Height of image.
+ * @return	This function returns size in bytes.
+ *
+ */
+int _mmplayer_csc_get_image_size(MMPlayerVideoColorspace fmt, int width, int height);
+/**
+ * This function is to convert and scale a frame at once.
+ *
+ * @param[in,out]	param		Source, and destination of _mmplayer_csc_get_image_size() bytes.
+ * @return	This function returns zero on success, or negative value with error code.
+ * @remarks	Frame is split into bands of lines converted by the pool, if there's the pool.
+ *		Otherwise it's converted in the calling thread.
+ *
+ */
+int _mmplayer_csc_convert(MMPlayerCscParam *param);
+/**
+ * This function is to take a reference of the conversion pool shared in process.
+ *
+ * @remarks	The first one creates the pool with threads of online cores less one.
+ *
+ */
+void _mmplayer_csc_pool_ref(void);
+/**
+ * This function is to drop a reference of the conversion pool.
+ *
+ * @remarks	The last one frees the pool.
+ *
+ */
+void _mmplayer_csc_pool_unref(void);
+/**
+ * This function is to set number of threads of the conversion pool.
+ *
+ * @param[in]	threads		Threads of pool. 0 for online cores less one.
+ * @remarks	It's for testing, and applies to the pool created after it.
+ *
+ */
+void _mmplayer_csc_set_pool_size(int threads);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif	/* __MM_PLAYER_CSC_H__ */
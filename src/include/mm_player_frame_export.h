@@ -0,0 +1,68 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef __MM_PLAYER_FRAME_EXPORT_H__
+#define __MM_PLAYER_FRAME_EXPORT_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <mm_types.h>
+#include "mm_player_priv.h"
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to start exporting video frames to other process.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	path		Path of UNIX socket to listen.
+ * @param[in]	slot_count	Number of frame slots in shared memory.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	Frames which reach video sink are copied to a ring of memfd slots
+ *		and their descriptors are sent to the connected consumer.
+ * @see		_mmplayer_stop_frame_export
+ *
+ */
+int _mmplayer_start_frame_export(MMHandleType hplayer, const char *path, int slot_count);
+/**
+ * This function is to stop exporting video frames.
+ *
+ * @param[in]	handle		Handle of player.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	It's ok to call it when export is not started.
+ * @see		_mmplayer_start_frame_export
+ *
+ */
+int _mmplayer_stop_frame_export(MMHandleType hplayer);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -88,6 +88,24 @@
 	<td>int</td>
 	<td>range</td>
 	</tr>
+	<tr>
+	<td>"capture_format"</td>
+	<td>int</td>
+	<td>range</td>
+	<td>MM_PLAYER_COLORSPACE_RGB888</td>
+	</tr>
+	<tr>
+	<td>"capture_width"</td>
+	<td>int</td>
+	<td>range</td>
+	<td>0</td>
+	</tr>
+	<tr>
+	<td>"capture_height"</td>
+	<td>int</td>
+	<td>range</td>
+	<td>0</td>
+	</tr>
 	</table></div>
 
 */
@@ -99,6 +117,8 @@ typedef enum {
     MM_PLAYER_COLORSPACE_I420 = 0, 		/**< I420 format - planer */
     MM_PLAYER_COLORSPACE_RGB888,			/**< RGB888 pixel format */
     MM_PLAYER_COLORSPACE_NV12_TILED,		/**< Customized color format in s5pc110 */
+    MM_PLAYER_COLORSPACE_NV12,			/**< NV12 format - semi planer */
+    MM_PLAYER_COLORSPACE_BGRA8888,		/**< BGRA8888 pixel format */
 }MMPlayerVideoColorspace;
 
 typedef struct
@@ -108,6 +128,169 @@ typedef struct
 	MMPlayerVideoColorspace fmt;			/* color space type */	
 } MMPlayerVideoCapture;
 
+typedef struct
+{
+	int slot;								/* slot index to release the frame */
+	MMPlayerVideoCapture image;				/* captured image. it's valid until the slot is released */
+	int width;								/* width of captured image */
+	int height;								/* height of captured image */
+	unsigned int timestamp;					/* timestamp of frame in msec */
+	unsigned int dropped;					/* number of frames dropped so far */
+} MMPlayerCaptureFrame;
+
+#define MM_PLAYER_IMGB_MPLANE_MAX	4
+#define MM_PLAYER_CAPTURE_SLOT_MAX	16
+#define MM_PLAYER_VIDEO_FRAME_LEASE_MAX	8
+#define MM_PLAYER_EXPORT_SLOT_MAX	16
+#define MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX	8
+#define MM_PLAYER_AUDIO_ANALYSIS_BAND_MAX	32
+
+/* image buffer definition ***************************************************
+
+    +------------------------------------------+ ---
+    |                                          |  ^
+    |     a[], p[]                             |  |
+    |     +---------------------------+ ---    |  |
+    |     |                           |  ^     |  |
+    |     |<---------- w[] ---------->|  |     |  |
+    |     |                           |  |     |  |
+    |     |                           |        |
+    |     |                           |  h[]   |  e[]
+    |     |                           |        |
+    |     |                           |  |     |  |
+    |     |                           |  |     |  |
+    |     |                           |  v     |  |
+    |     +---------------------------+ ---    |  |
+    |                                          |  v
+    +------------------------------------------+ ---
+
+    |<----------------- s[] ------------------>|
+*/
+typedef struct
+{
+	/* width of each image plane */
+	int	w[MM_PLAYER_IMGB_MPLANE_MAX];
+	/* height of each image plane */
+	int	h[MM_PLAYER_IMGB_MPLANE_MAX];
+	/* stride of each image plane */
+	int	s[MM_PLAYER_IMGB_MPLANE_MAX];
+	/* elevation of each image plane */
+	int	e[MM_PLAYER_IMGB_MPLANE_MAX];
+	/* user space address of each image plane */
+	void	*a[MM_PLAYER_IMGB_MPLANE_MAX];
+	/* physical address of each image plane, if needs */
+	void	*p[MM_PLAYER_IMGB_MPLANE_MAX];
+	/* color space type of image */
+	int	cs;
+	/* left postion, if needs */
+	int	x;
+	/* top position, if needs */
+	int	y;
+	/* to align memory */
+	int	__dummy2;
+	/* arbitrary data */
+	int	data[16];
+} MMPlayerMPlaneImage;
+
+typedef struct
+{
+	MMPlayerMPlaneImage image;				/* planes of decoded frame. cs is one of MMPlayerVideoColorspace */
+	unsigned int timestamp;					/* timestamp of frame in msec */
+	void *priv;								/* decoded buffer held by the lease. don't touch it */
+} MMPlayerVideoFrame;
+
+/* descriptor of exported frame. it's sent to consumer over UNIX socket */
+typedef struct
+{
+	unsigned int slot;						/* slot index to release */
+	unsigned int generation;				/* generation of shared memory */
+	unsigned int offset;					/* offset of slot in shared memory */
+	unsigned int size;						/* size of frame data */
+	unsigned int format;					/* MMPlayerVideoColorspace */
+	unsigned int width;
+	unsigned int height;
+	unsigned int planes;					/* number of planes */
+	unsigned int plane_offset[MM_PLAYER_IMGB_MPLANE_MAX];	/* offset of each plane from slot */
+	unsigned int stride[MM_PLAYER_IMGB_MPLANE_MAX];
+	unsigned int elevation[MM_PLAYER_IMGB_MPLANE_MAX];	/* for tiled format only */
+	unsigned long long pts;					/* presentation timestamp in nsec */
+} MMPlayerExportFrameDesc;
+
+/* message sent back by consumer to release a slot */
+typedef struct
+{
+	unsigned int slot;
+	unsigned int generation;
+} MMPlayerExportFrameRelease;
+
+/*
+ * Enumerations of pcm sample format for batched audio stream
+ */
+typedef enum {
+	MM_PLAYER_PCM_FORMAT_S16 = 0,		/**< signed 16bit integer */
+	MM_PLAYER_PCM_FORMAT_F32,			/**< 32bit float in -1.0 ~ 1.0 */
+} MMPlayerPcmFormat;
+
+/* statistics of batched audio stream */
+typedef struct
+{
+	unsigned int overruns;					/* number of buffers dropped because ring was full */
+	unsigned int dropped_frames;			/* number of frames dropped by overrun */
+	unsigned long long delivered_frames;	/* number of frames delivered to callback */
+} MMPlayerPcmBatchStat;
+
+/* result of audio analysis. levels are in dBFS */
+typedef struct
+{
+	int channels;
+	float rms[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX];	/* rms level of each channel */
+	float peak[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX];	/* peak level of each channel */
+	int bands;
+	float band[MM_PLAYER_AUDIO_ANALYSIS_BAND_MAX];		/* spectrum level of log spaced bands, from low to high */
+	unsigned int timestamp;					/* position of the end of analysed audio in msec */
+	unsigned int sequence;					/* increased whenever result is updated. 0 if not analysed yet */
+} MMPlayerAudioAnalysis;
+
+/* throughput of adaptive http streaming in bps */
+typedef struct
+{
+	unsigned int download;			/* network throughput while segments are being downloaded */
+	unsigned int decrypt;			/* decryption throughput while segments are being decrypted */
+} MMPlayerStreamingThroughput;
+
+/*
+ * Enumerations of reason of adaptive bitrate decision
+ */
+typedef enum {
+	MM_PLAYER_STREAMING_ABR_KEEP = 0,		/**< current bitrate fits the estimated throughput */
+	MM_PLAYER_STREAMING_ABR_STARTUP,		/**< not enough throughput samples yet */
+	MM_PLAYER_STREAMING_ABR_UP,				/**< switched up by one step */
+	MM_PLAYER_STREAMING_ABR_DOWN,			/**< switched down to sustainable one */
+	MM_PLAYER_STREAMING_ABR_PANIC,			/**< switched down with buffer running out */
+	MM_PLAYER_STREAMING_ABR_HOLD,			/**< switch up is held by hysteresis or low buffer */
+	MM_PLAYER_STREAMING_ABR_BUFFERED,		/**< switch down is not needed with full buffer */
+} MMPlayerStreamingAbrReason;
+
+/* bitrate decision of adaptive http streaming, made after each segment */
+typedef struct
+{
+	unsigned int segment;				/* number of segments decided so far */
+	unsigned int throughput;			/* throughput of the segment in bps. 0 if not measured */
+	unsigned int estimate;				/* smoothed throughput in bps */
+	unsigned int buffer_msec;			/* media buffered ahead of playback */
+	unsigned int from_bandwidth;		/* bandwidth of variant before the decision */
+	unsigned int to_bandwidth;			/* bandwidth of variant chosen */
+	MMPlayerStreamingAbrReason reason;
+} MMPlayerStreamingAbrDecision;
+
+/*
+ * Enumerations of volume fade curve
+ */
+typedef enum {
+	MM_PLAYER_FADE_CURVE_LINEAR = 0,		/**< gain changes by same amount every sample */
+	MM_PLAYER_FADE_CURVE_EXPONENTIAL,		/**< gain changes by same dB every sample */
+} MMPlayerFadeCurve;
+
 /**
  * Buffer need data callback function type.
  *
@@ -154,6 +337,29 @@ typedef bool	(*mm_player_buffer_seek_data_callback) (unsigned long long offset,
  */
 typedef bool	(*mm_player_video_stream_callback) (void *stream, int stream_size, void *user_param, int width, int height);
 
+/**
+ * Continuous video capture callback function type.
+ *
+ * @param	frame		[in]	Captured frame. It should be released by mm_player_release_captured_frame()
+ * @param	user_param	[in]	User defined parameter which is passed when continuous
+ *								capture is started
+ *
+ * @return	This callback function have to return MM_ERROR_NONE.
+ */
+typedef bool	(*mm_player_continuous_capture_callback) (MMPlayerCaptureFrame *frame, void *user_param);
+
+/**
+ * Video frame lease callback function type.
+ *
+ * @param	frame		[in]	Decoded frame leased to application. It should be released
+ *								by mm_player_release_video_frame()
+ * @param	user_param	[in]	User defined parameter which is passed when set
+ *								video frame callback
+ *
+ * @return	This callback function have to return MM_ERROR_NONE.
+ */
+typedef bool	(*mm_player_video_frame_callback) (MMPlayerVideoFrame *frame, void *user_param);
+
 /**
  * Audio stream callback function type.
  *
@@ -166,6 +372,29 @@ typedef bool	(*mm_player_video_stream_callback) (void *stream, int stream_size,
  */
 typedef bool	(*mm_player_video_capture_callback) (void *stream, int stream_size, void *user_param);
 
+/**
+ * PCM extraction progress callback function type.
+ *
+ * @param	position	[in]	Length of extracted pcm in msec
+ * @param	duration	[in]	Length of range to extract in msec
+ * @param	user_param	[in]	User defined parameter which is passed when pcm
+ *								extraction is started
+ *
+ * @return	This callback function have to return MM_ERROR_NONE.
+ */
+typedef bool	(*mm_player_pcm_progress_callback) (int position, int duration, void *user_param);
+
+/**
+ * Volume fade done callback function type.
+ *
+ * @param	gain		[in]	Gain reached by fade
+ * @param	user_param	[in]	User defined parameter which is passed when set
+ *								to volume fade callback
+ *
+ * @return	This callback function have to return MM_ERROR_NONE.
+ */
+typedef bool	(*mm_player_volume_fade_callback) (float gain, void *user_param);
+
 /**
  * This function is to set play speed for playback.
  *
@@ -191,12 +420,82 @@ int mm_player_set_play_speed(MMHandleType player, float rate);
  *
  * @return	This function returns zero on success, or negative value with error
  *			code.
- * @remark
+ * @remark	Frame is converted to 32bit RGB and valid only in the callback.
+ *			mm_player_set_video_frame_callback() can be used to get decoded frames without copy.
  * @see		mm_player_video_stream_callback mm_player_set_audio_stream_callback
  * @since
  */
 int mm_player_set_video_stream_callback(MMHandleType player, mm_player_video_stream_callback callback, void *user_param);
 
+/**
+ * This function set callback function for leasing decoded video frames from player.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	callback	[in]	Video frame callback function.
+ * @param	max_leases	[in]	Maximum number of frames application can hold. (1 ~ MM_PLAYER_VIDEO_FRAME_LEASE_MAX)
+ * @param	user_param	[in]	User parameter.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ * @remark	It should be set before realizing player. Frames are passed in decoded format
+ *			such as I420, NV12 or NV12 tiled without conversion and copy. The decoded buffer
+ *			is kept until the frame is released. Frames are dropped while application
+ *			holds max_leases frames, so that decoder doesn't run out of buffers.
+ *			All frames should be released before unrealizing player.
+ * @see		mm_player_video_frame_callback mm_player_release_video_frame
+ * @since
+ */
+int mm_player_set_video_frame_callback(MMHandleType player, mm_player_video_frame_callback callback, int max_leases, void *user_param);
+
+/**
+ * This function releases video frame leased by video frame callback.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	frame		[in]	Leased video frame.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ * @remark	Frame can't be used after release.
+ * @see		mm_player_set_video_frame_callback
+ * @since
+ */
+int mm_player_release_video_frame(MMHandleType player, MMPlayerVideoFrame *frame);
+
+/**
+ * This function is to export video frames to other process through shared memory.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	path		[in]	Path of UNIX socket which player listens on.
+ * @param	slot_count	[in]	Number of frame slots. (1 ~ MM_PLAYER_EXPORT_SLOT_MAX)
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	Consumer connects to the SOCK_SEQPACKET socket of path. Each frame which reaches
+ *			video sink is copied to a slot of memfd backed memory and MMPlayerExportFrameDesc
+ *			is sent for it. The memfd is attached with SCM_RIGHTS to the first descriptor
+ *			of each generation, and consumer should map it again when it comes.
+ *			Consumer sends MMPlayerExportFrameRelease back when it's done with a slot.
+ *			Frames are dropped if there's no free slot. One consumer is served at a time.
+ * @see		mm_player_stop_frame_export
+ * @since
+ */
+int mm_player_start_frame_export(MMHandleType player, const char *path, int slot_count);
+
+/**
+ * This function is to stop exporting video frames.
+ *
+ * @param	player		[in]	Handle of player.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	Consumer is disconnected and socket file is removed.
+ * @see		mm_player_start_frame_export
+ * @since
+ */
+int mm_player_stop_frame_export(MMHandleType player);
+
 /**
  * This function set callback function for receiving audio stream from player.
  *
@@ -212,6 +511,212 @@ int mm_player_set_video_stream_callback(MMHandleType player, mm_player_video_str
  */
 int mm_player_set_audio_buffer_callback(MMHandleType player, mm_player_audio_stream_callback callback, void *user_param);
 
+/**
+ * This function is to deliver audio stream in fixed size chunks from separated thread.
+ *
+ * @param	player			[in]	Handle of player.
+ * @param	chunk_frames	[in]	Number of frames in a chunk. 0 to disable batching.
+ * @param	format			[in]	Sample format of chunk.
+ * @param	planar			[in]	TRUE to put channels one after another in a chunk.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	It should be set before realizing player with audio stream callback.
+ *			Streaming thread only copies decoded samples into a ring buffer, and the callback
+ *			is called from delivery thread with chunk_frames frames. So, slow callback doesn't
+ *			stall decoding. But, if the ring is full, decoded buffers are dropped and counted
+ *			as overrun. The last chunk of stream can be shorter than chunk_frames.
+ *			In planar layout, each channel of the chunk has as many samples as frames of the chunk.
+ *			Chunk is valid only in the callback.
+ * @see		mm_player_set_audio_stream_callback, mm_player_get_audio_stream_batch_stat
+ * @since
+ */
+int mm_player_set_audio_stream_batch(MMHandleType player, int chunk_frames, MMPlayerPcmFormat format, int planar);
+
+/**
+ * This function is to get statistics of batched audio stream.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	stat		[out]	Statistics of current or last batched stream.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ * @remark
+ * @see		mm_player_set_audio_stream_batch
+ * @since
+ */
+int mm_player_get_audio_stream_batch_stat(MMHandleType player, MMPlayerPcmBatchStat *stat);
+
+/**
+ * This function is to analyse level and spectrum of audio during playback.
+ *
+ * @param	player			[in]	Handle of player.
+ * @param	interval_msec	[in]	Interval of analysis in msec. (10 ~ 10000) 0 to disable.
+ * @param	bands			[in]	Number of spectrum bands. (0 ~ MM_PLAYER_AUDIO_ANALYSIS_BAND_MAX)
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	Audio is analysed on the audio streaming thread after volume is applied,
+ *			without copying it to application. RMS and peak of each channel cover whole
+ *			interval, and spectrum covers the last 1024 samples of interval.
+ *			Signed 16bit and 32bit float audio can be analysed. It can be set at any time,
+ *			and the result can be read by mm_player_get_audio_analysis().
+ * @see		mm_player_get_audio_analysis
+ * @since
+ */
+int mm_player_set_audio_analysis(MMHandleType player, int interval_msec, int bands);
+
+/**
+ * This function is to get the latest result of audio analysis.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	result		[out]	Latest result of analysis.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ * @remark	Compare sequence of result to know whether it's updated.
+ * @see		mm_player_set_audio_analysis
+ * @since
+ */
+int mm_player_get_audio_analysis(MMHandleType player, MMPlayerAudioAnalysis *result);
+
+/**
+ * This function is to extract pcm of a range as fast as decoder can.
+ *
+ * @param	player			[in]	Handle of player.
+ * @param	start_msec		[in]	Start position of range in msec.
+ * @param	end_msec		[in]	End position of range in msec. 0 means end of stream.
+ * @param	segment_count	[in]	Number of segments decoded in parallel. (1 ~ 8)
+ * @param	callback		[in]	Callback to receive pcm.
+ * @param	progress_callback	[in]	Callback to receive progress. It can be NULL.
+ * @param	user_param		[in]	User parameter of callbacks.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	It returns after whole range is delivered. The range is decoded by separated
+ *			pipelines without clock, so it doesn't affect playback. If segment_count is
+ *			greater than 1, the range is split into as many segments which are decoded in
+ *			parallel, and pcm is delivered in order of position without gap or overlap.
+ *			Segments are not shorter than 10 seconds, and decoding of later segments
+ *			pauses once 1MB of each is waiting for the segments before it to be delivered.
+ *			Other player apis are not blocked meanwhile.
+ *			Format follows "pcm_extraction_samplerate", "pcm_extraction_channels" and
+ *			"pcm_extraction_depth". Progress is reported for every percent of the range
+ *			when the range is known.
+ * @see		mm_player_audio_stream_callback, mm_player_pcm_progress_callback
+ * @since
+ */
+int mm_player_extract_pcm(MMHandleType player, int start_msec, int end_msec, int segment_count,
+	mm_player_audio_stream_callback callback, mm_player_pcm_progress_callback progress_callback, void *user_param);
+
+/**
+ * This function is to fade volume to a target gain.
+ *
+ * @param	player			[in]	Handle of player.
+ * @param	gain			[in]	Target gain. (0.0 ~ 1.0)
+ * @param	duration_msec	[in]	Duration of fade in msec. 0 changes gain at once.
+ * @param	curve			[in]	Curve of fade.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	Gain is applied after volume, and changes every sample from the current gain.
+ *			A running fade is replaced. mm_player_volume_fade_callback is called when the
+ *			target is reached. If "sound_fade_time" attribute is not 0, pause, resume and
+ *			stop fade out and in for that time.
+ * @see		mm_player_set_volume_fade_callback
+ * @since
+ */
+int mm_player_set_volume_fade(MMHandleType player, float gain, int duration_msec, MMPlayerFadeCurve curve);
+
+/**
+ * This function is to set callback called when volume fade is done.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	callback	[in]	Fade done callback. NULL to unset.
+ * @param	user_param	[in]	User parameter.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ * @remark	It's called on audio streaming thread for fades of pause, resume and stop too.
+ * @see		mm_player_set_volume_fade
+ * @since
+ */
+int mm_player_set_volume_fade_callback(MMHandleType player, mm_player_volume_fade_callback callback, void *user_param);
+
+/**
+ * This function is to switch audio sink without stopping playback.
+ *
+ * @param	player		[in]	Handle of player.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	New audio sink is created with current "sound_volume_type", "sound_route",
+ *			"sound_priority" and "sound_spk_out_only" attributes. Setting "sound_route" or
+ *			"sound_spk_out_only" switches audio sink by itself. New sink gets ready while
+ *			current sink is playing, and it's linked between buffers without preroll. Position keeps going on, and current
+ *			sink plays out sound it has before it's released. If player is paused, it's
+ *			linked when resumed. It fails while previous switch is not finished.
+ * @see		mm_player_get_audio_sink_switch_gap
+ * @since
+ */
+int mm_player_switch_audio_sink(MMHandleType player);
+
+/**
+ * This function is to get silence gap of last audio sink switch.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	gap_usec	[out]	Gap between the end of sound given to previous sink and the
+ *								start of sound in new sink in usec. -1 if not measured yet.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	It's measured in running time of pipeline when first buffer reaches new sink.
+ *			It includes sound lost in switching and delay of new sink, but not output
+ *			latency of device.
+ * @see		mm_player_switch_audio_sink
+ * @since
+ */
+int mm_player_get_audio_sink_switch_gap(MMHandleType player, int *gap_usec);
+
+/**
+ * This function is to get throughput of adaptive http streaming.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	throughput	[out]	Download and decryption throughput in bps. 0 if not measured yet.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code. MM_ERROR_PLAYER_NO_OP is returned if it's not HLS streaming.
+ *
+ * @remark	Segments are downloaded and decrypted by different threads, so each one is
+ *			measured only in the time spent on it. Playback can't go faster than the
+ *			lower one.
+ * @since
+ */
+int mm_player_get_streaming_throughput(MMHandleType player, MMPlayerStreamingThroughput *throughput);
+
+/**
+ * This function is to get recent bitrate decisions of adaptive http streaming.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	decisions	[out]	Array to be filled with decisions, oldest first.
+ * @param	max			[in]	Number of entries of decisions.
+ * @param	count		[out]	Number of decisions filled.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code. MM_ERROR_PLAYER_NO_OP is returned if it's not HLS streaming.
+ *
+ * @remark	Up to 32 latest decisions are kept. Variant is chosen by harmonic mean of
+ *			throughput of recent segments and media time buffered ahead of playback.
+ * @since
+ */
+int mm_player_get_streaming_abr_log(MMHandleType player, MMPlayerStreamingAbrDecision *decisions, int max, int *count);
+
 /**
  * This function is to capture video frame. 
  *
@@ -222,11 +727,85 @@ int mm_player_set_audio_buffer_callback(MMHandleType player, mm_player_audio_str
  *
  * @remark	Captured buffer is sent asynchronously through message callback with MM_MESSAGE_VIDEO_CAPTURED. 
  *			And, application should free the captured buffer directly. 
+ *			Format and size of captured buffer follow "capture_format", "capture_width" and "capture_height".
  * @see		MM_MESSAGE_VIDEO_CAPTURED
  * @since
  */
 int mm_player_do_video_capture(MMHandleType player);
 
+/**
+ * This function is to extract video frames at given positions without display.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	positions	[in]	Array of positions to extract in msec.
+ * @param	count		[in]	Number of positions.
+ * @param	width		[in]	Width of extracted frames.
+ * @param	height		[in]	Height of extracted frames.
+ * @param	frames		[out]	Array of extracted frames in the order of positions.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	Frames are decoded from the nearest key frame of each position by separated pipeline,
+ *			so it does not affect playback. The output is RGB888 and application should free
+ *			the data of each frame directly.
+ * @see		mm_player_do_video_capture
+ * @since
+ */
+int mm_player_extract_video_frames(MMHandleType player, const int *positions, int count, int width, int height, MMPlayerVideoCapture *frames);
+
+/**
+ * This function is to capture video frames continuously during playback.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	frame_interval	[in]	Capture every Nth frame. 0 to use fps.
+ * @param	fps		[in]	Capture frames at this rate if frame_interval is 0.
+ * @param	slot_count	[in]	Number of frame slots. (1 ~ MM_PLAYER_CAPTURE_SLOT_MAX)
+ * @param	callback	[in]	Callback to receive captured frames.
+ * @param	user_param	[in]	User parameter of callback.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	Frames are converted into preallocated slots and delivered from capture thread.
+ *			A slot is not reused until it's released by mm_player_release_captured_frame().
+ *			If all slots are in use or capture thread is busy, frames are dropped
+ *			instead of blocking playback. Format and size follow "capture_format",
+ *			"capture_width" and "capture_height". Don't stop capture in the callback.
+ * @see		mm_player_stop_continuous_capture, mm_player_release_captured_frame
+ * @since
+ */
+int mm_player_start_continuous_capture(MMHandleType player, int frame_interval, int fps, int slot_count, mm_player_continuous_capture_callback callback, void *user_param);
+
+/**
+ * This function is to stop continuous capture.
+ *
+ * @param	player		[in]	Handle of player.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	All slots are freed. Frames delivered before can't be used any more.
+ * @see		mm_player_start_continuous_capture
+ * @since
+ */
+int mm_player_stop_continuous_capture(MMHandleType player);
+
+/**
+ * This function is to give a slot of continuous capture back to player.
+ *
+ * @param	player		[in]	Handle of player.
+ * @param	slot		[in]	Slot index of captured frame.
+ *
+ * @return	This function returns zero on success, or negative value with error
+ *			code.
+ *
+ * @remark	It can be called in the callback of continuous capture.
+ * @see		mm_player_start_continuous_capture
+ * @since
+ */
+int mm_player_release_captured_frame(MMHandleType player, int slot);
+
 /**
  * This function set callback function for receiving need data message from player.
  *
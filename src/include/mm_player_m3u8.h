@@ -28,6 +28,12 @@
  * - gst_m3u8_client_get_next_fragment is modified.
  * - gst_m3u8_client_check_next_fragment is added.
  * File name is changed to mm_player_m3u8.c
+ * For long live playlists,
+ * - gst_m3u8_update is rewritten to parse in single pass with table of tags.
+ * - media files are kept in array and relative uris share base of playlist.
+ * - media files of live playlist are kept over refresh by sequence number.
+ * - media files are indexed by sequence in ring and remaining duration is kept.
+ * - media files are allocated from arena of playlist and repeated strings are interned.
  */
 
 
@@ -39,9 +45,24 @@
 G_BEGIN_DECLS typedef struct _GstM3U8 GstM3U8;
 typedef struct _GstM3U8MediaFile GstM3U8MediaFile;
 typedef struct _GstM3U8Client GstM3U8Client;
+typedef struct _GstM3U8FileRing GstM3U8FileRing;
+typedef struct _GstM3U8ArenaChunk GstM3U8ArenaChunk;
 
 #define GST_M3U8_MEDIA_FILE(f) ((GstM3U8MediaFile*)f)
 
+#define GST_M3U8_DIGEST_SIZE 16
+
+/* media files in order of sequence. sequences are contiguous */
+struct _GstM3U8FileRing
+{
+  GstM3U8MediaFile **data;
+  guint size;                   /* allocated, power of 2 */
+  guint head;                   /* index of the first one */
+  guint len;
+};
+
+#define gst_m3u8_file_ring_index(ring, i) ((ring)->data[((ring)->head + (i)) & ((ring)->size - 1)])
+
 struct _GstM3U8
 {
   gchar *uri;
@@ -53,29 +74,36 @@ struct _GstM3U8
 
   gint bandwidth;
   gint program_id;
-  gchar *codecs;
+  const gchar *codecs;          /* interned in main playlist */
   gint width;
   gint height;
-  GList *files;
+  GstM3U8FileRing files;
 
   /*< private > */
-  gchar *last_data;
+  gchar *base_dir;              /* base of relative uri */
+  gchar *base_root;             /* base of absolute path */
+  guint8 last_digest[GST_M3U8_DIGEST_SIZE];     /* digest of last playlist text */
+  gboolean has_last_digest;
   GList *lists;                 /* list of GstM3U8 from the main playlist */
   GstM3U8 *parent;              /* main playlist (if any) */
   guint mediasequence;          /* EXT-X-MEDIA-SEQUENCE & increased with new media file */
+  gint64 duration_end;          /* running sum of durations of media files added */
+  GstM3U8ArenaChunk *arena_head;        /* media files and their strings */
+  GstM3U8ArenaChunk *arena_tail;
+  GHashTable *strings;          /* interned key urls, uri directories and codecs, counted by users */
 };
 
 struct _GstM3U8MediaFile
 {
   gchar *title;
   gint duration;
+  const gchar *base;            /* shared base of uri, or interned directory of absolute uri */
   gchar *uri;
   guint sequence;               /* the sequence nb of this file */
+  gint64 offset;                /* running sum of durations before this file */
 
-  gchar *key_url;
-  unsigned char key[16];
+  const gchar *key_url;         /* interned in playlist */
   unsigned char iv[16];
-  
 };
 
 struct _GstM3U8Client
@@ -92,6 +120,7 @@ void gst_m3u8_client_free (GstM3U8Client * client);
 gboolean gst_m3u8_client_update (GstM3U8Client * client, gchar * data);
 void gst_m3u8_client_set_current (GstM3U8Client * client, GstM3U8 * m3u8);
 const GstM3U8MediaFile *gst_m3u8_client_get_next_fragment (GstM3U8Client * client,  gboolean * discontinuity);
+gchar *gst_m3u8_media_file_get_uri (const GstM3U8MediaFile * file);
 #define gst_m3u8_client_get_uri(Client) ((Client)->main->uri)
 #define gst_m3u8_client_has_variant_playlist(Client) ((Client)->main->lists)
 #define gst_m3u8_client_is_live(Client) (!(Client)->current->endlist)
@@ -0,0 +1,114 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef __MM_PLAYER_PCM_H__
+#define __MM_PLAYER_PCM_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <mm_types.h>
+#include "mm_player_priv.h"
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to configure batched delivery of audio stream.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	chunk_frames	Number of frames per chunk. 0 disables batching.
+ * @param[in]	format		Sample format of chunk.
+ * @param[in]	planar		Layout of chunk.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	It's applied when audio stream callback is configured.
+ * @see		_mmplayer_start_pcm_batch
+ *
+ */
+int _mmplayer_set_pcm_batch(MMHandleType hplayer, int chunk_frames, MMPlayerPcmFormat format, int planar);
+/**
+ * This function is to get statistics of batched delivery.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[out]	stat		Statistics of running or last batch.
+ * @return	This function returns zero on success, or negative value with errors.
+ *
+ */
+int _mmplayer_get_pcm_batch_stat(MMHandleType hplayer, MMPlayerPcmBatchStat *stat);
+/**
+ * This function is to extract pcm of a range faster than realtime.
+ *
+ * @param[in]	handle		Handle of player.
+ * @param[in]	start_msec	Start position of range.
+ * @param[in]	end_msec	End position of range. 0 means end of stream.
+ * @param[in]	segment_count	Number of segments decoded in parallel.
+ * @param[in]	callback	Callback to receive pcm in order of position.
+ * @param[in]	progress_callback	Callback to receive progress. It can be NULL.
+ * @param[in]	user_param	User parameter of callbacks.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	It returns after whole range is delivered. Format follows
+ *		"pcm_extraction_samplerate", "pcm_extraction_channels" and "pcm_extraction_depth".
+ *
+ */
+int _mmplayer_extract_pcm(MMHandleType hplayer, int start_msec, int end_msec, int segment_count,
+	mm_player_audio_stream_callback callback, mm_player_pcm_progress_callback progress_callback, void *user_param);
+/**
+ * This function is to start delivery thread of batched audio stream.
+ *
+ * @param[in]	player		Handle of player.
+ * @return	This function returns zero on success, or negative value with errors.
+ * @remarks	Callback and user parameter of audio stream are taken at this time.
+ * @see		_mmplayer_stop_pcm_batch, _mmplayer_push_pcm_batch
+ *
+ */
+int _mmplayer_start_pcm_batch(mm_player_t* player);
+/**
+ * This function is to stop delivery thread of batched audio stream.
+ *
+ * @param[in]	player		Handle of player.
+ * @param[in]	flush		Deliver frames remained in ring before stop.
+ * @remarks	Streaming thread should not push any more when it's called.
+ *		It's ok to call it when batch is not started.
+ * @see		_mmplayer_start_pcm_batch
+ *
+ */
+void _mmplayer_stop_pcm_batch(mm_player_t* player, gboolean flush);
+/**
+ * This function is to put decoded audio into ring of batched delivery.
+ *
+ * @param[in]	player		Handle of player.
+ * @param[in]	buffer		Decoded audio buffer.
+ * @remarks	It's called on streaming thread and never blocks. Buffer is dropped if ring is full.
+ *
+ */
+void _mmplayer_push_pcm_batch(mm_player_t* player, GstBuffer *buffer);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif
@@ -55,7 +55,6 @@
 |    GLOBAL #defines:														|
 ---------------------------------------------------------------------------*/
 
-#define MM_PLAYER_IMGB_MPLANE_MAX	4
 #define MM_PLAYER_STREAM_COUNT_MAX	3
 
 #define MM_PLAYER_CAST(x_player) 		((mm_player_t *)(x_player))
@@ -180,6 +179,7 @@ enum AudioElementID
 	MMPLAYER_A_CAPS_DEFAULT,
 	MMPLAYER_A_SINK,
 	MMPLAYER_A_RESAMPLER,
+	MMPLAYER_A_FADE,
 	MMPLAYER_A_NUM
 };
 
@@ -328,6 +328,26 @@ typedef struct
 	int bluetooth;	/* enable/disable */
 } MMPlayerSoundInfo;
 
+/* audio sink switch without stopping playback */
+typedef struct
+{
+	GstPad *pad;			/* src pad feeding audio sink */
+	gulong event_probe_id;
+	gulong buffer_probe_id;
+	GstSegment segment;		/* segment as audio sink sees */
+	gboolean has_segment;
+	GstClockTime last_stop;	/* running time of the end of last buffer */
+
+	GstElement *new_sink;	/* waiting for the pad to be blocked */
+	GstElement *old_sink;	/* playing out its ring buffer */
+	guint drain_timer;
+
+	gboolean measuring;
+	GstClockTime switch_stop;	/* running time of the end of sound given to old sink */
+	gint gap_usec;			/* silence gap of last switch. -1 if not measured */
+	gboolean route_pending;	/* route is changed while switching. switched again after it */
+} MMPlayerAudioSinkSwitch;
+
 typedef struct {
 	char *buf;
 	int len;
@@ -355,52 +375,126 @@ typedef struct {
 	gulong sig;
 } MMPlayerSignalItem;
 
-/* image buffer definition ***************************************************
-
-    +------------------------------------------+ ---
-    |                                          |  ^
-    |     a[], p[]                             |  |
-    |     +---------------------------+ ---    |  |
-    |     |                           |  ^     |  |
-    |     |<---------- w[] ---------->|  |     |  |
-    |     |                           |  |     |  |
-    |     |                           |        |
-    |     |                           |  h[]   |  e[]
-    |     |                           |        |
-    |     |                           |  |     |  |
-    |     |                           |  |     |  |
-    |     |                           |  v     |  |
-    |     +---------------------------+ ---    |  |
-    |                                          |  v
-    +------------------------------------------+ ---
-
-    |<----------------- s[] ------------------>|
-*/
+/* a frame slot of continuous capture */
 typedef struct
 {
-	/* width of each image plane */
-	int	w[MM_PLAYER_IMGB_MPLANE_MAX];
-	/* height of each image plane */
-	int	h[MM_PLAYER_IMGB_MPLANE_MAX];
-	/* stride of each image plane */
-	int	s[MM_PLAYER_IMGB_MPLANE_MAX];
-	/* elevation of each image plane */
-	int	e[MM_PLAYER_IMGB_MPLANE_MAX];
-	/* user space address of each image plane */
-	void	*a[MM_PLAYER_IMGB_MPLANE_MAX];
-	/* physical address of each image plane, if needs */
-	void	*p[MM_PLAYER_IMGB_MPLANE_MAX];
-	/* color space type of image */
-	int	cs;
-	/* left postion, if needs */
-	int	x;
-	/* top position, if needs */
-	int	y;
-	/* to align memory */
-	int	__dummy2;
-	/* arbitrary data */
-	int	data[16];
-} MMPlayerMPlaneImage;
+	MMPlayerCaptureFrame frame;
+	int capacity;				/* allocated size of frame.image.data */
+	gint in_use;				/* application owns it until released */
+} MMPlayerCaptureSlot;
+
+/* continuous capture */
+typedef struct
+{
+	int interval;				/* capture every Nth frame */
+	GstClockTime period;		/* or capture frames at this period */
+	GstClockTime next_ts;
+	GstClockTime last_ts;
+	guint frame_count;
+	guint dropped;
+
+	GstPad *pad;
+	gulong probe_id;
+	GstBuffer *pending;		/* buffer waiting for capture thread */
+	int pending_slot;
+
+	MMPlayerCaptureSlot *slots;
+	int slot_count;
+	int next_slot;
+
+	mm_player_continuous_capture_callback callback;
+	void *user_param;
+
+	/* with capture mutex. callback is called without it, so stop can be called in it */
+	gboolean delivering;
+	gboolean stopped;			/* stopped while delivering. capture thread frees it */
+} MMPlayerContinuousCapture;
+
+/* cross process frame export */
+typedef struct
+{
+	gchar *path;				/* path of listening socket */
+	int listen_fd;
+	int client_fd;				/* connected consumer */
+
+	int mem_fd;					/* memfd of all slots */
+	unsigned char *mem;
+	gsize mem_size;
+	gsize slot_size;
+	unsigned int generation;	/* increased whenever memfd is reallocated */
+	gboolean send_fd;			/* consumer doesn't have current memfd */
+
+	gboolean *in_use;			/* consumer owns the slot until released */
+	int slot_count;
+	int next_slot;
+	guint dropped;
+
+	GstPad *pad;
+	gulong probe_id;
+} MMPlayerFrameExport;
+
+/* batched pcm delivery of audio stream callback */
+typedef struct
+{
+	/* single producer(streaming thread), single consumer(delivery thread) ring of S16 interleaved frames.
+	 * head is written by producer only and tail by consumer only.
+	 */
+	guint8 *ring;
+	guint ring_frames;			/* power of 2 */
+	gint head;
+	gint tail;
+
+	int channels;
+	int rate;
+	gboolean passthrough;		/* stream is not S16, so it's delivered directly */
+
+	int chunk_frames;
+	MMPlayerPcmFormat format;
+	gboolean planar;
+	guint8 *chunk;				/* chunk in delivery format */
+
+	GThread *thread;
+	GMutex *lock;
+	GCond *cond;
+	gint waiting;				/* delivery thread is waiting for data */
+	gint flush;					/* deliver remained frames before exit */
+	gint exit;
+
+	MMPlayerPcmBatchStat stat;
+
+	mm_player_audio_stream_callback callback;
+	void *user_param;
+} MMPlayerPcmBatch;
+
+/* level and spectrum analysis of audio */
+typedef struct
+{
+	GMutex *lock;
+	GstPad *pad;
+	gulong probe_id;
+
+	int interval;				/* msec. 0 means disabled */
+	int bands;
+	int channels;
+	int rate;
+
+	/* accumulation of current interval */
+	guint interval_frames;
+	guint frames;
+	gdouble sum[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX];
+	gfloat peak[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX];
+
+	/* mono mix of the last samples of interval for spectrum */
+	gfloat *history;
+	guint history_pos;
+	gfloat *window;
+	gfloat *re;
+	gfloat *im;
+	gfloat *twiddle;			/* cos and sin of fft */
+	guint band_edge[MM_PLAYER_AUDIO_ANALYSIS_BAND_MAX + 1];	/* first fft bin of each band */
+
+	MMPlayerAudioAnalysis result;
+} MMPlayerAudioAnalyzer;
 
 typedef struct {
 	/* STATE */
@@ -435,9 +529,13 @@ typedef struct {
 	gboolean capture_thread_exit;
 	GCond* capture_thread_cond;
 	GMutex* capture_thread_mutex;
+	GMutex* continuous_capture_lock;	/* for continuous_capture and its counters. not held while converting */
 	MMPlayerVideoCapture capture;
 	MMPlayerVideoColorspace video_cs;	
 	MMPlayerMPlaneImage captured;
+	MMPlayerVideoColorspace capture_fmt;	/* requested output of capture */
+	int capture_width;
+	int capture_height;
 	
 	/* fakesink handling lock */
 	GMutex* fsink_lock;
@@ -474,6 +572,13 @@ typedef struct {
 	void* video_stream_cb_user_param;
 	int use_video_stream;
 
+	/* for video frame lease */
+	mm_player_video_frame_callback video_frame_cb;
+	void* video_frame_cb_user_param;
+	gint video_frame_max_leases;
+	gint video_frame_leases;
+	gint video_frame_session;	/* increased on unrealize. leases of old session are not counted */
+
 	/* audio stram callback */
 	mm_player_audio_stream_callback audio_stream_cb;
 	void* audio_stream_cb_user_param;
@@ -485,6 +590,32 @@ typedef struct {
 	/* video capture callback*/
 	gulong video_capture_cb_probe_id;
 
+	/* continuous video capture */
+	MMPlayerContinuousCapture *continuous_capture;
+
+	/* video frame export to other process */
+	MMPlayerFrameExport *frame_export;
+	GMutex *frame_export_lock;
+
+	/* batched pcm delivery */
+	int pcm_batch_frames;		/* 0 means no batching */
+	MMPlayerPcmFormat pcm_batch_format;
+	gboolean pcm_batch_planar;
+	MMPlayerPcmBatch *pcm_batch;
+	MMPlayerPcmBatchStat pcm_batch_stat;	/* stat of last stopped batch */
+	GMutex *pcm_batch_lock;
+
+	/* audio level and spectrum analysis */
+	MMPlayerAudioAnalyzer *audio_analyzer;
+
+	/* volume fade */
+	mm_player_volume_fade_callback volume_fade_cb;
+	void* volume_fade_cb_user_param;
+
+	/* audio sink switch */
+	MMPlayerAudioSinkSwitch audiosink_switch;
+	GMutex *audiosink_switch_lock;
+
 	/* video display */
 	GstPad* tee_src_pad[2];
 	gboolean use_multi_surface;
@@ -502,6 +633,12 @@ typedef struct {
 	MMAudioFilterInfo audio_filter_info;
 	gboolean bypass_sound_effect;
 
+	/* staged sound filter update. see mm_player_sound_filter_begin_update() */
+	gboolean sound_filter_batch;
+	gboolean sound_filter_staged;
+	MMAudioFilterType sound_filter_staged_type;
+	MMAudioFilterPresetType sound_filter_staged_preset;
+
 	gulong audio_cb_probe_id;
 
 	/* for appsrc */
@@ -642,6 +779,12 @@ int _mmplayer_set_volume(MMHandleType hplayer, MMPlayerVolumeType volume);
 int _mmplayer_get_volume(MMHandleType hplayer, MMPlayerVolumeType *volume);
 int _mmplayer_set_mute(MMHandleType hplayer, int mute);
 int _mmplayer_get_mute(MMHandleType hplayer, int* pmute);
+int _mmplayer_set_volume_fade(MMHandleType hplayer, float gain, int duration_msec, MMPlayerFadeCurve curve);
+int _mmplayer_set_volume_fade_cb(MMHandleType hplayer, mm_player_volume_fade_callback callback, void *user_param);
+int _mmplayer_switch_audio_sink(MMHandleType hplayer);
+int _mmplayer_get_audio_sink_switch_gap(MMHandleType hplayer, int *gap_usec);
+int _mmplayer_get_streaming_throughput(MMHandleType hplayer, MMPlayerStreamingThroughput *throughput);
+int _mmplayer_get_streaming_abr_log(MMHandleType hplayer, MMPlayerStreamingAbrDecision *decisions, int max, int *count);
 int _mmplayer_start(MMHandleType hplayer);
 int _mmplayer_stop(MMHandleType hplayer);
 int _mmplayer_pause(MMHandleType hplayer);
@@ -658,6 +801,8 @@ int _mmplayer_set_buffer_seek_data_cb(MMHandleType hplayer,mm_player_buffer_seek
 int _mmplayer_set_playspeed(MMHandleType hplayer, gdouble rate);
 int _mmplayer_set_message_callback(MMHandleType hplayer, MMMessageCallback callback, void *user_param);
 int _mmplayer_set_videostream_cb(MMHandleType hplayer,mm_player_video_stream_callback callback, void *user_param);
+int _mmplayer_set_video_frame_cb(MMHandleType hplayer, mm_player_video_frame_callback callback, int max_leases, void *user_param);
+int _mmplayer_release_video_frame(MMHandleType hplayer, MMPlayerVideoFrame *frame);
 int _mmplayer_set_audiostream_cb(MMHandleType hplayer,mm_player_audio_stream_callback callback, void *user_param);
 int _mmplayer_set_subtitle_silent (MMHandleType hplayer, int silent);
 int _mmplayer_get_subtitle_silent (MMHandleType hplayer, int* silent);
@@ -668,6 +813,7 @@ gboolean	_mmplayer_update_content_attrs(mm_player_t* player);
  */
 int _mmplayer_set_volume_tune(MMHandleType hplayer, MMPlayerVolumeType volume);
 int _mmplayer_update_video_param(mm_player_t* player);
+int _mmplayer_update_audio_route(mm_player_t* player);
 int _mmplayer_set_audiobuffer_cb(MMHandleType hplayer, mm_player_audio_stream_callback callback, void *user_param);
 
 #ifdef __cplusplus
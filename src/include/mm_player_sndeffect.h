@@ -304,6 +304,35 @@ int mm_player_is_supported_preset_filter_type(MMHandleType hplayer, MMAudioFilte
  */
 int mm_player_is_supported_custom_filter_type(MMHandleType hplayer, MMAudioFilterCustomType filter);
 
+/**
+ * This function is to start staging sound filter changes.
+ *
+ * @param	hplayer		[in]	Handle of player.
+ *
+ * @return	This function returns zero on success, or negative value with error code.
+ *
+ * @remark	Until mm_player_sound_filter_commit_update() is called, mm_player_sound_filter_preset_apply(),
+ *		mm_player_sound_filter_custom_apply() and mm_player_sound_filter_bypass() only record the request.
+ *		Levels can be changed freely in the meantime. Useful while UI slider is dragged.
+ * @see		mm_player_sound_filter_commit_update
+ * @since
+ */
+int mm_player_sound_filter_begin_update(MMHandleType hplayer);
+
+/**
+ * This function is to apply staged sound filter changes at once.
+ *
+ * @param	hplayer		[in]	Handle of player.
+ *
+ * @return	This function returns zero on success, or negative value with error code.
+ *
+ * @remark	Only the last requested apply or bypass is done. Built-in equalizer moves
+ *		to the new setting over a short ramp without click.
+ * @see		mm_player_sound_filter_begin_update
+ * @since
+ */
+int mm_player_sound_filter_commit_update(MMHandleType hplayer);
+
 /**
 	@}
  */
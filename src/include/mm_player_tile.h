@@ -0,0 +1,102 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __MM_PLAYER_TILE_H__
+#define __MM_PLAYER_TILE_H__
+
+/*=======================================================================================
+| INCLUDE FILES										|
+========================================================================================*/
+#include <glib.h>
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*=======================================================================================
+| GLOBAL DEFINITIONS AND DECLARATIONS FOR MODULE					|
+========================================================================================*/
+/* widest line detiled by kernels. wider one is detiled by crop */
+#define MMPLAYER_TILE_LINE_WIDTH_MAX	8192
+
+/* copy kernel of 64 bytes tile lines */
+typedef enum
+{
+	MM_PLAYER_TILE_KERNEL_AUTO = 0,		/* best one of this cpu */
+	MM_PLAYER_TILE_KERNEL_C,
+	MM_PLAYER_TILE_KERNEL_SSE2,
+	MM_PLAYER_TILE_KERNEL_AVX2,
+	MM_PLAYER_TILE_KERNEL_NEON,
+	MM_PLAYER_TILE_KERNEL_NUM
+} MMPlayerTileKernel;
+
+/*=======================================================================================
+| GLOBAL FUNCTION PROTOTYPES								|
+========================================================================================*/
+/**
+ * This function is to convert a region of NV12 tiled (ST12) plane to linear.
+ *
+ * @param[out]	dst		Linear plane of (width-left-right) x (height-top-bottom).
+ * @param[in]	src		Y or UV plane of NV12 tiled.
+ * @param[in]	width		Width of plane.
+ * @param[in]	height		Height of plane. It's half of frame for UV.
+ * @param[in]	left, top, right, bottom	Size to crop.
+ * @remarks	It can write a byte more than odd width.
+ *
+ */
+void _mmplayer_tile_to_linear_crop(unsigned char *dst, unsigned char *src, int width, int height,
+		int left, int top, int right, int bottom);
+/**
+ * This function is to convert a line of NV12 tiled (ST12) plane to linear.
+ *
+ * @param[out]	dst		Linear line of width bytes.
+ * @param[in]	src		Y or UV plane of NV12 tiled.
+ * @param[in]	width		Width of plane.
+ * @param[in]	height		Height of plane. It's half of frame for UV.
+ * @param[in]	y		Line to convert.
+ * @remarks	Full 64 bytes tile lines are copied by the kernel selected for this cpu.
+ *		Output is same as _mmplayer_tile_to_linear_crop() of the line.
+ *
+ */
+void _mmplayer_tile_to_linear_line(unsigned char *dst, const unsigned char *src, int width, int height, int y);
+/**
+ * This function is to select copy kernel.
+ *
+ * @param[in]	kernel		Kernel to use. MM_PLAYER_TILE_KERNEL_AUTO selects by cpu.
+ * @return	This function returns TRUE on success, or FALSE if cpu or build doesn't have it.
+ * @remarks	It's for testing. Kernel is selected by cpu if it's not called.
+ *
+ */
+gboolean _mmplayer_tile_set_kernel(MMPlayerTileKernel kernel);
+/**
+ * This function is to get copy kernel in use.
+ *
+ * @return	Kernel selected for this cpu or by _mmplayer_tile_set_kernel().
+ *
+ */
+MMPlayerTileKernel _mmplayer_tile_get_kernel(void);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif	/* __MM_PLAYER_TILE_H__ */
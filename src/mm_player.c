@@ -33,6 +33,9 @@
 #include "mm_player_ini.h"
 #include "mm_debug.h"
 #include "mm_player_capture.h"
+#include "mm_player_frame_export.h"
+#include "mm_player_pcm.h"
+#include "mm_player_audio_analysis.h"
 
 int mm_player_create(MMHandleType *player)
 {
@@ -248,6 +251,189 @@ int mm_player_set_audio_buffer_callback(MMHandleType player, mm_player_audio_str
 	return result;
 }
 
+int mm_player_set_audio_stream_batch(MMHandleType player, int chunk_frames, MMPlayerPcmFormat format, int planar)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_set_pcm_batch(player, chunk_frames, format, planar);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_get_audio_stream_batch_stat(MMHandleType player, MMPlayerPcmBatchStat *stat)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_get_pcm_batch_stat(player, stat);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_set_audio_analysis(MMHandleType player, int interval_msec, int bands)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_set_audio_analysis(player, interval_msec, bands);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_get_audio_analysis(MMHandleType player, MMPlayerAudioAnalysis *result)
+{
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	/* NOTE : it's polled by visualizer frequently. analyzer has its own lock */
+	return _mmplayer_get_audio_analysis(player, result);
+}
+
+int mm_player_set_volume_fade(MMHandleType player, float gain, int duration_msec, MMPlayerFadeCurve curve)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_set_volume_fade(player, gain, duration_msec, curve);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_set_volume_fade_callback(MMHandleType player, mm_player_volume_fade_callback callback, void *user_param)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_set_volume_fade_cb(player, callback, user_param);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_switch_audio_sink(MMHandleType player)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_switch_audio_sink(player);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_get_audio_sink_switch_gap(MMHandleType player, int *gap_usec)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(gap_usec, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_get_audio_sink_switch_gap(player, gap_usec);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_get_streaming_throughput(MMHandleType player, MMPlayerStreamingThroughput *throughput)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(throughput, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_get_streaming_throughput(player, throughput);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_get_streaming_abr_log(MMHandleType player, MMPlayerStreamingAbrDecision *decisions, int max, int *count)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(decisions && max > 0 && count, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_get_streaming_abr_log(player, decisions, max, count);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_extract_pcm(MMHandleType player, int start_msec, int end_msec, int segment_count,
+	mm_player_audio_stream_callback callback, mm_player_pcm_progress_callback progress_callback, void *user_param)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	/* NOTE : it takes time with its own pipelines. so, cmd lock is not held
+	 * not to block other player apis.
+	 */
+	result = _mmplayer_extract_pcm(player, start_msec, end_msec, segment_count, callback, progress_callback, user_param);
+
+	return result;
+}
+
 int mm_player_set_video_stream_callback(MMHandleType player, mm_player_video_stream_callback callback, void *user_param)
 {
 	int result = MM_ERROR_NONE;
@@ -265,6 +451,71 @@ int mm_player_set_video_stream_callback(MMHandleType player, mm_player_video_str
 	return result;
 }
 
+int mm_player_set_video_frame_callback(MMHandleType player, mm_player_video_frame_callback callback, int max_leases, void *user_param)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_set_video_frame_cb(player, callback, max_leases, user_param);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_release_video_frame(MMHandleType player, MMPlayerVideoFrame *frame)
+{
+	int result = MM_ERROR_NONE;
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	/* NOTE : frames can be released in any thread, even in the callback.
+	 * so, cmd lock is not held.
+	 */
+	result = _mmplayer_release_video_frame(player, frame);
+
+	return result;
+}
+
+int mm_player_start_frame_export(MMHandleType player, const char *path, int slot_count)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_start_frame_export(player, path, slot_count);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_stop_frame_export(MMHandleType player)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_stop_frame_export(player);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
 int mm_player_do_video_capture(MMHandleType player)
 {
 	int result = MM_ERROR_NONE;
@@ -282,6 +533,71 @@ int mm_player_do_video_capture(MMHandleType player)
 	return result;
 }
 
+int mm_player_extract_video_frames(MMHandleType player, const int *positions, int count, int width, int height, MMPlayerVideoCapture *frames)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(positions && frames, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	/* NOTE : it takes time with its own pipeline. so, cmd lock is not held
+	 * not to block other player apis.
+	 */
+	result = _mmplayer_extract_video_frames(player, positions, count, width, height, frames);
+
+	return result;
+}
+
+int mm_player_start_continuous_capture(MMHandleType player, int frame_interval, int fps, int slot_count, mm_player_continuous_capture_callback callback, void *user_param)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_start_continuous_capture(player, frame_interval, fps, slot_count, callback, user_param);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_stop_continuous_capture(MMHandleType player)
+{
+	int result = MM_ERROR_NONE;
+
+	debug_log("\n");
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	MMPLAYER_CMD_LOCK( player );
+
+	result = _mmplayer_stop_continuous_capture(player);
+
+	MMPLAYER_CMD_UNLOCK( player );
+
+	return result;
+}
+
+int mm_player_release_captured_frame(MMHandleType player, int slot)
+{
+	int result = MM_ERROR_NONE;
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	/* NOTE : it's called in capture callback usually. so, cmd lock is not held
+	 * not to be blocked by stopping capture.
+	 */
+	result = _mmplayer_release_captured_frame(player, slot);
+
+	return result;
+}
+
 int mm_player_set_buffer_need_data_callback(MMHandleType player, mm_player_buffer_need_data_callback callback, void * user_param)
 {
 	int result = MM_ERROR_NONE;
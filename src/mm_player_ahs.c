@@ -45,94 +45,65 @@ static gpointer manifest_update_thread(gpointer data);
 static gpointer media_download_thread (gpointer data);
 static gboolean ahs_client_is_live (mm_player_ahs_t *ahs_player);
 static gboolean ahs_manifest_get_update_interval (mm_player_ahs_t *ahs_player, GTimeVal *next_update);
-static gboolean ahs_create_manifest_download_pipeline (mm_player_ahs_t *ahs_player);
-static gboolean ahs_create_key_download_pipeline (mm_player_ahs_t *ahs_player);
-static gboolean ahs_create_media_download_pipeline (mm_player_ahs_t *ahs_player);
-static gboolean ahs_parse_manifest_update_client (mm_player_ahs_t *ahs_player);
-static gboolean ahs_manifest_download_callback(GstBus *bus, GstMessage *msg, gpointer data);
-static gboolean ahs_key_download_callback(GstBus *bus, GstMessage *msg, gpointer data);
-static gboolean ahs_media_download_callback(GstBus *bus, GstMessage *msg, gpointer data);
+static gboolean ahs_download_manifest (mm_player_ahs_t *ahs_player, gboolean *reload);
+static gboolean ahs_get_key (mm_player_ahs_t *ahs_player, const gchar *key_uri, gchar *data, GError **error);
+static void ahs_segment_downloaded (mm_player_ahs_t *ahs_player);
+static ahs_segment_t *ahs_segment_new (mm_player_ahs_t *ahs_player, gchar *media_uri, gchar *key_uri, char *iv);
+static void ahs_segment_free (ahs_segment_t *seg);
+static gboolean ahs_prefetch_fill (mm_player_ahs_t *ahs_player);
+static void ahs_prefetch_cancel (mm_player_ahs_t *ahs_player);
+static gboolean ahs_push_segment (mm_player_ahs_t *ahs_player, ahs_segment_t *seg);
+static gint ahs_get_next_sequence (mm_player_ahs_t *ahs_player);
+static void ahs_set_next_sequence (mm_player_ahs_t *ahs_player, gint sequence);
+static gboolean ahs_parse_manifest_update_client (mm_player_ahs_t *ahs_player, gchar *manifest);
+static void ahs_post_error (mm_player_ahs_t *ahs_player, GError *error);
 static gboolean ahs_determining_next_file_load (mm_player_ahs_t *ahs_player, gboolean *is_ready);
 static gboolean ahs_set_current_manifest (mm_player_ahs_t *ahs_player);
 static gchar* ahs_get_current_manifest (mm_player_ahs_t *ahs_player);
-static gboolean ahs_switch_playlist (mm_player_ahs_t *ahs_player, guint download_rate);
-static gboolean ahs_get_next_media_uri (mm_player_ahs_t *ahs_player, gchar **media_uri, gchar **key_uri, char **iv);
-static gboolean ahs_decrypt_media (mm_player_ahs_t *ahs_player,GstBuffer *InBuf, GstBuffer **OutBuf);
-static gboolean ahs_destory_manifest_download_pipeline(mm_player_ahs_t *ahs_player);
-static gboolean ahs_destory_media_download_pipeline(mm_player_ahs_t *ahs_player);
-static gboolean ahs_destory_key_download_pipeline(mm_player_ahs_t *ahs_player);
+static guint ahs_get_buffer_level (mm_player_ahs_t *ahs_player);
+static gboolean ahs_switch_playlist (mm_player_ahs_t *ahs_player);
+static gboolean ahs_get_next_media_uri (mm_player_ahs_t *ahs_player, gchar **media_uri, gchar **key_uri, char **iv, guint *duration);
+static gpointer ahs_decrypt_new (mm_player_ahs_t *ahs_player, gchar *key, char *iv);
+static void ahs_decrypt_free (mm_player_ahs_t *ahs_player, gpointer decrypt);
+static gboolean ahs_decrypt_media (mm_player_ahs_t *ahs_player, gpointer decrypt, GstBuffer *InBuf, GstBuffer **OutBuf);
+static gboolean ahs_decrypt_media_end (mm_player_ahs_t *ahs_player, gpointer decrypt, GstBuffer **OutBuf);
 static gboolean ahs_is_buffer_discontinuous (mm_player_ahs_t *ahs_player);
 static gboolean ahs_clear_discontinuous (mm_player_ahs_t *ahs_player);
 
-static void
-on_new_buffer_from_appsink (GstElement * appsink, void* data)
+/* called for each piece of plain media in order.
+ * discont is set till the first buffer of a discontinuous segment is pushed */
+static gboolean
+ahs_push_media_chunk (mm_player_ahs_t *ahs_player, GstBuffer *OutBuf, gboolean *discont)
 {
-	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
-	GstBuffer *InBuf = NULL;
 	GstFlowReturn fret = GST_FLOW_OK;
 
-	InBuf = gst_app_sink_pull_buffer ((GstAppSink *)appsink);
-	
-	if (InBuf && ahs_player->appsrc) 
+	if (NULL == ahs_player->appsrc)
 	{
-		ahs_player->seg_size = ahs_player->seg_size + GST_BUFFER_SIZE (InBuf);
-		
-              //g_print ("******** Pushing buffer size = %d and total_seg_size = %"G_GUINT64_FORMAT"\n", GST_BUFFER_SIZE (InBuf), ahs_player->seg_size);
-
-		if (ahs_player->cur_key_uri)
-		{
-			GstBuffer *OutBuf = NULL;
-			
-			ahs_decrypt_media (ahs_player, InBuf, &OutBuf);
-
-			gst_buffer_unref (InBuf);
-
-			/* FIXME : Reset Buffer property */
-			GST_BUFFER_TIMESTAMP (OutBuf) = GST_CLOCK_TIME_NONE;
-			GST_BUFFER_DURATION (OutBuf) = GST_CLOCK_TIME_NONE;
-			GST_BUFFER_FLAGS(OutBuf) = 0;
-			
-			if (ahs_is_buffer_discontinuous(ahs_player)) 
-			{
-   				g_print ("\n\n\n\nMarking fragment as discontinuous...\n\n\n\n\n");
-    				GST_BUFFER_FLAG_SET (OutBuf, GST_BUFFER_FLAG_DISCONT);
-                            ahs_clear_discontinuous (ahs_player);
-  			}
-
-			fret = gst_app_src_push_buffer ((GstAppSrc *)ahs_player->appsrc, OutBuf);
-			if (fret != GST_FLOW_OK)
-			{
-				g_print ("\n\nError in pushing buffer to appsrc: reason - %s\n\n", gst_flow_get_name(fret));
-				__mm_player_ahs_stop (ahs_player);
-			}
+		debug_warning ("appsrc is not valid!!!\n");
+		gst_buffer_unref (OutBuf);
+		return FALSE;
+	}
 
-		}
-		else
-		{
-			/* FIXME : Reset Buffer property */
-			GST_BUFFER_TIMESTAMP (InBuf) = GST_CLOCK_TIME_NONE;
-			GST_BUFFER_DURATION (InBuf) = GST_CLOCK_TIME_NONE;
-			GST_BUFFER_FLAGS(InBuf) = 0;
-			
-			if (ahs_is_buffer_discontinuous(ahs_player)) 
-			{
-   				g_print ("\n\n\n\n \t\t(((((((((((((((((((((((   Marking fragment as discontinuous... ))))))))))))))))))))))))\n\n\n\n\n");
-    				GST_BUFFER_FLAG_SET (InBuf, GST_BUFFER_FLAG_DISCONT);
-				ahs_clear_discontinuous (ahs_player);
-  			}
+	/* FIXME : Reset Buffer property */
+	GST_BUFFER_TIMESTAMP (OutBuf) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DURATION (OutBuf) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_FLAGS(OutBuf) = 0;
 
-			fret = gst_app_src_push_buffer ((GstAppSrc *)ahs_player->appsrc, InBuf);
-			if (fret != GST_FLOW_OK)
-			{
-				g_print ("\n\nError in pushing buffer to appsrc: reason - %s\n\n", gst_flow_get_name(fret));
-				__mm_player_ahs_stop (ahs_player);
-			}
-		}
+	if (*discont)
+	{
+		g_print ("\n\n\n\nMarking fragment as discontinuous...\n\n\n\n\n");
+		GST_BUFFER_FLAG_SET (OutBuf, GST_BUFFER_FLAG_DISCONT);
+		*discont = FALSE;
 	}
-	else 
+
+	fret = gst_app_src_push_buffer ((GstAppSrc *)ahs_player->appsrc, OutBuf);
+	if (fret != GST_FLOW_OK)
 	{
-		debug_warning ("Pulled buffer is not valid!!!\n");
+		g_print ("\n\nError in pushing buffer to appsrc: reason - %s\n\n", gst_flow_get_name(fret));
+		return FALSE;
 	}
+
+	return TRUE;
 }
 
 static gpointer 
@@ -144,11 +115,7 @@ manifest_update_thread(gpointer data)
 	GTimeVal tmp_update = {0, };
 	guint64 start = 0;
 	guint64 stop = 0;
-	
-	debug_log ("Waiting for trigger to start downloading manifest...\n");
-	g_mutex_lock (ahs_player->manifest_mutex);
-	g_cond_wait (ahs_player->manifest_update_cond, ahs_player->manifest_mutex);
-	g_mutex_unlock (ahs_player->manifest_mutex);
+	gboolean reload = FALSE;
 
 	while (1)
 	{
@@ -168,22 +135,15 @@ manifest_update_thread(gpointer data)
 		start =  (next_update.tv_sec * 1000000)+ next_update.tv_usec;
 		
 		/* download manifest file */
-		bret = ahs_create_manifest_download_pipeline (ahs_player);
+		bret = ahs_download_manifest (ahs_player, &reload);
 		if (FALSE == bret)
 		{
 			goto exit;
 		}
-		
-		/* waiting for playlist to be downloaded */		
-		g_mutex_lock (ahs_player->manifest_mutex);
-		if (ahs_player->manifest_thread_exit == TRUE)
-		{
-			g_mutex_unlock (ahs_player->manifest_mutex);
-			goto exit;
-		}
-		debug_log ("waiting for manifest file to be downloaded...waiting on manifest eos cond\n");
-		g_cond_wait (ahs_player->manifest_eos_cond, ahs_player->manifest_mutex);
-		g_mutex_unlock (ahs_player->manifest_mutex);
+
+		/* sub playlist of variant playlist is downloaded at once */
+		if (reload)
+			continue;
 		
 		if (ahs_client_is_live (ahs_player))
 		{
@@ -247,20 +207,13 @@ static gpointer
 media_download_thread (gpointer data)
 {
 	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
+	ahs_segment_t *seg = NULL;
 	gboolean bret = FALSE;
-	gchar *media_uri = NULL;
-	gchar *key_uri = NULL;
-	GTimeVal time = {0, };
 	GstFlowReturn fret = GST_FLOW_OK;
-	char *iv = (char *) malloc (16);
-	if (iv == NULL)
-	{
-		g_print ("ERRORR");
-		return NULL;
-	}
 
 	g_mutex_lock (ahs_player->media_mutex);
-	g_cond_wait(ahs_player->media_start_cond, ahs_player->media_mutex);
+	while (!ahs_player->media_started && !ahs_player->media_thread_exit)
+		g_cond_wait(ahs_player->media_start_cond, ahs_player->media_mutex);
 	g_mutex_unlock (ahs_player->media_mutex);
 
 	debug_log ("Received received manifest file...Moving to media download\n");
@@ -278,24 +231,25 @@ media_download_thread (gpointer data)
 		if (ahs_player->need_bw_switch)
 		{
 			debug_log ("Need to Switch BW, start updating new switched URI...\n");
-			g_cond_signal (ahs_player->manifest_update_cond);
+
+			/* segments of old bandwidth are requested again from new playlist */
+			ahs_prefetch_cancel (ahs_player);
+
 			g_mutex_lock (ahs_player->manifest_mutex);
 			if (ahs_player->media_thread_exit)
 			{
 				g_mutex_unlock (ahs_player->manifest_mutex);
 				goto exit;
 			}
+			g_cond_signal (ahs_player->manifest_update_cond);
 			debug_log ("waiting for manifest eos in media download thread...\n");
 			g_cond_wait (ahs_player->manifest_eos_cond, ahs_player->manifest_mutex);	
 			g_mutex_unlock (ahs_player->manifest_mutex);
 	
 		}
-	
-		media_uri = NULL;
-		key_uri = NULL;
-		
-		/* Get next media file to download */
-		bret = ahs_get_next_media_uri (ahs_player, &media_uri, &key_uri, &iv);
+
+		/* request next segments till window is full */
+		bret = ahs_prefetch_fill (ahs_player);
 		if (FALSE == bret)
 		{
 			ahs_player->media_thread_exit = TRUE;
@@ -307,17 +261,21 @@ media_download_thread (gpointer data)
 			goto exit;
 		}
 
-		if (NULL == media_uri)
+		g_mutex_lock (ahs_player->prefetch_lock);
+		seg = (ahs_segment_t *) g_queue_peek_head (&ahs_player->segments);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+
+		if (NULL == seg)
 		{
 			if (ahs_client_is_live (ahs_player))
 			{
-				g_cond_signal (ahs_player->manifest_update_cond);
 				g_mutex_lock (ahs_player->manifest_mutex);
 				if (ahs_player->media_thread_exit)
 				{
 					g_mutex_unlock (ahs_player->manifest_mutex);
 					goto exit;
 				}
+				g_cond_signal (ahs_player->manifest_update_cond);
 				debug_log ("waiting for manifest eos in media download thread...\n");	
 				g_cond_wait (ahs_player->manifest_eos_cond, ahs_player->manifest_mutex);
 				g_mutex_unlock (ahs_player->manifest_mutex);
@@ -335,57 +293,25 @@ media_download_thread (gpointer data)
 				goto exit;
 			}
 		}
-		
-		if (key_uri)
-		{	
-			if (ahs_player->cur_key_uri)
-			{
-				g_free (ahs_player->cur_key_uri);
-				ahs_player->cur_key_uri = NULL;
-			}
-			
-			ahs_player->cur_key_uri = g_strdup (key_uri);
-			g_free (key_uri);
-			key_uri = NULL;
-			
-			memcpy (ahs_player->cur_iv, iv, 16);
 
-			g_mutex_lock (ahs_player->media_mutex);
-			ahs_create_key_download_pipeline (ahs_player);
-			g_cond_wait (ahs_player->key_eos_cond, ahs_player->media_mutex);
-			g_mutex_unlock (ahs_player->media_mutex);
-
-			g_print ("Downloaded key url.. and key data is = %s\n", ahs_player->cur_key_data);
-		}
-
-		ahs_player->cur_media_uri = g_strdup (media_uri);
-		g_free (media_uri);
-		media_uri = NULL;
-
-		/* note down segment start time */
-		g_get_current_time (&time);
-		ahs_player->seg_start_time = (time.tv_sec * 1000000)+ time.tv_usec;
-		debug_log ("start time in usec = %"G_GUINT64_FORMAT"\n", ahs_player->seg_start_time);
-
-		bret = ahs_create_media_download_pipeline (ahs_player);
+		/* head of window is pushed while it's being downloaded */
+		bret = ahs_push_segment (ahs_player, seg);
 		if (FALSE == bret)
 		{
 			goto exit;
 		}
 
-		/* waiting for media file to be downloaded */
-		g_mutex_lock (ahs_player->media_mutex);
-		if (ahs_player->media_thread_exit)
-		{
-			g_mutex_unlock (ahs_player->media_mutex);
-			goto exit;
-		}
-		debug_log ("waiting on media EOS....\n");
-		g_cond_wait (ahs_player->media_eos_cond, ahs_player->media_mutex);
-		g_mutex_unlock (ahs_player->media_mutex);
-	
-		debug_log ("Done with waiting on media EOS....\n");
-		
+		g_mutex_lock (ahs_player->prefetch_lock);
+		g_queue_pop_head (&ahs_player->segments);
+		ahs_player->pushed_duration += seg->duration;
+		g_cond_broadcast (ahs_player->prefetch_cond);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+
+		ahs_segment_free (seg);
+
+		debug_log ("Done with downloading media....\n");
+
+		ahs_segment_downloaded (ahs_player);
 	}
 
 
@@ -396,658 +322,830 @@ exit:
 	return NULL;
 }
 
-static gboolean
-ahs_create_manifest_download_pipeline (mm_player_ahs_t *ahs_player)
+static guint64
+ahs_get_time (void)
 {
-	gboolean bret = FALSE;
-	GstStateChangeReturn	sret = GST_STATE_CHANGE_SUCCESS;
-	gchar* manifest_dump_file_name = NULL;
-	gint fd = -1;
+	GTimeVal time = {0, };
 
-	debug_log ("<<<\n");
+	g_get_current_time (&time);
 
-	/* If pipeline exists, then cleanup first */
-	if (ahs_player->manifest_download_pipeline)
-		ahs_destory_manifest_download_pipeline(ahs_player);
+	return ((guint64)time.tv_sec * 1000000) + time.tv_usec;
+}
 
-	/* Create element */
-	ahs_player->manifest_download_pipeline = gst_pipeline_new ("AHS manifest Pipeline");
-	if (NULL == ahs_player->manifest_download_pipeline)
-	{
-		debug_error ("Can't create manifest download pipeline...");
-		return FALSE;
-	}
-	ahs_player->manifest_download_src = gst_element_factory_make ("souphttpsrc", "AHS manifest download source");
-	if (NULL == ahs_player->manifest_download_src)
+static ahs_segment_t *
+ahs_segment_new (mm_player_ahs_t *ahs_player, gchar *media_uri, gchar *key_uri, char *iv)
+{
+	ahs_segment_t *seg = NULL;
+
+	seg = g_new0 (ahs_segment_t, 1);
+
+	seg->ahs_player = ahs_player;
+	seg->media_uri = media_uri;
+	seg->key_uri = key_uri;
+	if (key_uri)
+		memcpy (seg->iv, iv, sizeof(seg->iv));
+	g_queue_init (&seg->chunks);
+	g_queue_init (&seg->ready);
+
+	return seg;
+}
+
+static void
+ahs_segment_free (ahs_segment_t *seg)
+{
+	g_queue_foreach (&seg->chunks, (GFunc) gst_buffer_unref, NULL);
+	g_queue_clear (&seg->chunks);
+	g_queue_foreach (&seg->ready, (GFunc) gst_buffer_unref, NULL);
+	g_queue_clear (&seg->ready);
+
+	if (seg->decrypt)
+		ahs_decrypt_free ((mm_player_ahs_t *) seg->ahs_player, seg->decrypt);
+
+	if (seg->error)
+		g_error_free (seg->error);
+
+	MMPLAYER_FREEIF (seg->media_uri);
+	MMPLAYER_FREEIF (seg->key_uri);
+
+	g_free (seg);
+}
+
+/* called with prefetch_lock */
+static void
+ahs_segment_drop_chunks (mm_player_ahs_t *ahs_player, ahs_segment_t *seg)
+{
+	GstBuffer *chunk = NULL;
+
+	while ((chunk = (GstBuffer *) g_queue_pop_head (&seg->chunks)))
 	{
-		debug_error ("Can't create manifest download src...");
-		return FALSE;
+		ahs_player->prefetch_buffered -= GST_BUFFER_SIZE (chunk);
+		gst_buffer_unref (chunk);
 	}
 
-	if (ahs_player->user_agent)
+	while ((chunk = (GstBuffer *) g_queue_pop_head (&seg->ready)))
 	{
-		g_object_set (ahs_player->manifest_download_src, "user-agent", ahs_player->user_agent, NULL );
+		ahs_player->prefetch_buffered -= GST_BUFFER_SIZE (chunk);
+		gst_buffer_unref (chunk);
 	}
+}
+
+/* a cancelled segment is freed when no thread has it. called with prefetch_lock */
+static gboolean
+ahs_segment_is_used (ahs_segment_t *seg)
+{
+	return (seg->started && !seg->done) || seg->decrypting || seg->cancelling;
+}
+
+/* called with prefetch_lock. only the time while some segment is being downloaded
+ * is counted, so bandwidth is not lowered by idle time of a full window */
+static void
+ahs_prefetch_set_busy (mm_player_ahs_t *ahs_player, gboolean busy)
+{
+	guint64 now = ahs_get_time ();
 
-	ahs_player->manifest_download_sink = gst_element_factory_make ("filesink", "AHS manifest download sink");
-	if (NULL == ahs_player->manifest_download_sink)
+	if (busy)
 	{
-		debug_error ("Can't create manifest download sink...");
-		return FALSE;
+		if (0 == ahs_player->prefetch_active++)
+			ahs_player->prefetch_busy_since = now;
 	}
-	
-	/* Add to bin and link */
-	gst_bin_add_many (GST_BIN (ahs_player->manifest_download_pipeline), 
-					ahs_player->manifest_download_src, ahs_player->manifest_download_sink,
-					NULL);
-	
-	bret = gst_element_link (ahs_player->manifest_download_src, ahs_player->manifest_download_sink);
-	if (FALSE == bret)
+	else
 	{
-		debug_error ("Can't link elements src and sink...");
-		return FALSE;
+		if (0 == --ahs_player->prefetch_active)
+			ahs_player->prefetch_busy_time += now - ahs_player->prefetch_busy_since;
 	}
-	
-	/* Set Bus */
-	GstBus* bus = gst_pipeline_get_bus (GST_PIPELINE (ahs_player->manifest_download_pipeline));
-	gst_bus_add_watch (bus, ahs_manifest_download_callback, ahs_player);
-	gst_object_unref (bus);
-
-	/* Set URI */
-	g_object_set (G_OBJECT (ahs_player->manifest_download_src), "location", ahs_player->cur_mf_uri, NULL);
+}
 
-	if (ahs_player->ahs_manifest_dmp_location)
-		g_unlink(ahs_player->ahs_manifest_dmp_location);
+/* called in prefetch thread for each piece of media. it never waits, since the
+ * connection would be kept idle and the head could wait for a connection. the
+ * budget of window is checked before a segment is started instead */
+static gboolean
+ahs_prefetch_chunk (GstBuffer *chunk, gpointer data)
+{
+	ahs_segment_t *seg = (ahs_segment_t *) data;
+	mm_player_ahs_t *ahs_player = (mm_player_ahs_t *) seg->ahs_player;
 
-	/* set path to dump manifest file */
-	manifest_dump_file_name = g_strdup(HLS_MANIFEST_DEFAULT_FILE_NAME);
+	g_mutex_lock (ahs_player->prefetch_lock);
 
-	fd = g_mkstemp(manifest_dump_file_name);
-	if (fd == -1)
+	if (seg->cancelled || ahs_player->prefetch_exit)
 	{
-		debug_error("failed to open temporary file\n");
-		MMPLAYER_FREEIF(manifest_dump_file_name);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+		gst_buffer_unref (chunk);
 		return FALSE;
 	}
-	
-	sprintf (ahs_player->ahs_manifest_dmp_location, "%s.m3u8", manifest_dump_file_name);
 
-	if (g_file_test (manifest_dump_file_name, G_FILE_TEST_EXISTS))
+	/* encrypted one goes through decrypt thread */
+	if (seg->key_uri)
+		g_queue_push_tail (&seg->chunks, chunk);
+	else
+		g_queue_push_tail (&seg->ready, chunk);
+	ahs_player->prefetch_buffered += GST_BUFFER_SIZE (chunk);
+	ahs_player->prefetch_bytes += GST_BUFFER_SIZE (chunk);
+
+	g_cond_broadcast (ahs_player->prefetch_cond);
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	return TRUE;
+}
+
+/* first segment in window which is not taken yet. segments after the head are not
+ * started while the window holds more than prefetch_buffer_size, so the window goes
+ * over it by the segments in flight at most. called with prefetch_lock */
+static ahs_segment_t *
+ahs_prefetch_next_segment (mm_player_ahs_t *ahs_player)
+{
+	GList *list = NULL;
+
+	for (list = ahs_player->segments.head; list; list = g_list_next (list))
 	{
-		close(fd);
-		g_unlink(manifest_dump_file_name);
+		ahs_segment_t *seg = (ahs_segment_t *) list->data;
+
+		if (seg->started)
+			continue;
+
+		if (list != ahs_player->segments.head
+			&& ahs_player->prefetch_buffered >= ahs_player->prefetch_buffer_size)
+			return NULL;
+
+		return seg;
 	}
 
-	MMPLAYER_FREEIF(manifest_dump_file_name);
+	return NULL;
+}
+
+static gpointer
+prefetch_download_thread (gpointer data)
+{
+	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
+	ahs_segment_t *seg = NULL;
+	GError *error = NULL;
+	gboolean bret = FALSE;
+	gchar key[16] = {0, };
 
-	/* ENAMETOOLONG or not  */
-	if (strlen(ahs_player->ahs_manifest_dmp_location) > HLS_POSIX_PATH_MAX)
+	while (1)
 	{
-		debug_error("file name too long\n");
-		return FALSE;
-	}
-	
-	g_object_set (G_OBJECT (ahs_player->manifest_download_sink), "location", ahs_player->ahs_manifest_dmp_location, NULL);
+		g_mutex_lock (ahs_player->prefetch_lock);
+		while (!ahs_player->prefetch_exit && !(seg = ahs_prefetch_next_segment (ahs_player)))
+			g_cond_wait (ahs_player->prefetch_cond, ahs_player->prefetch_lock);
 
-	debug_log ("src location = %s, save location = %s\n", ahs_player->cur_mf_uri, ahs_player->ahs_manifest_dmp_location);
+		if (ahs_player->prefetch_exit)
+		{
+			g_mutex_unlock (ahs_player->prefetch_lock);
+			break;
+		}
 
-	g_print ("Going to download manifest-uri -> %s\n", ahs_player->cur_mf_uri);
+		seg->started = TRUE;
+		ahs_prefetch_set_busy (ahs_player, TRUE);
+		g_mutex_unlock (ahs_player->prefetch_lock);
 
-	/* Start to download */
-	sret = gst_element_set_state (ahs_player->manifest_download_pipeline, GST_STATE_PLAYING);
+		/* key is cached before the segment is pushed. failure is reported on push */
+		if (seg->key_uri && !ahs_get_key (ahs_player, seg->key_uri, key, NULL))
+			debug_warning ("failed to prefetch key : %s\n", seg->key_uri);
 
-	debug_log ("sret = %d\n", sret);
+		debug_log ("Going to download media-uri -> %s\n", seg->media_uri);
 
-	debug_log (">>>\n");
+		error = NULL;
+		bret = __mm_player_ahs_fetch_stream (ahs_player->fetch, seg->media_uri, ahs_prefetch_chunk, seg, &error);
 
-	return TRUE;
+		g_mutex_lock (ahs_player->prefetch_lock);
+		ahs_prefetch_set_busy (ahs_player, FALSE);
 
-}
+		seg->done = TRUE;
 
-static gboolean
-ahs_destory_manifest_download_pipeline(mm_player_ahs_t *ahs_player)
-{
-	debug_log ("<<<\n");
+		if (!bret)
+		{
+			seg->failed = TRUE;
+			if (NULL == seg->error)
+				seg->error = error;
+			else if (error)
+				g_error_free (error);
+		}
 
-	gst_element_set_state (ahs_player->manifest_download_pipeline, GST_STATE_NULL);
-	gst_element_get_state (ahs_player->manifest_download_pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+		/* plain one is all in ready. encrypted one is after decryption */
+		if (NULL == seg->key_uri || seg->failed)
+			seg->ready_done = TRUE;
 
-	gst_object_unref(ahs_player->manifest_download_pipeline);
-	ahs_player->manifest_download_pipeline = NULL;
+		if (seg->cancelled)
+		{
+			debug_log ("segment %d is cancelled\n", seg->sequence);
+			if (!ahs_segment_is_used (seg))
+				ahs_segment_free (seg);
+		}
 
-	debug_log (">>>\n");
+		g_cond_broadcast (ahs_player->prefetch_cond);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+	}
 
-	return TRUE;
+	debug_log ("Exiting from prefetch thread...\n");
+
+	return NULL;
 }
 
-static gboolean
-ahs_create_media_download_pipeline (mm_player_ahs_t *ahs_player)
+/* first encrypted segment in window which has something to decrypt and is not
+ * taken by other decrypt thread. called with prefetch_lock */
+static ahs_segment_t *
+ahs_decrypt_next_segment (mm_player_ahs_t *ahs_player)
 {
-	gboolean bret = FALSE;
-	GstBus* bus = NULL;
-	
-	debug_log ("<<<\n");
-
-	/* If pipeline exists, then cleanup first */
-	if (ahs_player->media_download_pipeline) 
-		ahs_destory_media_download_pipeline(ahs_player);
+	GList *list = NULL;
 
-	/* Create element */
-	ahs_player->media_download_pipeline = gst_pipeline_new ("AHS media Pipeline");
-	if (NULL == ahs_player->media_download_pipeline)
+	for (list = ahs_player->segments.head; list; list = g_list_next (list))
 	{
-		debug_error ("Can't create media download pipeline...");
-		return FALSE;
-	}
-	ahs_player->media_download_src = gst_element_factory_make ("souphttpsrc", "AHS media download source");
-	if (NULL == ahs_player->media_download_src)
-	{
-		debug_error ("Can't create media download src...");
-		return FALSE;
-	}
+		ahs_segment_t *seg = (ahs_segment_t *) list->data;
 
-	if (ahs_player->user_agent)
-	{
-		g_object_set (ahs_player->media_download_src, "user-agent", ahs_player->user_agent, NULL );
-	}
+		if (!seg->key_uri || seg->decrypting || seg->ready_done)
+			continue;
 
-	ahs_player->media_download_sink = gst_element_factory_make ("appsink", "AHS media download sink");
-	if (NULL == ahs_player->media_download_sink)
-	{
-		debug_error ("Can't create media download sink...");
-		return FALSE;
+		if (!g_queue_is_empty (&seg->chunks) || seg->done)
+			return seg;
 	}
-	
-	/* Add to bin and link */
-	gst_bin_add_many (GST_BIN (ahs_player->media_download_pipeline), 
-					ahs_player->media_download_src, ahs_player->media_download_sink,
-					NULL);
-	
-	bret = gst_element_link (ahs_player->media_download_src, ahs_player->media_download_sink);
-	if (FALSE == bret)
-	{
-		debug_error ("Can't link elements src and sink...");
-		return FALSE;
-	}
-	
-	/* Set Bus */
-	bus = gst_pipeline_get_bus (GST_PIPELINE (ahs_player->media_download_pipeline));
-	gst_bus_add_watch (bus, ahs_media_download_callback, ahs_player);
-	gst_object_unref (bus);
 
-	/* Set URI on src element */
-	g_object_set (G_OBJECT (ahs_player->media_download_src), "location", ahs_player->cur_media_uri, NULL);
+	return NULL;
+}
 
-	g_print ("Going to download media-uri -> %s\n", ahs_player->cur_media_uri);
+/* decrypts chunks of segments in window ahead of push, so network reads and pushing
+ * don't wait for decryption. cbc of each segment is independent, so segments are
+ * decrypted in parallel while chunks of a segment are decrypted in order */
+static gpointer
+decrypt_thread (gpointer data)
+{
+	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
+	ahs_segment_t *seg = NULL;
+	GstBuffer *chunk = NULL;
+	GstBuffer *OutBuf = NULL;
+	GQueue chunks = G_QUEUE_INIT;
+	GQueue ready = G_QUEUE_INIT;
+	GError *error = NULL;
+	gchar key[16] = {0, };
+	gboolean done = FALSE;
+	gboolean bret = TRUE;
+	guint64 start = 0;
+	guint64 in_size = 0;
+	guint64 out_size = 0;
 
-	/* setting properties on sink element */
-	g_object_set (G_OBJECT (ahs_player->media_download_sink), "emit-signals", TRUE, "sync", FALSE, NULL);
-	g_signal_connect (ahs_player->media_download_sink, "new-buffer",  G_CALLBACK (on_new_buffer_from_appsink), ahs_player);
+	while (1)
+	{
+		g_mutex_lock (ahs_player->prefetch_lock);
+		while (!ahs_player->prefetch_exit && !(seg = ahs_decrypt_next_segment (ahs_player)))
+			g_cond_wait (ahs_player->prefetch_cond, ahs_player->prefetch_lock);
 
-	/* Start to download */
-	gst_element_set_state (ahs_player->media_download_pipeline, GST_STATE_PLAYING);
+		if (ahs_player->prefetch_exit)
+		{
+			g_mutex_unlock (ahs_player->prefetch_lock);
+			break;
+		}
 
-	debug_log (">>>\n");
+		/* all chunks so far at once */
+		seg->decrypting = TRUE;
+		done = seg->done;
+		while ((chunk = (GstBuffer *) g_queue_pop_head (&seg->chunks)))
+			g_queue_push_tail (&chunks, chunk);
+		g_mutex_unlock (ahs_player->prefetch_lock);
 
-	return TRUE;
+		bret = TRUE;
+		error = NULL;
+		in_size = 0;
+		out_size = 0;
 
-}
+		if (NULL == seg->decrypt)
+		{
+			/* key is usually cached already by prefetch thread */
+			if (!ahs_get_key (ahs_player, seg->key_uri, key, &error))
+				bret = FALSE;
+			else if (NULL == (seg->decrypt = ahs_decrypt_new (ahs_player, key, seg->iv)))
+				bret = FALSE;
+		}
 
-static gboolean 
-ahs_destory_media_download_pipeline(mm_player_ahs_t *ahs_player)
-{
-	debug_log ("<<<\n");
+		start = ahs_get_time ();
 
-	gst_element_set_state (ahs_player->media_download_pipeline, GST_STATE_NULL);
-	gst_element_get_state (ahs_player->media_download_pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+		while ((chunk = (GstBuffer *) g_queue_pop_head (&chunks)))
+		{
+			in_size += GST_BUFFER_SIZE (chunk);
 
-	gst_object_unref(ahs_player->media_download_pipeline);
-	ahs_player->media_download_pipeline = NULL;
+			if (!bret)
+			{
+				gst_buffer_unref (chunk);
+				continue;
+			}
 
-	debug_log (">>>\n");
+			/* decrypted in place. last block is given at the end */
+			bret = ahs_decrypt_media (ahs_player, seg->decrypt, chunk, &OutBuf);
+			if (bret && OutBuf)
+			{
+				out_size += GST_BUFFER_SIZE (OutBuf);
+				g_queue_push_tail (&ready, OutBuf);
+			}
+		}
 
-	return TRUE;
-}
+		if (bret && done)
+		{
+			bret = ahs_decrypt_media_end (ahs_player, seg->decrypt, &OutBuf);
+			if (bret && OutBuf)
+			{
+				out_size += GST_BUFFER_SIZE (OutBuf);
+				g_queue_push_tail (&ready, OutBuf);
+			}
+		}
 
-static gboolean
-ahs_create_key_download_pipeline (mm_player_ahs_t *ahs_player)
-{
-	gboolean bret = FALSE;
-	GstBus* bus = NULL;
-	
-	debug_log ("<<<\n");
+		if (!bret && NULL == error)
+		{
+			error = g_error_new (GST_STREAM_ERROR, GST_STREAM_ERROR_DECRYPT,
+				"failed to decrypt, URL: %s", seg->media_uri);
+		}
 
-	/* If pipeline exists, then cleanup first */
-	if (ahs_player->key_download_pipeline) 
-		ahs_destory_key_download_pipeline(ahs_player);
+		g_mutex_lock (ahs_player->prefetch_lock);
 
-	/* Create element */
-	ahs_player->key_download_pipeline = gst_pipeline_new ("AHS key Pipeline");
-	if (NULL == ahs_player->key_download_pipeline)
-	{
-		debug_error ("Can't create key download pipeline...");
-		return FALSE;
-	}
-	ahs_player->key_download_src = gst_element_factory_make ("souphttpsrc", "AHS key download source");
-	if (NULL == ahs_player->key_download_src)
-	{
-		debug_error ("Can't create key download src...");
-		return FALSE;
-	}
+		ahs_player->decrypt_bytes += in_size;
+		ahs_player->decrypt_time += ahs_get_time () - start;
+		ahs_player->prefetch_buffered -= in_size;
 
-	if (ahs_player->user_agent)
-	{
-		g_object_set (ahs_player->key_download_src, "user-agent", ahs_player->user_agent, NULL );
-	}
+		if (seg->cancelled)
+		{
+			g_queue_foreach (&ready, (GFunc) gst_buffer_unref, NULL);
+			g_queue_clear (&ready);
+		}
+		else
+		{
+			while ((OutBuf = (GstBuffer *) g_queue_pop_head (&ready)))
+				g_queue_push_tail (&seg->ready, OutBuf);
+			ahs_player->prefetch_buffered += out_size;
+		}
 
-	ahs_player->key_download_sink = gst_element_factory_make ("filesink", "AHS key download sink");
-	if (NULL == ahs_player->key_download_sink)
-	{
-		debug_error ("Can't create key download sink...");
-		return FALSE;
-	}
-	
-	/* Add to bin and link */
-	gst_bin_add_many (GST_BIN (ahs_player->key_download_pipeline), 
-					ahs_player->key_download_src, ahs_player->key_download_sink,
-					NULL);
-	
-	bret = gst_element_link (ahs_player->key_download_src, ahs_player->key_download_sink);
-	if (FALSE == bret)
-	{
-		debug_error ("Can't link elements src and sink...");
-		return FALSE;
-	}
-	
-	/* Set Bus */
-	bus = gst_pipeline_get_bus (GST_PIPELINE (ahs_player->key_download_pipeline));
-	gst_bus_add_watch (bus, ahs_key_download_callback, ahs_player);
-	gst_object_unref (bus);
-	
-	/* Set URI */
-	g_object_set (G_OBJECT (ahs_player->key_download_src), "location", ahs_player->cur_key_uri, NULL);
-	sprintf (ahs_player->ahs_key_dmp_location, "/opt/apps/com.samsung.video-player/data%s", strrchr(ahs_player->cur_key_uri, '/'));
-	debug_log ("src location = %s, save location = %s\n", ahs_player->cur_key_uri, ahs_player->ahs_key_dmp_location);
-	
-	g_print ("Going to download key-uri -> %s\n", ahs_player->cur_key_uri);
+		if (!bret)
+		{
+			debug_error ("failed to decrypt segment %d\n", seg->sequence);
+			seg->failed = TRUE;
+			seg->ready_done = TRUE;
+			if (NULL == seg->error)
+				seg->error = error;
+			else
+				g_error_free (error);
+		}
+		else if (done)
+		{
+			seg->ready_done = TRUE;
+		}
 
-	g_object_set (G_OBJECT (ahs_player->key_download_sink), "location", ahs_player->ahs_key_dmp_location, NULL);
+		seg->decrypting = FALSE;
 
-	/* Start to download */
-	gst_element_set_state (ahs_player->key_download_pipeline, GST_STATE_PLAYING);
+		if (seg->cancelled && !ahs_segment_is_used (seg))
+			ahs_segment_free (seg);
 
-	debug_log (">>>\n");
+		g_cond_broadcast (ahs_player->prefetch_cond);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+	}
 
-	return TRUE;
+	debug_log ("Exiting from decrypt thread...\n");
 
+	return NULL;
 }
 
+/* requests next segments till window is full. FALSE on error */
 static gboolean
-ahs_destory_key_download_pipeline(mm_player_ahs_t *ahs_player)
+ahs_prefetch_fill (mm_player_ahs_t *ahs_player)
 {
-	debug_log ("<<<\n");
+	ahs_segment_t *seg = NULL;
+	gchar *media_uri = NULL;
+	gchar *key_uri = NULL;
+	char iv[16] = {0, };
+	char *iv_ptr = iv;
+	guint duration = 0;
+
+	/* window is changed only in media thread */
+	while (g_queue_get_length (&ahs_player->segments) < ahs_player->prefetch_count)
+	{
+		media_uri = NULL;
+		key_uri = NULL;
+		duration = 0;
 
-	gst_element_set_state (ahs_player->key_download_pipeline, GST_STATE_NULL);
-	gst_element_get_state (ahs_player->key_download_pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+		if (!ahs_get_next_media_uri (ahs_player, &media_uri, &key_uri, &iv_ptr, &duration))
+			return FALSE;
 
-	gst_object_unref(ahs_player->key_download_pipeline);
-	ahs_player->key_download_pipeline = NULL;
+		if (NULL == media_uri)
+		{
+			MMPLAYER_FREEIF (key_uri);
+			break;
+		}
 
-	debug_log (">>>\n");
+		seg = ahs_segment_new (ahs_player, media_uri, key_uri, iv);
+		seg->sequence = ahs_get_next_sequence (ahs_player) - 1;
+		seg->duration = duration;
+		seg->discontinuity = ahs_is_buffer_discontinuous (ahs_player);
+		ahs_clear_discontinuous (ahs_player);
+
+		debug_log ("segment %d is added to window\n", seg->sequence);
+
+		g_mutex_lock (ahs_player->prefetch_lock);
+		g_queue_push_tail (&ahs_player->segments, seg);
+		g_cond_broadcast (ahs_player->prefetch_cond);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+	}
 
 	return TRUE;
 }
-static gboolean
-ahs_client_is_live (mm_player_ahs_t *ahs_player)
+
+/* cancels segments in window except the ones at the head which are done already.
+ * the next segment is the first one cancelled. called in media thread on switch
+ * of bandwidth, and should be on seek */
+static void
+ahs_prefetch_cancel (mm_player_ahs_t *ahs_player)
 {
-	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	ahs_segment_t *seg = NULL;
+	GQueue in_flight = G_QUEUE_INIT;
+	guint kept = 0;
+	gint sequence = -1;
+
+	g_mutex_lock (ahs_player->prefetch_lock);
+
+	while ((seg = (ahs_segment_t *) g_queue_peek_nth (&ahs_player->segments, kept)) && seg->done && !seg->failed)
+		kept++;
+
+	while ((seg = (ahs_segment_t *) g_queue_pop_nth (&ahs_player->segments, kept)))
 	{
-		return (hls_client_is_live(ahs_player->ahs_client));
+		if (sequence < 0)
+			sequence = seg->sequence;
+
+		seg->cancelled = TRUE;
+		ahs_segment_drop_chunks (ahs_player, seg);
+
+		/* kept till its request is cancelled, so the address isn't reused by a new
+		 * segment whose request would be cancelled instead */
+		if (seg->started && !seg->done)
+		{
+			seg->cancelling = TRUE;
+			g_queue_push_tail (&in_flight, seg);
+		}
+
+		/* or freed by the thread which has it */
+		if (!ahs_segment_is_used (seg))
+			ahs_segment_free (seg);
 	}
-	return TRUE;
-}
 
-static gboolean
-ahs_manifest_get_update_interval (mm_player_ahs_t *ahs_player, GTimeVal *next_update)
-{
-	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	g_cond_broadcast (ahs_player->prefetch_cond);
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	/* a request which is not sent yet is refused at its first chunk */
+	while ((seg = (ahs_segment_t *) g_queue_pop_head (&in_flight)))
 	{
-		return hls_playlist_update_interval(ahs_player->ahs_client, next_update);
+		__mm_player_ahs_fetch_cancel_stream (ahs_player->fetch, seg);
+
+		g_mutex_lock (ahs_player->prefetch_lock);
+		seg->cancelling = FALSE;
+		if (!ahs_segment_is_used (seg))
+			ahs_segment_free (seg);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+	}
+
+	if (sequence >= 0)
+	{
+		debug_log ("%d segments are kept, next one is %d\n", kept, sequence);
+		ahs_set_next_sequence (ahs_player, sequence);
 	}
-	return TRUE;
 }
 
+/* pushes chunks of the segment in order till it's done */
 static gboolean
-ahs_parse_manifest_update_client (mm_player_ahs_t *ahs_player)
+ahs_push_segment (mm_player_ahs_t *ahs_player, ahs_segment_t *seg)
 {
-	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	GstBuffer *chunk = NULL;
+	gboolean discont = seg->discontinuity;
+	gboolean bret = FALSE;
+
+	MMPLAYER_FREEIF (ahs_player->cur_media_uri);
+	ahs_player->cur_media_uri = g_strdup (seg->media_uri);
+
+	MMPLAYER_FREEIF (ahs_player->cur_key_uri);
+	if (seg->key_uri)
+		ahs_player->cur_key_uri = g_strdup (seg->key_uri);
+
+	/* chunks come here already decrypted */
+	while (1)
 	{
-		return hls_parse_playlist_update_client(ahs_player->ahs_client, ahs_player->ahs_manifest_dmp_location);
+		g_mutex_lock (ahs_player->prefetch_lock);
+		while (!ahs_player->prefetch_exit && !seg->ready_done && g_queue_is_empty (&seg->ready))
+			g_cond_wait (ahs_player->prefetch_cond, ahs_player->prefetch_lock);
+
+		if (ahs_player->prefetch_exit)
+		{
+			g_mutex_unlock (ahs_player->prefetch_lock);
+			return FALSE;
+		}
+
+		chunk = (GstBuffer *) g_queue_pop_head (&seg->ready);
+		if (chunk)
+		{
+			ahs_player->prefetch_buffered -= GST_BUFFER_SIZE (chunk);
+			g_cond_broadcast (ahs_player->prefetch_cond);
+		}
+		g_mutex_unlock (ahs_player->prefetch_lock);
+
+		/* done and all pushed */
+		if (NULL == chunk)
+			break;
+
+		bret = ahs_push_media_chunk (ahs_player, chunk, &discont);
+		if (FALSE == bret)
+		{
+			return FALSE;
+		}
 	}
-	else
+
+	if (seg->failed)
 	{
+		if (seg->error)
+		{
+			ahs_post_error (ahs_player, seg->error);
+			seg->error = NULL;
+		}
 		return FALSE;
 	}
+
+	return TRUE;
+}
+
+static void
+ahs_post_error (mm_player_ahs_t *ahs_player, GError *error)
+{
+	GstMessage *new_msg = NULL;
+
+	debug_error ("AHS download error = %s\n", error->message);
+
+	if (ahs_player->appsrc)
+	{
+		new_msg = gst_message_new_error (GST_OBJECT_CAST (ahs_player->appsrc), error, error->message);
+		if (!gst_element_post_message (ahs_player->appsrc, new_msg))
+			debug_error ("Error posting msg\n");
+	}
+
+	g_error_free (error);
 }
 
+/* reload is set when the sub playlist should be downloaded at once */
 static gboolean
-ahs_manifest_download_callback(GstBus *bus, GstMessage *msg, gpointer data)
+ahs_download_manifest (mm_player_ahs_t *ahs_player, gboolean *reload)
 {
-	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
-	gboolean bret = TRUE;
-	
+	gchar *manifest = NULL;
+	GError *error = NULL;
+
 	debug_log ("<<<\n");
 
-	if ( !ahs_player ) 
+	*reload = FALSE;
+
+	g_print ("Going to download manifest-uri -> %s\n", ahs_player->cur_mf_uri);
+
+	if (!__mm_player_ahs_fetch_data (ahs_player->fetch, ahs_player->cur_mf_uri, &manifest, NULL, &error))
 	{
-		debug_error("AHS player handle is invalid\n");
+		if (error)
+			ahs_post_error (ahs_player, error);
 		return FALSE;
 	}
 
-	switch ( GST_MESSAGE_TYPE( msg ) )
-	{
-		case GST_MESSAGE_EOS:
-			{
-				debug_log("MANIFEST EOS received, state=[%d]\n", ahs_player->ahs_state);
-				
-				if (ahs_player->manifest_download_pipeline)
-					ahs_destory_manifest_download_pipeline(ahs_player);
+	debug_log("MANIFEST downloaded, state=[%d]\n", ahs_player->ahs_state);
 
-				/* Parse and Update client*/
-				ahs_parse_manifest_update_client (ahs_player);
+	/* Parse and Update client*/
+	ahs_parse_manifest_update_client (ahs_player, manifest);
 
-				debug_log ("Current STATE = [%s]\n", state_string[ahs_player->ahs_state]);
+	debug_log ("Current STATE = [%s]\n", state_string[ahs_player->ahs_state]);
 
-				debug_log ("Received EOS on manifest download...broadcast manifest eos\n");
-				g_cond_broadcast (ahs_player->manifest_eos_cond);
+	debug_log ("Received manifest...broadcast manifest eos\n");
+	g_mutex_lock (ahs_player->manifest_mutex);
+	g_cond_broadcast (ahs_player->manifest_eos_cond);
+	g_mutex_unlock (ahs_player->manifest_mutex);
 
-				/* state transition : MAIN PLAYLIST -> SUB PLAYLIST (optional) -> MEDIA FILE STREAMING */
-				g_mutex_lock (ahs_player->state_lock);
-				if (ahs_player->ahs_state == AHS_STATE_PREPARE_MANIFEST) 
-				{
-					if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
-					{
-						////////////////////////////////
-						//// http live streaming 
-						///////////////////////////////
-
-						if (hls_downloaded_variant_playlist (ahs_player->ahs_client, ahs_player->cur_mf_uri))
-						{
-							debug_log ("Downloaded Variant playlist file\n");
-							/* if set current playlist based on bandwidth */
-							ahs_set_current_manifest (ahs_player);
-
-							if (ahs_player->cur_mf_uri)
-							{
-								g_free (ahs_player->cur_mf_uri);
-								ahs_player->cur_mf_uri = NULL;
-							}
-
-							ahs_player->cur_mf_uri = g_strdup(ahs_get_current_manifest(ahs_player));
-							
-							debug_log ("Signal to wakeup manifest thread...\n");
-							g_cond_signal (ahs_player->manifest_update_cond);
-						}
-						else
-						{
-							ahs_player->ahs_state = AHS_STATE_MEDIA_STREAMING;
-						}
-					}
-				}
+	/* state transition : MAIN PLAYLIST -> SUB PLAYLIST (optional) -> MEDIA FILE STREAMING */
+	g_mutex_lock (ahs_player->state_lock);
+	if (ahs_player->ahs_state == AHS_STATE_PREPARE_MANIFEST)
+	{
+		if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+		{
+			////////////////////////////////
+			//// http live streaming
+			///////////////////////////////
 
-				/* If state is for media streaming */
-				debug_log ("Current STATE = [%s]\n", state_string[ahs_player->ahs_state]);
-					
-				if (AHS_STATE_MEDIA_STREAMING == ahs_player->ahs_state) 
+			if (hls_downloaded_variant_playlist (ahs_player->ahs_client, ahs_player->cur_mf_uri))
+			{
+				debug_log ("Downloaded Variant playlist file\n");
+				/* if set current playlist based on bandwidth */
+				ahs_set_current_manifest (ahs_player);
+
+				if (ahs_player->cur_mf_uri)
 				{
-					debug_log ("Signal start of media download....\n");
-					g_cond_signal (ahs_player->media_start_cond);
+					g_free (ahs_player->cur_mf_uri);
+					ahs_player->cur_mf_uri = NULL;
 				}
-				g_mutex_unlock (ahs_player->state_lock);
-			}
-			
-			break;
 
-		case GST_MESSAGE_ERROR:
-			{
-				gboolean ret = FALSE;
-				GError *error = NULL;
-				gchar* debug = NULL;
-				GstMessage *new_msg = NULL;
-				
-				/* get error code */
-				gst_message_parse_error( msg, &error, &debug );
-				debug_error ("GST_MESSAGE_ERROR = %s\n", debug);
-				new_msg = gst_message_new_error (GST_OBJECT_CAST ((GstAppSrc *)ahs_player->appsrc), error, debug);
-				
-				ret = gst_element_post_message ((GstAppSrc *)ahs_player->appsrc, new_msg);
-				__mm_player_ahs_stop (ahs_player);
-				//__mm_player_ahs_deinitialize(ahs_player);
-				//__mm_player_ahs_destroy(&ahs_player);
-				
-				g_print ("\n\n\nError posting msg = %d\n\n\n\n", ret);
-				//g_free( debug);
-				//debug = NULL;
-				//g_error_free( error);
-			}
-			break;
+				ahs_player->cur_mf_uri = g_strdup(ahs_get_current_manifest(ahs_player));
 
-		case GST_MESSAGE_WARNING:
+				*reload = TRUE;
+			}
+			else
 			{
-				char* debug = NULL;
-				GError* error = NULL;
-				gst_message_parse_warning(msg, &error, &debug);
-				debug_warning("warning : %s\n", error->message);
-				debug_warning("debug : %s\n", debug);
-				g_free( debug);
-				debug = NULL;
-				g_error_free( error);
+				ahs_player->ahs_state = AHS_STATE_MEDIA_STREAMING;
 			}
-			break;
+		}
+	}
 
-		default:
-			//debug_warning("unhandled message\n");
-			break;
+	/* If state is for media streaming */
+	debug_log ("Current STATE = [%s]\n", state_string[ahs_player->ahs_state]);
+
+	if (AHS_STATE_MEDIA_STREAMING == ahs_player->ahs_state)
+	{
+		debug_log ("Signal start of media download....\n");
+		g_mutex_lock (ahs_player->media_mutex);
+		ahs_player->media_started = TRUE;
+		g_cond_signal (ahs_player->media_start_cond);
+		g_mutex_unlock (ahs_player->media_mutex);
 	}
+	g_mutex_unlock (ahs_player->state_lock);
 
 	debug_log (">>>\n");
 
-	return bret;
+	return TRUE;
 }
 
 static gboolean
-ahs_key_download_callback(GstBus *bus, GstMessage *msg, gpointer data)
+ahs_key_is_expired (mm_player_ahs_t *ahs_player, ahs_key_t *key, guint64 now)
 {
-	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
-	gboolean bret = TRUE;
-	
-	debug_log ("<<<\n");
+	if (0 == ahs_player->key_cache_ttl)
+		return FALSE;
 
-	if ( !ahs_player ) 
+	return (now - key->time) > ((guint64)ahs_player->key_cache_ttl * 1000000);
+}
+
+/* drops expired keys, and the oldest one if cache is full. called with key_lock */
+static void
+ahs_key_cache_trim (mm_player_ahs_t *ahs_player)
+{
+	GHashTableIter iter;
+	gpointer uri = NULL;
+	gpointer value = NULL;
+	gpointer oldest = NULL;
+	guint64 oldest_time = G_MAXUINT64;
+	guint64 now = ahs_get_time ();
+
+	g_hash_table_iter_init (&iter, ahs_player->keys);
+	while (g_hash_table_iter_next (&iter, &uri, &value))
 	{
-		debug_error("AHS player handle is invalid\n");
-		return FALSE;
+		ahs_key_t *key = (ahs_key_t *) value;
+
+		if (!key->ready)
+			continue;
+
+		if (ahs_key_is_expired (ahs_player, key, now))
+		{
+			debug_log ("key is expired : %s\n", (gchar *) uri);
+			g_hash_table_iter_remove (&iter);
+			continue;
+		}
+
+		if (key->time < oldest_time)
+		{
+			oldest_time = key->time;
+			oldest = uri;
+		}
 	}
 
-	switch ( GST_MESSAGE_TYPE( msg ) )
+	if (oldest && g_hash_table_size (ahs_player->keys) >= AHS_KEY_CACHE_MAX)
+		g_hash_table_remove (ahs_player->keys, oldest);
+}
+
+/* key of a uri is downloaded once for the session. others asking same key
+ * wait for the download in progress */
+static gboolean
+ahs_get_key (mm_player_ahs_t *ahs_player, const gchar *key_uri, gchar *data, GError **error)
+{
+	ahs_key_t *key = NULL;
+	gchar *body = NULL;
+	gsize size = 0;
+	gboolean bret = FALSE;
+
+	g_mutex_lock (ahs_player->key_lock);
+
+	while ((key = (ahs_key_t *) g_hash_table_lookup (ahs_player->keys, key_uri)) && !key->ready)
+		g_cond_wait (ahs_player->key_cond, ahs_player->key_lock);
+
+	if (key && !ahs_key_is_expired (ahs_player, key, ahs_get_time ()))
 	{
-		case GST_MESSAGE_EOS:
-			{
-				FILE *keyfd = NULL;
-				guint bytes_read = 0;
-				int i =0;
-				
-				debug_log("KEY EOS received, state=[%d]\n", ahs_player->ahs_state);
-				if (ahs_player->key_download_pipeline) 
-					ahs_destory_key_download_pipeline(ahs_player);
+		memcpy (data, key->data, sizeof(key->data));
+		g_mutex_unlock (ahs_player->key_lock);
+		return TRUE;
+	}
 
-				debug_log ("Current STATE = [%s]\n", state_string[ahs_player->ahs_state]);
+	ahs_key_cache_trim (ahs_player);
 
-				if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
-				{
-					keyfd = fopen (ahs_player->ahs_key_dmp_location, "r");
-					if (keyfd == NULL)
-					{
-						g_print ("failed to open key file...\n\n\n");
-						return FALSE;
-					}
-					
-					/* read key file */
-					bytes_read = fread (ahs_player->cur_key_data, sizeof (unsigned char), 16, keyfd);
-					if (sizeof(ahs_player->cur_key_data) != bytes_read)
-					{
-					    printf ("key file is not proper...bytes_read from key file = %d\n", bytes_read);
-					    return FALSE;
-					}	
-
-					bret = hls_decryption_initialize (ahs_player->ahs_client, &ahs_player->cur_key_data, ahs_player->cur_iv);
-					if (FALSE == bret)
-					{
-						g_print ("Failed to initialize encryption....\n\n");
-					}
-				}
-				g_cond_signal (ahs_player->key_eos_cond);
-				debug_log ("signalling key download EOS\n");
-			}
-			
-			break;
+	key = g_new0 (ahs_key_t, 1);
+	g_hash_table_replace (ahs_player->keys, g_strdup (key_uri), key);
 
-		case GST_MESSAGE_ERROR:
-			{
-				GError *error = NULL;
-				gchar* debug = NULL;
-				/* get error code */
-				//gst_message_parse_error( msg, &error, &debug );
-				debug_error ("GST_MESSAGE_ERROR = %s\n", debug);
-				
-				gst_element_post_message ((GstAppSrc *)ahs_player->appsrc, msg);
-				//g_free( debug);
-				debug = NULL;
-				//g_error_free( error);
-			}
-			break;
+	g_mutex_unlock (ahs_player->key_lock);
+
+	debug_log ("Going to download key-uri -> %s\n", key_uri);
+
+	bret = __mm_player_ahs_fetch_data (ahs_player->fetch, key_uri, &body, &size, error);
+	if (bret && sizeof(key->data) != size)
+	{
+		debug_error ("key is not proper...key size = %d\n", size);
+		g_set_error (error, GST_STREAM_ERROR, GST_STREAM_ERROR_DECRYPT, "wrong key size %d, URL: %s", size, key_uri);
+		bret = FALSE;
+	}
 
-		case GST_MESSAGE_WARNING:
-			{
-				char* debug = NULL;
-				GError* error = NULL;
-				gst_message_parse_warning(msg, &error, &debug);
-				debug_warning("warning : %s\n", error->message);
-				debug_warning("debug : %s\n", debug);
-				g_free( debug);
-				debug = NULL;
-				g_error_free( error);
-			}
-			break;
+	g_mutex_lock (ahs_player->key_lock);
 
-		default:
-			//debug_warning("unhandled message\n");
-			break;
+	if (bret)
+	{
+		memcpy (key->data, body, sizeof(key->data));
+		key->time = ahs_get_time ();
+		key->ready = TRUE;
+
+		memcpy (data, key->data, sizeof(key->data));
+	}
+	else
+	{
+		/* waiting ones try by themselves */
+		g_hash_table_remove (ahs_player->keys, key_uri);
 	}
+
+	g_cond_broadcast (ahs_player->key_cond);
+	g_mutex_unlock (ahs_player->key_lock);
+
+	MMPLAYER_FREEIF (body);
+
 	return bret;
 }
 
-
-static gboolean
-ahs_media_download_callback(GstBus *bus, GstMessage *msg, gpointer data)
+/* bandwidth is of the segments downloaded at the same time since last one */
+static void
+ahs_segment_downloaded (mm_player_ahs_t *ahs_player)
 {
-	mm_player_ahs_t *ahs_player = (mm_player_ahs_t*) data;
-	gboolean bret = TRUE;
-	
+	guint64 now = 0;
+	guint64 bytes = 0;
+	guint64 busy_time = 0;
+
 	debug_log ("<<<\n");
 
-	if ( !ahs_player ) 
+	g_mutex_lock (ahs_player->prefetch_lock);
+	if (ahs_player->prefetch_active)
 	{
-		debug_error("AHS player handle is invalid\n");
-		return FALSE;
+		now = ahs_get_time ();
+		ahs_player->prefetch_busy_time += now - ahs_player->prefetch_busy_since;
+		ahs_player->prefetch_busy_since = now;
 	}
+	bytes = ahs_player->prefetch_bytes;
+	busy_time = ahs_player->prefetch_busy_time;
+	ahs_player->prefetch_bytes = 0;
+	ahs_player->prefetch_busy_time = 0;
+	g_mutex_unlock (ahs_player->prefetch_lock);
 
-	switch ( GST_MESSAGE_TYPE( msg ) )
+	debug_log ("%"G_GUINT64_FORMAT" bytes in %"G_GUINT64_FORMAT" usec, time to first byte = %"G_GUINT64_FORMAT" usec\n",
+		bytes, busy_time, __mm_player_ahs_fetch_get_ttfb (ahs_player->fetch));
+
+	/* keeps last one if segment was downloaded already */
+	if (busy_time)
 	{
-		case GST_MESSAGE_EOS:
-			{
-				glong diff = 0;
-				GTimeVal time = {0, };
-				
-				debug_log("MEDIA EOS received, state=[%d]\n", ahs_player->ahs_state);
-				
-				if (ahs_player->media_download_pipeline) 
-					ahs_destory_media_download_pipeline(ahs_player);
-				
-	  			g_get_current_time (&time);
-				ahs_player->seg_end_time = (time.tv_sec * 1000000)+ time.tv_usec;
-				debug_log ("end time in usec = %"G_GUINT64_FORMAT"\n", ahs_player->seg_end_time);
-
-				diff = ahs_player->seg_end_time - ahs_player->seg_start_time;
-				
-				ahs_player->download_rate = (guint)((ahs_player->seg_size * 8 * 1000000) / diff);
-
-				ahs_player->cache_frag_count++;
-
-				
-				g_print("***********  frag_cnt = %d and download rate = %d bps **************\n", ahs_player->cache_frag_count, ahs_player->download_rate);
-
-				/* first initial fragments go with least possible bit-rate */
-				if (ahs_player->cache_frag_count == DEFAULT_FRAGMENTS_CACHE)
-				{
-					debug_log ("=======================================\n");
-					debug_log (" \t Done with caching initial %d fragments\n", ahs_player->cache_frag_count);
-					debug_log ("=======================================\n");
-				}
-				
-				if (ahs_player->cache_frag_count >= DEFAULT_FRAGMENTS_CACHE)
-				{
-					ahs_switch_playlist (ahs_player, ahs_player->download_rate);				
-				}
+		ahs_player->download_rate = (guint)((bytes * 8 * 1000000) / busy_time);
 
-				ahs_player->seg_size = 0;
+		g_mutex_lock (ahs_player->prefetch_lock);
+		__mm_player_ahs_abr_add_throughput (ahs_player->abr, ahs_player->download_rate);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+	}
 
-				g_mutex_lock (ahs_player->media_mutex);
-				g_cond_broadcast (ahs_player->media_eos_cond);
-				g_mutex_unlock (ahs_player->media_mutex);
+	debug_log ("download rate = %d bps\n", ahs_player->download_rate);
 
-				debug_log ("Signaled media ts EOS...\n");
+	ahs_switch_playlist (ahs_player);
 
-			}
-			break;
+	debug_log (">>>\n");
+}
 
-		case GST_MESSAGE_ERROR:
-			{
-				GError *error = NULL;
-				gchar* debug = NULL;
-				GstMessage *new_msg = NULL;
-				gboolean ret = FALSE;
-				
-				/* get error code */
-				gst_message_parse_error( msg, &error, &debug );
-				debug_error ("GST_MESSAGE_ERROR = %s\n", debug);
-				new_msg = gst_message_new_error (GST_OBJECT_CAST ((GstAppSrc *)ahs_player->appsrc), error, debug);
-				
-				ret = gst_element_post_message ((GstAppSrc *)ahs_player->appsrc, new_msg);
-				
-				//MMPLAYER_FREEIF( debug );
-				//g_error_free( error );
-			}
-			break;
+static gboolean
+ahs_client_is_live (mm_player_ahs_t *ahs_player)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		return (hls_client_is_live(ahs_player->ahs_client));
+	}
+	return TRUE;
+}
 
-		case GST_MESSAGE_WARNING:
-			{
-				char* debug = NULL;
-				GError* error = NULL;
-				gst_message_parse_warning(msg, &error, &debug);
-				debug_warning("warning : %s\n", error->message);
-				debug_warning("debug : %s\n", debug);
-				MMPLAYER_FREEIF( debug );
-				g_error_free( error );
-			}
-			break;
+static gboolean
+ahs_manifest_get_update_interval (mm_player_ahs_t *ahs_player, GTimeVal *next_update)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		return hls_playlist_update_interval(ahs_player->ahs_client, next_update);
+	}
+	return TRUE;
+}
 
-		default:
-			//debug_warning("unhandled message\n");
-			break;
+/* takes manifest */
+static gboolean
+ahs_parse_manifest_update_client (mm_player_ahs_t *ahs_player, gchar *manifest)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		return hls_parse_playlist_update_client(ahs_player->ahs_client, manifest);
+	}
+	else
+	{
+		g_free (manifest);
+		return FALSE;
 	}
-	//debug_log (">>>\n");
-	return bret;
 }
 
 static gboolean 
@@ -1093,14 +1191,60 @@ ahs_get_current_manifest (mm_player_ahs_t *ahs_player)
 	return hls_get_current_playlist (ahs_player->ahs_client);
 }
 
+/* media time pushed ahead of playback in msec. playback position is taken from
+ * pipeline, where the stream starts from 0 with the first pushed segment */
+static guint
+ahs_get_buffer_level (mm_player_ahs_t *ahs_player)
+{
+	GstObject *pipeline = NULL;
+	GstFormat format = GST_FORMAT_TIME;
+	gint64 position = 0;
+	guint64 played = 0;
+	guint64 pushed = 0;
+
+	pipeline = gst_element_get_parent (ahs_player->appsrc);
+	if (pipeline)
+	{
+		/* nothing is played yet if it fails */
+		if (gst_element_query_position (GST_ELEMENT (pipeline), &format, &position) && position > 0)
+			played = position / GST_MSECOND;
+
+		gst_object_unref (pipeline);
+	}
+
+	g_mutex_lock (ahs_player->prefetch_lock);
+	pushed = ahs_player->pushed_duration;
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	return (pushed > played) ? (guint)(pushed - played) : 0;
+}
+
 static gboolean
-ahs_switch_playlist (mm_player_ahs_t *ahs_player, guint download_rate)
+ahs_switch_playlist (mm_player_ahs_t *ahs_player)
 {
+	guint bandwidths[AHS_ABR_VARIANT_MAX] = {0, };
+	gint count = 0;
+	gint current = 0;
+	gint next = 0;
+	guint buffer_msec = 0;
+
 	if ((MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type) && (hls_can_switch (ahs_player->ahs_client)))
 	{
 		ahs_player->need_bw_switch = FALSE;
-		
-		hls_switch_playlist (ahs_player->ahs_client, download_rate, &ahs_player->need_bw_switch);
+
+		count = hls_get_variants (ahs_player->ahs_client, bandwidths, AHS_ABR_VARIANT_MAX, &current);
+		if (0 == count)
+			return FALSE;
+
+		buffer_msec = ahs_get_buffer_level (ahs_player);
+
+		g_mutex_lock (ahs_player->prefetch_lock);
+		__mm_player_ahs_abr_set_variants (ahs_player->abr, bandwidths, count, current);
+		next = __mm_player_ahs_abr_decide (ahs_player->abr, buffer_msec);
+		g_mutex_unlock (ahs_player->prefetch_lock);
+
+		if (next != current && hls_set_variant (ahs_player->ahs_client, next))
+			ahs_player->need_bw_switch = TRUE;
 
 		debug_log ("Need BW Switch = %d\n", ahs_player->need_bw_switch);
 		
@@ -1125,16 +1269,36 @@ ahs_switch_playlist (mm_player_ahs_t *ahs_player, guint download_rate)
 }
 
 static gboolean 
-ahs_get_next_media_uri (mm_player_ahs_t *ahs_player, gchar **media_uri, gchar **key_uri, char **iv)
+ahs_get_next_media_uri (mm_player_ahs_t *ahs_player, gchar **media_uri, gchar **key_uri, char **iv, guint *duration)
 {
 	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
 	{
-		return hls_get_next_media_fragment (ahs_player->ahs_client, media_uri, key_uri, iv);
+		return hls_get_next_media_fragment (ahs_player->ahs_client, media_uri, key_uri, iv, duration);
 	}
 	
 	return TRUE;
 }
 
+static gint
+ahs_get_next_sequence (mm_player_ahs_t *ahs_player)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		return hls_get_next_sequence (ahs_player->ahs_client);
+	}
+
+	return -1;
+}
+
+static void
+ahs_set_next_sequence (mm_player_ahs_t *ahs_player, gint sequence)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		hls_set_next_sequence (ahs_player->ahs_client, sequence);
+	}
+}
+
 static gboolean
 ahs_is_buffer_discontinuous (mm_player_ahs_t *ahs_player)
 {
@@ -1162,14 +1326,49 @@ ahs_clear_discontinuous (mm_player_ahs_t *ahs_player)
 	}
 }
 
+static gpointer
+ahs_decrypt_new (mm_player_ahs_t *ahs_player, gchar *key, char *iv)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		return hls_decryption_new (key, (unsigned char *) iv);
+	}
+
+	return NULL;
+}
+
+static void
+ahs_decrypt_free (mm_player_ahs_t *ahs_player, gpointer decrypt)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		hls_decryption_free ((hls_decrypt_t *) decrypt);
+	}
+}
+
+static gboolean
+ahs_decrypt_media (mm_player_ahs_t *ahs_player, gpointer decrypt, GstBuffer *InBuf, GstBuffer **OutBuf)
+{
+	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
+	{
+		return hls_decrypt_media_fragment ((hls_decrypt_t *) decrypt, InBuf, OutBuf);
+	}
+
+	*OutBuf = InBuf;
+
+	return TRUE;
+}
+
 static gboolean
-ahs_decrypt_media (mm_player_ahs_t *ahs_player,GstBuffer *InBuf, GstBuffer **OutBuf)
+ahs_decrypt_media_end (mm_player_ahs_t *ahs_player, gpointer decrypt, GstBuffer **OutBuf)
 {
 	if (MM_PLAYER_URI_TYPE_HLS == ahs_player->uri_type)
 	{
-		return hls_decrypt_media_fragment (ahs_player->ahs_client, InBuf, OutBuf);
+		return hls_decrypt_media_fragment_end ((hls_decrypt_t *) decrypt, OutBuf);
 	}
 
+	*OutBuf = NULL;
+
 	return TRUE;
 }
 
@@ -1235,18 +1434,28 @@ mm_player_ahs_t * __mm_player_ahs_create ()
 	{
 		goto ERROR;
 	}
-	ahs_player->media_eos_cond = g_cond_new ();
-	if (NULL == ahs_player->media_eos_cond)
+	ahs_player->state_lock = g_mutex_new ();
+	if (NULL == ahs_player->state_lock)
 	{
 		goto ERROR;
 	}
-	ahs_player->key_eos_cond = g_cond_new ();
-	if (NULL == ahs_player->key_eos_cond)
+	ahs_player->prefetch_lock = g_mutex_new ();
+	if (NULL == ahs_player->prefetch_lock)
 	{
 		goto ERROR;
 	}
-	ahs_player->state_lock = g_mutex_new ();
-	if (NULL == ahs_player->state_lock)
+	ahs_player->prefetch_cond = g_cond_new ();
+	if (NULL == ahs_player->prefetch_cond)
+	{
+		goto ERROR;
+	}
+	ahs_player->key_lock = g_mutex_new ();
+	if (NULL == ahs_player->key_lock)
+	{
+		goto ERROR;
+	}
+	ahs_player->key_cond = g_cond_new ();
+	if (NULL == ahs_player->key_cond)
 	{
 		goto ERROR;
 	}
@@ -1262,31 +1471,39 @@ mm_player_ahs_t * __mm_player_ahs_create ()
 	/* manifest related variables */
 	ahs_player->manifest_thread = NULL;
 	ahs_player->manifest_thread_exit = FALSE;
-	ahs_player->manifest_download_pipeline = NULL;
-	ahs_player->manifest_download_src = NULL;
-	ahs_player->manifest_download_sink = NULL;	
-
-	memset (ahs_player->ahs_manifest_dmp_location, 0, HLS_POSIX_PATH_MAX);
 
 	/* media related variables */
 	ahs_player->media_thread = NULL;
 	ahs_player->media_thread_exit = FALSE;
-
-	ahs_player->media_download_pipeline = NULL;
-	ahs_player->media_download_src = NULL;
-	ahs_player->media_download_sink = NULL;
+	ahs_player->media_started = FALSE;
 
 	/* key related variables */
 	ahs_player->cur_key_uri = NULL;
-	memset (ahs_player->ahs_key_dmp_location, 0, 256);
-	ahs_player->key_download_pipeline = NULL;
-	ahs_player->key_download_src = NULL;
-	ahs_player->key_download_sink = NULL;
-
-	ahs_player->seg_start_time = 0;     /* segment start time in usec*/
-	ahs_player->seg_end_time = 0;
-	ahs_player->seg_size = 0;
-	ahs_player->cache_frag_count = 0;
+	ahs_player->keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	ahs_player->key_cache_ttl = 0;
+
+	ahs_player->fetch = NULL;
+
+	/* prefetch related variables */
+	memset (ahs_player->prefetch_threads, 0, sizeof(ahs_player->prefetch_threads));
+	ahs_player->prefetch_count = AHS_DEFAULT_PREFETCH_COUNT;
+	ahs_player->prefetch_buffer_size = AHS_DEFAULT_PREFETCH_BUFFER_SIZE;
+	g_queue_init (&ahs_player->segments);
+	ahs_player->prefetch_buffered = 0;
+	ahs_player->prefetch_exit = FALSE;
+	ahs_player->prefetch_active = 0;
+	ahs_player->prefetch_bytes = 0;
+	ahs_player->prefetch_busy_time = 0;
+	ahs_player->prefetch_busy_since = 0;
+
+	memset (ahs_player->decrypt_threads, 0, sizeof(ahs_player->decrypt_threads));
+	ahs_player->decrypt_bytes = 0;
+	ahs_player->decrypt_time = 0;
+
+	ahs_player->download_rate = 0;
+
+	ahs_player->abr = __mm_player_ahs_abr_create ();
+	ahs_player->pushed_duration = 0;
 	
 	ahs_player->hls_is_wait_for_reload = FALSE;
 
@@ -1315,15 +1532,21 @@ ERROR:
 	if ( ahs_player->media_start_cond )
 		g_cond_free ( ahs_player->media_start_cond );
 
-	if ( ahs_player->media_eos_cond )
-		g_cond_free ( ahs_player->media_eos_cond );
-
-	if ( ahs_player->key_eos_cond )
-		g_cond_free ( ahs_player->key_eos_cond );
-
 	if (ahs_player->state_lock)
 		g_mutex_free(ahs_player->state_lock);
 
+	if (ahs_player->prefetch_lock)
+		g_mutex_free(ahs_player->prefetch_lock);
+
+	if ( ahs_player->prefetch_cond )
+		g_cond_free ( ahs_player->prefetch_cond );
+
+	if (ahs_player->key_lock)
+		g_mutex_free(ahs_player->key_lock);
+
+	if ( ahs_player->key_cond )
+		g_cond_free ( ahs_player->key_cond );
+
 	return NULL;
 	
 	
@@ -1379,9 +1602,115 @@ gboolean __mm_player_ahs_initialize (mm_player_ahs_t *ahs_player, int uri_type,
 	return TRUE;
 }
 
+/* prefetch and decrypt threads are joined and segments left in window are freed */
+static void
+ahs_prefetch_stop (mm_player_ahs_t *ahs_player)
+{
+	ahs_segment_t *seg = NULL;
+	gint i = 0;
+
+	g_mutex_lock (ahs_player->prefetch_lock);
+	ahs_player->prefetch_exit = TRUE;
+	g_cond_broadcast (ahs_player->prefetch_cond);
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	for (i = 0; i < AHS_MAX_PREFETCH_COUNT; i++)
+	{
+		if (ahs_player->prefetch_threads[i])
+		{
+			g_thread_join (ahs_player->prefetch_threads[i]);
+			ahs_player->prefetch_threads[i] = NULL;
+		}
+	}
+
+	for (i = 0; i < AHS_DECRYPT_THREAD_COUNT; i++)
+	{
+		if (ahs_player->decrypt_threads[i])
+		{
+			g_thread_join (ahs_player->decrypt_threads[i]);
+			ahs_player->decrypt_threads[i] = NULL;
+		}
+	}
+
+	while ((seg = (ahs_segment_t *) g_queue_pop_head (&ahs_player->segments)))
+	{
+		ahs_segment_drop_chunks (ahs_player, seg);
+		ahs_segment_free (seg);
+	}
+}
+
+gboolean __mm_player_ahs_set_prefetch (mm_player_ahs_t *ahs_player, gint count, guint buffer_size)
+{
+	return_val_if_fail (ahs_player, FALSE);
+	return_val_if_fail (count > 0, FALSE);
+
+	/* each download holds a connection */
+	if (count > AHS_MAX_PREFETCH_COUNT)
+	{
+		debug_warning ("prefetch count %d is limited to %d\n", count, AHS_MAX_PREFETCH_COUNT);
+		count = AHS_MAX_PREFETCH_COUNT;
+	}
+
+	debug_log ("prefetch %d segments within %u bytes\n", count, buffer_size);
+
+	/* applied on next start */
+	ahs_player->prefetch_count = count;
+	ahs_player->prefetch_buffer_size = buffer_size;
+
+	return TRUE;
+}
+
+/* keys are downloaded again after ttl_sec. 0 keeps them for the session */
+gboolean __mm_player_ahs_set_key_cache_ttl (mm_player_ahs_t *ahs_player, guint ttl_sec)
+{
+	return_val_if_fail (ahs_player, FALSE);
+
+	debug_log ("key cache ttl = %u sec\n", ttl_sec);
+
+	g_mutex_lock (ahs_player->key_lock);
+	ahs_player->key_cache_ttl = ttl_sec;
+	g_mutex_unlock (ahs_player->key_lock);
+
+	return TRUE;
+}
+
+/* rates in bps. decrypt rate is of the time spent in decryption only */
+gboolean __mm_player_ahs_get_throughput (mm_player_ahs_t *ahs_player, guint *download_rate, guint *decrypt_rate)
+{
+	return_val_if_fail (ahs_player && download_rate && decrypt_rate, FALSE);
+
+	g_mutex_lock (ahs_player->prefetch_lock);
+
+	*download_rate = ahs_player->download_rate;
+
+	if (ahs_player->decrypt_time)
+		*decrypt_rate = (guint)((ahs_player->decrypt_bytes * 8 * 1000000) / ahs_player->decrypt_time);
+	else
+		*decrypt_rate = 0;
+
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	return TRUE;
+}
+
+/* recent decisions of bitrate, oldest first. returns the number of them */
+gint __mm_player_ahs_get_abr_log (mm_player_ahs_t *ahs_player, ahs_abr_decision_t *decisions, gint max)
+{
+	gint count = 0;
+
+	return_val_if_fail (ahs_player && decisions, 0);
+
+	g_mutex_lock (ahs_player->prefetch_lock);
+	count = __mm_player_ahs_abr_get_log (ahs_player->abr, decisions, max);
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	return count;
+}
+
 gboolean __mm_player_ahs_start (mm_player_ahs_t *ahs_player)
 {
 	gboolean bret = TRUE;
+	gint i = 0;
 
 	debug_log ("<<<\n");
 
@@ -1393,11 +1722,23 @@ gboolean __mm_player_ahs_start (mm_player_ahs_t *ahs_player)
 	
 	g_print ("\n >>>>>>>>>>> AHS download START\n");
 
-	/* download manifest file */
-	if (!ahs_create_manifest_download_pipeline (ahs_player))
+	/* all the requests of this session share connections */
+	ahs_player->fetch = __mm_player_ahs_fetch_create (ahs_player->user_agent);
+	if (NULL == ahs_player->fetch)
+	{
+		debug_error("failed to create http fetch\n");
 		return FALSE;
+	}
 
 	ahs_player->ahs_state = AHS_STATE_PREPARE_MANIFEST;
+	ahs_player->manifest_thread_exit = FALSE;
+	ahs_player->media_thread_exit = FALSE;
+	ahs_player->media_started = FALSE;
+	ahs_player->prefetch_exit = FALSE;
+	ahs_player->pushed_duration = 0;
+	__mm_player_ahs_abr_reset (ahs_player->abr);
+
+	/* manifest thread downloads main playlist at once */
 
 	ahs_player->manifest_thread = g_thread_create (manifest_update_thread, (gpointer)ahs_player, TRUE, NULL);
 
@@ -1416,6 +1757,30 @@ gboolean __mm_player_ahs_start (mm_player_ahs_t *ahs_player)
 		goto ERROR;
 	}
 
+	/* segments in window are downloaded at once */
+	for (i = 0; i < ahs_player->prefetch_count; i++)
+	{
+		ahs_player->prefetch_threads[i] = g_thread_create (prefetch_download_thread, (gpointer)ahs_player, TRUE, NULL);
+
+		if ( !ahs_player->prefetch_threads[i] )
+		{
+			debug_error("failed to create thread : prefetch\n");
+			goto ERROR;
+		}
+	}
+
+	/* encrypted segments in window are decrypted ahead */
+	for (i = 0; i < AHS_DECRYPT_THREAD_COUNT; i++)
+	{
+		ahs_player->decrypt_threads[i] = g_thread_create (decrypt_thread, (gpointer)ahs_player, TRUE, NULL);
+
+		if ( !ahs_player->decrypt_threads[i] )
+		{
+			debug_error("failed to create thread : decrypt\n");
+			goto ERROR;
+		}
+	}
+
 	g_print ("\n >>>>>>>>>>> AHS download START DONE\n");
 
 	debug_log (">>>\n");
@@ -1426,15 +1791,32 @@ ERROR:
 
 	if (ahs_player->manifest_thread)
 	{
+		g_mutex_lock (ahs_player->manifest_mutex);
+		ahs_player->manifest_thread_exit = TRUE;
+		g_cond_broadcast (ahs_player->manifest_update_cond);
+		g_mutex_unlock (ahs_player->manifest_mutex);
+
+		__mm_player_ahs_fetch_cancel (ahs_player->fetch);
+
 		g_thread_join( ahs_player->manifest_thread);
 		ahs_player->manifest_thread = NULL;
 	}
 
 	if (ahs_player->media_thread)
 	{
+		g_mutex_lock (ahs_player->media_mutex);
+		ahs_player->media_thread_exit = TRUE;
+		g_cond_broadcast (ahs_player->media_start_cond);
+		g_mutex_unlock (ahs_player->media_mutex);
+
 		g_thread_join( ahs_player->media_thread);
 		ahs_player->media_thread = NULL;
 	}
+
+	ahs_prefetch_stop (ahs_player);
+
+	__mm_player_ahs_fetch_destroy (ahs_player->fetch);
+	ahs_player->fetch = NULL;
 	
 	return FALSE;
 }
@@ -1517,9 +1899,6 @@ gboolean __mm_player_ahs_deinitialize (mm_player_ahs_t *ahs_player)
 
 	
 	ahs_player->is_initialized = FALSE;
-
-	if (ahs_player->ahs_manifest_dmp_location)
-		g_unlink(ahs_player->ahs_manifest_dmp_location);
 	
 	g_print ("\n >>>>>>>>>>> AHS deinitalize DONE \n");
 	debug_log (">>>\n");
@@ -1558,16 +1937,25 @@ gboolean __mm_player_ahs_stop (mm_player_ahs_t *ahs_player)
 	
 	ahs_player->ahs_state = AHS_STATE_STOP;
 
+	g_mutex_lock (ahs_player->prefetch_lock);
+	ahs_player->prefetch_exit = TRUE;
+	g_cond_broadcast (ahs_player->prefetch_cond);
+	g_mutex_unlock (ahs_player->prefetch_lock);
+
+	/* requests in flight return at once */
+	if (ahs_player->fetch)
+		__mm_player_ahs_fetch_cancel (ahs_player->fetch);
+
 	if (ahs_player->media_thread)
 	{
 		g_mutex_lock (ahs_player->media_mutex);
 		ahs_player->media_thread_exit = TRUE;
+		g_cond_broadcast (ahs_player->media_start_cond);
 		g_mutex_unlock (ahs_player->media_mutex);
 
-		g_cond_broadcast (ahs_player->manifest_eos_cond);		
-		g_cond_broadcast (ahs_player->media_eos_cond);
-		g_cond_broadcast (ahs_player->media_start_cond);
-		g_cond_broadcast (ahs_player->key_eos_cond);
+		g_mutex_lock (ahs_player->manifest_mutex);
+		g_cond_broadcast (ahs_player->manifest_eos_cond);
+		g_mutex_unlock (ahs_player->manifest_mutex);
 
 		debug_log ("waiting for media thread to finish\n");
 		g_thread_join (ahs_player->media_thread);
@@ -1579,10 +1967,9 @@ gboolean __mm_player_ahs_stop (mm_player_ahs_t *ahs_player)
 	{
 		g_mutex_lock (ahs_player->manifest_mutex);
 		ahs_player->manifest_thread_exit = TRUE;
-		g_mutex_unlock (ahs_player->manifest_mutex);
-		
 		g_cond_broadcast (ahs_player->manifest_update_cond);
 		g_cond_broadcast (ahs_player->manifest_eos_cond);
+		g_mutex_unlock (ahs_player->manifest_mutex);
 
 		debug_log ("waiting for manifest thread to finish\n");
 		g_thread_join (ahs_player->manifest_thread);
@@ -1590,14 +1977,19 @@ gboolean __mm_player_ahs_stop (mm_player_ahs_t *ahs_player)
 		debug_log("manifest thread released\n");
 	}
 
-	if (ahs_player->manifest_download_pipeline)
-		ahs_destory_manifest_download_pipeline(ahs_player);
+	debug_log ("waiting for prefetch threads to finish\n");
+	ahs_prefetch_stop (ahs_player);
 
-	if (ahs_player->media_download_pipeline)
-		ahs_destory_media_download_pipeline(ahs_player);
+	/* keys are of this session */
+	g_mutex_lock (ahs_player->key_lock);
+	g_hash_table_remove_all (ahs_player->keys);
+	g_mutex_unlock (ahs_player->key_lock);
 
-	if (ahs_player->key_download_pipeline)
-		ahs_destory_key_download_pipeline(ahs_player);
+	if (ahs_player->fetch)
+	{
+		__mm_player_ahs_fetch_destroy (ahs_player->fetch);
+		ahs_player->fetch = NULL;
+	}
 
 	debug_fleave ();
 
@@ -1625,14 +2017,8 @@ gboolean __mm_player_ahs_destroy (mm_player_ahs_t *ahs_player)
 	if (ahs_player->manifest_eos_cond)
 		g_cond_broadcast (ahs_player->manifest_eos_cond);
 
-	if (ahs_player->media_eos_cond)
-		g_cond_broadcast (ahs_player->media_eos_cond);
-	
 	if (ahs_player->media_start_cond)
 		g_cond_broadcast (ahs_player->media_start_cond);
-	
-	if (ahs_player->key_eos_cond)
-		g_cond_broadcast (ahs_player->key_eos_cond);
 
 
 	g_print ("waiting for manifest thread to finish from destroy\n");
@@ -1646,6 +2032,7 @@ gboolean __mm_player_ahs_destroy (mm_player_ahs_t *ahs_player)
 	{
 		g_thread_join (ahs_player->media_thread);
 	}
+	ahs_prefetch_stop (ahs_player);
 	g_print ("DESTROY threads are DEAD \n");
 
 	/* initialize ahs common variables */
@@ -1691,23 +2078,38 @@ gboolean __mm_player_ahs_destroy (mm_player_ahs_t *ahs_player)
 		g_mutex_free (ahs_player->media_mutex);
 		ahs_player->media_mutex = NULL;
 	}
-	if (ahs_player->media_eos_cond)
-	{
-		g_cond_free (ahs_player->media_eos_cond);
-		ahs_player->media_eos_cond = NULL;
-	}
 	if (ahs_player->media_start_cond)
 	{
 		g_cond_free (ahs_player->media_start_cond);
 		ahs_player->media_start_cond = NULL;
 	}	
+	if (ahs_player->prefetch_lock)
+	{
+		g_mutex_free (ahs_player->prefetch_lock);
+		ahs_player->prefetch_lock = NULL;
+	}
+	if (ahs_player->prefetch_cond)
+	{
+		g_cond_free (ahs_player->prefetch_cond);
+		ahs_player->prefetch_cond = NULL;
+	}
+	if (ahs_player->keys)
+	{
+		g_hash_table_destroy (ahs_player->keys);
+		ahs_player->keys = NULL;
+	}
+	if (ahs_player->key_lock)
+	{
+		g_mutex_free (ahs_player->key_lock);
+		ahs_player->key_lock = NULL;
+	}
+	if (ahs_player->key_cond)
+	{
+		g_cond_free (ahs_player->key_cond);
+		ahs_player->key_cond = NULL;
+	}
 
 	/* key related variables */
-	if (ahs_player->key_eos_cond)
-	{
-		g_cond_free (ahs_player->key_eos_cond);
-		ahs_player->key_eos_cond = NULL;
-	}	
 	if (ahs_player->cur_key_uri )
 	{
 		g_free (ahs_player->cur_key_uri);
@@ -1720,6 +2122,18 @@ gboolean __mm_player_ahs_destroy (mm_player_ahs_t *ahs_player)
 		ahs_player->ahs_client = NULL;
 	}
 
+	if (ahs_player->fetch)
+	{
+		__mm_player_ahs_fetch_destroy (ahs_player->fetch);
+		ahs_player->fetch = NULL;
+	}
+
+	if (ahs_player->abr)
+	{
+		__mm_player_ahs_abr_destroy (ahs_player->abr);
+		ahs_player->abr = NULL;
+	}
+
 	MMPLAYER_FREEIF(ahs_player->user_agent);
 
 	free (ahs_player);
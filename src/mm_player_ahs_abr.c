@@ -0,0 +1,241 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>,
+ * naveen cherukuri <naveen.ch@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "mm_player_ahs_abr.h"
+
+/* harmonic mean is dominated by low samples, so a short burst doesn't lead to switch up */
+static guint
+ahs_abr_estimate (ahs_abr_t *abr)
+{
+	gdouble sum = 0;
+	gint i = 0;
+
+	for (i = 0; i < abr->sample_count; i++)
+		sum += 1.0 / abr->samples[i];
+
+	if (0 == abr->sample_count)
+		return 0;
+
+	return (guint)(abr->sample_count / sum);
+}
+
+/* highest variant sustainable by estimated throughput. both of throughput and buffer
+ * level decide, and a switch up is given one step at a time after some segments */
+static gint
+ahs_abr_select_default (ahs_abr_t *abr, ahs_abr_reason_t *reason)
+{
+	gdouble usable = abr->estimate * AHS_ABR_SAFETY_FACTOR;
+	gint target = 0;
+
+	if (abr->sample_count < AHS_ABR_STARTUP_SAMPLES)
+	{
+		*reason = AHS_ABR_REASON_STARTUP;
+		return abr->current;
+	}
+
+	for (target = abr->variant_count - 1; target > 0; target--)
+	{
+		if (abr->bandwidths[target] <= usable)
+			break;
+	}
+
+	if (target < abr->current)
+	{
+		/* dip of throughput is covered by buffer */
+		if (abr->buffer_msec >= AHS_ABR_BUFFER_HIGH_MSEC)
+		{
+			*reason = AHS_ABR_REASON_BUFFERED;
+			return abr->current;
+		}
+
+		*reason = (abr->buffer_msec < AHS_ABR_BUFFER_LOW_MSEC) ? AHS_ABR_REASON_PANIC : AHS_ABR_REASON_DOWN;
+		return target;
+	}
+
+	if (target > abr->current)
+	{
+		if (abr->held < AHS_ABR_HOLD_SEGMENTS || abr->buffer_msec < AHS_ABR_BUFFER_LOW_MSEC)
+		{
+			*reason = AHS_ABR_REASON_HOLD;
+			return abr->current;
+		}
+
+		*reason = AHS_ABR_REASON_UP;
+		return abr->current + 1;
+	}
+
+	*reason = AHS_ABR_REASON_KEEP;
+	return abr->current;
+}
+
+ahs_abr_t *
+__mm_player_ahs_abr_create (void)
+{
+	ahs_abr_t *abr = NULL;
+
+	abr = g_new0 (ahs_abr_t, 1);
+
+	abr->select = ahs_abr_select_default;
+
+	return abr;
+}
+
+void
+__mm_player_ahs_abr_destroy (ahs_abr_t *abr)
+{
+	return_if_fail (abr);
+
+	g_free (abr);
+}
+
+/* forgets samples and decisions, keeping variants and algorithm */
+void
+__mm_player_ahs_abr_reset (ahs_abr_t *abr)
+{
+	return_if_fail (abr);
+
+	memset (abr->samples, 0, sizeof(abr->samples));
+	abr->sample_count = 0;
+	abr->sample_index = 0;
+	abr->last_sample = 0;
+	abr->estimate = 0;
+	abr->buffer_msec = 0;
+	abr->held = 0;
+
+	abr->log_head = 0;
+	abr->log_count = 0;
+	abr->segment_count = 0;
+}
+
+/* NULL for default one */
+void
+__mm_player_ahs_abr_set_select_func (ahs_abr_t *abr, ahs_abr_select_func select)
+{
+	return_if_fail (abr);
+
+	abr->select = select ? select : ahs_abr_select_default;
+}
+
+/* bandwidths should be in ascending order. variants may be changed by reload */
+gboolean
+__mm_player_ahs_abr_set_variants (ahs_abr_t *abr, const guint *bandwidths, gint count, gint current)
+{
+	return_val_if_fail (abr && bandwidths, FALSE);
+	return_val_if_fail (count > 0 && count <= AHS_ABR_VARIANT_MAX, FALSE);
+	return_val_if_fail (current >= 0 && current < count, FALSE);
+
+	memcpy (abr->bandwidths, bandwidths, sizeof(guint) * count);
+	abr->variant_count = count;
+	abr->current = current;
+
+	return TRUE;
+}
+
+/* rate of a segment download in bps */
+void
+__mm_player_ahs_abr_add_throughput (ahs_abr_t *abr, guint rate)
+{
+	return_if_fail (abr);
+
+	if (0 == rate)
+		return;
+
+	abr->samples[abr->sample_index] = rate;
+	abr->sample_index = (abr->sample_index + 1) % AHS_ABR_THROUGHPUT_SAMPLES;
+	if (abr->sample_count < AHS_ABR_THROUGHPUT_SAMPLES)
+		abr->sample_count++;
+
+	abr->last_sample = rate;
+	abr->estimate = ahs_abr_estimate (abr);
+}
+
+/* called after each segment with media time buffered ahead of playback.
+ * returns index of variant for next segments, and it's logged */
+gint
+__mm_player_ahs_abr_decide (ahs_abr_t *abr, guint buffer_msec)
+{
+	ahs_abr_decision_t *decision = NULL;
+	ahs_abr_reason_t reason = AHS_ABR_REASON_KEEP;
+	gint next = 0;
+
+	return_val_if_fail (abr && abr->variant_count, 0);
+
+	abr->buffer_msec = buffer_msec;
+	abr->segment_count++;
+
+	next = abr->select (abr, &reason);
+	if (next < 0)
+		next = 0;
+	else if (next >= abr->variant_count)
+		next = abr->variant_count - 1;
+
+	decision = &abr->log[(abr->log_head + abr->log_count) % AHS_ABR_LOG_MAX];
+	if (abr->log_count < AHS_ABR_LOG_MAX)
+		abr->log_count++;
+	else
+		abr->log_head = (abr->log_head + 1) % AHS_ABR_LOG_MAX;
+
+	decision->segment = abr->segment_count;
+	decision->throughput = abr->last_sample;
+	decision->estimate = abr->estimate;
+	decision->buffer_msec = buffer_msec;
+	decision->from_bandwidth = abr->bandwidths[abr->current];
+	decision->to_bandwidth = abr->bandwidths[next];
+	decision->reason = reason;
+
+	debug_log ("abr : segment %u, throughput %u, estimate %u bps, buffer %u msec, %u -> %u bps (reason %d)\n",
+		decision->segment, decision->throughput, decision->estimate, buffer_msec,
+		decision->from_bandwidth, decision->to_bandwidth, reason);
+
+	abr->last_sample = 0;
+
+	if (next != abr->current)
+	{
+		abr->current = next;
+		abr->held = 0;
+	}
+	else
+	{
+		abr->held++;
+	}
+
+	return next;
+}
+
+/* copies recent decisions, oldest first. returns the number of them */
+gint
+__mm_player_ahs_abr_get_log (ahs_abr_t *abr, ahs_abr_decision_t *decisions, gint max)
+{
+	gint count = 0;
+	gint i = 0;
+
+	return_val_if_fail (abr && decisions, 0);
+
+	count = MIN (max, abr->log_count);
+
+	/* latest ones */
+	for (i = 0; i < count; i++)
+		decisions[i] = abr->log[(abr->log_head + abr->log_count - count + i) % AHS_ABR_LOG_MAX];
+
+	return count;
+}
+
@@ -0,0 +1,182 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>,
+ * naveen cherukuri <naveen.ch@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* replays recorded segment throughput and buffer level into the abr controller
+ * and checks its decision log. the controller sees nothing else, so it's exact */
+#include <stdio.h>
+#include "mm_player_ahs_abr.h"
+
+typedef struct
+{
+	guint throughput;			/* download rate of the segment in bps */
+	guint buffer_msec;			/* buffered ahead of playback after the segment */
+
+	/* expected */
+	guint to_bandwidth;
+	ahs_abr_reason_t reason;
+}ahs_abr_test_step_t;
+
+static const guint variants[] = { 300000, 800000, 1500000, 3000000 };
+
+static const ahs_abr_test_step_t trace[] =
+{
+	/* no switch till there are enough samples, then one step up every hold period */
+	{ 5000000,  4000,  300000, AHS_ABR_REASON_STARTUP },
+	{ 5000000,  9000,  300000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 14000,  300000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 19000,  800000, AHS_ABR_REASON_UP },
+	{ 5000000, 24000,  800000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 29000,  800000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 30000,  800000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 30000, 1500000, AHS_ABR_REASON_UP },
+	{ 5000000, 30000, 1500000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 30000, 1500000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 30000, 1500000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 30000, 3000000, AHS_ABR_REASON_UP },
+	{ 5000000, 30000, 3000000, AHS_ABR_REASON_KEEP },
+
+	/* throughput drops. full buffer absorbs the first dip */
+	{ 1000000, 25000, 3000000, AHS_ABR_REASON_BUFFERED },
+	{ 1000000, 15000, 1500000, AHS_ABR_REASON_DOWN },
+	{ 1000000,  5000,  800000, AHS_ABR_REASON_PANIC },
+	{ 1000000,  6000,  800000, AHS_ABR_REASON_KEEP },
+
+	/* recovers. harmonic mean rises slowly and low buffer holds switch up */
+	{ 5000000,  6000,  800000, AHS_ABR_REASON_KEEP },
+	{ 5000000,  6000,  800000, AHS_ABR_REASON_KEEP },
+	{ 5000000,  6000,  800000, AHS_ABR_REASON_HOLD },
+	{ 5000000, 12000, 1500000, AHS_ABR_REASON_UP },
+};
+
+#define AHS_ABR_TEST_STEPS	(sizeof(trace) / sizeof(trace[0]))
+
+static gint failed = 0;
+
+#define AHS_ABR_TEST_CHECK(expr) \
+do \
+{ \
+	if (!(expr)) \
+	{ \
+		fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		failed++; \
+	} \
+} while (0)
+
+static void
+ahs_abr_test_replay (void)
+{
+	ahs_abr_decision_t log[AHS_ABR_LOG_MAX];
+	ahs_abr_t *abr = NULL;
+	guint i = 0;
+	gint count = 0;
+	gint next = 0;
+
+	abr = __mm_player_ahs_abr_create ();
+	AHS_ABR_TEST_CHECK (__mm_player_ahs_abr_set_variants (abr, variants, 4, 0));
+
+	for (i = 0; i < AHS_ABR_TEST_STEPS; i++)
+	{
+		__mm_player_ahs_abr_add_throughput (abr, trace[i].throughput);
+		next = __mm_player_ahs_abr_decide (abr, trace[i].buffer_msec);
+
+		AHS_ABR_TEST_CHECK (variants[next] == trace[i].to_bandwidth);
+	}
+
+	count = __mm_player_ahs_abr_get_log (abr, log, AHS_ABR_LOG_MAX);
+	AHS_ABR_TEST_CHECK (count == AHS_ABR_TEST_STEPS);
+
+	for (i = 0; i < (guint)count && i < AHS_ABR_TEST_STEPS; i++)
+	{
+		if (log[i].to_bandwidth != trace[i].to_bandwidth || log[i].reason != trace[i].reason)
+		{
+			fprintf (stderr, "segment %u : %u bps (reason %d), expected %u bps (reason %d)\n",
+				log[i].segment, log[i].to_bandwidth, log[i].reason, trace[i].to_bandwidth, trace[i].reason);
+			failed++;
+		}
+
+		AHS_ABR_TEST_CHECK (log[i].segment == i + 1);
+		AHS_ABR_TEST_CHECK (log[i].throughput == trace[i].throughput);
+		AHS_ABR_TEST_CHECK (log[i].buffer_msec == trace[i].buffer_msec);
+		AHS_ABR_TEST_CHECK (log[i].from_bandwidth == (i ? trace[i - 1].to_bandwidth : variants[0]));
+	}
+
+	/* latest ones only */
+	count = __mm_player_ahs_abr_get_log (abr, log, 2);
+	AHS_ABR_TEST_CHECK (count == 2);
+	AHS_ABR_TEST_CHECK (log[1].segment == AHS_ABR_TEST_STEPS);
+
+	/* same trace gives same decisions after reset */
+	__mm_player_ahs_abr_reset (abr);
+	AHS_ABR_TEST_CHECK (__mm_player_ahs_abr_set_variants (abr, variants, 4, 0));
+
+	for (i = 0; i < AHS_ABR_TEST_STEPS; i++)
+	{
+		__mm_player_ahs_abr_add_throughput (abr, trace[i].throughput);
+		next = __mm_player_ahs_abr_decide (abr, trace[i].buffer_msec);
+
+		AHS_ABR_TEST_CHECK (variants[next] == trace[i].to_bandwidth);
+	}
+
+	__mm_player_ahs_abr_destroy (abr);
+}
+
+/* ring keeps the last AHS_ABR_LOG_MAX decisions */
+static void
+ahs_abr_test_log_ring (void)
+{
+	ahs_abr_decision_t log[AHS_ABR_LOG_MAX];
+	ahs_abr_t *abr = NULL;
+	gint count = 0;
+	gint i = 0;
+
+	abr = __mm_player_ahs_abr_create ();
+	AHS_ABR_TEST_CHECK (__mm_player_ahs_abr_set_variants (abr, variants, 4, 0));
+
+	for (i = 0; i < AHS_ABR_LOG_MAX + 5; i++)
+	{
+		__mm_player_ahs_abr_add_throughput (abr, 1000000);
+		__mm_player_ahs_abr_decide (abr, 30000);
+	}
+
+	count = __mm_player_ahs_abr_get_log (abr, log, AHS_ABR_LOG_MAX);
+	AHS_ABR_TEST_CHECK (count == AHS_ABR_LOG_MAX);
+	AHS_ABR_TEST_CHECK (log[0].segment == 6);
+	AHS_ABR_TEST_CHECK (log[AHS_ABR_LOG_MAX - 1].segment == AHS_ABR_LOG_MAX + 5);
+
+	__mm_player_ahs_abr_destroy (abr);
+}
+
+int
+main (int argc, char *argv[])
+{
+	ahs_abr_test_replay ();
+	ahs_abr_test_log_ring ();
+
+	if (failed)
+	{
+		fprintf (stderr, "%d checks failed\n", failed);
+		return 1;
+	}
+
+	return 0;
+}
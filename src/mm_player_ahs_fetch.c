@@ -0,0 +1,373 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>,
+ * naveen cherukuri <naveen.ch@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "mm_player_ahs_fetch.h"
+#include "mm_player_utils.h"
+
+typedef struct
+{
+	mm_player_ahs_fetch_t *fetch;
+	SoupMessage *msg;
+	GstBuffer *pending;		/* allocated, not given by got-chunk yet */
+	mm_player_ahs_fetch_chunk_cb chunk_cb;
+	gpointer user_data;
+	guint64 start;
+}ahs_fetch_request_t;
+
+static guint64
+ahs_fetch_get_time (void)
+{
+	GTimeVal time = {0, };
+
+	g_get_current_time (&time);
+
+	return ((guint64)time.tv_sec * 1000000) + time.tv_usec;
+}
+
+/* response body is read straight into the GstBuffer which is pushed later.
+ * soup doesn't hold a reference, so the buffer is writable in chunk_cb */
+static SoupBuffer *
+ahs_fetch_chunk_allocator (SoupMessage *msg, gsize max_len, gpointer user_data)
+{
+	ahs_fetch_request_t *request = (ahs_fetch_request_t *) user_data;
+	GstBuffer *buffer = NULL;
+	gsize size = AHS_FETCH_CHUNK_SIZE;
+
+	if (max_len && max_len < size)
+		size = max_len;
+
+	/* previous one was not used */
+	if (request->pending)
+		gst_buffer_unref (request->pending);
+
+	buffer = gst_buffer_new_and_alloc (AHS_FETCH_CHUNK_HEADROOM + size);
+	GST_BUFFER_DATA (buffer) += AHS_FETCH_CHUNK_HEADROOM;
+	GST_BUFFER_SIZE (buffer) = size;
+
+	request->pending = buffer;
+
+	return soup_buffer_new_with_owner (GST_BUFFER_DATA (buffer), size, buffer, NULL);
+}
+
+static void
+ahs_fetch_got_chunk (SoupMessage *msg, SoupBuffer *chunk, gpointer user_data)
+{
+	ahs_fetch_request_t *request = (ahs_fetch_request_t *) user_data;
+	GstBuffer *buffer = NULL;
+
+	/* only the body of final response. not of redirection or error */
+	if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
+		return;
+
+	if (request->pending && soup_buffer_get_owner (chunk) == request->pending)
+	{
+		buffer = request->pending;
+		request->pending = NULL;
+	}
+	else
+	{
+		/* not from our allocator */
+		buffer = gst_buffer_new_and_alloc (AHS_FETCH_CHUNK_HEADROOM + chunk->length);
+		GST_BUFFER_DATA (buffer) += AHS_FETCH_CHUNK_HEADROOM;
+		memcpy (GST_BUFFER_DATA (buffer), chunk->data, chunk->length);
+	}
+
+	GST_BUFFER_SIZE (buffer) = chunk->length;
+
+	if (!request->chunk_cb (buffer, request->user_data))
+	{
+		debug_log ("chunk is refused, cancel the request\n");
+		soup_session_cancel_message (request->fetch->session, msg, SOUP_STATUS_CANCELLED);
+	}
+}
+
+static void
+ahs_fetch_got_headers (SoupMessage *msg, gpointer user_data)
+{
+	ahs_fetch_request_t *request = (ahs_fetch_request_t *) user_data;
+	guint64 ttfb = ahs_fetch_get_time () - request->start;
+
+	/* called in soup thread */
+	g_mutex_lock (request->fetch->lock);
+	request->fetch->ttfb = ttfb;
+	g_mutex_unlock (request->fetch->lock);
+}
+
+/* blocks till the response is done. the request is cancelled with the fetch */
+static guint
+ahs_fetch_send (mm_player_ahs_fetch_t *fetch, ahs_fetch_request_t *request)
+{
+	guint status = SOUP_STATUS_NONE;
+
+	g_mutex_lock (fetch->lock);
+	if (fetch->cancelled)
+	{
+		g_mutex_unlock (fetch->lock);
+		soup_message_set_status (request->msg, SOUP_STATUS_CANCELLED);
+		return SOUP_STATUS_CANCELLED;
+	}
+	fetch->messages = g_list_prepend (fetch->messages, request);
+	g_mutex_unlock (fetch->lock);
+
+	status = soup_session_send_message (fetch->session, request->msg);
+
+	g_mutex_lock (fetch->lock);
+	fetch->messages = g_list_remove (fetch->messages, request);
+	g_mutex_unlock (fetch->lock);
+
+	return status;
+}
+
+static gboolean
+ahs_fetch_check_status (guint status, const gchar *reason, const gchar *uri, GError **error)
+{
+	gint code = GST_RESOURCE_ERROR_OPEN_READ;
+
+	if (SOUP_STATUS_IS_SUCCESSFUL (status))
+		return TRUE;
+
+	/* not an error to report */
+	if (SOUP_STATUS_CANCELLED == status)
+	{
+		debug_log ("request is cancelled : %s\n", uri);
+		return FALSE;
+	}
+
+	if (SOUP_STATUS_IS_TRANSPORT_ERROR (status))
+		code = GST_RESOURCE_ERROR_READ;
+	else if (SOUP_STATUS_NOT_FOUND == status)
+		code = GST_RESOURCE_ERROR_NOT_FOUND;
+
+	debug_error ("failed to fetch %s : %d %s\n", uri, status, reason);
+	g_set_error (error, GST_RESOURCE_ERROR, code, "%s (%d), URL: %s", reason, status, uri);
+
+	return FALSE;
+}
+
+mm_player_ahs_fetch_t *
+__mm_player_ahs_fetch_create (const gchar *user_agent)
+{
+	mm_player_ahs_fetch_t *fetch = NULL;
+
+	debug_fenter ();
+
+	fetch = g_new0 (mm_player_ahs_fetch_t, 1);
+
+	fetch->lock = g_mutex_new ();
+	if (NULL == fetch->lock)
+		goto ERROR;
+
+	/* http/1.1 connections are persistent, so they are reused by the following requests */
+	fetch->session = soup_session_sync_new_with_options (
+			SOUP_SESSION_MAX_CONNS_PER_HOST, AHS_FETCH_MAX_CONNS_PER_HOST,
+			SOUP_SESSION_TIMEOUT, AHS_FETCH_TIMEOUT_SEC,
+			NULL);
+	if (NULL == fetch->session)
+	{
+		debug_error ("failed to create http session\n");
+		goto ERROR;
+	}
+
+	if (user_agent)
+		g_object_set (fetch->session, SOUP_SESSION_USER_AGENT, user_agent, NULL);
+
+	debug_fleave ();
+
+	return fetch;
+
+ERROR:
+	if (fetch->lock)
+		g_mutex_free (fetch->lock);
+
+	MMPLAYER_FREEIF (fetch);
+
+	return NULL;
+}
+
+void
+__mm_player_ahs_fetch_destroy (mm_player_ahs_fetch_t *fetch)
+{
+	debug_fenter ();
+
+	return_if_fail (fetch);
+
+	__mm_player_ahs_fetch_cancel (fetch);
+
+	soup_session_abort (fetch->session);
+	g_object_unref (fetch->session);
+
+	g_list_free (fetch->messages);
+	g_mutex_free (fetch->lock);
+
+	g_free (fetch);
+
+	debug_fleave ();
+}
+
+/* body is handed to chunk_cb as it arrives */
+gboolean
+__mm_player_ahs_fetch_stream (mm_player_ahs_fetch_t *fetch, const gchar *uri,
+	mm_player_ahs_fetch_chunk_cb chunk_cb, gpointer user_data, GError **error)
+{
+	ahs_fetch_request_t request = {0, };
+	SoupMessage *msg = NULL;
+	gboolean ret = FALSE;
+
+	return_val_if_fail (fetch && uri && chunk_cb, FALSE);
+
+	msg = soup_message_new (SOUP_METHOD_GET, uri);
+	if (NULL == msg)
+	{
+		g_set_error (error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_OPEN_READ, "invalid URL: %s", uri);
+		return FALSE;
+	}
+
+	request.fetch = fetch;
+	request.msg = msg;
+	request.chunk_cb = chunk_cb;
+	request.user_data = user_data;
+	request.start = ahs_fetch_get_time ();
+
+	soup_message_body_set_accumulate (msg->response_body, FALSE);
+	soup_message_set_chunk_allocator (msg, ahs_fetch_chunk_allocator, &request, NULL);
+	g_signal_connect (msg, "got-headers", G_CALLBACK (ahs_fetch_got_headers), &request);
+
+	/* any 2xx can have body, e.g. 206 of a range request. status is checked in the handler */
+	g_signal_connect (msg, "got-chunk", G_CALLBACK (ahs_fetch_got_chunk), &request);
+
+	ahs_fetch_send (fetch, &request);
+
+	if (request.pending)
+		gst_buffer_unref (request.pending);
+
+	ret = ahs_fetch_check_status (msg->status_code, msg->reason_phrase, uri, error);
+
+	g_object_unref (msg);
+
+	return ret;
+}
+
+/* whole body at once. data is nul terminated and should be freed */
+gboolean
+__mm_player_ahs_fetch_data (mm_player_ahs_fetch_t *fetch, const gchar *uri,
+	gchar **data, gsize *size, GError **error)
+{
+	ahs_fetch_request_t request = {0, };
+	SoupMessage *msg = NULL;
+	SoupBuffer *body = NULL;
+	gboolean ret = FALSE;
+
+	return_val_if_fail (fetch && uri && data, FALSE);
+
+	msg = soup_message_new (SOUP_METHOD_GET, uri);
+	if (NULL == msg)
+	{
+		g_set_error (error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_OPEN_READ, "invalid URL: %s", uri);
+		return FALSE;
+	}
+
+	request.fetch = fetch;
+	request.msg = msg;
+	request.start = ahs_fetch_get_time ();
+	g_signal_connect (msg, "got-headers", G_CALLBACK (ahs_fetch_got_headers), &request);
+
+	ahs_fetch_send (fetch, &request);
+
+	ret = ahs_fetch_check_status (msg->status_code, msg->reason_phrase, uri, error);
+	if (ret)
+	{
+		body = soup_message_body_flatten (msg->response_body);
+
+		*data = g_malloc (body->length + 1);
+		memcpy (*data, body->data, body->length);
+		(*data)[body->length] = '\0';
+
+		if (size)
+			*size = body->length;
+
+		soup_buffer_free (body);
+	}
+
+	g_object_unref (msg);
+
+	return ret;
+}
+
+guint64
+__mm_player_ahs_fetch_get_ttfb (mm_player_ahs_fetch_t *fetch)
+{
+	guint64 ttfb = 0;
+
+	return_val_if_fail (fetch, 0);
+
+	g_mutex_lock (fetch->lock);
+	ttfb = fetch->ttfb;
+	g_mutex_unlock (fetch->lock);
+
+	return ttfb;
+}
+
+/* cancels requests in flight and refuses new ones. used to stop the session */
+void
+__mm_player_ahs_fetch_cancel (mm_player_ahs_fetch_t *fetch)
+{
+	GList *list = NULL;
+
+	return_if_fail (fetch);
+
+	g_mutex_lock (fetch->lock);
+
+	fetch->cancelled = TRUE;
+
+	for (list = fetch->messages; list; list = g_list_next (list))
+	{
+		ahs_fetch_request_t *request = (ahs_fetch_request_t *) list->data;
+		soup_session_cancel_message (fetch->session, request->msg, SOUP_STATUS_CANCELLED);
+	}
+
+	g_mutex_unlock (fetch->lock);
+}
+
+/* cancels the streaming request in flight with user_data, if any */
+void
+__mm_player_ahs_fetch_cancel_stream (mm_player_ahs_fetch_t *fetch, gpointer user_data)
+{
+	GList *list = NULL;
+
+	return_if_fail (fetch);
+
+	g_mutex_lock (fetch->lock);
+
+	for (list = fetch->messages; list; list = g_list_next (list))
+	{
+		ahs_fetch_request_t *request = (ahs_fetch_request_t *) list->data;
+
+		if (request->chunk_cb && request->user_data == user_data)
+		{
+			debug_log ("cancel request in flight\n");
+			soup_session_cancel_message (fetch->session, request->msg, SOUP_STATUS_CANCELLED);
+		}
+	}
+
+	g_mutex_unlock (fetch->lock);
+}
+
@@ -25,33 +25,6 @@
 
 static const float update_interval_factor[] = { 1, 0.5, 1.5, 3 };
 #define AES_BLOCK_SIZE 16
-#define BITRATE_SWITCH_UPPER_THRESHOLD 0.4
-#define BITRATE_SWITCH_LOWER_THRESHOLD 0.1
-
-static gboolean hls_switch_to_lowerband (mm_player_hls_t * player, guint download_rate);
-static gboolean hls_switch_to_upperband (mm_player_hls_t * ahs_player, GList *next_bw_lists, guint download_rate);
-
-/* utility function for removing '\r' character in string */
-char* string_replace (char* text, int len)
-{
-	int i=0;
-	char *dst_ptr = NULL;
-	char* tmp = malloc (len);
-	if (NULL == tmp)
-	{
-		debug_error ("Failed to allocate memory...\n");
-		return NULL;
-	}
-	memset (tmp, 0, len);
-	dst_ptr = tmp;
-
-	for (i=0; i<len; i++) 	{
-		if (text[i] != '\r') {
-			*dst_ptr++ = text[i];
-		}
-	}
-	return tmp;
-}
 
 gint my_compare (gconstpointer a,  gconstpointer b)
 {
@@ -63,7 +36,8 @@ gint my_compare (gconstpointer a,  gconstpointer b)
 
 void hls_dump_mediafile (GstM3U8MediaFile* mediafile)
 {
-	debug_log ("[%d][%d][%s][%s]\n", mediafile->sequence, mediafile->duration, mediafile->title, mediafile->uri);
+	debug_log ("[%d][%d][%s][%s%s]\n", mediafile->sequence, mediafile->duration, mediafile->title,
+		mediafile->base ? mediafile->base : "", mediafile->uri);
 }
 
 void hls_dump_m3u8 (GstM3U8* m3u8)
@@ -73,20 +47,18 @@ void hls_dump_m3u8 (GstM3U8* m3u8)
 			m3u8->version, m3u8->endlist, m3u8->bandwidth, m3u8->targetduration, m3u8->mediasequence);
 	debug_log ("allow cache = %s, program_id = %d, codecs = %s\n", m3u8->allowcache, m3u8->program_id, m3u8->codecs);
 	debug_log ("width = %d, height = %d\n", m3u8->width, m3u8->height);
-	debug_log ("last data = [%s], parent = [%p]\n", m3u8->last_data, m3u8->parent);
+	debug_log ("parent = [%p]\n", m3u8->parent);
 
 	GList* tmp = m3u8->lists;
+	guint i = 0;
 	while (tmp) {
 		debug_log ("################### SUB playlist ##################\n");
 		hls_dump_m3u8 (tmp->data);
 		tmp = g_list_next(tmp);
 	}
 
-	tmp = m3u8->files;
-	while (tmp) {
-		hls_dump_mediafile (tmp->data);
-		tmp = g_list_next(tmp);
-	}
+	for (i = 0; i < m3u8->files.len; i++)
+		hls_dump_mediafile (gst_m3u8_file_ring_index (&m3u8->files, i));
 }
 
 void hls_dump_playlist (void *hls_handle)
@@ -106,30 +78,15 @@ void hls_dump_playlist (void *hls_handle)
 
 #define MMPLAYER_DEFAULT_AUDIO_BANDWIDTH        70000 /* FIXIT */
 
-gboolean hls_parse_playlist_update_client (void *hls_handle, char* playlist)
+/* playlist is downloaded text, taking ownership */
+gboolean hls_parse_playlist_update_client (void *hls_handle, gchar* playlist)
 {
 	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
-	GError *error = NULL;
-	guint8 *data = NULL;
-	
-	debug_log ("<<<  Playlist =  [%s] \n" ,playlist);
-
-	/* prepare MMAP */
-	GMappedFile *file = g_mapped_file_new (playlist, TRUE, &error);
-	if (error) 
-	{
-		g_print ("failed to open file: %s\n", error->message);
-		g_error_free (error);
-		return FALSE;
-	}
 	
-	data = (guint8 *) g_mapped_file_get_contents (file);
-
-	/* Get replaced text (remove '\r') */
-	char* replaced_text = string_replace (data, g_mapped_file_get_length (file));
+	debug_log ("<<<\n");
 
-	/* update with replaced text */
-	if (gst_m3u8_client_update (hls_player->client, replaced_text))	
+	/* NOTE : parser takes it and handles '\r' */
+	if (gst_m3u8_client_update (hls_player->client, playlist))	
 	{
 		GList *my_list = NULL;
 		guint list_count = g_list_length(hls_player->client->main->lists);
@@ -163,9 +120,6 @@ gboolean hls_parse_playlist_update_client (void *hls_handle, char* playlist)
 	{
 		g_print ("\n\n!!!!!!!!!!!!!!!! RELOADED but NO changes!!!!!!\n\n");
 	}
-
-	/* clean up */
-	g_mapped_file_unref (file);
 	
 	return TRUE;
 
@@ -239,7 +193,7 @@ gboolean hls_is_variant_playlist (void *hls_handle)
 {
 	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
 	
-	if ( gst_m3u8_client_has_variant_playlist (hls_player->client) && (hls_player->client->current->files == NULL)) 
+	if ( gst_m3u8_client_has_variant_playlist (hls_player->client) && (hls_player->client->current->files.len == 0)) 
 	{
 		return TRUE;
 	}
@@ -349,139 +303,49 @@ hls_determining_next_file_load (void *hls_handle, gboolean *is_ready)
 
 
 
-static gboolean
-hls_switch_to_upperband (mm_player_hls_t * ahs_player, GList *next_bw_lists, guint download_rate)
+/* bandwidths of variants in ascending order, and index of current one. returns the number of them */
+gint hls_get_variants (void *hls_handle, guint *bandwidths, gint max, gint *current)
 {
-	GstM3U8 *next_client = NULL;
-	GList *final_bw_lists = NULL;
+	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
+	GList *list = NULL;
+	gint count = 0;
 
-	while (1)
-	{
-	       next_client = (GstM3U8 *)next_bw_lists->data;
-		if (download_rate > (next_client->bandwidth + (BITRATE_SWITCH_UPPER_THRESHOLD * next_client->bandwidth)))
-		{
-			final_bw_lists = next_bw_lists;
-			next_bw_lists = g_list_next (next_bw_lists);
-			if (NULL == next_bw_lists)
-			{
-				debug_log ("\n****** reached max BW possible.... *********\n");
-				ahs_player->client->main->lists = final_bw_lists;
-				gst_m3u8_client_set_current (ahs_player->client, final_bw_lists->data);
-				debug_log("Client is MAX FAST, switching to bitrate %d\n", ahs_player->client->current->bandwidth);	
-				break;				
-			}
-		}
-		else
-		{
-			// TODO: Wrong condition.. need to check
-			#if 0
-			ahs_player->client->main->lists = final_bw_lists;
-			gst_m3u8_client_set_current (ahs_player->client, final_bw_lists->data);
-			#endif
-			debug_log("Client is FAST, switching to bitrate %d\n", ahs_player->client->current->bandwidth);	
-			break;
-  		}
-	}
+	*current = 0;
 
-	return TRUE;
-}
-
-static gboolean
-hls_switch_to_lowerband (mm_player_hls_t * player, guint download_rate)
-{
-	GList *cur_bw_lists = player->client->main->lists;
-	GList *prev_bw_lists = NULL;
-	GList *present_bw_lists = player->client->main->lists;
-	GstM3U8 *cur_client = (GstM3U8 *)cur_bw_lists->data;;
-	GstM3U8 *present_client = NULL;
-	
-	while (1)
+	/* sorted by bitrate when main playlist is parsed */
+	for (list = hls_player->client->main->lists; list && count < max; list = g_list_next (list))
 	{
-		present_client = (GstM3U8 *)present_bw_lists->data;
-		
-		if (download_rate < (present_client->bandwidth + (BITRATE_SWITCH_LOWER_THRESHOLD * present_client->bandwidth)))
-		{
-			prev_bw_lists = present_bw_lists;
-			
-			if(NULL == present_bw_lists->prev) 
-			{
-				if (cur_client->bandwidth == present_client->bandwidth)
-				{
-					debug_log ("\n\n\n We are at same lower BW\n\n\n");
-					return TRUE;
-				}
-				debug_log ("\n****** reached min BW possible.... *********\n\n");
-				player->client->main->lists = prev_bw_lists;
-				gst_m3u8_client_set_current (player->client, prev_bw_lists->data);
-				debug_log("Client is MAX SLOW, switching to bitrate %d\n", player->client->current->bandwidth);	
-				return TRUE;				
-			}
+		GstM3U8 *m3u8 = (GstM3U8 *) list->data;
 
-			present_bw_lists = g_list_previous (present_bw_lists);
+		if (m3u8 == hls_player->client->current)
+			*current = count;
 
-		}
-		else
-		{
-			player->client->main->lists = present_bw_lists;
-			gst_m3u8_client_set_current (player->client, present_bw_lists->data);
-			debug_log ("Client is SLOW, switching to bitrate %d\n", player->client->current->bandwidth);	
-			break;
-  		}
+		bandwidths[count++] = m3u8->bandwidth;
 	}
 
-	return TRUE;
+	return count;
 }
 
-gboolean hls_switch_playlist (void *hls_handle, guint download_rate, gboolean *need_bw_switch)
+gboolean hls_set_variant (void *hls_handle, gint index)
 {
 	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
+	GstM3U8 *m3u8 = NULL;
 
-	GList *next_bw_lists = NULL;
-	GstM3U8 *next_client = NULL;
-	GList *present_bw_lists = NULL;
-	GstM3U8 *present_client = NULL;
-	GList *prev_bw_lists = NULL;
-	GstM3U8 *prev_client = NULL;
-
-	present_bw_lists = hls_player->client->main->lists;
-	present_client = (GstM3U8 *)present_bw_lists->data;
-	if (NULL == present_client)
+	m3u8 = (GstM3U8 *) g_list_nth_data (hls_player->client->main->lists, index);
+	if (NULL == m3u8)
 	{
-		g_print ("\n\n ERROR : Present client is NULL\n\n");
+		debug_error ("no variant of index %d\n", index);
 		return FALSE;
 	}
 
-	next_bw_lists = g_list_next (hls_player->client->main->lists);
-	if (next_bw_lists)
-	{
-		next_client = (GstM3U8 *)next_bw_lists->data;
-	}
-	
-	prev_bw_lists = g_list_previous (hls_player->client->main->lists);
-	if (prev_bw_lists)
-	{
-		prev_client = (GstM3U8 *)prev_bw_lists->data;
-	}
-	
-	if (next_bw_lists && (download_rate > (next_client->bandwidth + (BITRATE_SWITCH_UPPER_THRESHOLD * next_client->bandwidth))))
-	{
-		/* our download rate is 40% more than next bandwidth available */
-		hls_switch_to_upperband (hls_player, next_bw_lists, download_rate);
-		g_print (">>>>>>> Need to switch to UPPER BW [ %d ]\n", hls_player->client->current->bandwidth);
-
-		*need_bw_switch = TRUE;
-	}
-	if (prev_bw_lists && (download_rate < (present_client->bandwidth + (BITRATE_SWITCH_LOWER_THRESHOLD * present_client->bandwidth))))
-	{
-		hls_switch_to_lowerband (hls_player, download_rate);	
-		g_print ("<<<<< Need to switch to LOWER BW [ %d ]\n", hls_player->client->current->bandwidth);
-		*need_bw_switch = TRUE;
-	}
+	gst_m3u8_client_set_current (hls_player->client, m3u8);
+	debug_log ("switching to bitrate %d\n", m3u8->bandwidth);
 
 	return TRUE;
 }
 
-gboolean hls_get_next_media_fragment (void *hls_handle, gchar **media_uri, gchar **key_uri,  char **iv)
+/* duration is in msec */
+gboolean hls_get_next_media_fragment (void *hls_handle, gchar **media_uri, gchar **key_uri,  char **iv, guint *duration)
 {
 	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
 	GstM3U8MediaFile *next_fragment_file = NULL;
@@ -512,8 +376,9 @@ gboolean hls_get_next_media_fragment (void *hls_handle, gchar **media_uri, gchar
 		}		
 		if (next_fragment_file->uri)
 		{
-			*media_uri = g_strdup (next_fragment_file->uri);
+			*media_uri = gst_m3u8_media_file_get_uri (next_fragment_file);
 		}
+		*duration = next_fragment_file->duration * 1000;
 	}
 	else
 	{
@@ -523,6 +388,25 @@ gboolean hls_get_next_media_fragment (void *hls_handle, gchar **media_uri, gchar
 	return TRUE;
 }
 
+gint
+hls_get_next_sequence (void *hls_handle)
+{
+	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
+
+	return hls_player->client->sequence;
+}
+
+/* fragments from the sequence are given again */
+void
+hls_set_next_sequence (void *hls_handle, gint sequence)
+{
+	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
+
+	debug_log ("next sequence is set to %d from %d\n", sequence, hls_player->client->sequence);
+
+	hls_player->client->sequence = sequence;
+}
+
 gboolean
 hls_is_buffer_discontinuous (void *hls_handle)
 {
@@ -607,77 +491,141 @@ hls_store_media_presentation (void *hls_handle, unsigned char *buffer, unsigned
 
 }
 
-gboolean hls_decryption_initialize (void *hls_handle, gchar *key_data, unsigned char *iv)
+/* decryption of a media fragment with its key and iv */
+hls_decrypt_t *
+hls_decryption_new (gchar *key_data, unsigned char *iv)
 {
-	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
+	hls_decrypt_t *decrypt = NULL;
 
-	EVP_CIPHER_CTX_init(&(hls_player->decrypt));
-	EVP_DecryptInit_ex(&(hls_player->decrypt), EVP_aes_128_cbc(), NULL, key_data, iv);
-	
-	return TRUE;
+	decrypt = g_new0 (hls_decrypt_t, 1);
+
+	EVP_CIPHER_CTX_init(&(decrypt->ctx));
+	if (!EVP_DecryptInit_ex(&(decrypt->ctx), EVP_aes_128_cbc(), NULL, key_data, iv))
+	{
+		debug_error ("failed to initialize decryption\n");
+		hls_decryption_free (decrypt);
+		return NULL;
+	}
+
+	/* padding is removed by hls_decrypt_media_fragment_end, so blocks are decrypted in place */
+	EVP_CIPHER_CTX_set_padding(&(decrypt->ctx), 0);
+
+	return decrypt;
 }
 
-gboolean
-hls_decrypt_media_fragment (void *hls_handle,GstBuffer *InBuf, GstBuffer **OutBuf)
+void
+hls_decryption_free (hls_decrypt_t *decrypt)
 {
-	mm_player_hls_t *hls_player = (mm_player_hls_t *) hls_handle;
+	EVP_CIPHER_CTX_cleanup(&(decrypt->ctx));
+
+	g_free (decrypt);
+}
 
-	unsigned int inbuf_size = 0;
-	unsigned char *inbuf_data = NULL;
-	int remain = 0;
-	unsigned int out_len = 0;
+/* takes InBuf. it's decrypted in place when it's writable and has room before its data
+ * for the bytes carried from previous one, so OutBuf is usually InBuf trimmed.
+ * last block is kept back for padding and OutBuf is NULL if nothing is ready yet */
+gboolean
+hls_decrypt_media_fragment (hls_decrypt_t *decrypt, GstBuffer *InBuf, GstBuffer **OutBuf)
+{
 	GstBuffer *buffer = NULL;
-						
-	if (hls_player->remained)
+	unsigned char *data = NULL;
+	guint held = decrypt->has_last_block ? AES_BLOCK_SIZE : 0;
+	guint prefix = held + decrypt->remained_len;
+	guint size = 0;
+	guint aligned = 0;
+	int out_len = 0;
+
+	*OutBuf = NULL;
+
+	if (gst_buffer_is_writable (InBuf) && GST_BUFFER_MALLOCDATA (InBuf)
+		&& (GST_BUFFER_DATA (InBuf) - GST_BUFFER_MALLOCDATA (InBuf)) >= prefix)
 	{
-		buffer = gst_buffer_merge (hls_player->remained, InBuf);
-		if (NULL == buffer)
-		{
-			g_print ("ERROR: Failed to merge...\n");
-			return FALSE;
-		}
-				
-		gst_buffer_unref (hls_player->remained);
-		hls_player->remained = NULL;
+		buffer = InBuf;
+		GST_BUFFER_DATA (buffer) -= prefix;
+		GST_BUFFER_SIZE (buffer) += prefix;
 	}
 	else
 	{
-		buffer = InBuf;
+		buffer = gst_buffer_new_and_alloc (prefix + GST_BUFFER_SIZE (InBuf));
+		memcpy (GST_BUFFER_DATA (buffer) + prefix, GST_BUFFER_DATA (InBuf), GST_BUFFER_SIZE (InBuf));
+		gst_buffer_unref (InBuf);
 	}
 
-	inbuf_size = GST_BUFFER_SIZE (buffer);
-	inbuf_data = GST_BUFFER_DATA (buffer);
-	
-	remain = inbuf_size % AES_BLOCK_SIZE;
-			
-	if (remain)
+	data = GST_BUFFER_DATA (buffer);
+	size = GST_BUFFER_SIZE (buffer);
+
+	/* [kept plain text][carried cipher text][cipher text of InBuf] */
+	memcpy (data, decrypt->last_block, held);
+	memcpy (data + held, decrypt->remained, decrypt->remained_len);
+
+	aligned = size - held - ((size - held) % AES_BLOCK_SIZE);
+
+	decrypt->remained_len = size - held - aligned;
+	memcpy (decrypt->remained, data + held + aligned, decrypt->remained_len);
+
+	if (0 == aligned)
 	{
-		hls_player->remained = gst_buffer_new_and_alloc (remain);
-		if (NULL == hls_player->remained)
-		{
-			g_print ("Error: failed to allocate memory...\n");
-			return FALSE;
-		}
-				
-		/* copy remained portion to buffer */
-		memcpy (GST_BUFFER_DATA(hls_player->remained), inbuf_data + inbuf_size- remain, remain);
+		/* kept block stays */
+		gst_buffer_unref (buffer);
+		return TRUE;
 	}
-			
-	out_len = inbuf_size - remain + AES_BLOCK_SIZE;
 
-	*OutBuf = gst_buffer_new_and_alloc (out_len);
-	if (NULL == *OutBuf)
+	if (!EVP_DecryptUpdate(&(decrypt->ctx), data + held, &out_len, data + held, aligned))
 	{
-		g_print ("Failed to allocate memory for OutBuf...\n");
+		debug_error ("failed to decrypt %d bytes\n", aligned);
+		gst_buffer_unref (buffer);
 		return FALSE;
 	}
-				
-	EVP_DecryptUpdate(&(hls_player->decrypt), GST_BUFFER_DATA(*OutBuf), &out_len, inbuf_data, inbuf_size - remain);
 
-	GST_BUFFER_SIZE (*OutBuf) = out_len;
+	memcpy (decrypt->last_block, data + held + aligned - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+	decrypt->has_last_block = TRUE;
+
+	size = held + aligned - AES_BLOCK_SIZE;
+	if (0 == size)
+	{
+		gst_buffer_unref (buffer);
+		return TRUE;
+	}
+
+	GST_BUFFER_SIZE (buffer) = size;
+	*OutBuf = buffer;
 
 	return TRUE;
+}
 
+/* gives the last block of a media fragment without padding. OutBuf is NULL if nothing is left */
+gboolean
+hls_decrypt_media_fragment_end (hls_decrypt_t *decrypt, GstBuffer **OutBuf)
+{
+	guint padding = 0;
+
+	*OutBuf = NULL;
+
+	if (decrypt->remained_len)
+	{
+		debug_warning ("%d bytes are dropped short of a block\n", decrypt->remained_len);
+		decrypt->remained_len = 0;
+	}
+
+	if (!decrypt->has_last_block)
+		return TRUE;
+
+	decrypt->has_last_block = FALSE;
+
+	padding = decrypt->last_block[AES_BLOCK_SIZE - 1];
+	if (padding < 1 || padding > AES_BLOCK_SIZE)
+	{
+		debug_warning ("wrong padding %d, last block is kept as it is\n", padding);
+		padding = 0;
+	}
+
+	if (AES_BLOCK_SIZE == padding)
+		return TRUE;
+
+	*OutBuf = gst_buffer_new_and_alloc (AES_BLOCK_SIZE - padding);
+	memcpy (GST_BUFFER_DATA (*OutBuf), decrypt->last_block, AES_BLOCK_SIZE - padding);
+
+	return TRUE;
 }
 
 void * __mm_player_hls_create ()
@@ -729,7 +677,6 @@ gboolean __mm_player_hls_initialize (void *hls_handle, gchar *uri)
 		return FALSE;
 	}
 	
-	hls_player->remained = NULL;
 	hls_player->allow_cache_fd = NULL;
 	
 	return TRUE;
@@ -222,6 +222,15 @@ __mmplayer_apply_attribute(MMHandleType handle, const char *attribute_name)
 			return MM_ERROR_PLAYER_INTERNAL;
 		}
 	}
+	else if ( g_strrstr(attribute_name, "sound_route") || g_strrstr(attribute_name, "sound_spk_out_only") )
+	{
+		/* audio sink is switched while playing */
+		if ( MM_ERROR_NONE != _mmplayer_update_audio_route( player ) )
+		{
+			debug_error("failed to update audio route\n");
+			return MM_ERROR_PLAYER_INTERNAL;
+		}
+	}
 
 	debug_fleave();
 
@@ -352,6 +361,33 @@ _mmplayer_construct_attribute(MMHandleType handle)
 			0,
 			0
 		},
+		{	/* number of segments downloaded at once by adaptive http streaming */
+			"streaming_prefetch_count",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) AHS_DEFAULT_PREFETCH_COUNT,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			1,
+			AHS_MAX_PREFETCH_COUNT
+		},
+		{	/* bytes of prefetched segments kept before being pushed */
+			"streaming_prefetch_buffer_size",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) AHS_DEFAULT_PREFETCH_BUFFER_SIZE,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			0,
+			MMPLAYER_MAX_INT
+		},
+		{	/* sec to keep AES-128 keys of HLS. 0 keeps them till stop */
+			"streaming_key_cache_ttl",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) 0,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			0,
+			MMPLAYER_MAX_INT
+		},
 		{
 			"subtitle_uri",
 			MM_ATTRS_TYPE_STRING,
@@ -772,6 +808,15 @@ _mmplayer_construct_attribute(MMHandleType handle)
 			FALSE,
 			TRUE
 		},
+		{
+			"sound_fade_time",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) 0,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			0,
+			MMPLAYER_MAX_INT
+		},
 		{
 			"sound_volume_type",
 			MM_ATTRS_TYPE_INT,
@@ -916,6 +961,33 @@ _mmplayer_construct_attribute(MMHandleType handle)
 			0,
 			MMPLAYER_MAX_INT
 		},
+		{
+			"capture_format",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) MM_PLAYER_COLORSPACE_RGB888,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			MM_PLAYER_COLORSPACE_I420,
+			MM_PLAYER_COLORSPACE_BGRA8888
+		},
+		{
+			"capture_width",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) 0,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			0,
+			MMPLAYER_MAX_INT
+		},
+		{
+			"capture_height",
+			MM_ATTRS_TYPE_INT,
+			MM_ATTRS_FLAG_RW,
+			(void *) 0,
+			MM_ATTRS_VALID_TYPE_INT_RANGE,
+			0,
+			MMPLAYER_MAX_INT
+		},
 		{
 			"pd_mode",
 			MM_ATTRS_TYPE_INT,
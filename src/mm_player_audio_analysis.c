@@ -0,0 +1,688 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <string.h>
+#include <math.h>
+
+#include <mm_debug.h>
+#include <mm_error.h>
+#include "mm_player_audio_analysis.h"
+#include "mm_player_utils.h"
+
+/* SSE2 only when the compiler targets it. i386 builds may not */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MMPLAYER_ANALYSIS_USE_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MMPLAYER_ANALYSIS_USE_NEON
+#endif
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_ANALYSIS_FFT_ORDER		10
+#define MMPLAYER_ANALYSIS_FFT_SIZE		(1 << MMPLAYER_ANALYSIS_FFT_ORDER)
+#define MMPLAYER_ANALYSIS_INTERVAL_MIN	10
+#define MMPLAYER_ANALYSIS_INTERVAL_MAX	10000
+#define MMPLAYER_ANALYSIS_FLOOR_DB		-100.0f
+#define MMPLAYER_ANALYSIS_LOWEST_FREQ	20.0
+
+/* lanes of 128bit vector of S16 samples */
+#define MMPLAYER_ANALYSIS_S16_LANES		8
+#define MMPLAYER_ANALYSIS_F32_LANES		4
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static gboolean __mmplayer_audio_analysis_probe(GstPad *pad, GstBuffer *buffer, gpointer u_data);
+static void __mmplayer_audio_analysis_reset(MMPlayerAudioAnalyzer *analyzer);
+static void __mmplayer_audio_analysis_update_bands(MMPlayerAudioAnalyzer *analyzer);
+static void __mmplayer_audio_analysis_publish(MMPlayerAudioAnalyzer *analyzer, GstClockTime timestamp);
+static void __mmplayer_audio_level_s16(const gint16 *src, guint frames, int channels, gdouble *sum, gfloat *peak);
+static void __mmplayer_audio_level_f32(const gfloat *src, guint frames, int channels, gdouble *sum, gfloat *peak);
+static void __mmplayer_audio_fft(MMPlayerAudioAnalyzer *analyzer);
+static gfloat __mmplayer_audio_to_db(gdouble power);
+static void __mmplayer_audio_analysis_free(MMPlayerAudioAnalyzer *analyzer);
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+int
+_mmplayer_set_audio_analysis(MMHandleType hplayer, int interval_msec, int bands)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerAudioAnalyzer *analyzer = NULL;
+	guint i = 0;
+
+	debug_fenter();
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(interval_msec == 0 ||
+		(interval_msec >= MMPLAYER_ANALYSIS_INTERVAL_MIN && interval_msec <= MMPLAYER_ANALYSIS_INTERVAL_MAX), MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(bands >= 0 && bands <= MM_PLAYER_AUDIO_ANALYSIS_BAND_MAX, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	if ( !player->audio_analyzer )
+	{
+		if ( !interval_msec )
+			return MM_ERROR_NONE;
+
+		/* NOTE : it's kept until player is destroyed, so probe never sees it freed */
+		analyzer = g_try_new0(MMPlayerAudioAnalyzer, 1);
+		if ( !analyzer )
+			return MM_ERROR_PLAYER_NO_FREE_SPACE;
+
+		analyzer->lock = g_mutex_new();
+		analyzer->history = g_try_new0(gfloat, MMPLAYER_ANALYSIS_FFT_SIZE);
+		analyzer->window = g_try_new0(gfloat, MMPLAYER_ANALYSIS_FFT_SIZE);
+		analyzer->re = g_try_new0(gfloat, MMPLAYER_ANALYSIS_FFT_SIZE);
+		analyzer->im = g_try_new0(gfloat, MMPLAYER_ANALYSIS_FFT_SIZE);
+		analyzer->twiddle = g_try_new0(gfloat, MMPLAYER_ANALYSIS_FFT_SIZE);
+
+		if ( !analyzer->lock || !analyzer->history || !analyzer->window ||
+			!analyzer->re || !analyzer->im || !analyzer->twiddle )
+		{
+			/* not attached yet and lock can be NULL. so, freed here without detach */
+			__mmplayer_audio_analysis_free(analyzer);
+			return MM_ERROR_PLAYER_NO_FREE_SPACE;
+		}
+
+		/* hann window and twiddles of cos in the first half, sin in the second half */
+		for ( i = 0; i < MMPLAYER_ANALYSIS_FFT_SIZE; i++ )
+			analyzer->window[i] = 0.5f - 0.5f * cosf(2.0f * G_PI * i / (MMPLAYER_ANALYSIS_FFT_SIZE - 1));
+
+		for ( i = 0; i < MMPLAYER_ANALYSIS_FFT_SIZE / 2; i++ )
+		{
+			analyzer->twiddle[i] = cosf(2.0f * G_PI * i / MMPLAYER_ANALYSIS_FFT_SIZE);
+			analyzer->twiddle[i + MMPLAYER_ANALYSIS_FFT_SIZE / 2] = -sinf(2.0f * G_PI * i / MMPLAYER_ANALYSIS_FFT_SIZE);
+		}
+
+		player->audio_analyzer = analyzer;
+	}
+
+	analyzer = player->audio_analyzer;
+
+	g_mutex_lock(analyzer->lock);
+
+	analyzer->interval = interval_msec;
+	analyzer->bands = bands;
+	__mmplayer_audio_analysis_reset(analyzer);
+
+	g_mutex_unlock(analyzer->lock);
+
+	debug_log("audio analysis : interval %d msec, %d bands\n", interval_msec, bands);
+
+	if ( interval_msec )
+		_mmplayer_attach_audio_analyzer(player);
+	else
+		_mmplayer_detach_audio_analyzer(player);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_get_audio_analysis(MMHandleType hplayer, MMPlayerAudioAnalysis *result)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(result, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	if ( !player->audio_analyzer )
+	{
+		debug_warning("audio analysis is not enabled\n");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	g_mutex_lock(player->audio_analyzer->lock);
+	*result = player->audio_analyzer->result;
+	g_mutex_unlock(player->audio_analyzer->lock);
+
+	return MM_ERROR_NONE;
+}
+
+void
+_mmplayer_attach_audio_analyzer(mm_player_t* player)
+{
+	MMPlayerAudioAnalyzer *analyzer = NULL;
+
+	return_if_fail(player);
+
+	analyzer = player->audio_analyzer;
+
+	if ( !analyzer || !player->pipeline || !player->pipeline->audiobin ||
+		!player->pipeline->audiobin[MMPLAYER_A_VOL].gst )
+		return;
+
+	g_mutex_lock(analyzer->lock);
+
+	if ( analyzer->interval && !analyzer->probe_id )
+	{
+		/* analyse what is heard, before sound effect changes it */
+		analyzer->pad = gst_element_get_static_pad(player->pipeline->audiobin[MMPLAYER_A_VOL].gst, "src");
+		if ( analyzer->pad )
+			analyzer->probe_id = gst_pad_add_buffer_probe(analyzer->pad,
+				G_CALLBACK(__mmplayer_audio_analysis_probe), analyzer);
+	}
+
+	g_mutex_unlock(analyzer->lock);
+}
+
+void
+_mmplayer_detach_audio_analyzer(mm_player_t* player)
+{
+	MMPlayerAudioAnalyzer *analyzer = NULL;
+
+	return_if_fail(player);
+
+	analyzer = player->audio_analyzer;
+	if ( !analyzer )
+		return;
+
+	g_mutex_lock(analyzer->lock);
+
+	if ( analyzer->pad )
+	{
+		if ( analyzer->probe_id )
+			gst_pad_remove_buffer_probe(analyzer->pad, analyzer->probe_id);
+
+		gst_object_unref(analyzer->pad);
+	}
+
+	analyzer->pad = NULL;
+	analyzer->probe_id = 0;
+
+	g_mutex_unlock(analyzer->lock);
+}
+
+void
+_mmplayer_release_audio_analyzer(mm_player_t* player)
+{
+	MMPlayerAudioAnalyzer *analyzer = NULL;
+
+	return_if_fail(player);
+
+	_mmplayer_detach_audio_analyzer(player);
+
+	analyzer = player->audio_analyzer;
+	player->audio_analyzer = NULL;
+
+	if ( !analyzer )
+		return;
+
+	__mmplayer_audio_analysis_free(analyzer);
+}
+
+static void
+__mmplayer_audio_analysis_free(MMPlayerAudioAnalyzer *analyzer)
+{
+	if ( analyzer->lock )
+		g_mutex_free(analyzer->lock);
+
+	MMPLAYER_FREEIF(analyzer->history);
+	MMPLAYER_FREEIF(analyzer->window);
+	MMPLAYER_FREEIF(analyzer->re);
+	MMPLAYER_FREEIF(analyzer->im);
+	MMPLAYER_FREEIF(analyzer->twiddle);
+
+	g_free(analyzer);
+}
+
+/**
+  * Accumulates levels of the buffer in place, and publishes result at every interval.
+  * Only the last samples of interval are mixed into history for spectrum.
+  */
+static gboolean
+__mmplayer_audio_analysis_probe(GstPad *pad, GstBuffer *buffer, gpointer u_data)
+{
+	MMPlayerAudioAnalyzer *analyzer = (MMPlayerAudioAnalyzer *) u_data;
+	GstStructure *str = NULL;
+	gboolean is_float = FALSE;
+	gint width = 0;
+	gint channels = 0;
+	gint rate = 0;
+	guint sample_size = 0;
+	guint frames = 0;
+	guint done = 0;
+	guint count = 0;
+	guint window_start = 0;
+	guint from = 0;
+	guint i = 0;
+	gint c = 0;
+	guint8 *data = NULL;
+
+	if ( !GST_BUFFER_CAPS(buffer) || !GST_BUFFER_SIZE(buffer) )
+		return TRUE;
+
+	str = gst_caps_get_structure(GST_BUFFER_CAPS(buffer), 0);
+	is_float = gst_structure_has_name(str, "audio/x-raw-float");
+	gst_structure_get_int(str, "width", &width);
+	gst_structure_get_int(str, "channels", &channels);
+	gst_structure_get_int(str, "rate", &rate);
+
+	if ( (is_float && width != 32) || (!is_float && width != 16) ||
+		channels <= 0 || channels > MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX || rate <= 0 )
+		return TRUE;
+
+	g_mutex_lock(analyzer->lock);
+
+	if ( !analyzer->interval )
+		goto DONE;
+
+	if ( channels != analyzer->channels || rate != analyzer->rate )
+	{
+		analyzer->channels = channels;
+		analyzer->rate = rate;
+		__mmplayer_audio_analysis_reset(analyzer);
+	}
+
+	sample_size = width / 8;
+	frames = GST_BUFFER_SIZE(buffer) / (sample_size * channels);
+	data = GST_BUFFER_DATA(buffer);
+
+	while ( done < frames )
+	{
+		count = MIN(frames - done, analyzer->interval_frames - analyzer->frames);
+
+		if ( is_float )
+			__mmplayer_audio_level_f32((const gfloat *)data + done * channels, count, channels, analyzer->sum, analyzer->peak);
+		else
+			__mmplayer_audio_level_s16((const gint16 *)data + done * channels, count, channels, analyzer->sum, analyzer->peak);
+
+		/* mono mix of samples in the last fft window of interval */
+		if ( analyzer->bands )
+		{
+			window_start = (analyzer->interval_frames > MMPLAYER_ANALYSIS_FFT_SIZE) ?
+				analyzer->interval_frames - MMPLAYER_ANALYSIS_FFT_SIZE : 0;
+			from = (window_start > analyzer->frames) ? MIN(window_start - analyzer->frames, count) : 0;
+
+			for ( i = from; i < count; i++ )
+			{
+				gfloat mix = 0.0f;
+
+				for ( c = 0; c < channels; c++ )
+				{
+					if ( is_float )
+						mix += ((const gfloat *)data)[(done + i) * channels + c];
+					else
+						mix += ((const gint16 *)data)[(done + i) * channels + c] / 32768.0f;
+				}
+
+				analyzer->history[analyzer->history_pos] = mix / channels;
+				analyzer->history_pos = (analyzer->history_pos + 1) & (MMPLAYER_ANALYSIS_FFT_SIZE - 1);
+			}
+		}
+
+		analyzer->frames += count;
+		done += count;
+
+		if ( analyzer->frames >= analyzer->interval_frames )
+		{
+			GstClockTime timestamp = GST_CLOCK_TIME_NONE;
+
+			if ( GST_BUFFER_TIMESTAMP_IS_VALID(buffer) )
+				timestamp = GST_BUFFER_TIMESTAMP(buffer) + gst_util_uint64_scale(done, GST_SECOND, rate);
+
+			__mmplayer_audio_analysis_publish(analyzer, timestamp);
+		}
+	}
+
+DONE:
+	g_mutex_unlock(analyzer->lock);
+
+	return TRUE;
+}
+
+static void
+__mmplayer_audio_analysis_reset(MMPlayerAudioAnalyzer *analyzer)
+{
+	int c = 0;
+
+	analyzer->frames = 0;
+	analyzer->history_pos = 0;
+	analyzer->interval_frames = MAX(1, (guint)gst_util_uint64_scale(analyzer->rate, analyzer->interval, 1000));
+
+	for ( c = 0; c < MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX; c++ )
+	{
+		analyzer->sum[c] = 0.0;
+		analyzer->peak[c] = 0.0f;
+	}
+
+	if ( analyzer->history )
+		memset(analyzer->history, 0x00, sizeof(gfloat) * MMPLAYER_ANALYSIS_FFT_SIZE);
+
+	__mmplayer_audio_analysis_update_bands(analyzer);
+}
+
+/**
+  * Splits fft bins into log spaced bands from 20Hz to nyquist.
+  * Each band has one bin at least.
+  */
+static void
+__mmplayer_audio_analysis_update_bands(MMPlayerAudioAnalyzer *analyzer)
+{
+	gdouble low = 0.0;
+	gdouble high = 0.0;
+	guint bins = MMPLAYER_ANALYSIS_FFT_SIZE / 2;
+	guint edge = 0;
+	int b = 0;
+
+	if ( !analyzer->bands || !analyzer->rate )
+		return;
+
+	low = MMPLAYER_ANALYSIS_LOWEST_FREQ * MMPLAYER_ANALYSIS_FFT_SIZE / analyzer->rate;
+	low = MAX(low, 1.0);
+	high = bins;
+
+	analyzer->band_edge[0] = (guint)low;
+
+	for ( b = 1; b <= analyzer->bands; b++ )
+	{
+		edge = (guint)(low * pow(high / low, (gdouble)b / analyzer->bands) + 0.5);
+		analyzer->band_edge[b] = CLAMP(edge, analyzer->band_edge[b - 1] + 1, bins);
+	}
+}
+
+static void
+__mmplayer_audio_analysis_publish(MMPlayerAudioAnalyzer *analyzer, GstClockTime timestamp)
+{
+	MMPlayerAudioAnalysis *result = &analyzer->result;
+	gdouble scale = 0.0;
+	gdouble power = 0.0;
+	guint k = 0;
+	int c = 0;
+	int b = 0;
+
+	result->channels = analyzer->channels;
+
+	for ( c = 0; c < analyzer->channels; c++ )
+	{
+		result->rms[c] = __mmplayer_audio_to_db(analyzer->sum[c] / analyzer->frames);
+		result->peak[c] = __mmplayer_audio_to_db((gdouble)analyzer->peak[c] * analyzer->peak[c]);
+
+		analyzer->sum[c] = 0.0;
+		analyzer->peak[c] = 0.0f;
+	}
+
+	result->bands = analyzer->bands;
+
+	if ( analyzer->bands )
+	{
+		__mmplayer_audio_fft(analyzer);
+
+		/* full scale sine makes 0dB. sum of hann window is N/2 */
+		scale = 4.0 / ((gdouble)MMPLAYER_ANALYSIS_FFT_SIZE * MMPLAYER_ANALYSIS_FFT_SIZE / 4.0);
+
+		for ( b = 0; b < analyzer->bands; b++ )
+		{
+			power = 0.0;
+
+			for ( k = analyzer->band_edge[b]; k < analyzer->band_edge[b + 1]; k++ )
+				power += (gdouble)analyzer->re[k] * analyzer->re[k] + (gdouble)analyzer->im[k] * analyzer->im[k];
+
+			/* energy of the band. hann window spreads a tone into 1.5 bins in average */
+			result->band[b] = __mmplayer_audio_to_db(power * scale / 1.5);
+		}
+	}
+
+	if ( GST_CLOCK_TIME_IS_VALID(timestamp) )
+		result->timestamp = (unsigned int)GST_TIME_AS_MSECONDS(timestamp);
+
+	result->sequence++;
+	if ( !result->sequence )
+		result->sequence = 1;
+
+	analyzer->frames = 0;
+}
+
+/**
+  * Sum of squares and peak of each channel. Sums are normalized to full scale.
+  * Interleaved channels map to fixed lanes if lanes are multiple of channels.
+  */
+static void
+__mmplayer_audio_level_s16(const gint16 *src, guint frames, int channels, gdouble *sum, gfloat *peak)
+{
+	guint count = frames * channels;
+	guint i = 0;
+	gint sample = 0;
+	gint max[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX] = {0, };
+	gdouble acc[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX] = {0, };
+	int c = 0;
+
+#if defined(MMPLAYER_ANALYSIS_USE_SSE2) || defined(MMPLAYER_ANALYSIS_USE_NEON)
+	if ( MMPLAYER_ANALYSIS_S16_LANES % channels == 0 )
+	{
+		gfloat lane_sum[MMPLAYER_ANALYSIS_S16_LANES];
+		gint16 lane_max[MMPLAYER_ANALYSIS_S16_LANES];
+		gint16 lane_min[MMPLAYER_ANALYSIS_S16_LANES];
+		int l = 0;
+#if defined(MMPLAYER_ANALYSIS_USE_SSE2)
+		__m128 sum_lo = _mm_setzero_ps();
+		__m128 sum_hi = _mm_setzero_ps();
+		__m128i vmax = _mm_setzero_si128();
+		__m128i vmin = _mm_setzero_si128();
+
+		for ( ; i + MMPLAYER_ANALYSIS_S16_LANES <= count; i += MMPLAYER_ANALYSIS_S16_LANES )
+		{
+			__m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i lo = _mm_mullo_epi16(x, x);
+			__m128i hi = _mm_mulhi_epi16(x, x);
+
+			sum_lo = _mm_add_ps(sum_lo, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, hi)));
+			sum_hi = _mm_add_ps(sum_hi, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, hi)));
+			vmax = _mm_max_epi16(vmax, x);
+			vmin = _mm_min_epi16(vmin, x);
+		}
+
+		_mm_storeu_ps(lane_sum, sum_lo);
+		_mm_storeu_ps(lane_sum + 4, sum_hi);
+		_mm_storeu_si128((__m128i *)lane_max, vmax);
+		_mm_storeu_si128((__m128i *)lane_min, vmin);
+#else
+		float32x4_t sum_lo = vdupq_n_f32(0.0f);
+		float32x4_t sum_hi = vdupq_n_f32(0.0f);
+		int16x8_t vmax = vdupq_n_s16(0);
+		int16x8_t vmin = vdupq_n_s16(0);
+
+		for ( ; i + MMPLAYER_ANALYSIS_S16_LANES <= count; i += MMPLAYER_ANALYSIS_S16_LANES )
+		{
+			int16x8_t x = vld1q_s16(src + i);
+
+			sum_lo = vaddq_f32(sum_lo, vcvtq_f32_s32(vmull_s16(vget_low_s16(x), vget_low_s16(x))));
+			sum_hi = vaddq_f32(sum_hi, vcvtq_f32_s32(vmull_s16(vget_high_s16(x), vget_high_s16(x))));
+			vmax = vmaxq_s16(vmax, x);
+			vmin = vminq_s16(vmin, x);
+		}
+
+		vst1q_f32(lane_sum, sum_lo);
+		vst1q_f32(lane_sum + 4, sum_hi);
+		vst1q_s16(lane_max, vmax);
+		vst1q_s16(lane_min, vmin);
+#endif
+		for ( l = 0; l < MMPLAYER_ANALYSIS_S16_LANES; l++ )
+		{
+			acc[l % channels] += lane_sum[l];
+			max[l % channels] = MAX(max[l % channels], MAX(lane_max[l], -lane_min[l]));
+		}
+	}
+#endif
+
+	/* the rest. i is always at frame boundary */
+	for ( ; i < count; i++ )
+	{
+		c = i % channels;
+		sample = src[i];
+		acc[c] += (gdouble)(sample * sample);
+		max[c] = MAX(max[c], ABS(sample));
+	}
+
+	for ( c = 0; c < channels; c++ )
+	{
+		sum[c] += acc[c] / (32768.0 * 32768.0);
+		peak[c] = MAX(peak[c], max[c] / 32768.0f);
+	}
+}
+
+static void
+__mmplayer_audio_level_f32(const gfloat *src, guint frames, int channels, gdouble *sum, gfloat *peak)
+{
+	guint count = frames * channels;
+	guint i = 0;
+	gfloat sample = 0.0f;
+	gfloat max[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX] = {0.0f, };
+	gdouble acc[MM_PLAYER_AUDIO_ANALYSIS_CHANNEL_MAX] = {0.0, };
+	int c = 0;
+
+#if defined(MMPLAYER_ANALYSIS_USE_SSE2) || defined(MMPLAYER_ANALYSIS_USE_NEON)
+	if ( MMPLAYER_ANALYSIS_F32_LANES % channels == 0 )
+	{
+		gfloat lane_sum[MMPLAYER_ANALYSIS_F32_LANES];
+		gfloat lane_max[MMPLAYER_ANALYSIS_F32_LANES];
+		int l = 0;
+#if defined(MMPLAYER_ANALYSIS_USE_SSE2)
+		const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		__m128 vsum = _mm_setzero_ps();
+		__m128 vmax = _mm_setzero_ps();
+
+		for ( ; i + MMPLAYER_ANALYSIS_F32_LANES <= count; i += MMPLAYER_ANALYSIS_F32_LANES )
+		{
+			__m128 x = _mm_loadu_ps(src + i);
+
+			vsum = _mm_add_ps(vsum, _mm_mul_ps(x, x));
+			vmax = _mm_max_ps(vmax, _mm_and_ps(x, abs_mask));
+		}
+
+		_mm_storeu_ps(lane_sum, vsum);
+		_mm_storeu_ps(lane_max, vmax);
+#else
+		float32x4_t vsum = vdupq_n_f32(0.0f);
+		float32x4_t vmax = vdupq_n_f32(0.0f);
+
+		for ( ; i + MMPLAYER_ANALYSIS_F32_LANES <= count; i += MMPLAYER_ANALYSIS_F32_LANES )
+		{
+			float32x4_t x = vld1q_f32(src + i);
+
+			vsum = vmlaq_f32(vsum, x, x);
+			vmax = vmaxq_f32(vmax, vabsq_f32(x));
+		}
+
+		vst1q_f32(lane_sum, vsum);
+		vst1q_f32(lane_max, vmax);
+#endif
+		for ( l = 0; l < MMPLAYER_ANALYSIS_F32_LANES; l++ )
+		{
+			acc[l % channels] += lane_sum[l];
+			max[l % channels] = MAX(max[l % channels], lane_max[l]);
+		}
+	}
+#endif
+
+	for ( ; i < count; i++ )
+	{
+		c = i % channels;
+		sample = src[i];
+		acc[c] += (gdouble)sample * sample;
+		max[c] = MAX(max[c], fabsf(sample));
+	}
+
+	for ( c = 0; c < channels; c++ )
+	{
+		sum[c] += acc[c];
+		peak[c] = MAX(peak[c], max[c]);
+	}
+}
+
+/**
+  * In-place radix-2 fft of windowed history. Result is in re and im.
+  */
+static void
+__mmplayer_audio_fft(MMPlayerAudioAnalyzer *analyzer)
+{
+	const guint n = MMPLAYER_ANALYSIS_FFT_SIZE;
+	gfloat *re = analyzer->re;
+	gfloat *im = analyzer->im;
+	const gfloat *cos_table = analyzer->twiddle;
+	const gfloat *sin_table = analyzer->twiddle + n / 2;
+	guint i = 0;
+	guint j = 0;
+	guint k = 0;
+	guint bit = 0;
+	guint len = 0;
+	guint step = 0;
+	gfloat tr = 0.0f;
+	gfloat ti = 0.0f;
+
+	/* the oldest sample of history is at history_pos. bit reversed order */
+	for ( i = 0; i < n; i++ )
+	{
+		for ( j = 0, bit = 0; bit < MMPLAYER_ANALYSIS_FFT_ORDER; bit++ )
+			j |= ((i >> bit) & 1) << (MMPLAYER_ANALYSIS_FFT_ORDER - 1 - bit);
+
+		re[j] = analyzer->history[(analyzer->history_pos + i) & (n - 1)] * analyzer->window[i];
+		im[j] = 0.0f;
+	}
+
+	for ( len = 2; len <= n; len <<= 1 )
+	{
+		step = n / len;
+
+		for ( i = 0; i < n; i += len )
+		{
+			for ( k = 0; k < len / 2; k++ )
+			{
+				gfloat wr = cos_table[k * step];
+				gfloat wi = sin_table[k * step];
+				guint a = i + k;
+				guint b = a + len / 2;
+
+				tr = re[b] * wr - im[b] * wi;
+				ti = re[b] * wi + im[b] * wr;
+
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+
+static gfloat
+__mmplayer_audio_to_db(gdouble power)
+{
+	gfloat db = MMPLAYER_ANALYSIS_FLOOR_DB;
+
+	if ( power > 0.0 )
+		db = (gfloat)(10.0 * log10(power));
+
+	return MAX(db, MMPLAYER_ANALYSIS_FLOOR_DB);
+}
@@ -0,0 +1,731 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <string.h>
+#include <math.h>
+#include <gst/gst.h>
+#include <gst/base/gstbasetransform.h>
+
+#include <mm_debug.h>
+#include "mm_player_audio_eq.h"
+#include "mm_player_audio_eq_dsp.h"
+#include "mm_player_ini.h"
+#include "mm_player_utils.h"
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_TYPE_AUDIO_EQ			(__mmplayer_audio_eq_get_type())
+#define MMPLAYER_AUDIO_EQ(obj)			(G_TYPE_CHECK_INSTANCE_CAST((obj), MMPLAYER_TYPE_AUDIO_EQ, MMPlayerAudioEq))
+
+#define MMPLAYER_AUDIO_EQ_CHANNEL_MAX		8
+
+/* band layout of custom EQ */
+#define MMPLAYER_AUDIO_EQ_LOWEST_FREQ		60.0
+#define MMPLAYER_AUDIO_EQ_HIGHEST_FREQ		16000.0
+
+/* band layout of presets, two octaves apart */
+#define MMPLAYER_AUDIO_EQ_PRESET_BANDS		5
+#define MMPLAYER_AUDIO_EQ_PRESET_Q		0.667
+
+/* shelves for bass and clarity extension filters */
+#define MMPLAYER_AUDIO_EQ_BASS_FREQ		100.0
+#define MMPLAYER_AUDIO_EQ_CLARITY_FREQ		6000.0
+#define MMPLAYER_AUDIO_EQ_EXT_MAX_DB		9.0
+
+/* level range used when ini doesn't have it */
+#define MMPLAYER_AUDIO_EQ_LEVEL_LIMIT		12
+
+/* gains move to new target over ramp time. coefficients are updated every block while ramping */
+#define MMPLAYER_AUDIO_EQ_RAMP_TIME_DEFAULT	30
+#define MMPLAYER_AUDIO_EQ_RAMP_TIME_MAX		1000
+#define MMPLAYER_AUDIO_EQ_RAMP_BLOCK		32
+
+enum {
+	PROP_0,
+	PROP_FILTER_ACTION,
+	PROP_FILTER_OUTPUT_MODE,
+	PROP_PRESET_MODE,
+	PROP_CUSTOM_EQ,
+	PROP_CUSTOM_EXT,
+	PROP_HOLD_UPDATE,
+	PROP_RAMP_TIME,
+};
+
+typedef struct {
+	GstBaseTransform element;
+
+	/* properties. protected by object lock */
+	gint action;
+	gint output_mode;
+	gint preset;
+	gint custom_eq[MM_AUDIO_FILTER_EQ_BAND_MAX];
+	gint custom_ext[MM_AUDIO_FILTER_CUSTOM_NUM-1];
+	gint ramp_time;
+	gboolean hold;		/* changes are staged until hold is released */
+	gboolean changed;
+
+	/* streaming thread only */
+	gint rate;
+	gint channels;
+	gint lanes;
+	gint run_action;
+	gboolean ramping;
+	MMPlayerAudioEqSection current[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	MMPlayerAudioEqSection target[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	gdouble step[MMPLAYER_AUDIO_EQ_STAGE_MAX];	/* dB per ramp block */
+	MMPlayerAudioEqCoef coef[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	gfloat *state;		/* z1 and z2 of each section, [stage][2][lanes] */
+} MMPlayerAudioEq;
+
+typedef struct {
+	GstBaseTransformClass parent_class;
+} MMPlayerAudioEqClass;
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS:											|
+---------------------------------------------------------------------------*/
+static GstStaticPadTemplate __mmplayer_audio_eq_sink_template = GST_STATIC_PAD_TEMPLATE("sink",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS("audio/x-raw-int, "
+		"endianness = (int) BYTE_ORDER, "
+		"signed = (boolean) true, "
+		"width = (int) 16, "
+		"depth = (int) 16, "
+		"rate = (int) [ 1, MAX ], "
+		"channels = (int) [ 1, 8 ]"));
+
+static GstStaticPadTemplate __mmplayer_audio_eq_src_template = GST_STATIC_PAD_TEMPLATE("src",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS("audio/x-raw-int, "
+		"endianness = (int) BYTE_ORDER, "
+		"signed = (boolean) true, "
+		"width = (int) 16, "
+		"depth = (int) 16, "
+		"rate = (int) [ 1, MAX ], "
+		"channels = (int) [ 1, 8 ]"));
+
+static const gdouble __mmplayer_audio_eq_preset_freq[MMPLAYER_AUDIO_EQ_PRESET_BANDS] =
+	{ 60.0, 230.0, 910.0, 3600.0, 14000.0 };
+
+/* gain(dB) of preset bands in order of preset-mode(MMAudioFilterPresetType - 1).
+ * spatial presets can't be made by equalizer, so only their tonal balance is kept.
+ */
+static const gint8 __mmplayer_audio_eq_preset_gain[MM_AUDIO_FILTER_PRESET_NUM-1][MMPLAYER_AUDIO_EQ_PRESET_BANDS] =
+{
+	{  0,  0,  0,  0,  0 },	/* normal */
+	{ -1,  2,  4,  2, -1 },	/* pop */
+	{  4,  2, -2,  2,  4 },	/* rock */
+	{  5,  2,  0,  2,  3 },	/* dance */
+	{  3,  1, -1,  2,  3 },	/* jazz */
+	{  4,  2, -1,  2,  3 },	/* classic */
+	{ -2,  0,  3,  3,  0 },	/* vocal */
+	{  6,  3,  0,  0,  0 },	/* bass boost */
+	{  0,  0,  0,  3,  6 },	/* treble boost */
+	{  3,  1,  0,  1,  2 },	/* mtheater */
+	{  0,  0,  0,  0,  0 },	/* externalization */
+	{  0,  0,  0,  0,  0 },	/* cafe */
+	{  0,  0,  0,  0,  0 },	/* concert hall */
+	{ -3,  0,  4,  2, -3 },	/* voice */
+	{  3,  1,  0,  1,  2 },	/* movie */
+	{  2,  0,  0,  1,  2 },	/* virtual 5.1 */
+};
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static void __mmplayer_audio_eq_set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec);
+static void __mmplayer_audio_eq_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+static gboolean __mmplayer_audio_eq_set_caps(GstBaseTransform *trans, GstCaps *incaps, GstCaps *outcaps);
+static gboolean __mmplayer_audio_eq_stop(GstBaseTransform *trans);
+static GstFlowReturn __mmplayer_audio_eq_transform_ip(GstBaseTransform *trans, GstBuffer *buffer);
+static void __mmplayer_audio_eq_retarget(MMPlayerAudioEq *eq);
+static void __mmplayer_audio_eq_set_target(MMPlayerAudioEq *eq, gint slot, MMPlayerAudioEqShape shape, gdouble freq, gdouble q, gdouble gain);
+static gboolean __mmplayer_audio_eq_advance(MMPlayerAudioEq *eq);
+static void __mmplayer_audio_eq_update_coef(MMPlayerAudioEq *eq, gint slot);
+static gint __mmplayer_audio_eq_clamp_level(gint level, gint range_index);
+
+GST_BOILERPLATE(MMPlayerAudioEq, __mmplayer_audio_eq, GstBaseTransform, GST_TYPE_BASE_TRANSFORM);
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+gboolean
+_mmplayer_audio_eq_register(void)
+{
+	debug_fenter();
+
+	if ( ! gst_element_register(NULL, MMPLAYER_AUDIO_EQ_FACTORY, GST_RANK_NONE, MMPLAYER_TYPE_AUDIO_EQ) )
+	{
+		debug_error("failed to register %s\n", MMPLAYER_AUDIO_EQ_FACTORY);
+		return FALSE;
+	}
+
+	debug_fleave();
+
+	return TRUE;
+}
+
+static void
+__mmplayer_audio_eq_base_init(gpointer klass)
+{
+	GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class,
+		gst_static_pad_template_get(&__mmplayer_audio_eq_sink_template));
+	gst_element_class_add_pad_template(element_class,
+		gst_static_pad_template_get(&__mmplayer_audio_eq_src_template));
+
+	gst_element_class_set_details_simple(element_class,
+		"Player equalizer",
+		"Filter/Effect/Audio",
+		"Biquad equalizer used when sound effect plugin is not available",
+		"Samsung Electronics Co., Ltd.");
+}
+
+static void
+__mmplayer_audio_eq_class_init(MMPlayerAudioEqClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+	GstBaseTransformClass *trans_class = GST_BASE_TRANSFORM_CLASS(klass);
+
+	gobject_class->set_property = __mmplayer_audio_eq_set_property;
+	gobject_class->get_property = __mmplayer_audio_eq_get_property;
+
+	/* same properties with soundalive */
+	g_object_class_install_property(gobject_class, PROP_FILTER_ACTION,
+		g_param_spec_int("filter-action", "Filter action", "Type of filter to apply(0:none, 1:preset, 2:custom)",
+			MM_AUDIO_FILTER_TYPE_NONE, MM_AUDIO_FILTER_TYPE_CUSTOM, MM_AUDIO_FILTER_TYPE_NONE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property(gobject_class, PROP_FILTER_OUTPUT_MODE,
+		g_param_spec_int("filter-output-mode", "Filter output mode", "Output device(0:speaker, 1:earphone)",
+			MM_AUDIO_FILTER_OUTPUT_SPK, MM_AUDIO_FILTER_OUTPUT_EAR, MM_AUDIO_FILTER_OUTPUT_SPK,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property(gobject_class, PROP_PRESET_MODE,
+		g_param_spec_int("preset-mode", "Preset mode", "Preset type without auto",
+			0, MM_AUDIO_FILTER_PRESET_NUM - 2, 0,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property(gobject_class, PROP_CUSTOM_EQ,
+		g_param_spec_pointer("custom-eq", "Custom EQ", "Level list of EQ bands",
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property(gobject_class, PROP_CUSTOM_EXT,
+		g_param_spec_pointer("custom-ext", "Custom extension", "Level list of extension filters enabled by ini",
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/* not in soundalive */
+	g_object_class_install_property(gobject_class, PROP_HOLD_UPDATE,
+		g_param_spec_boolean("hold-update", "Hold update", "Stage property changes and apply them at once when released",
+			FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property(gobject_class, PROP_RAMP_TIME,
+		g_param_spec_int("ramp-time", "Ramp time", "Time in msec to move to new filter settings",
+			0, MMPLAYER_AUDIO_EQ_RAMP_TIME_MAX, MMPLAYER_AUDIO_EQ_RAMP_TIME_DEFAULT,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	trans_class->set_caps = GST_DEBUG_FUNCPTR(__mmplayer_audio_eq_set_caps);
+	trans_class->stop = GST_DEBUG_FUNCPTR(__mmplayer_audio_eq_stop);
+	trans_class->transform_ip = GST_DEBUG_FUNCPTR(__mmplayer_audio_eq_transform_ip);
+}
+
+static void
+__mmplayer_audio_eq_init(MMPlayerAudioEq *eq, MMPlayerAudioEqClass *klass)
+{
+	eq->action = MM_AUDIO_FILTER_TYPE_NONE;
+	eq->output_mode = MM_AUDIO_FILTER_OUTPUT_SPK;
+	eq->ramp_time = MMPLAYER_AUDIO_EQ_RAMP_TIME_DEFAULT;
+	eq->run_action = MM_AUDIO_FILTER_TYPE_NONE;
+	eq->changed = TRUE;
+
+	gst_base_transform_set_in_place(GST_BASE_TRANSFORM(eq), TRUE);
+	gst_base_transform_set_passthrough(GST_BASE_TRANSFORM(eq), TRUE);
+}
+
+static void
+__mmplayer_audio_eq_set_property(GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec)
+{
+	MMPlayerAudioEq *eq = MMPLAYER_AUDIO_EQ(object);
+	const gint *list = NULL;
+	gboolean changed = TRUE;
+	gint count = 0;
+	gint index = 0;
+
+	GST_OBJECT_LOCK(eq);
+
+	switch (prop_id)
+	{
+		case PROP_FILTER_ACTION:
+			eq->action = g_value_get_int(value);
+			break;
+
+		case PROP_FILTER_OUTPUT_MODE:
+			/* response of equalizer doesn't depend on output device */
+			eq->output_mode = g_value_get_int(value);
+			break;
+
+		case PROP_PRESET_MODE:
+			eq->preset = g_value_get_int(value);
+			break;
+
+		case PROP_CUSTOM_EQ:
+			list = g_value_get_pointer(value);
+			if (list)
+			{
+				memcpy(eq->custom_eq, list,
+					sizeof(gint) * MIN(PLAYER_INI()->audio_filter_custom_eq_num, MM_AUDIO_FILTER_EQ_BAND_MAX));
+			}
+			break;
+
+		case PROP_CUSTOM_EXT:
+			/* list has levels of filters enabled by ini only. see __mmplayer_set_harmony_filter() */
+			list = g_value_get_pointer(value);
+			for (count = 1; list && count < MM_AUDIO_FILTER_CUSTOM_NUM; count++)
+			{
+				if (index == PLAYER_INI()->audio_filter_custom_ext_num)
+					break;
+
+				if (PLAYER_INI()->audio_filter_custom_list[count])
+					eq->custom_ext[count-1] = list[index++];
+			}
+			break;
+
+		case PROP_HOLD_UPDATE:
+			eq->hold = g_value_get_boolean(value);
+			break;
+
+		case PROP_RAMP_TIME:
+			eq->ramp_time = g_value_get_int(value);
+			changed = FALSE;
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			changed = FALSE;
+			break;
+	}
+
+	/* streaming thread picks up all staged changes together */
+	if (changed && !eq->hold)
+		eq->changed = TRUE;
+
+	GST_OBJECT_UNLOCK(eq);
+}
+
+static void
+__mmplayer_audio_eq_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	MMPlayerAudioEq *eq = MMPLAYER_AUDIO_EQ(object);
+
+	GST_OBJECT_LOCK(eq);
+
+	switch (prop_id)
+	{
+		case PROP_FILTER_ACTION:
+			g_value_set_int(value, eq->action);
+			break;
+
+		case PROP_FILTER_OUTPUT_MODE:
+			g_value_set_int(value, eq->output_mode);
+			break;
+
+		case PROP_PRESET_MODE:
+			g_value_set_int(value, eq->preset);
+			break;
+
+		case PROP_CUSTOM_EQ:
+			g_value_set_pointer(value, eq->custom_eq);
+			break;
+
+		case PROP_CUSTOM_EXT:
+			g_value_set_pointer(value, eq->custom_ext);
+			break;
+
+		case PROP_HOLD_UPDATE:
+			g_value_set_boolean(value, eq->hold);
+			break;
+
+		case PROP_RAMP_TIME:
+			g_value_set_int(value, eq->ramp_time);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+
+	GST_OBJECT_UNLOCK(eq);
+}
+
+static gboolean
+__mmplayer_audio_eq_set_caps(GstBaseTransform *trans, GstCaps *incaps, GstCaps *outcaps)
+{
+	MMPlayerAudioEq *eq = MMPLAYER_AUDIO_EQ(trans);
+	GstStructure *str = NULL;
+	gint rate = 0;
+	gint channels = 0;
+	gint slot = 0;
+
+	str = gst_caps_get_structure(incaps, 0);
+	if ( ! gst_structure_get_int(str, "rate", &rate) ||
+		! gst_structure_get_int(str, "channels", &channels) ||
+		rate <= 0 || channels <= 0 || channels > MMPLAYER_AUDIO_EQ_CHANNEL_MAX )
+	{
+		debug_error("invalid caps for equalizer\n");
+		return FALSE;
+	}
+
+	MMPLAYER_FREEIF(eq->state);
+
+	eq->rate = rate;
+	eq->channels = channels;
+	eq->lanes = (channels + MMPLAYER_AUDIO_EQ_LANES - 1) & ~(MMPLAYER_AUDIO_EQ_LANES - 1);
+	eq->state = g_malloc0(sizeof(gfloat) * MMPLAYER_AUDIO_EQ_STAGE_MAX * 2 * eq->lanes);
+
+	/* sections should be designed again for new rate */
+	for (slot = 0; slot < MMPLAYER_AUDIO_EQ_STAGE_MAX; slot++)
+	{
+		eq->coef[slot].active = FALSE;
+		__mmplayer_audio_eq_update_coef(eq, slot);
+	}
+
+	debug_log("equalizer configured. rate(%d), channels(%d)\n", rate, channels);
+
+	return TRUE;
+}
+
+static gboolean
+__mmplayer_audio_eq_stop(GstBaseTransform *trans)
+{
+	MMPlayerAudioEq *eq = MMPLAYER_AUDIO_EQ(trans);
+
+	MMPLAYER_FREEIF(eq->state);
+	eq->rate = 0;
+	eq->channels = 0;
+	eq->lanes = 0;
+
+	return TRUE;
+}
+
+static GstFlowReturn
+__mmplayer_audio_eq_transform_ip(GstBaseTransform *trans, GstBuffer *buffer)
+{
+	MMPlayerAudioEq *eq = MMPLAYER_AUDIO_EQ(trans);
+	gint16 *data = NULL;
+	guint frames = 0;
+	guint block = 0;
+	gint slot = 0;
+	gboolean idle = FALSE;
+
+	if ( ! eq->state )
+		return GST_FLOW_OK;
+
+	__mmplayer_audio_eq_retarget(eq);
+
+	/* filter is off and all sections are flat */
+	if ( eq->run_action == MM_AUDIO_FILTER_TYPE_NONE && ! eq->ramping )
+	{
+		for (slot = 0; slot < MMPLAYER_AUDIO_EQ_STAGE_MAX; slot++)
+		{
+			if (eq->coef[slot].active)
+				break;
+		}
+		idle = (slot == MMPLAYER_AUDIO_EQ_STAGE_MAX);
+	}
+
+	/* passthrough is switched only here to avoid racing with property changes.
+	 * buffer is not writable in passthrough, so processing starts from next buffer.
+	 * it is safe because sections always start ramping from flat.
+	 */
+	if ( gst_base_transform_is_passthrough(trans) )
+	{
+		if ( ! idle )
+			gst_base_transform_set_passthrough(trans, FALSE);
+		return GST_FLOW_OK;
+	}
+
+	if ( idle )
+	{
+		gst_base_transform_set_passthrough(trans, TRUE);
+		return GST_FLOW_OK;
+	}
+
+	data = (gint16*)GST_BUFFER_DATA(buffer);
+	frames = GST_BUFFER_SIZE(buffer) / (sizeof(gint16) * eq->channels);
+
+	while ( frames )
+	{
+		block = frames;
+
+		/* coefficients move a little every block until they reach target */
+		if ( eq->ramping )
+		{
+			eq->ramping = __mmplayer_audio_eq_advance(eq);
+			block = MIN(frames, MMPLAYER_AUDIO_EQ_RAMP_BLOCK);
+		}
+
+		_mmplayer_audio_eq_run(eq->coef, eq->state, eq->channels, eq->lanes, data, block);
+
+		data += block * eq->channels;
+		frames -= block;
+	}
+
+	return GST_FLOW_OK;
+}
+
+/* take new targets if any property is changed since last buffer. sections ramp from where they are */
+static void
+__mmplayer_audio_eq_retarget(MMPlayerAudioEq *eq)
+{
+	gint custom_eq[MM_AUDIO_FILTER_EQ_BAND_MAX] = {0, };
+	gint custom_ext[MM_AUDIO_FILTER_CUSTOM_NUM-1] = {0, };
+	gint eq_num = MIN(PLAYER_INI()->audio_filter_custom_eq_num, MM_AUDIO_FILTER_EQ_BAND_MAX);
+	gint action = 0;
+	gint preset = 0;
+	gint ramp_time = 0;
+	gint count = 0;
+	gint ext_index = 1;	/* index of level range. 0 is for EQ */
+	gint max = 0;
+	gint blocks = 0;
+	gdouble ratio = 0.0;
+	gdouble q = 0.0;
+	gdouble distance = 0.0;
+	MMPlayerAudioEqSection *cur = NULL;
+	MMPlayerAudioEqSection *tgt = NULL;
+
+	GST_OBJECT_LOCK(eq);
+	if ( ! eq->changed )
+	{
+		GST_OBJECT_UNLOCK(eq);
+		return;
+	}
+	action = eq->action;
+	preset = eq->preset;
+	ramp_time = eq->ramp_time;
+	memcpy(custom_eq, eq->custom_eq, sizeof(custom_eq));
+	memcpy(custom_ext, eq->custom_ext, sizeof(custom_ext));
+	eq->changed = FALSE;
+	GST_OBJECT_UNLOCK(eq);
+
+	/* unused sections keep their shape and go flat */
+	for (count = 0; count < MMPLAYER_AUDIO_EQ_STAGE_MAX; count++)
+	{
+		eq->target[count] = eq->current[count];
+		eq->target[count].gain = 0.0;
+	}
+
+	if (action == MM_AUDIO_FILTER_TYPE_PRESET)
+	{
+		for (count = 0; count < MMPLAYER_AUDIO_EQ_PRESET_BANDS; count++)
+		{
+			__mmplayer_audio_eq_set_target(eq, count, MMPLAYER_AUDIO_EQ_PEAKING,
+				__mmplayer_audio_eq_preset_freq[count], MMPLAYER_AUDIO_EQ_PRESET_Q,
+				__mmplayer_audio_eq_preset_gain[preset][count]);
+		}
+	}
+	else if (action == MM_AUDIO_FILTER_TYPE_CUSTOM)
+	{
+		/* EQ bands are spread in log scale. Q is given by distance of bands */
+		if (eq_num > 1)
+		{
+			ratio = pow(MMPLAYER_AUDIO_EQ_HIGHEST_FREQ / MMPLAYER_AUDIO_EQ_LOWEST_FREQ, 1.0 / (eq_num - 1));
+			q = sqrt(ratio) / (ratio - 1.0);
+		}
+
+		for (count = 0; count < eq_num; count++)
+		{
+			if (eq_num > 1)
+			{
+				__mmplayer_audio_eq_set_target(eq, count, MMPLAYER_AUDIO_EQ_PEAKING,
+					MMPLAYER_AUDIO_EQ_LOWEST_FREQ * pow(ratio, count), q,
+					__mmplayer_audio_eq_clamp_level(custom_eq[count], MM_AUDIO_FILTER_CUSTOM_EQ));
+			}
+			else
+			{
+				__mmplayer_audio_eq_set_target(eq, count, MMPLAYER_AUDIO_EQ_PEAKING,
+					1000.0, M_SQRT1_2, __mmplayer_audio_eq_clamp_level(custom_eq[count], MM_AUDIO_FILTER_CUSTOM_EQ));
+			}
+		}
+
+		/* extension filters. only bass and clarity can be made by shelving filter */
+		for (count = 1; count < MM_AUDIO_FILTER_CUSTOM_NUM; count++)
+		{
+			if ( ! PLAYER_INI()->audio_filter_custom_list[count] )
+				continue;
+
+			max = PLAYER_INI()->audio_filter_custom_max_level_list[ext_index];
+
+			if (count == MM_AUDIO_FILTER_CUSTOM_BASS && max > 0)
+			{
+				__mmplayer_audio_eq_set_target(eq, MMPLAYER_AUDIO_EQ_SLOT_BASS, MMPLAYER_AUDIO_EQ_LOW_SHELF,
+					MMPLAYER_AUDIO_EQ_BASS_FREQ, M_SQRT1_2,
+					MMPLAYER_AUDIO_EQ_EXT_MAX_DB * __mmplayer_audio_eq_clamp_level(custom_ext[count-1], ext_index) / max);
+			}
+			else if (count == MM_AUDIO_FILTER_CUSTOM_CLARITY && max > 0)
+			{
+				__mmplayer_audio_eq_set_target(eq, MMPLAYER_AUDIO_EQ_SLOT_CLARITY, MMPLAYER_AUDIO_EQ_HIGH_SHELF,
+					MMPLAYER_AUDIO_EQ_CLARITY_FREQ, M_SQRT1_2,
+					MMPLAYER_AUDIO_EQ_EXT_MAX_DB * __mmplayer_audio_eq_clamp_level(custom_ext[count-1], ext_index) / max);
+			}
+			else if (custom_ext[count-1])
+			{
+				debug_warning("custom filter(%d) is not supported by built-in equalizer\n", count);
+			}
+
+			ext_index++;
+		}
+	}
+
+	/* all sections reach their target at the same time. a section changing its shape
+	 * goes flat first, and then to the new gain with new shape.
+	 */
+	blocks = MAX(1, eq->rate * ramp_time / 1000 / MMPLAYER_AUDIO_EQ_RAMP_BLOCK);
+
+	for (count = 0; count < MMPLAYER_AUDIO_EQ_STAGE_MAX; count++)
+	{
+		cur = &eq->current[count];
+		tgt = &eq->target[count];
+
+		if (cur->shape == tgt->shape && cur->freq == tgt->freq && cur->q == tgt->q)
+			distance = fabs(tgt->gain - cur->gain);
+		else
+			distance = fabs(cur->gain) + fabs(tgt->gain);
+
+		eq->step[count] = distance / blocks;
+	}
+
+	eq->run_action = action;
+	eq->ramping = TRUE;
+
+	debug_log("equalizer retargeted. action(%d), preset(%d), ramp(%d msec)\n", action, preset, ramp_time);
+}
+
+static void
+__mmplayer_audio_eq_set_target(MMPlayerAudioEq *eq, gint slot, MMPlayerAudioEqShape shape, gdouble freq, gdouble q, gdouble gain)
+{
+	MMPlayerAudioEqSection *tgt = &eq->target[slot];
+
+	tgt->shape = shape;
+	tgt->freq = freq;
+	tgt->q = q;
+	tgt->gain = gain;
+}
+
+/* move gains of sections by a step. returns TRUE if any section has not reached target */
+static gboolean
+__mmplayer_audio_eq_advance(MMPlayerAudioEq *eq)
+{
+	MMPlayerAudioEqSection *cur = NULL;
+	MMPlayerAudioEqSection *tgt = NULL;
+	gboolean ramping = FALSE;
+	gboolean same = FALSE;
+	gdouble goal = 0.0;
+	gint slot = 0;
+
+	for (slot = 0; slot < MMPLAYER_AUDIO_EQ_STAGE_MAX; slot++)
+	{
+		cur = &eq->current[slot];
+		tgt = &eq->target[slot];
+		same = (cur->shape == tgt->shape && cur->freq == tgt->freq && cur->q == tgt->q);
+
+		if (same && cur->gain == tgt->gain)
+			continue;
+
+		/* flat section can change its shape without click */
+		if ( ! same && cur->gain == 0.0 )
+		{
+			cur->shape = tgt->shape;
+			cur->freq = tgt->freq;
+			cur->q = tgt->q;
+			same = TRUE;
+		}
+
+		goal = same ? tgt->gain : 0.0;
+
+		if (fabs(goal - cur->gain) <= eq->step[slot])
+			cur->gain = goal;
+		else
+			cur->gain += (goal > cur->gain) ? eq->step[slot] : -eq->step[slot];
+
+		__mmplayer_audio_eq_update_coef(eq, slot);
+
+		if ( ! same || cur->gain != tgt->gain )
+			ramping = TRUE;
+	}
+
+	return ramping;
+}
+
+static void
+__mmplayer_audio_eq_update_coef(MMPlayerAudioEq *eq, gint slot)
+{
+	MMPlayerAudioEqCoef *coef = &eq->coef[slot];
+	MMPlayerAudioEqCoef design = {0, };
+	gfloat *state = NULL;
+	gint lane = 0;
+
+	if ( ! _mmplayer_audio_eq_design(&eq->current[slot], eq->rate, &design) )
+	{
+		coef->active = FALSE;
+		return;
+	}
+
+	/* section which was not running has old state */
+	if ( ! coef->active )
+	{
+		state = eq->state + slot * 2 * eq->lanes;
+		for (lane = 0; lane < 2 * eq->lanes; lane++)
+			state[lane] = 0.0f;
+	}
+
+	*coef = design;
+	coef->active = TRUE;
+}
+
+static gint
+__mmplayer_audio_eq_clamp_level(gint level, gint range_index)
+{
+	gint min = PLAYER_INI()->audio_filter_custom_min_level_list[range_index];
+	gint max = PLAYER_INI()->audio_filter_custom_max_level_list[range_index];
+
+	/* ini has no range when extension filter is not configured */
+	if (min >= max)
+	{
+		min = -MMPLAYER_AUDIO_EQ_LEVEL_LIMIT;
+		max = MMPLAYER_AUDIO_EQ_LEVEL_LIMIT;
+	}
+
+	return CLAMP(level, min, max);
+}
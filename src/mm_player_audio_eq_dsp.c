@@ -0,0 +1,387 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <math.h>
+
+#include "mm_player_audio_eq_dsp.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MMPLAYER_AUDIO_EQ_USE_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MMPLAYER_AUDIO_EQ_USE_NEON
+#endif
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+/* sections over this ratio of sampling rate are not applied */
+#define MMPLAYER_AUDIO_EQ_NYQUIST_MARGIN	0.45
+
+/* filter states smaller than this are flushed to zero to avoid denormals */
+#define MMPLAYER_AUDIO_EQ_DENORMAL		1.0e-15f
+
+/* runs active stages over a group of up to MMPLAYER_AUDIO_EQ_LANES channels */
+typedef void (*MMPlayerAudioEqGroupFunc)(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames);
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static void __mmplayer_audio_eq_group_c(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames);
+#ifdef MMPLAYER_AUDIO_EQ_USE_SSE2
+static void __mmplayer_audio_eq_group_sse2(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames);
+#endif
+#ifdef MMPLAYER_AUDIO_EQ_USE_NEON
+static void __mmplayer_audio_eq_group_neon(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames);
+#endif
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS:											|
+---------------------------------------------------------------------------*/
+#if defined(MMPLAYER_AUDIO_EQ_USE_SSE2)
+static MMPlayerAudioEqKernel __mmplayer_audio_eq_kernel = MM_PLAYER_AUDIO_EQ_KERNEL_SSE2;
+static MMPlayerAudioEqGroupFunc __mmplayer_audio_eq_group = __mmplayer_audio_eq_group_sse2;
+#elif defined(MMPLAYER_AUDIO_EQ_USE_NEON)
+static MMPlayerAudioEqKernel __mmplayer_audio_eq_kernel = MM_PLAYER_AUDIO_EQ_KERNEL_NEON;
+static MMPlayerAudioEqGroupFunc __mmplayer_audio_eq_group = __mmplayer_audio_eq_group_neon;
+#else
+static MMPlayerAudioEqKernel __mmplayer_audio_eq_kernel = MM_PLAYER_AUDIO_EQ_KERNEL_C;
+static MMPlayerAudioEqGroupFunc __mmplayer_audio_eq_group = __mmplayer_audio_eq_group_c;
+#endif
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+/* coefficients from "Cookbook formulae for audio EQ biquad filter" by R. Bristow-Johnson */
+gboolean
+_mmplayer_audio_eq_design(const MMPlayerAudioEqSection *section, gint rate, MMPlayerAudioEqCoef *coef)
+{
+	gdouble a = 0.0;
+	gdouble w0 = 0.0;
+	gdouble cs = 0.0;
+	gdouble alpha = 0.0;
+	gdouble sq = 0.0;
+	gdouble b0 = 0.0, b1 = 0.0, b2 = 0.0;
+	gdouble a0 = 0.0, a1 = 0.0, a2 = 0.0;
+
+	/* flat section is skipped */
+	if (section->gain == 0.0 || section->freq >= rate * MMPLAYER_AUDIO_EQ_NYQUIST_MARGIN)
+		return FALSE;
+
+	a = pow(10.0, section->gain / 40.0);
+	w0 = 2.0 * M_PI * section->freq / rate;
+	cs = cos(w0);
+	alpha = sin(w0) / (2.0 * section->q);
+	sq = 2.0 * sqrt(a) * alpha;
+
+	switch (section->shape)
+	{
+		case MMPLAYER_AUDIO_EQ_PEAKING:
+			b0 = 1.0 + alpha * a;
+			b1 = -2.0 * cs;
+			b2 = 1.0 - alpha * a;
+			a0 = 1.0 + alpha / a;
+			a1 = -2.0 * cs;
+			a2 = 1.0 - alpha / a;
+			break;
+
+		case MMPLAYER_AUDIO_EQ_LOW_SHELF:
+			b0 = a * ((a + 1.0) - (a - 1.0) * cs + sq);
+			b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cs);
+			b2 = a * ((a + 1.0) - (a - 1.0) * cs - sq);
+			a0 = (a + 1.0) + (a - 1.0) * cs + sq;
+			a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cs);
+			a2 = (a + 1.0) + (a - 1.0) * cs - sq;
+			break;
+
+		case MMPLAYER_AUDIO_EQ_HIGH_SHELF:
+			b0 = a * ((a + 1.0) + (a - 1.0) * cs + sq);
+			b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cs);
+			b2 = a * ((a + 1.0) + (a - 1.0) * cs - sq);
+			a0 = (a + 1.0) - (a - 1.0) * cs + sq;
+			a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cs);
+			a2 = (a + 1.0) - (a - 1.0) * cs - sq;
+			break;
+	}
+
+	coef->b0 = b0 / a0;
+	coef->b1 = b1 / a0;
+	coef->b2 = b2 / a0;
+	coef->a1 = a1 / a0;
+	coef->a2 = a2 / a0;
+
+	return TRUE;
+}
+
+/* transposed direct form II cascade */
+void
+_mmplayer_audio_eq_run(const MMPlayerAudioEqCoef *coef, gfloat *state, gint channels, gint lanes,
+		gint16 *data, guint frames)
+{
+	gint stage[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	gint stages = 0;
+	gint group = 0;
+	gint count = 0;
+	gint s = 0;
+
+	for (s = 0; s < MMPLAYER_AUDIO_EQ_STAGE_MAX; s++)
+	{
+		if (coef[s].active)
+			stage[stages++] = s;
+	}
+
+	if ( ! stages )
+		return;
+
+	for (group = 0; group < channels; group += MMPLAYER_AUDIO_EQ_LANES)
+		__mmplayer_audio_eq_group(coef, state, stage, stages, channels, lanes, group, data, frames);
+
+	/* decaying states after silence would become denormal */
+	for (s = 0; s < stages; s++)
+	{
+		gfloat *z = state + stage[s] * 2 * lanes;
+
+		for (count = 0; count < 2 * lanes; count++)
+		{
+			if (fabsf(z[count]) < MMPLAYER_AUDIO_EQ_DENORMAL)
+				z[count] = 0.0f;
+		}
+	}
+}
+
+gboolean
+_mmplayer_audio_eq_set_kernel(MMPlayerAudioEqKernel kernel)
+{
+	switch (kernel)
+	{
+		case MM_PLAYER_AUDIO_EQ_KERNEL_AUTO:
+#if defined(MMPLAYER_AUDIO_EQ_USE_SSE2)
+			return _mmplayer_audio_eq_set_kernel(MM_PLAYER_AUDIO_EQ_KERNEL_SSE2);
+#elif defined(MMPLAYER_AUDIO_EQ_USE_NEON)
+			return _mmplayer_audio_eq_set_kernel(MM_PLAYER_AUDIO_EQ_KERNEL_NEON);
+#else
+			return _mmplayer_audio_eq_set_kernel(MM_PLAYER_AUDIO_EQ_KERNEL_C);
+#endif
+
+		case MM_PLAYER_AUDIO_EQ_KERNEL_C:
+			__mmplayer_audio_eq_group = __mmplayer_audio_eq_group_c;
+			break;
+
+#ifdef MMPLAYER_AUDIO_EQ_USE_SSE2
+		case MM_PLAYER_AUDIO_EQ_KERNEL_SSE2:
+			__mmplayer_audio_eq_group = __mmplayer_audio_eq_group_sse2;
+			break;
+#endif
+
+#ifdef MMPLAYER_AUDIO_EQ_USE_NEON
+		case MM_PLAYER_AUDIO_EQ_KERNEL_NEON:
+			__mmplayer_audio_eq_group = __mmplayer_audio_eq_group_neon;
+			break;
+#endif
+
+		default:
+			return FALSE;
+	}
+
+	__mmplayer_audio_eq_kernel = kernel;
+
+	return TRUE;
+}
+
+MMPlayerAudioEqKernel
+_mmplayer_audio_eq_get_kernel(void)
+{
+	return __mmplayer_audio_eq_kernel;
+}
+
+static void
+__mmplayer_audio_eq_group_c(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames)
+{
+	gint width = MIN(channels - group, MMPLAYER_AUDIO_EQ_LANES);
+	gint count = 0;
+	gint s = 0;
+	guint i = 0;
+
+	for (count = 0; count < width; count++)
+	{
+		for (i = 0; i < frames; i++)
+		{
+			gint16 *sample = data + i * channels + group + count;
+			gfloat x = *sample;
+			gfloat y = 0.0f;
+
+			for (s = 0; s < stages; s++)
+			{
+				const MMPlayerAudioEqCoef *c = &coef[stage[s]];
+				gfloat *z = state + stage[s] * 2 * lanes + group + count;
+
+				y = c->b0 * x + z[0];
+				z[0] = c->b1 * x - c->a1 * y + z[lanes];
+				z[lanes] = c->b2 * x - c->a2 * y;
+				x = y;
+			}
+
+			x = floorf(x + 0.5f);
+			*sample = (gint16)CLAMP(x, -32768.0f, 32767.0f);
+		}
+	}
+}
+
+#ifdef MMPLAYER_AUDIO_EQ_USE_SSE2
+static void
+__mmplayer_audio_eq_group_sse2(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames)
+{
+	__m128 b0[MMPLAYER_AUDIO_EQ_STAGE_MAX], b1[MMPLAYER_AUDIO_EQ_STAGE_MAX], b2[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	__m128 a1[MMPLAYER_AUDIO_EQ_STAGE_MAX], a2[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	__m128 z1[MMPLAYER_AUDIO_EQ_STAGE_MAX], z2[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	gint width = MIN(channels - group, MMPLAYER_AUDIO_EQ_LANES);
+	gfloat in[MMPLAYER_AUDIO_EQ_LANES] = {0, };
+	gint16 out[8];
+	gint count = 0;
+	gint s = 0;
+	guint i = 0;
+
+	for (s = 0; s < stages; s++)
+	{
+		const MMPlayerAudioEqCoef *c = &coef[stage[s]];
+		gfloat *z = state + stage[s] * 2 * lanes + group;
+
+		b0[s] = _mm_set1_ps(c->b0);
+		b1[s] = _mm_set1_ps(c->b1);
+		b2[s] = _mm_set1_ps(c->b2);
+		a1[s] = _mm_set1_ps(c->a1);
+		a2[s] = _mm_set1_ps(c->a2);
+		z1[s] = _mm_loadu_ps(z);
+		z2[s] = _mm_loadu_ps(z + lanes);
+	}
+
+	for (i = 0; i < frames; i++)
+	{
+		gint16 *frame = data + i * channels + group;
+		__m128 x, y;
+
+		for (count = 0; count < width; count++)
+			in[count] = frame[count];
+		x = _mm_loadu_ps(in);
+
+		for (s = 0; s < stages; s++)
+		{
+			y = _mm_add_ps(_mm_mul_ps(b0[s], x), z1[s]);
+			z1[s] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1[s], x), _mm_mul_ps(a1[s], y)), z2[s]);
+			z2[s] = _mm_sub_ps(_mm_mul_ps(b2[s], x), _mm_mul_ps(a2[s], y));
+			x = y;
+		}
+
+		/* rounding and saturation */
+		_mm_storel_epi64((__m128i*)out, _mm_packs_epi32(_mm_cvtps_epi32(x), _mm_setzero_si128()));
+		for (count = 0; count < width; count++)
+			frame[count] = out[count];
+	}
+
+	for (s = 0; s < stages; s++)
+	{
+		gfloat *z = state + stage[s] * 2 * lanes + group;
+
+		_mm_storeu_ps(z, z1[s]);
+		_mm_storeu_ps(z + lanes, z2[s]);
+	}
+}
+#endif
+
+#ifdef MMPLAYER_AUDIO_EQ_USE_NEON
+static void
+__mmplayer_audio_eq_group_neon(const MMPlayerAudioEqCoef *coef, gfloat *state, const gint *stage, gint stages,
+		gint channels, gint lanes, gint group, gint16 *data, guint frames)
+{
+	float32x4_t b0[MMPLAYER_AUDIO_EQ_STAGE_MAX], b1[MMPLAYER_AUDIO_EQ_STAGE_MAX], b2[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	float32x4_t a1[MMPLAYER_AUDIO_EQ_STAGE_MAX], a2[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	float32x4_t z1[MMPLAYER_AUDIO_EQ_STAGE_MAX], z2[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	gint width = MIN(channels - group, MMPLAYER_AUDIO_EQ_LANES);
+	gfloat in[MMPLAYER_AUDIO_EQ_LANES] = {0, };
+	gint16 out[4];
+	gint count = 0;
+	gint s = 0;
+	guint i = 0;
+
+	for (s = 0; s < stages; s++)
+	{
+		const MMPlayerAudioEqCoef *c = &coef[stage[s]];
+		gfloat *z = state + stage[s] * 2 * lanes + group;
+
+		b0[s] = vdupq_n_f32(c->b0);
+		b1[s] = vdupq_n_f32(c->b1);
+		b2[s] = vdupq_n_f32(c->b2);
+		a1[s] = vdupq_n_f32(c->a1);
+		a2[s] = vdupq_n_f32(c->a2);
+		z1[s] = vld1q_f32(z);
+		z2[s] = vld1q_f32(z + lanes);
+	}
+
+	for (i = 0; i < frames; i++)
+	{
+		gint16 *frame = data + i * channels + group;
+		float32x4_t x, y;
+
+		for (count = 0; count < width; count++)
+			in[count] = frame[count];
+		x = vld1q_f32(in);
+
+		for (s = 0; s < stages; s++)
+		{
+			y = vmlaq_f32(z1[s], b0[s], x);
+			z1[s] = vaddq_f32(vmlsq_f32(vmulq_f32(b1[s], x), a1[s], y), z2[s]);
+			z2[s] = vmlsq_f32(vmulq_f32(b2[s], x), a2[s], y);
+			x = y;
+		}
+
+		/* conversion truncates toward zero, so round by adding half with sign */
+		x = vaddq_f32(x, vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f)));
+		vst1_s16(out, vqmovn_s32(vcvtq_s32_f32(x)));
+		for (count = 0; count < width; count++)
+			frame[count] = out[count];
+	}
+
+	for (s = 0; s < stages; s++)
+	{
+		gfloat *z = state + stage[s] * 2 * lanes + group;
+
+		vst1q_f32(z, z1[s]);
+		vst1q_f32(z + lanes, z2[s]);
+	}
+}
+#endif
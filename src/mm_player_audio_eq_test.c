@@ -0,0 +1,353 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* runs biquad cascade with every kernel of this build. outputs are compared with
+ * the c kernel, and gain of sine waves is compared with response of coefficients */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include "mm_player_audio_eq_dsp.h"
+
+#define AUDIO_EQ_TEST_RATE		48000
+#define AUDIO_EQ_TEST_AMPLITUDE		4000.0		/* gain of test configs doesn't clip */
+#define AUDIO_EQ_TEST_FRAMES		(AUDIO_EQ_TEST_RATE / 2)
+#define AUDIO_EQ_TEST_SETTLED		(AUDIO_EQ_TEST_FRAMES / 2)
+#define AUDIO_EQ_TEST_TOLERANCE_DB	0.05
+#define AUDIO_EQ_TEST_BENCH_SEC		60
+
+static gint failed = 0;
+
+#define AUDIO_EQ_TEST_CHECK(expr) \
+do \
+{ \
+	if (!(expr)) \
+	{ \
+		fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		failed++; \
+	} \
+} while (0)
+
+static const gchar *kernel_names[MM_PLAYER_AUDIO_EQ_KERNEL_NUM] = { "auto", "c", "sse2", "neon" };
+
+static const gdouble test_freq[] = { 30.0, 60.0, 100.0, 230.0, 910.0, 1000.0, 3600.0, 6000.0, 10000.0, 14000.0, 18000.0 };
+
+#define AUDIO_EQ_TEST_FREQS	(sizeof(test_freq) / sizeof(test_freq[0]))
+
+typedef struct
+{
+	const gchar *name;
+	MMPlayerAudioEqSection section[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+} audio_eq_test_config_t;
+
+/* rock preset, and custom EQ at the limits with both extension shelves */
+static const audio_eq_test_config_t configs[] =
+{
+	{ "preset", {
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 60.0, 0.667, 4.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 230.0, 0.667, 2.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 910.0, 0.667, -2.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 3600.0, 0.667, 2.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 14000.0, 0.667, 4.0 },
+	} },
+	{ "custom", {
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 60.0, 0.828, 12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 132.6, 0.828, -12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 293.2, 0.828, 12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 648.1, 0.828, -12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 1432.6, 0.828, 12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 3166.8, 0.828, -12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 7000.0, 0.828, 12.0 },
+		{ MMPLAYER_AUDIO_EQ_PEAKING, 16000.0, 0.828, -12.0 },
+		{ MMPLAYER_AUDIO_EQ_LOW_SHELF, 100.0, M_SQRT1_2, 9.0 },
+		{ MMPLAYER_AUDIO_EQ_HIGH_SHELF, 6000.0, M_SQRT1_2, -9.0 },
+	} },
+};
+
+#define AUDIO_EQ_TEST_CONFIGS	(sizeof(configs) / sizeof(configs[0]))
+
+static void
+audio_eq_test_design (const audio_eq_test_config_t *config, MMPlayerAudioEqCoef *coef)
+{
+	gint s = 0;
+
+	for (s = 0; s < MMPLAYER_AUDIO_EQ_STAGE_MAX; s++)
+		coef[s].active = _mmplayer_audio_eq_design (&config->section[s], AUDIO_EQ_TEST_RATE, &coef[s]);
+}
+
+/* |H(e^jw)| of cascade in dB */
+static gdouble
+audio_eq_test_response (const MMPlayerAudioEqCoef *coef, gdouble freq)
+{
+	gdouble w = 2.0 * M_PI * freq / AUDIO_EQ_TEST_RATE;
+	gdouble c1 = cos (w), s1 = sin (w);
+	gdouble c2 = cos (2.0 * w), s2 = sin (2.0 * w);
+	gdouble db = 0.0;
+	gint s = 0;
+
+	for (s = 0; s < MMPLAYER_AUDIO_EQ_STAGE_MAX; s++)
+	{
+		gdouble nr, ni, dr, di;
+
+		if (!coef[s].active)
+			continue;
+
+		nr = coef[s].b0 + coef[s].b1 * c1 + coef[s].b2 * c2;
+		ni = -coef[s].b1 * s1 - coef[s].b2 * s2;
+		dr = 1.0 + coef[s].a1 * c1 + coef[s].a2 * c2;
+		di = -coef[s].a1 * s1 - coef[s].a2 * s2;
+
+		db += 10.0 * log10 ((nr * nr + ni * ni) / (dr * dr + di * di));
+	}
+
+	return db;
+}
+
+/* same sine in every channel, with different phase */
+static void
+audio_eq_test_sine (gint16 *data, gint channels, gdouble freq)
+{
+	gint i = 0;
+	gint ch = 0;
+
+	for (i = 0; i < AUDIO_EQ_TEST_FRAMES; i++)
+	{
+		for (ch = 0; ch < channels; ch++)
+			data[i * channels + ch] = (gint16)lrint (AUDIO_EQ_TEST_AMPLITUDE * sin (2.0 * M_PI * freq * i / AUDIO_EQ_TEST_RATE + ch));
+	}
+}
+
+/* amplitude of freq in settled part by least squares fit of sine and cosine */
+static gdouble
+audio_eq_test_amplitude (const gint16 *data, gint channels, gint ch, gdouble freq)
+{
+	gdouble ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+	gdouble a = 0.0, b = 0.0, det = 0.0;
+	gint i = 0;
+
+	for (i = AUDIO_EQ_TEST_SETTLED; i < AUDIO_EQ_TEST_FRAMES; i++)
+	{
+		gdouble w = 2.0 * M_PI * freq * i / AUDIO_EQ_TEST_RATE;
+		gdouble sn = sin (w), cs = cos (w);
+		gdouble y = data[i * channels + ch];
+
+		ss += sn * sn;
+		cc += cs * cs;
+		sc += sn * cs;
+		ys += y * sn;
+		yc += y * cs;
+	}
+
+	det = ss * cc - sc * sc;
+	a = (ys * cc - yc * sc) / det;
+	b = (yc * ss - ys * sc) / det;
+
+	return sqrt (a * a + b * b);
+}
+
+static void
+audio_eq_test_run (MMPlayerAudioEqKernel kernel, const MMPlayerAudioEqCoef *coef, gint channels, gint16 *data, guint frames)
+{
+	gint lanes = (channels + MMPLAYER_AUDIO_EQ_LANES - 1) & ~(MMPLAYER_AUDIO_EQ_LANES - 1);
+	gfloat *state = g_malloc0 (sizeof (gfloat) * MMPLAYER_AUDIO_EQ_STAGE_MAX * 2 * lanes);
+	guint done = 0;
+	guint block = 0;
+
+	_mmplayer_audio_eq_set_kernel (kernel);
+
+	/* odd block sizes as buffers of pipeline */
+	while (done < frames)
+	{
+		block = MIN (frames - done, 1021);
+		_mmplayer_audio_eq_run (coef, state, channels, lanes, data + done * channels, block);
+		done += block;
+	}
+
+	g_free (state);
+}
+
+/* designed sections give their gain at center or end of band */
+static void
+audio_eq_test_design_gain (void)
+{
+	MMPlayerAudioEqSection peaking = { MMPLAYER_AUDIO_EQ_PEAKING, 1000.0, 1.0, 6.0 };
+	MMPlayerAudioEqSection low = { MMPLAYER_AUDIO_EQ_LOW_SHELF, 100.0, M_SQRT1_2, 9.0 };
+	MMPlayerAudioEqSection high = { MMPLAYER_AUDIO_EQ_HIGH_SHELF, 6000.0, M_SQRT1_2, -9.0 };
+	MMPlayerAudioEqSection flat = { MMPLAYER_AUDIO_EQ_PEAKING, 1000.0, 1.0, 0.0 };
+	MMPlayerAudioEqSection nyquist = { MMPLAYER_AUDIO_EQ_PEAKING, 22000.0, 1.0, 6.0 };
+	MMPlayerAudioEqCoef coef[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+
+	memset (coef, 0, sizeof (coef));
+
+	coef[0].active = _mmplayer_audio_eq_design (&peaking, AUDIO_EQ_TEST_RATE, &coef[0]);
+	AUDIO_EQ_TEST_CHECK (coef[0].active);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 1000.0) - 6.0) < 0.01);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 20.0)) < 0.05);
+
+	coef[0].active = _mmplayer_audio_eq_design (&low, AUDIO_EQ_TEST_RATE, &coef[0]);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 10.0) - 9.0) < 0.05);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 100.0) - 4.5) < 0.05);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 10000.0)) < 0.05);
+
+	coef[0].active = _mmplayer_audio_eq_design (&high, AUDIO_EQ_TEST_RATE, &coef[0]);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 20000.0) + 9.0) < 0.1);
+	AUDIO_EQ_TEST_CHECK (fabs (audio_eq_test_response (coef, 100.0)) < 0.05);
+
+	AUDIO_EQ_TEST_CHECK (!_mmplayer_audio_eq_design (&flat, AUDIO_EQ_TEST_RATE, &coef[0]));
+	AUDIO_EQ_TEST_CHECK (!_mmplayer_audio_eq_design (&nyquist, AUDIO_EQ_TEST_RATE, &coef[0]));
+}
+
+/* every kernel against c kernel, and measured gain against response */
+static void
+audio_eq_test_compare (const audio_eq_test_config_t *config, gint channels)
+{
+	MMPlayerAudioEqCoef coef[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	guint samples = AUDIO_EQ_TEST_FRAMES * channels;
+	gint16 *ref = g_malloc (sizeof (gint16) * samples);
+	gint16 *out = g_malloc (sizeof (gint16) * samples);
+	MMPlayerAudioEqKernel kernel = MM_PLAYER_AUDIO_EQ_KERNEL_C;
+	guint f = 0;
+	guint i = 0;
+	gint ch = 0;
+
+	memset (coef, 0, sizeof (coef));
+	audio_eq_test_design (config, coef);
+
+	for (f = 0; f < AUDIO_EQ_TEST_FREQS; f++)
+	{
+		gdouble expected = audio_eq_test_response (coef, test_freq[f]);
+
+		audio_eq_test_sine (ref, channels, test_freq[f]);
+		audio_eq_test_run (MM_PLAYER_AUDIO_EQ_KERNEL_C, coef, channels, ref, AUDIO_EQ_TEST_FRAMES);
+
+		for (ch = 0; ch < channels; ch++)
+		{
+			gdouble db = 20.0 * log10 (audio_eq_test_amplitude (ref, channels, ch, test_freq[f]) / AUDIO_EQ_TEST_AMPLITUDE);
+
+			if (fabs (db - expected) > AUDIO_EQ_TEST_TOLERANCE_DB)
+			{
+				fprintf (stderr, "%s, %d ch : %.0f Hz of channel %d is %.3f dB, expected %.3f dB\n",
+					config->name, channels, test_freq[f], ch, db, expected);
+				failed++;
+			}
+		}
+
+		for (kernel = MM_PLAYER_AUDIO_EQ_KERNEL_C + 1; kernel < MM_PLAYER_AUDIO_EQ_KERNEL_NUM; kernel++)
+		{
+			gint max_diff = 0;
+			guint diffs = 0;
+
+			if (!_mmplayer_audio_eq_set_kernel (kernel))
+				continue;
+
+			audio_eq_test_sine (out, channels, test_freq[f]);
+			audio_eq_test_run (kernel, coef, channels, out, AUDIO_EQ_TEST_FRAMES);
+
+			for (i = 0; i < samples; i++)
+			{
+				gint diff = ABS (out[i] - ref[i]);
+
+				max_diff = MAX (max_diff, diff);
+				diffs += (diff != 0);
+			}
+
+			/* c kernel adds half in float before floor, so values close to halves
+			 * may be rounded to other side. vector kernels round exactly */
+			if (max_diff > 1 || diffs > samples / 100)
+			{
+				fprintf (stderr, "%s, %d ch, %.0f Hz : %s differs from c by %d at most, %u samples\n",
+					config->name, channels, test_freq[f], kernel_names[kernel], max_diff, diffs);
+				failed++;
+			}
+		}
+	}
+
+	g_free (ref);
+	g_free (out);
+}
+
+static void
+audio_eq_test_bench (void)
+{
+	const audio_eq_test_config_t *config = &configs[AUDIO_EQ_TEST_CONFIGS - 1];
+	MMPlayerAudioEqCoef coef[MMPLAYER_AUDIO_EQ_STAGE_MAX];
+	guint frames = AUDIO_EQ_TEST_RATE * AUDIO_EQ_TEST_BENCH_SEC;
+	gint16 *data = g_malloc (sizeof (gint16) * frames * 2);
+	MMPlayerAudioEqKernel kernel = MM_PLAYER_AUDIO_EQ_KERNEL_C;
+	struct timeval start, end;
+	gdouble msec = 0.0;
+	guint i = 0;
+
+	memset (coef, 0, sizeof (coef));
+	audio_eq_test_design (config, coef);
+
+	for (kernel = MM_PLAYER_AUDIO_EQ_KERNEL_C; kernel < MM_PLAYER_AUDIO_EQ_KERNEL_NUM; kernel++)
+	{
+		if (!_mmplayer_audio_eq_set_kernel (kernel))
+			continue;
+
+		for (i = 0; i < frames * 2; i++)
+			data[i] = (gint16)((i * 7919) % 8000 - 4000);
+
+		gettimeofday (&start, NULL);
+		audio_eq_test_run (kernel, coef, 2, data, frames);
+		gettimeofday (&end, NULL);
+
+		msec = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_usec - start.tv_usec) / 1000.0;
+		printf ("%s : %d sec of 48kHz stereo with %d sections in %.1f msec (%.0fx realtime)\n",
+			kernel_names[kernel], AUDIO_EQ_TEST_BENCH_SEC, MMPLAYER_AUDIO_EQ_STAGE_MAX, msec,
+			msec > 0.0 ? AUDIO_EQ_TEST_BENCH_SEC * 1000.0 / msec : 0.0);
+	}
+
+	_mmplayer_audio_eq_set_kernel (MM_PLAYER_AUDIO_EQ_KERNEL_AUTO);
+
+	g_free (data);
+}
+
+int
+main (int argc, char *argv[])
+{
+	guint c = 0;
+
+	audio_eq_test_design_gain ();
+
+	for (c = 0; c < AUDIO_EQ_TEST_CONFIGS; c++)
+	{
+		/* 6 channels run a full group and a partial one */
+		audio_eq_test_compare (&configs[c], 1);
+		audio_eq_test_compare (&configs[c], 2);
+		audio_eq_test_compare (&configs[c], 6);
+	}
+
+	_mmplayer_audio_eq_set_kernel (MM_PLAYER_AUDIO_EQ_KERNEL_AUTO);
+	AUDIO_EQ_TEST_CHECK (_mmplayer_audio_eq_get_kernel () != MM_PLAYER_AUDIO_EQ_KERNEL_AUTO);
+
+	audio_eq_test_bench ();
+
+	if (failed)
+	{
+		fprintf (stderr, "%d checks failed\n", failed);
+		return 1;
+	}
+
+	return 0;
+}
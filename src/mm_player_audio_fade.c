@@ -0,0 +1,480 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <string.h>
+#include <math.h>
+#include <gst/gst.h>
+#include <gst/base/gstbasetransform.h>
+
+#include <mm_debug.h>
+#include "mm_player_audio_fade.h"
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_TYPE_AUDIO_FADE		(__mmplayer_audio_fade_get_type())
+#define MMPLAYER_AUDIO_FADE(obj)		(G_TYPE_CHECK_INSTANCE_CAST((obj), MMPLAYER_TYPE_AUDIO_FADE, MMPlayerAudioFade))
+#define MMPLAYER_IS_AUDIO_FADE(obj)		(G_TYPE_CHECK_INSTANCE_TYPE((obj), MMPLAYER_TYPE_AUDIO_FADE))
+
+/* exponential fade can't reach zero. it goes to -60dB and then to zero at the end */
+#define MMPLAYER_AUDIO_FADE_FLOOR		0.001
+
+typedef struct {
+	GstBaseTransform element;
+
+	/* protected by object lock */
+	gdouble gain;		/* gain of the last processed sample */
+	gdouble target;
+	MMPlayerFadeCurve curve;
+	guint duration;		/* msec of requested fade */
+	gboolean pending;	/* fade is requested and will start from next buffer */
+	guint remaining;	/* frames left in running fade */
+	gdouble step;		/* added(linear) or multiplied(exponential) every frame */
+	GstClockTime end_time;	/* running time of the sample finishing the last fade */
+	GCond *cond;
+	MMPlayerAudioFadeDoneFunc done_func;
+	gpointer done_data;
+
+	/* streaming thread only */
+	gint rate;
+	gint channels;
+	gboolean is_float;
+} MMPlayerAudioFade;
+
+typedef struct {
+	GstBaseTransformClass parent_class;
+} MMPlayerAudioFadeClass;
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS:											|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_AUDIO_FADE_CAPS \
+	"audio/x-raw-int, " \
+	"endianness = (int) BYTE_ORDER, " \
+	"signed = (boolean) true, " \
+	"width = (int) 16, " \
+	"depth = (int) 16, " \
+	"rate = (int) [ 1, MAX ], " \
+	"channels = (int) [ 1, MAX ]; " \
+	"audio/x-raw-float, " \
+	"endianness = (int) BYTE_ORDER, " \
+	"width = (int) 32, " \
+	"rate = (int) [ 1, MAX ], " \
+	"channels = (int) [ 1, MAX ]"
+
+static GstStaticPadTemplate __mmplayer_audio_fade_sink_template = GST_STATIC_PAD_TEMPLATE("sink",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(MMPLAYER_AUDIO_FADE_CAPS));
+
+static GstStaticPadTemplate __mmplayer_audio_fade_src_template = GST_STATIC_PAD_TEMPLATE("src",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(MMPLAYER_AUDIO_FADE_CAPS));
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static void __mmplayer_audio_fade_finalize(GObject *object);
+static gboolean __mmplayer_audio_fade_set_caps(GstBaseTransform *trans, GstCaps *incaps, GstCaps *outcaps);
+static gboolean __mmplayer_audio_fade_stop(GstBaseTransform *trans);
+static GstFlowReturn __mmplayer_audio_fade_transform_ip(GstBaseTransform *trans, GstBuffer *buffer);
+static void __mmplayer_audio_fade_begin(MMPlayerAudioFade *fade);
+static void __mmplayer_audio_fade_apply_s16(gint16 *data, guint samples, gfloat gain);
+static void __mmplayer_audio_fade_apply_f32(gfloat *data, guint samples, gfloat gain);
+
+GST_BOILERPLATE(MMPlayerAudioFade, __mmplayer_audio_fade, GstBaseTransform, GST_TYPE_BASE_TRANSFORM);
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+gboolean
+_mmplayer_audio_fade_register(void)
+{
+	debug_fenter();
+
+	if ( ! gst_element_register(NULL, MMPLAYER_AUDIO_FADE_FACTORY, GST_RANK_NONE, MMPLAYER_TYPE_AUDIO_FADE) )
+	{
+		debug_error("failed to register %s\n", MMPLAYER_AUDIO_FADE_FACTORY);
+		return FALSE;
+	}
+
+	debug_fleave();
+
+	return TRUE;
+}
+
+void
+_mmplayer_audio_fade_start(GstElement *element, gdouble target, guint duration_msec, MMPlayerFadeCurve curve)
+{
+	MMPlayerAudioFade *fade = NULL;
+
+	return_if_fail( element && MMPLAYER_IS_AUDIO_FADE(element) );
+
+	fade = MMPLAYER_AUDIO_FADE(element);
+
+	GST_OBJECT_LOCK(fade);
+	fade->target = CLAMP(target, 0.0, 1.0);
+	fade->duration = duration_msec;
+	fade->curve = curve;
+	fade->pending = TRUE;
+	fade->remaining = 0;
+	fade->end_time = GST_CLOCK_TIME_NONE;
+	GST_OBJECT_UNLOCK(fade);
+
+	debug_log("fade to %.3f in %d msec, curve(%d)\n", target, duration_msec, curve);
+}
+
+void
+_mmplayer_audio_fade_set_gain(GstElement *element, gdouble gain)
+{
+	MMPlayerAudioFade *fade = NULL;
+
+	return_if_fail( element && MMPLAYER_IS_AUDIO_FADE(element) );
+
+	fade = MMPLAYER_AUDIO_FADE(element);
+
+	GST_OBJECT_LOCK(fade);
+	fade->gain = fade->target = CLAMP(gain, 0.0, 1.0);
+	fade->pending = FALSE;
+	fade->remaining = 0;
+	fade->end_time = GST_CLOCK_TIME_NONE;
+	g_cond_broadcast(fade->cond);
+	GST_OBJECT_UNLOCK(fade);
+}
+
+gboolean
+_mmplayer_audio_fade_wait(GstElement *element, guint timeout_msec)
+{
+	MMPlayerAudioFade *fade = NULL;
+	GTimeVal until;
+	gboolean done = FALSE;
+
+	return_val_if_fail( element && MMPLAYER_IS_AUDIO_FADE(element), FALSE );
+
+	fade = MMPLAYER_AUDIO_FADE(element);
+
+	g_get_current_time(&until);
+	g_time_val_add(&until, (glong)timeout_msec * 1000);
+
+	GST_OBJECT_LOCK(fade);
+	while ( fade->pending || fade->remaining )
+	{
+		if ( ! g_cond_timed_wait(fade->cond, GST_OBJECT_GET_LOCK(fade), &until) )
+			break;
+	}
+	done = ! ( fade->pending || fade->remaining );
+	GST_OBJECT_UNLOCK(fade);
+
+	if ( ! done )
+		debug_warning("fade is not done in %d msec\n", timeout_msec);
+
+	return done;
+}
+
+GstClockTime
+_mmplayer_audio_fade_get_end_time(GstElement *element)
+{
+	MMPlayerAudioFade *fade = NULL;
+	GstClockTime end_time = GST_CLOCK_TIME_NONE;
+
+	return_val_if_fail( element && MMPLAYER_IS_AUDIO_FADE(element), GST_CLOCK_TIME_NONE );
+
+	fade = MMPLAYER_AUDIO_FADE(element);
+
+	GST_OBJECT_LOCK(fade);
+	end_time = fade->end_time;
+	GST_OBJECT_UNLOCK(fade);
+
+	return end_time;
+}
+
+void
+_mmplayer_audio_fade_set_done_func(GstElement *element, MMPlayerAudioFadeDoneFunc func, gpointer user_data)
+{
+	MMPlayerAudioFade *fade = NULL;
+
+	return_if_fail( element && MMPLAYER_IS_AUDIO_FADE(element) );
+
+	fade = MMPLAYER_AUDIO_FADE(element);
+
+	GST_OBJECT_LOCK(fade);
+	fade->done_func = func;
+	fade->done_data = user_data;
+	GST_OBJECT_UNLOCK(fade);
+}
+
+static void
+__mmplayer_audio_fade_base_init(gpointer klass)
+{
+	GstElementClass *element_class = GST_ELEMENT_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class,
+		gst_static_pad_template_get(&__mmplayer_audio_fade_sink_template));
+	gst_element_class_add_pad_template(element_class,
+		gst_static_pad_template_get(&__mmplayer_audio_fade_src_template));
+
+	gst_element_class_set_details_simple(element_class,
+		"Player fade",
+		"Filter/Effect/Audio",
+		"Sample accurate gain ramp of player",
+		"Samsung Electronics Co., Ltd.");
+}
+
+static void
+__mmplayer_audio_fade_class_init(MMPlayerAudioFadeClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+	GstBaseTransformClass *trans_class = GST_BASE_TRANSFORM_CLASS(klass);
+
+	gobject_class->finalize = __mmplayer_audio_fade_finalize;
+
+	trans_class->set_caps = GST_DEBUG_FUNCPTR(__mmplayer_audio_fade_set_caps);
+	trans_class->stop = GST_DEBUG_FUNCPTR(__mmplayer_audio_fade_stop);
+	trans_class->transform_ip = GST_DEBUG_FUNCPTR(__mmplayer_audio_fade_transform_ip);
+}
+
+static void
+__mmplayer_audio_fade_init(MMPlayerAudioFade *fade, MMPlayerAudioFadeClass *klass)
+{
+	fade->gain = 1.0;
+	fade->target = 1.0;
+	fade->curve = MM_PLAYER_FADE_CURVE_LINEAR;
+	fade->end_time = GST_CLOCK_TIME_NONE;
+	fade->cond = g_cond_new();
+
+	gst_base_transform_set_in_place(GST_BASE_TRANSFORM(fade), TRUE);
+}
+
+static void
+__mmplayer_audio_fade_finalize(GObject *object)
+{
+	MMPlayerAudioFade *fade = MMPLAYER_AUDIO_FADE(object);
+
+	if ( fade->cond )
+	{
+		g_cond_free(fade->cond);
+		fade->cond = NULL;
+	}
+
+	G_OBJECT_CLASS(parent_class)->finalize(object);
+}
+
+static gboolean
+__mmplayer_audio_fade_set_caps(GstBaseTransform *trans, GstCaps *incaps, GstCaps *outcaps)
+{
+	MMPlayerAudioFade *fade = MMPLAYER_AUDIO_FADE(trans);
+	GstStructure *str = NULL;
+	gint rate = 0;
+	gint channels = 0;
+
+	str = gst_caps_get_structure(incaps, 0);
+	if ( ! gst_structure_get_int(str, "rate", &rate) ||
+		! gst_structure_get_int(str, "channels", &channels) ||
+		rate <= 0 || channels <= 0 )
+	{
+		debug_error("invalid caps for fade\n");
+		return FALSE;
+	}
+
+	fade->rate = rate;
+	fade->channels = channels;
+	fade->is_float = gst_structure_has_name(str, "audio/x-raw-float");
+
+	return TRUE;
+}
+
+static gboolean
+__mmplayer_audio_fade_stop(GstBaseTransform *trans)
+{
+	MMPlayerAudioFade *fade = MMPLAYER_AUDIO_FADE(trans);
+
+	/* no more buffer. finish running fade not to block waiter */
+	GST_OBJECT_LOCK(fade);
+	if ( fade->pending || fade->remaining )
+	{
+		fade->gain = fade->target;
+		fade->pending = FALSE;
+		fade->remaining = 0;
+		g_cond_broadcast(fade->cond);
+	}
+	GST_OBJECT_UNLOCK(fade);
+
+	return TRUE;
+}
+
+static GstFlowReturn
+__mmplayer_audio_fade_transform_ip(GstBaseTransform *trans, GstBuffer *buffer)
+{
+	MMPlayerAudioFade *fade = MMPLAYER_AUDIO_FADE(trans);
+	MMPlayerAudioFadeDoneFunc done_func = NULL;
+	gpointer done_data = NULL;
+	guint8 *data = GST_BUFFER_DATA(buffer);
+	GstClockTime ts = GST_BUFFER_TIMESTAMP(buffer);
+	guint sample_size = fade->is_float ? sizeof(gfloat) : sizeof(gint16);
+	guint total = 0;
+	guint frames = 0;
+	guint count = 0;
+	guint i = 0;
+	gint ch = 0;
+	gdouble gain = 0.0;
+
+	if ( ! fade->channels )
+		return GST_FLOW_OK;
+
+	frames = total = GST_BUFFER_SIZE(buffer) / (sample_size * fade->channels);
+
+	GST_OBJECT_LOCK(fade);
+
+	if ( fade->pending )
+		__mmplayer_audio_fade_begin(fade);
+
+	while ( frames )
+	{
+		if ( fade->remaining )
+		{
+			/* gain moves every frame */
+			count = MIN(frames, fade->remaining);
+			gain = fade->gain;
+
+			for (i = 0; i < count; i++)
+			{
+				if (fade->curve == MM_PLAYER_FADE_CURVE_EXPONENTIAL)
+					gain *= fade->step;
+				else
+					gain += fade->step;
+
+				for (ch = 0; ch < fade->channels; ch++)
+				{
+					if (fade->is_float)
+						__mmplayer_audio_fade_apply_f32((gfloat*)data + i * fade->channels + ch, 1, gain);
+					else
+						__mmplayer_audio_fade_apply_s16((gint16*)data + i * fade->channels + ch, 1, gain);
+				}
+			}
+
+			fade->gain = gain;
+			fade->remaining -= count;
+
+			if ( ! fade->remaining )
+			{
+				/* when the last faded sample is played. waiter adds sink latency */
+				if ( GST_CLOCK_TIME_IS_VALID(ts) )
+				{
+					fade->end_time = gst_segment_to_running_time(&trans->segment, GST_FORMAT_TIME,
+						ts + gst_util_uint64_scale_int(total - frames + count, GST_SECOND, fade->rate));
+				}
+
+				fade->gain = fade->target;
+				done_func = fade->done_func;
+				done_data = fade->done_data;
+				g_cond_broadcast(fade->cond);
+			}
+		}
+		else
+		{
+			/* steady gain. nothing to do at unity */
+			count = frames;
+
+			if (fade->gain != 1.0)
+			{
+				if (fade->is_float)
+					__mmplayer_audio_fade_apply_f32((gfloat*)data, count * fade->channels, fade->gain);
+				else
+					__mmplayer_audio_fade_apply_s16((gint16*)data, count * fade->channels, fade->gain);
+			}
+		}
+
+		data += count * fade->channels * sample_size;
+		frames -= count;
+	}
+
+	gain = fade->gain;
+
+	GST_OBJECT_UNLOCK(fade);
+
+	if ( done_func )
+		done_func(GST_ELEMENT(fade), gain, done_data);
+
+	return GST_FLOW_OK;
+}
+
+/* called with object lock */
+static void
+__mmplayer_audio_fade_begin(MMPlayerAudioFade *fade)
+{
+	guint frames = (guint)((guint64)fade->duration * fade->rate / 1000);
+
+	fade->pending = FALSE;
+
+	if ( ! frames || fade->gain == fade->target )
+	{
+		/* done at the first sample. still it's a fade requested */
+		fade->gain = fade->target;
+		fade->remaining = 1;
+		fade->step = (fade->curve == MM_PLAYER_FADE_CURVE_EXPONENTIAL) ? 1.0 : 0.0;
+		return;
+	}
+
+	if (fade->curve == MM_PLAYER_FADE_CURVE_EXPONENTIAL)
+	{
+		fade->gain = MAX(fade->gain, MMPLAYER_AUDIO_FADE_FLOOR);
+		fade->step = pow(MAX(fade->target, MMPLAYER_AUDIO_FADE_FLOOR) / fade->gain, 1.0 / frames);
+	}
+	else
+	{
+		fade->step = (fade->target - fade->gain) / frames;
+	}
+
+	fade->remaining = frames;
+}
+
+static void
+__mmplayer_audio_fade_apply_s16(gint16 *data, guint samples, gfloat gain)
+{
+	gfloat value = 0.0f;
+	guint i = 0;
+
+	for (i = 0; i < samples; i++)
+	{
+		value = data[i] * gain;
+		data[i] = (gint16)CLAMP(value, -32768.0f, 32767.0f);
+	}
+}
+
+static void
+__mmplayer_audio_fade_apply_f32(gfloat *data, guint samples, gfloat gain)
+{
+	guint i = 0;
+
+	for (i = 0; i < samples; i++)
+		data[i] *= gain;
+}
@@ -0,0 +1,238 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* plays generated sine wave and switches audio sink by api and by route attribute.
+ * silence gap of each switch is checked. it's skipped if there is no audio device */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <glib.h>
+#include <mm_error.h>
+#include "mm_player.h"
+#include "mm_player_internal.h"
+
+#define AUDIO_SWITCH_TEST_SKIP			77		/* automake skips the test */
+#define AUDIO_SWITCH_TEST_RATE			44100
+#define AUDIO_SWITCH_TEST_SEC			10
+#define AUDIO_SWITCH_TEST_GAP_MAX		50000	/* usec. 2 periods of default sink */
+#define AUDIO_SWITCH_TEST_WAIT_MSEC		2000
+
+static gint failed = 0;
+
+#define AUDIO_SWITCH_TEST_CHECK(expr) \
+do \
+{ \
+	if (!(expr)) \
+	{ \
+		fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		failed++; \
+	} \
+} while (0)
+
+static void
+audio_switch_test_put_le (FILE *fp, guint value, gint bytes)
+{
+	gint i = 0;
+
+	for (i = 0; i < bytes; i++)
+		fputc ((value >> (i * 8)) & 0xff, fp);
+}
+
+/* 16 bits mono wav of 1kHz sine */
+static gboolean
+audio_switch_test_write_wav (const gchar *path)
+{
+	guint samples = AUDIO_SWITCH_TEST_RATE * AUDIO_SWITCH_TEST_SEC;
+	FILE *fp = NULL;
+	guint i = 0;
+
+	fp = fopen (path, "wb");
+	if (!fp)
+		return FALSE;
+
+	fwrite ("RIFF", 1, 4, fp);
+	audio_switch_test_put_le (fp, 36 + samples * 2, 4);
+	fwrite ("WAVEfmt ", 1, 8, fp);
+	audio_switch_test_put_le (fp, 16, 4);
+	audio_switch_test_put_le (fp, 1, 2);				/* pcm */
+	audio_switch_test_put_le (fp, 1, 2);				/* channels */
+	audio_switch_test_put_le (fp, AUDIO_SWITCH_TEST_RATE, 4);
+	audio_switch_test_put_le (fp, AUDIO_SWITCH_TEST_RATE * 2, 4);
+	audio_switch_test_put_le (fp, 2, 2);				/* block align */
+	audio_switch_test_put_le (fp, 16, 2);
+	fwrite ("data", 1, 4, fp);
+	audio_switch_test_put_le (fp, samples * 2, 4);
+
+	for (i = 0; i < samples; i++)
+	{
+		gint16 sample = (gint16)(8000 * sin (2 * G_PI * 1000 * i / AUDIO_SWITCH_TEST_RATE));
+		audio_switch_test_put_le (fp, (guint16)sample, 2);
+	}
+
+	fclose (fp);
+
+	return TRUE;
+}
+
+static gint
+audio_switch_test_position (MMHandleType player)
+{
+	gint pos = 0;
+
+	if (mm_player_get_position (player, MM_PLAYER_POS_FORMAT_TIME, &pos) != MM_ERROR_NONE)
+		return -1;
+
+	return pos;
+}
+
+/* waits first buffer in new sink. gap is -1 till then */
+static gint
+audio_switch_test_wait_gap (MMHandleType player)
+{
+	gint gap = -1;
+	gint waited = 0;
+
+	while (waited < AUDIO_SWITCH_TEST_WAIT_MSEC)
+	{
+		if (mm_player_get_audio_sink_switch_gap (player, &gap) == MM_ERROR_NONE && gap >= 0)
+			break;
+
+		usleep (10000);
+		waited += 10;
+	}
+
+	return gap;
+}
+
+static void
+audio_switch_test_check_switch (MMHandleType player, const gchar *by, gint pos_before)
+{
+	gint gap = audio_switch_test_wait_gap (player);
+	gint pos = 0;
+
+	printf ("switch by %s : gap %d usec\n", by, gap);
+
+	AUDIO_SWITCH_TEST_CHECK (gap >= 0);
+	AUDIO_SWITCH_TEST_CHECK (gap <= AUDIO_SWITCH_TEST_GAP_MAX);
+
+	/* playback goes on without re-preroll */
+	usleep (300000);
+	pos = audio_switch_test_position (player);
+	AUDIO_SWITCH_TEST_CHECK (pos > pos_before);
+}
+
+int
+main (int argc, char *argv[])
+{
+	MMHandleType player = 0;
+	gchar path[] = "/tmp/mm_player_audio_switch_test_XXXXXX";
+	gchar *uri = NULL;
+	gchar *err_attr_name = NULL;
+	gint spk_out_only = 0;
+	gint fd = -1;
+	gint pos = 0;
+	gint ret = 0;
+
+	fd = mkstemp (path);
+	if (fd < 0 || !audio_switch_test_write_wav (path))
+	{
+		fprintf (stderr, "failed to write test sound\n");
+		return 1;
+	}
+	close (fd);
+
+	uri = g_strdup_printf ("file://%s", path);
+
+	if (mm_player_create (&player) != MM_ERROR_NONE)
+	{
+		fprintf (stderr, "failed to create player. skipped\n");
+		ret = AUDIO_SWITCH_TEST_SKIP;
+		goto EXIT;
+	}
+
+	if (mm_player_set_attribute (player, &err_attr_name,
+			"profile_uri", uri, strlen (uri),
+			NULL) != MM_ERROR_NONE)
+	{
+		fprintf (stderr, "failed to set %s attribute\n", err_attr_name);
+		free (err_attr_name);
+		ret = 1;
+		goto DESTROY;
+	}
+
+	/* no audio device */
+	if (mm_player_realize (player) != MM_ERROR_NONE || mm_player_start (player) != MM_ERROR_NONE)
+	{
+		fprintf (stderr, "failed to play. skipped\n");
+		ret = AUDIO_SWITCH_TEST_SKIP;
+		goto UNREALIZE;
+	}
+
+	usleep (1000000);
+	pos = audio_switch_test_position (player);
+	if (pos <= 0)
+	{
+		fprintf (stderr, "sound is not played. skipped\n");
+		ret = AUDIO_SWITCH_TEST_SKIP;
+		goto STOP;
+	}
+
+	/* by api */
+	AUDIO_SWITCH_TEST_CHECK (mm_player_switch_audio_sink (player) == MM_ERROR_NONE);
+	audio_switch_test_check_switch (player, "api", pos);
+
+	/* by route. it's switched again with new route */
+	pos = audio_switch_test_position (player);
+	mm_player_get_attribute (player, NULL, "sound_spk_out_only", &spk_out_only, NULL);
+	AUDIO_SWITCH_TEST_CHECK (mm_player_set_attribute (player, NULL,
+			"sound_spk_out_only", !spk_out_only,
+			NULL) == MM_ERROR_NONE);
+	audio_switch_test_check_switch (player, "route", pos);
+
+	/* route is changed back right after switch is started. pending one follows it */
+	pos = audio_switch_test_position (player);
+	AUDIO_SWITCH_TEST_CHECK (mm_player_switch_audio_sink (player) == MM_ERROR_NONE);
+	AUDIO_SWITCH_TEST_CHECK (mm_player_set_attribute (player, NULL,
+			"sound_spk_out_only", spk_out_only,
+			NULL) == MM_ERROR_NONE);
+	audio_switch_test_check_switch (player, "route while switching", pos);
+
+	if (failed)
+	{
+		fprintf (stderr, "%d checks failed\n", failed);
+		ret = 1;
+	}
+
+STOP:
+	mm_player_stop (player);
+UNREALIZE:
+	mm_player_unrealize (player);
+DESTROY:
+	mm_player_destroy (player);
+EXIT:
+	g_free (uri);
+	unlink (path);
+
+	return ret;
+}
@@ -27,12 +27,25 @@
 ========================================================================================== */
 #include "mm_player_capture.h"
 #include "mm_player_priv.h"
+#include "mm_player_csc.h"
 
 #include <mm_util_imgp.h>
+#include <gst/app/gstappsink.h>
+#include <unistd.h>
 
 /*---------------------------------------------------------------------------
 |    LOCAL VARIABLE DEFINITIONS for internal								|
 ---------------------------------------------------------------------------*/
+/* elements of headless frame extraction pipeline */
+typedef struct
+{
+	GstElement *pipeline;
+	GstElement *src;
+	GstElement *conv;
+	GstElement *scale;
+	GstElement *filter;
+	GstElement *sink;
+} MMPlayerFrameExtractor;
 
 /*---------------------------------------------------------------------------
 |    LOCAL FUNCTION PROTOTYPES:												|
@@ -40,9 +53,21 @@
 static gboolean __mmplayer_video_capture_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data);
 static int  __mmplayer_get_video_frame_from_buffer(mm_player_t* player, GstBuffer *buffer);
 static void __mmplayer_capture_thread(gpointer data);
-static void __csc_tiled_to_linear_crop(unsigned char *yuv420_dest, unsigned char *nv12t_src, int yuv420_width, int yuv420_height, int left, int top, int right, int buttom);
-static int __tile_4x2_read(int x_size, int y_size, int x_pos, int y_pos);
 static int __mm_player_convert_colorspace(mm_player_t* player, unsigned char* src_data, mm_util_img_format src_fmt, unsigned int src_w, unsigned int src_h, mm_util_img_format dst_fmt);
+static mm_util_img_format __mmplayer_get_util_format(MMPlayerVideoColorspace fmt);
+static void __mmplayer_update_capture_param(mm_player_t* player);
+static void __mmplayer_get_capture_size(mm_player_t* player, int src_w, int src_h, int *dst_w, int *dst_h);
+static int __mm_player_convert_frame(mm_player_t* player, MMPlayerMPlaneImage *src);
+static gboolean __mmplayer_continuous_capture_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data);
+static void __mmplayer_continuous_capture_process(mm_player_t* player);
+static void __mmplayer_continuous_capture_free(MMPlayerContinuousCapture *cc);
+static void __mmplayer_fill_image(MMPlayerMPlaneImage *image, MMPlayerVideoColorspace cs, unsigned char *data, int width, int height);
+static gboolean __mmplayer_get_rgb32_format(GstStructure *structure, mm_util_img_format *fmt);
+static void __mmplayer_extractor_pad_added(GstElement *element, GstPad *pad, gpointer data);
+static GstPad* __mmplayer_extractor_add_converter(MMPlayerFrameExtractor *extractor, GstCaps *caps);
+static int __mmplayer_extractor_create(mm_player_t* player, MMPlayerFrameExtractor *extractor, const gchar *uri, int width, int height);
+static void __mmplayer_extractor_destroy(MMPlayerFrameExtractor *extractor);
+static int __mmplayer_extractor_get_frame(MMPlayerFrameExtractor *extractor, int position, int width, int height, gint timeout, MMPlayerVideoCapture *frame);
 
 /*===========================================================================================
 |																							|
@@ -53,6 +78,9 @@ int
 _mmplayer_initialize_video_capture(mm_player_t* player)
 {
 	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	player->capture_fmt = MM_PLAYER_COLORSPACE_RGB888;
+
 	/* create capture mutex */
 	player->capture_thread_mutex = g_mutex_new();
 	if ( ! player->capture_thread_mutex )
@@ -61,6 +89,13 @@ _mmplayer_initialize_video_capture(mm_player_t* player)
 		goto ERROR;
 	}
 
+	player->continuous_capture_lock = g_mutex_new();
+	if ( ! player->continuous_capture_lock )
+	{
+		debug_critical("Cannot create continuous capture mutex");
+		goto ERROR;
+	}
+
 	/* create capture cond */
 	player->capture_thread_cond = g_cond_new();
 	if ( ! player->capture_thread_cond )
@@ -79,6 +114,9 @@ _mmplayer_initialize_video_capture(mm_player_t* player)
 		goto ERROR;
 	}
 
+	/* share conversion workers with other players */
+	_mmplayer_csc_pool_ref();
+
 	return MM_ERROR_NONE;
 
 ERROR:
@@ -86,6 +124,9 @@ ERROR:
 	if ( player->capture_thread_mutex )
 		g_mutex_free ( player->capture_thread_mutex );
 
+	if ( player->continuous_capture_lock )
+		g_mutex_free ( player->continuous_capture_lock );
+
 	if ( player->capture_thread_cond )
 		g_cond_free ( player->capture_thread_cond );
 
@@ -96,6 +137,9 @@ int
 _mmplayer_release_video_capture(mm_player_t* player)
 {
 	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	_mmplayer_stop_continuous_capture((MMHandleType)player);
+
 	/* release capture thread */
 	if ( player->capture_thread_cond &&
 		 player->capture_thread_mutex &&
@@ -109,8 +153,11 @@ _mmplayer_release_video_capture(mm_player_t* player)
 		debug_log("waitting for capture thread exit");
 		g_thread_join ( player->capture_thread );
 		g_mutex_free ( player->capture_thread_mutex );
+		g_mutex_free ( player->continuous_capture_lock );
 		g_cond_free ( player->capture_thread_cond );
 		debug_log("capture thread released");
+
+		_mmplayer_csc_pool_unref();
 	}
 
 	return MM_ERROR_NONE;
@@ -128,12 +175,16 @@ _mmplayer_do_video_capture(MMHandleType hplayer)
 	return_val_if_fail(player && player->pipeline, MM_ERROR_PLAYER_NOT_INITIALIZED);
 
 	/* capturing or not */
-	if (player->video_capture_cb_probe_id || player->capture.data || player->captured.a[0] || player->captured.a[1])
+	if (player->video_capture_cb_probe_id || player->capture.data || player->captured.a[0] || player->captured.a[1] ||
+		player->continuous_capture)
 	{
 		debug_warning("capturing... we can't do any more");
 		return MM_ERROR_PLAYER_INVALID_STATE;
 	}
 
+	/* output format and size of this capture */
+	__mmplayer_update_capture_param(player);
+
 	/* check if video pipeline is linked or not */
 	if (!player->pipeline->videobin || !player->sent_bos)
 	{
@@ -176,13 +227,256 @@ _mmplayer_do_video_capture(MMHandleType hplayer)
 	return ret;
 }
 
+int
+_mmplayer_extract_video_frames(MMHandleType hplayer, const int *positions, int count, int width, int height, MMPlayerVideoCapture *frames)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerFrameExtractor extractor = {0, };
+	gchar *uri = NULL;
+	gint timeout = 0;
+	int ret = MM_ERROR_NONE;
+	int i = 0;
+
+	debug_fenter();
+
+	return_val_if_fail(player && player->attrs, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(positions && frames && count > 0, MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(width > 0 && height > 0, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	mm_attrs_get_string_by_name(player->attrs, "profile_uri", &uri);
+
+	if ( !uri || !gst_uri_is_valid(uri) )
+	{
+		debug_error("invalid uri to extract frames\n");
+		return MM_ERROR_PLAYER_INVALID_URI;
+	}
+
+	memset(frames, 0x00, sizeof(MMPlayerVideoCapture) * count);
+
+	timeout = PLAYER_INI()->localplayback_state_change_timeout;
+
+	ret = __mmplayer_extractor_create(player, &extractor, uri, width, height);
+	if ( ret != MM_ERROR_NONE )
+	{
+		debug_error("failed to create frame extractor\n");
+		goto ERROR;
+	}
+
+	/* preroll. no clock is running since there's no display or audio sink */
+	gst_element_set_state(extractor.pipeline, GST_STATE_PAUSED);
+	if ( gst_element_get_state(extractor.pipeline, NULL, NULL, timeout * GST_SECOND) != GST_STATE_CHANGE_SUCCESS )
+	{
+		debug_error("failed to preroll frame extractor\n");
+		ret = MM_ERROR_PLAYER_INTERNAL;
+		goto ERROR;
+	}
+
+	for ( i = 0; i < count; i++ )
+	{
+		ret = __mmplayer_extractor_get_frame(&extractor, positions[i], width, height, timeout, &frames[i]);
+		if ( ret != MM_ERROR_NONE )
+		{
+			debug_error("failed to extract frame at %d msec\n", positions[i]);
+			goto ERROR;
+		}
+	}
+
+	__mmplayer_extractor_destroy(&extractor);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+
+ERROR:
+	__mmplayer_extractor_destroy(&extractor);
+
+	for ( i = 0; i < count; i++ )
+	{
+		MMPLAYER_FREEIF(frames[i].data);
+		frames[i].size = 0;
+	}
+
+	return ret;
+}
+
+int
+_mmplayer_start_continuous_capture(MMHandleType hplayer, int interval, int fps, int slot_count, mm_player_continuous_capture_callback callback, void *user_param)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerContinuousCapture *cc = NULL;
+	int width = 0;
+	int height = 0;
+	int size = 0;
+	int i = 0;
+
+	debug_fenter();
+
+	return_val_if_fail(player && player->pipeline, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(callback, MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(interval > 0 || fps > 0, MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(slot_count > 0 && slot_count <= MM_PLAYER_CAPTURE_SLOT_MAX, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	if (player->continuous_capture || player->video_capture_cb_probe_id || player->capture.data)
+	{
+		debug_warning("capturing... we can't do any more");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	/* check if video pipeline is linked or not */
+	if (!player->pipeline->videobin || !player->sent_bos)
+	{
+		debug_warning("not ready to capture");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	/* output format and size of this capture */
+	__mmplayer_update_capture_param(player);
+
+	cc = g_try_new0(MMPlayerContinuousCapture, 1);
+	if ( !cc )
+		return MM_ERROR_PLAYER_NO_FREE_SPACE;
+
+	cc->slots = g_try_new0(MMPlayerCaptureSlot, slot_count);
+	if ( !cc->slots )
+		goto NO_FREE_SPACE;
+
+	cc->interval = interval;
+	cc->period = (interval > 0) ? 0 : GST_SECOND / fps;
+	cc->next_ts = GST_CLOCK_TIME_NONE;
+	cc->last_ts = GST_CLOCK_TIME_NONE;
+	cc->slot_count = slot_count;
+	cc->callback = callback;
+	cc->user_param = user_param;
+
+	/* preallocate slots for current video size. they are resized if video size is changed */
+	mm_attrs_get_int_by_name(player->attrs, "content_video_width", &width);
+	mm_attrs_get_int_by_name(player->attrs, "content_video_height", &height);
+
+	if (width > 0 && height > 0)
+	{
+		__mmplayer_get_capture_size(player, width, height, &width, &height);
+		size = _mmplayer_csc_get_image_size(player->capture_fmt, width, height);
+	}
+
+	for (i = 0; i < slot_count; i++)
+	{
+		cc->slots[i].frame.slot = i;
+
+		if (size > 0)
+		{
+			cc->slots[i].frame.image.data = (unsigned char*) g_try_malloc(size);
+			if ( !cc->slots[i].frame.image.data )
+				goto NO_FREE_SPACE;
+			cc->slots[i].capacity = size;
+		}
+	}
+
+	cc->pad = gst_element_get_static_pad(player->pipeline->videobin[MMPLAYER_V_SINK].gst, "sink");
+
+	g_mutex_lock(player->capture_thread_mutex);
+	g_mutex_lock(player->continuous_capture_lock);
+	player->continuous_capture = cc;
+	g_mutex_unlock(player->continuous_capture_lock);
+	g_mutex_unlock(player->capture_thread_mutex);
+
+	cc->probe_id = gst_pad_add_buffer_probe(cc->pad,
+		G_CALLBACK(__mmplayer_continuous_capture_probe), player);
+
+	debug_log("continuous capture started. interval: %d, fps: %d, slots: %d(%d bytes)\n",
+		interval, fps, slot_count, size);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+
+NO_FREE_SPACE:
+	debug_error("no free space for continuous capture\n");
+	__mmplayer_continuous_capture_free(cc);
+	return MM_ERROR_PLAYER_NO_FREE_SPACE;
+}
+
+int
+_mmplayer_stop_continuous_capture(MMHandleType hplayer)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerContinuousCapture *cc = NULL;
+
+	debug_fenter();
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	if (!player->continuous_capture)
+		return MM_ERROR_NONE;
+
+	/* NOTE : capture thread accesses it with capture mutex and probe and release
+	 * with continuous capture lock. so, it's safe to free it after detaching.
+	 */
+	g_mutex_lock(player->capture_thread_mutex);
+	g_mutex_lock(player->continuous_capture_lock);
+	cc = player->continuous_capture;
+	player->continuous_capture = NULL;
+	g_mutex_unlock(player->continuous_capture_lock);
+
+	/* callback is running. it can be this thread, so it's freed after callback returns */
+	if (cc && cc->delivering)
+	{
+		debug_log("continuous capture stopped while delivering. %d frames, %d dropped\n", cc->frame_count, cc->dropped);
+		cc->stopped = TRUE;
+		cc = NULL;
+	}
+	g_mutex_unlock(player->capture_thread_mutex);
+
+	if (cc)
+	{
+		debug_log("continuous capture stopped. %d frames, %d dropped\n", cc->frame_count, cc->dropped);
+		__mmplayer_continuous_capture_free(cc);
+	}
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_release_captured_frame(MMHandleType hplayer, int slot)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerContinuousCapture *cc = NULL;
+
+	return_val_if_fail(player && player->continuous_capture_lock, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	/* NOTE : capture mutex can't be used here since it's held while callback is called.
+	 * stop frees it with continuous capture lock too.
+	 */
+	g_mutex_lock(player->continuous_capture_lock);
+
+	cc = player->continuous_capture;
+
+	if (!cc)
+	{
+		g_mutex_unlock(player->continuous_capture_lock);
+		debug_warning("continuous capture is not started");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	if (slot < 0 || slot >= cc->slot_count)
+	{
+		g_mutex_unlock(player->continuous_capture_lock);
+		return MM_ERROR_COMMON_INVALID_ARGUMENT;
+	}
+
+	g_atomic_int_set(&cc->slots[slot].in_use, 0);
+
+	g_mutex_unlock(player->continuous_capture_lock);
+
+	return MM_ERROR_NONE;
+}
+
 static void
 __mmplayer_capture_thread(gpointer data)
 {
 	mm_player_t* player = (mm_player_t*) data;
 	MMMessageParamType msg = {0, };
-	unsigned char * linear_y_plane = NULL;
-	unsigned char * linear_uv_plane = NULL;
 
 	return_if_fail (player);
 
@@ -191,7 +485,11 @@ __mmplayer_capture_thread(gpointer data)
 		debug_log("capture thread started. waiting for signal");
 
 		g_mutex_lock(player->capture_thread_mutex);
-		g_cond_wait( player->capture_thread_cond, player->capture_thread_mutex );
+
+		/* frame of continuous capture can be queued before waiting */
+		if ( !player->capture_thread_exit &&
+			( !player->continuous_capture || !player->continuous_capture->pending ) )
+			g_cond_wait( player->capture_thread_cond, player->capture_thread_mutex );
 
 		if ( player->capture_thread_exit )
 		{
@@ -200,16 +498,20 @@ __mmplayer_capture_thread(gpointer data)
 		}
 		debug_log("capture thread is recieved signal");
 
+		if ( player->continuous_capture && player->continuous_capture->pending )
+		{
+			__mmplayer_continuous_capture_process(player);
+			g_mutex_unlock(player->capture_thread_mutex);
+			continue;
+		}
+
 		/* NOTE: Don't use MMPLAYER_CMD_LOCK() here.
 		 * Because deadlock can be happened if other player api is used in message callback. 
 		 */
 		if (player->video_cs == MM_PLAYER_COLORSPACE_NV12_TILED)
 		{
-			/* Colorspace conversion : NV12T-> NV12-> RGB888 */
+			/* Colorspace conversion : NV12T-> RGB888 */
 			int ret = 0;
-			int linear_y_plane_size;
-			int linear_uv_plane_size;
-			unsigned char * src_buffer = NULL;
 
 			debug_log("w[0]=%d, w[1]=%d", player->captured.w[0], player->captured.w[1]);
 			debug_log("h[0]=%d, h[1]=%d", player->captured.h[0], player->captured.h[1]);
@@ -229,56 +531,23 @@ __mmplayer_capture_thread(gpointer data)
 				goto ERROR;
 			}
 
-			linear_y_plane_size = (player->captured.w[0] * player->captured.h[0]);
-			linear_uv_plane_size = (player->captured.w[0] * player->captured.h[0]/2);
-
-			linear_y_plane = (unsigned char*) g_try_malloc(linear_y_plane_size);
-			if (linear_y_plane == NULL)
-			{
-				msg.code = MM_ERROR_PLAYER_NO_FREE_SPACE;
-				goto ERROR;
-			}
-
-			linear_uv_plane = (unsigned char*) g_try_malloc(linear_uv_plane_size);
-			if (linear_uv_plane == NULL)
-			{
-				msg.code = MM_ERROR_PLAYER_NO_FREE_SPACE;
-				goto ERROR;
-			}
-			/* NV12 tiled to linear */
-			__csc_tiled_to_linear_crop(linear_y_plane, player->captured.a[0], player->captured.w[0], player->captured.h[0], 0,0,0,0);
-			__csc_tiled_to_linear_crop(linear_uv_plane, player->captured.a[1], player->captured.w[0], player->captured.h[0]/2, 0,0,0,0);
+			/* NV12 tiled to requested format without intermediate linear planes */
+			player->captured.cs = MM_PLAYER_COLORSPACE_NV12_TILED;
+			ret = __mm_player_convert_frame(player, &player->captured);
 
+			/* clean */
 			MMPLAYER_FREEIF(player->captured.a[0]);
 			MMPLAYER_FREEIF(player->captured.a[1]);
 
-			src_buffer = (unsigned char*) g_try_malloc(linear_y_plane_size+linear_uv_plane_size);
-
-			if (src_buffer == NULL)
-			{
-				msg.code = MM_ERROR_PLAYER_NO_FREE_SPACE;
-				goto ERROR;
-			}
-			memset(src_buffer, 0x00, sizeof(linear_y_plane_size+linear_uv_plane_size));
-			memcpy(src_buffer, linear_y_plane, linear_y_plane_size);
-			memcpy(src_buffer+linear_y_plane_size, linear_uv_plane, linear_uv_plane_size);
-
-			/* NV12 linear to RGB888 */
-			ret = __mm_player_convert_colorspace(player, src_buffer, MM_UTIL_IMG_FMT_NV12,
-				player->captured.w[0], player->captured.h[0], MM_UTIL_IMG_FMT_RGB888);
-
 			if (ret != MM_ERROR_NONE)
 			{
-				debug_error("failed to convert nv12 linear");
+				debug_error("failed to convert nv12 tiled");
+				msg.code = ret;
 				goto ERROR;
 			}
-			/* clean */
-			MMPLAYER_FREEIF(src_buffer);
-			MMPLAYER_FREEIF(linear_y_plane);
-			MMPLAYER_FREEIF(linear_uv_plane);
 		}
 
-		player->capture.fmt = MM_PLAYER_COLORSPACE_RGB888;
+		player->capture.fmt = player->capture_fmt;
 		msg.data = &player->capture;
 		msg.size = player->capture.size;
 
@@ -296,8 +565,6 @@ ERROR:
 		if (player->video_cs == MM_PLAYER_COLORSPACE_NV12_TILED)
 		{
 			/* clean */
-			MMPLAYER_FREEIF(linear_y_plane);
-			MMPLAYER_FREEIF(linear_uv_plane);
 			MMPLAYER_FREEIF(player->captured.a[0]);
 			MMPLAYER_FREEIF(player->captured.a[1]);
 		}
@@ -314,7 +581,7 @@ EXIT:
 }
 
 /**
-  * The output is fixed as RGB888
+  * The output is converted to "capture_format" at "capture_width" x "capture_height"
   */
 static int
 __mmplayer_get_video_frame_from_buffer(mm_player_t* player, GstBuffer *buffer)
@@ -323,11 +590,14 @@ __mmplayer_get_video_frame_from_buffer(mm_player_t* player, GstBuffer *buffer)
 	gint uvplane_size = 0;
 	gint src_width = 0;
 	gint src_height = 0;
+	gint dst_width = 0;
+	gint dst_height = 0;
 	guint32 fourcc = 0;
 	GstCaps *caps = NULL;
 	GstStructure *structure = NULL;
 	mm_util_img_format src_fmt = MM_UTIL_IMG_FMT_YUV420;
-	mm_util_img_format dst_fmt = MM_UTIL_IMG_FMT_RGB888; // fixed
+	MMPlayerVideoColorspace src_cs = MM_PLAYER_COLORSPACE_I420;
+	int ret = MM_ERROR_NONE;
 
 	debug_fenter();
 
@@ -394,6 +664,7 @@ __mmplayer_get_video_frame_from_buffer(mm_player_t* player, GstBuffer *buffer)
 			case GST_MAKE_FOURCC ('I', '4', '2', '0'):
 			{
 				src_fmt = MM_UTIL_IMG_FMT_I420;
+				src_cs = MM_PLAYER_COLORSPACE_I420;
 			}
 			break;
 
@@ -406,64 +677,41 @@ __mmplayer_get_video_frame_from_buffer(mm_player_t* player, GstBuffer *buffer)
 	}
 	else if (gst_structure_has_name(structure, "video/x-raw-rgb"))
 	{
-		gint bpp;
-		gint depth;
-		gint endianess;
-		gint blue_mask;
-		gboolean bigendian = FALSE;
-		gboolean isbluefirst = FALSE;
-
-	     /**
-		* The followings will be considered.
-		* RGBx, xRGB, BGRx, xBGR
-		* RGB888, BGR888
-		* RGB565
-		*
-		*/
-		gst_structure_get_int (structure, "bpp", &bpp);
-		gst_structure_get_int (structure, "depth", &depth);
-		gst_structure_get_int (structure, "endianness", &endianess);
-		gst_structure_get_int (structure, "blue_mask", &blue_mask);
-
-		if (endianess == 4321)
-			bigendian = TRUE;
-
-		if (blue_mask == -16777216)
-			isbluefirst = TRUE;
-
-		switch(bpp)
-		{
-			case 32:
-			{
-				switch(depth)
-				{
-					case 32:
-						if (bigendian && isbluefirst)
-							src_fmt = MM_UTIL_IMG_FMT_BGRA8888;
-					case 24:
-						if (bigendian && isbluefirst)
-							src_fmt = MM_UTIL_IMG_FMT_BGRX8888;
-						break;
-					default:
-						goto UNKNOWN;
-						break;
-				}
-			}
-			break;
+		/* only BGRx and BGRA in memory order can be converted */
+		if ( !__mmplayer_get_rgb32_format(structure, &src_fmt) )
+			goto UNKNOWN;
 
-			case 24:
-			default:
-			{
-				goto UNKNOWN;
-			}
-			break;
-		}
+		src_cs = MM_PLAYER_COLORSPACE_BGRA8888;
 	}
 	else
 	{
 		goto UNKNOWN;
 	}
-	__mm_player_convert_colorspace(player, GST_BUFFER_DATA(buffer), src_fmt, src_width, src_height, dst_fmt);
+
+	player->video_cs = src_cs;
+
+	__mmplayer_get_capture_size(player, src_width, src_height, &dst_width, &dst_height);
+
+	if (dst_width == src_width && dst_height == src_height)
+	{
+		/* no scaling. mm_util can do it */
+		ret = __mm_player_convert_colorspace(player, GST_BUFFER_DATA(buffer), src_fmt, src_width, src_height,
+			__mmplayer_get_util_format(player->capture_fmt));
+	}
+	else
+	{
+		MMPlayerMPlaneImage image;
+
+		__mmplayer_fill_image(&image, src_cs, GST_BUFFER_DATA(buffer), src_width, src_height);
+
+		ret = __mm_player_convert_frame(player, &image);
+	}
+
+	if (ret != MM_ERROR_NONE)
+	{
+		debug_error("failed to convert captured frame\n");
+		return ret;
+	}
 
 DONE:
 	/* do convert colorspace */
@@ -507,6 +755,617 @@ __mmplayer_video_capture_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data)
 	return TRUE;
 }
 
+/**
+  * Selects frames to capture and passes them to capture thread.
+  * It never waits for capture thread. frames are dropped if it's busy or
+  * there's no free slot.
+  */
+static gboolean
+__mmplayer_continuous_capture_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data)
+{
+	mm_player_t* player = (mm_player_t*) u_data;
+	MMPlayerContinuousCapture *cc = NULL;
+	GstClockTime ts = GST_BUFFER_TIMESTAMP(buffer);
+	int i = 0;
+
+	return_val_if_fail ( player && buffer, TRUE );
+
+	/* counters are kept with continuous capture lock since capture mutex
+	 * is held by capture thread while converting.
+	 */
+	g_mutex_lock(player->continuous_capture_lock);
+
+	cc = player->continuous_capture;
+	if ( !cc )
+		goto EXIT;
+
+	cc->frame_count++;
+
+	if (cc->interval > 0)
+	{
+		if ((cc->frame_count - 1) % cc->interval)
+			goto EXIT;
+	}
+	else if (GST_CLOCK_TIME_IS_VALID(ts))
+	{
+		/* restart after seeking backward */
+		if (GST_CLOCK_TIME_IS_VALID(cc->last_ts) && ts < cc->last_ts)
+			cc->next_ts = GST_CLOCK_TIME_NONE;
+
+		cc->last_ts = ts;
+
+		if (GST_CLOCK_TIME_IS_VALID(cc->next_ts) && ts < cc->next_ts)
+			goto EXIT;
+
+		/* keep the rate without accumulating lateness */
+		if (GST_CLOCK_TIME_IS_VALID(cc->next_ts) && ts < cc->next_ts + cc->period)
+			cc->next_ts += cc->period;
+		else
+			cc->next_ts = ts + cc->period;
+	}
+
+	/* never wait for capture thread. stop can't free cc meanwhile
+	 * since it takes capture mutex before continuous capture lock.
+	 */
+	if ( !g_mutex_trylock(player->capture_thread_mutex) )
+	{
+		debug_log("capture thread is converting. drop it\n");
+		cc->dropped++;
+		goto EXIT;
+	}
+
+	if (cc->pending)
+	{
+		debug_log("capture thread is busy. drop it\n");
+		cc->dropped++;
+		g_mutex_unlock(player->capture_thread_mutex);
+		goto EXIT;
+	}
+
+	/* find a slot released by application */
+	for (i = 0; i < cc->slot_count; i++)
+	{
+		int slot = (cc->next_slot + i) % cc->slot_count;
+
+		if ( !g_atomic_int_get(&cc->slots[slot].in_use) )
+		{
+			g_atomic_int_set(&cc->slots[slot].in_use, 1);
+			cc->pending_slot = slot;
+			cc->next_slot = (slot + 1) % cc->slot_count;
+			cc->pending = gst_buffer_ref(buffer);
+			break;
+		}
+	}
+
+	if (cc->pending)
+	{
+		g_cond_signal(player->capture_thread_cond);
+	}
+	else
+	{
+		debug_log("no free slot. drop it\n");
+		cc->dropped++;
+	}
+
+	g_mutex_unlock(player->capture_thread_mutex);
+
+EXIT:
+	g_mutex_unlock(player->continuous_capture_lock);
+	return TRUE;
+}
+
+/**
+  * Converts pending buffer of continuous capture into its slot and delivers it.
+  * It's called in capture thread with capture mutex, which is released while delivering.
+  * cc can be freed when it returns.
+  */
+static void
+__mmplayer_continuous_capture_process(mm_player_t* player)
+{
+	MMPlayerContinuousCapture *cc = player->continuous_capture;
+	MMPlayerCaptureSlot *slot = &cc->slots[cc->pending_slot];
+	MMPlayerMPlaneImage image;
+	MMPlayerCscParam param = {0, };
+	GstClockTime ts = GST_BUFFER_TIMESTAMP(cc->pending);
+	int size = 0;
+
+	if ( _mmplayer_get_image_from_buffer(cc->pending, &image) != MM_ERROR_NONE )
+		goto DROP;
+
+	param.src = &image;
+	param.dst_fmt = player->capture_fmt;
+	__mmplayer_get_capture_size(player, image.w[0], image.h[0], &param.dst_w, &param.dst_h);
+
+	size = _mmplayer_csc_get_image_size(param.dst_fmt, param.dst_w, param.dst_h);
+
+	/* video size is changed */
+	if (slot->capacity < size)
+	{
+		MMPLAYER_FREEIF(slot->frame.image.data);
+		slot->capacity = 0;
+
+		slot->frame.image.data = (unsigned char*) g_try_malloc(size);
+		if ( !slot->frame.image.data )
+		{
+			debug_error("no free space for capture slot\n");
+			goto DROP;
+		}
+		slot->capacity = size;
+	}
+
+	param.dst = slot->frame.image.data;
+
+	if ( _mmplayer_csc_convert(&param) != MM_ERROR_NONE )
+		goto DROP;
+
+	gst_buffer_unref(cc->pending);
+	cc->pending = NULL;
+
+	slot->frame.image.size = size;
+	slot->frame.image.fmt = param.dst_fmt;
+	slot->frame.width = param.dst_w;
+	slot->frame.height = param.dst_h;
+	slot->frame.timestamp = GST_CLOCK_TIME_IS_VALID(ts) ? GST_TIME_AS_MSECONDS(ts) : 0;
+
+	g_mutex_lock(player->continuous_capture_lock);
+	slot->frame.dropped = cc->dropped;
+	g_mutex_unlock(player->continuous_capture_lock);
+
+	/* NOTE : capture mutex is released while callback is called.
+	 * application may stop capture or release frames in it.
+	 */
+	cc->delivering = TRUE;
+	g_mutex_unlock(player->capture_thread_mutex);
+
+	cc->callback(&slot->frame, cc->user_param);
+
+	g_mutex_lock(player->capture_thread_mutex);
+	cc->delivering = FALSE;
+
+	if (cc->stopped)
+	{
+		debug_log("free continuous capture stopped in callback\n");
+		__mmplayer_continuous_capture_free(cc);
+	}
+
+	return;
+
+DROP:
+	debug_error("failed to capture frame. drop it\n");
+
+	gst_buffer_unref(cc->pending);
+	cc->pending = NULL;
+
+	g_mutex_lock(player->continuous_capture_lock);
+	cc->dropped++;
+	g_mutex_unlock(player->continuous_capture_lock);
+
+	g_atomic_int_set(&slot->in_use, 0);
+}
+
+static void
+__mmplayer_continuous_capture_free(MMPlayerContinuousCapture *cc)
+{
+	int i = 0;
+
+	return_if_fail ( cc );
+
+	if (cc->pad)
+	{
+		if (cc->probe_id)
+			gst_pad_remove_buffer_probe(cc->pad, cc->probe_id);
+		gst_object_unref(cc->pad);
+	}
+
+	if (cc->pending)
+		gst_buffer_unref(cc->pending);
+
+	if (cc->slots)
+	{
+		for (i = 0; i < cc->slot_count; i++)
+			MMPLAYER_FREEIF(cc->slots[i].frame.image.data);
+
+		MMPLAYER_FREEIF(cc->slots);
+	}
+
+	g_free(cc);
+}
+
+int
+_mmplayer_get_image_from_buffer(GstBuffer *buffer, MMPlayerMPlaneImage *image)
+{
+	GstCaps *caps = NULL;
+	GstStructure *structure = NULL;
+	guint32 fourcc = 0;
+	gint width = 0;
+	gint height = 0;
+
+	return_val_if_fail ( buffer && image, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	caps = GST_BUFFER_CAPS(buffer);
+	return_val_if_fail ( caps, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	structure = gst_caps_get_structure (caps, 0);
+	return_val_if_fail ( structure, MM_ERROR_PLAYER_INTERNAL );
+
+	gst_structure_get_int (structure, "width", &width);
+	gst_structure_get_int (structure, "height", &height);
+
+	if (gst_structure_has_name(structure, "video/x-raw-yuv"))
+	{
+		gst_structure_get_fourcc (structure, "format", &fourcc);
+
+		if (fourcc == GST_MAKE_FOURCC ('S', 'T', '1', '2'))
+		{
+			MMPlayerMPlaneImage *proved = (MMPlayerMPlaneImage *)GST_BUFFER_MALLOCDATA(buffer);
+
+			if ( !proved || !proved->a[0] || !proved->a[1] )
+				return MM_ERROR_PLAYER_INTERNAL;
+
+			memcpy(image, proved, sizeof(MMPlayerMPlaneImage));
+			image->cs = MM_PLAYER_COLORSPACE_NV12_TILED;
+			image->w[0] = width;
+			image->h[0] = height;
+			return MM_ERROR_NONE;
+		}
+		else if (fourcc == GST_MAKE_FOURCC ('I', '4', '2', '0'))
+		{
+			__mmplayer_fill_image(image, MM_PLAYER_COLORSPACE_I420, GST_BUFFER_DATA(buffer), width, height);
+			return MM_ERROR_NONE;
+		}
+		else if (fourcc == GST_MAKE_FOURCC ('N', 'V', '1', '2'))
+		{
+			__mmplayer_fill_image(image, MM_PLAYER_COLORSPACE_NV12, GST_BUFFER_DATA(buffer), width, height);
+			return MM_ERROR_NONE;
+		}
+	}
+	else if (gst_structure_has_name(structure, "video/x-raw-rgb"))
+	{
+		mm_util_img_format fmt = MM_UTIL_IMG_FMT_BGRX8888;
+
+		/* BGRx and BGRA */
+		if ( __mmplayer_get_rgb32_format(structure, &fmt) )
+		{
+			__mmplayer_fill_image(image, MM_PLAYER_COLORSPACE_BGRA8888, GST_BUFFER_DATA(buffer), width, height);
+			return MM_ERROR_NONE;
+		}
+	}
+
+	debug_error("unknown format to capture\n");
+	return MM_ERROR_PLAYER_INTERNAL;
+}
+
+/**
+  * Checks 32bit rgb caps is B, G, R, x in memory, regardless of endianness.
+  * fmt is set to BGRA8888 if alpha is used or BGRX8888 otherwise.
+  */
+static gboolean
+__mmplayer_get_rgb32_format(GstStructure *structure, mm_util_img_format *fmt)
+{
+	gint bpp = 0;
+	gint depth = 0;
+	gint endianess = 0;
+	gint red_mask = 0;
+	gint green_mask = 0;
+	gint blue_mask = 0;
+	guint32 b = 0, g = 0, r = 0;
+
+	return_val_if_fail ( structure && fmt, FALSE );
+
+	if ( !gst_structure_get_int (structure, "bpp", &bpp) ||
+		!gst_structure_get_int (structure, "depth", &depth) ||
+		!gst_structure_get_int (structure, "endianness", &endianess) ||
+		!gst_structure_get_int (structure, "red_mask", &red_mask) ||
+		!gst_structure_get_int (structure, "green_mask", &green_mask) ||
+		!gst_structure_get_int (structure, "blue_mask", &blue_mask) )
+		return FALSE;
+
+	if (bpp != 32 || (depth != 24 && depth != 32))
+		goto UNSUPPORTED;
+
+	/* masks of first, second and third byte in memory */
+	if (endianess == G_BIG_ENDIAN)
+	{
+		b = 0xff000000; g = 0x00ff0000; r = 0x0000ff00;
+	}
+	else if (endianess == G_LITTLE_ENDIAN)
+	{
+		b = 0x000000ff; g = 0x0000ff00; r = 0x00ff0000;
+	}
+	else
+	{
+		goto UNSUPPORTED;
+	}
+
+	if ((guint32)blue_mask != b || (guint32)green_mask != g || (guint32)red_mask != r)
+		goto UNSUPPORTED;
+
+	*fmt = (depth == 32) ? MM_UTIL_IMG_FMT_BGRA8888 : MM_UTIL_IMG_FMT_BGRX8888;
+
+	return TRUE;
+
+UNSUPPORTED:
+	debug_error("unsupported rgb layout. bpp(%d) depth(%d) endianness(%d) masks(%08x %08x %08x)\n",
+		bpp, depth, endianess, red_mask, green_mask, blue_mask);
+	return FALSE;
+}
+
+/**
+  * Fills planes of contiguous I420, NV12 or BGRx frame of gstreamer.
+  */
+static void
+__mmplayer_fill_image(MMPlayerMPlaneImage *image, MMPlayerVideoColorspace cs, unsigned char *data, int width, int height)
+{
+	memset(image, 0x00, sizeof(MMPlayerMPlaneImage));
+
+	image->cs = cs;
+	image->w[0] = width;
+	image->h[0] = height;
+	image->a[0] = data;
+
+	if (cs == MM_PLAYER_COLORSPACE_I420)
+	{
+		/* strides of I420 in gstreamer */
+		image->s[0] = GST_ROUND_UP_4(width);
+		image->s[1] = image->s[2] = GST_ROUND_UP_8(width) / 2;
+		image->a[1] = data + image->s[0] * GST_ROUND_UP_2(height);
+		image->a[2] = (unsigned char*)image->a[1] + image->s[1] * (GST_ROUND_UP_2(height) / 2);
+	}
+	else if (cs == MM_PLAYER_COLORSPACE_NV12)
+	{
+		/* interleaved chroma has the same stride with luma */
+		image->s[0] = image->s[1] = GST_ROUND_UP_4(width);
+		image->a[1] = data + image->s[0] * GST_ROUND_UP_2(height);
+	}
+	else
+	{
+		image->s[0] = width * 4;
+	}
+}
+
+static void
+__mmplayer_extractor_pad_added(GstElement *element, GstPad *pad, gpointer data)
+{
+	MMPlayerFrameExtractor *extractor = (MMPlayerFrameExtractor *) data;
+	GstCaps *caps = NULL;
+	GstStructure *str = NULL;
+	GstElement *fakesink = NULL;
+	GstPad *sinkpad = NULL;
+	const gchar *name = NULL;
+
+	return_if_fail ( extractor && pad );
+
+	caps = gst_pad_get_caps(pad);
+	if ( !caps )
+		return;
+
+	str = gst_caps_get_structure(caps, 0);
+	name = str ? gst_structure_get_name(str) : NULL;
+
+	/* converter is added with the first video pad */
+	if ( name && g_str_has_prefix(name, "video/x-raw") && !extractor->conv )
+	{
+		sinkpad = __mmplayer_extractor_add_converter(extractor, caps);
+
+		debug_log("linking video pad to frame extractor\n");
+		if ( !sinkpad || GST_PAD_LINK(pad, sinkpad) != GST_PAD_LINK_OK )
+			debug_error("failed to link video pad to frame extractor\n");
+	}
+	else
+	{
+		/* other streams are not needed. drop them not to block demuxer */
+		fakesink = gst_element_factory_make("fakesink", NULL);
+		if ( fakesink )
+		{
+			g_object_set(G_OBJECT(fakesink), "sync", FALSE, "async", FALSE, NULL);
+			gst_bin_add(GST_BIN(extractor->pipeline), fakesink);
+			gst_element_sync_state_with_parent(fakesink);
+
+			sinkpad = gst_element_get_static_pad(fakesink, "sink");
+			GST_PAD_LINK(pad, sinkpad);
+		}
+	}
+
+	if ( sinkpad )
+		gst_object_unref(sinkpad);
+
+	gst_caps_unref(caps);
+}
+
+/* converter is chosen by output of decoder in this pipeline, which can differ from the player's */
+static GstPad*
+__mmplayer_extractor_add_converter(MMPlayerFrameExtractor *extractor, GstCaps *caps)
+{
+	const gchar *vconv_factory = "ffmpegcolorspace";
+	gchar *caps_type = NULL;
+
+	return_val_if_fail ( extractor && caps, NULL );
+
+	/* NOTE : tiled output of hw decoder can be converted by fimcconvert only */
+	caps_type = gst_caps_to_string(caps);
+	if ( caps_type && g_strrstr(caps_type, "ST12") )
+		vconv_factory = "fimcconvert";
+	else if (strlen(PLAYER_INI()->name_of_video_converter) > 0)
+		vconv_factory = PLAYER_INI()->name_of_video_converter;
+	MMPLAYER_FREEIF(caps_type);
+
+	debug_log("%s is used for frame extractor\n", vconv_factory);
+
+	extractor->conv = gst_element_factory_make(vconv_factory, "extractor_conv");
+	if ( !extractor->conv )
+	{
+		debug_error("failed to create %s for frame extractor\n", vconv_factory);
+		return NULL;
+	}
+
+	gst_bin_add(GST_BIN(extractor->pipeline), extractor->conv);
+
+	if ( !GST_ELEMENT_LINK(extractor->conv, extractor->scale) )
+	{
+		debug_error("failed to link converter of frame extractor\n");
+		return NULL;
+	}
+
+	gst_element_sync_state_with_parent(extractor->conv);
+
+	return gst_element_get_static_pad(extractor->conv, "sink");
+}
+
+/**
+  * FRAME EXTRACTOR
+  * - uridecodebin ! videoconvertor ! videoscale ! capsfilter(RGB888) ! appsink
+  * videoconvertor is added when decoded video pad is found
+  */
+static int
+__mmplayer_extractor_create(mm_player_t* player, MMPlayerFrameExtractor *extractor, const gchar *uri, int width, int height)
+{
+	GstCaps *caps = NULL;
+
+	return_val_if_fail ( player && extractor && uri, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	extractor->pipeline = gst_pipeline_new("frame_extractor");
+	extractor->src = gst_element_factory_make("uridecodebin", "extractor_src");
+	extractor->scale = gst_element_factory_make("videoscale", "extractor_scale");
+	extractor->filter = gst_element_factory_make("capsfilter", "extractor_filter");
+	extractor->sink = gst_element_factory_make("appsink", "extractor_sink");
+
+	if ( !extractor->pipeline || !extractor->src ||
+		!extractor->scale || !extractor->filter || !extractor->sink )
+	{
+		debug_error("failed to create elements of frame extractor\n");
+		goto ERROR;
+	}
+
+	g_object_set(G_OBJECT(extractor->src), "uri", uri, NULL);
+
+	/* same output with video capture */
+	caps = gst_caps_new_simple("video/x-raw-rgb",
+							"bpp", G_TYPE_INT, 24,
+							"depth", G_TYPE_INT, 24,
+							"endianness", G_TYPE_INT, G_BIG_ENDIAN,
+							"red_mask", G_TYPE_INT, 0xff0000,
+							"green_mask", G_TYPE_INT, 0x00ff00,
+							"blue_mask", G_TYPE_INT, 0x0000ff,
+							"width", G_TYPE_INT, width,
+							"height", G_TYPE_INT, height,
+							"pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+							NULL);
+	g_object_set(G_OBJECT(extractor->filter), "caps", caps, NULL);
+	gst_caps_unref(caps);
+
+	/* keep one decoded frame only. we don't need to sync on clock */
+	g_object_set(G_OBJECT(extractor->sink), "sync", FALSE, "max-buffers", 1, "drop", TRUE, NULL);
+
+	gst_bin_add_many(GST_BIN(extractor->pipeline), extractor->src,
+		extractor->scale, extractor->filter, extractor->sink, NULL);
+
+	if ( !GST_ELEMENT_LINK_MANY(extractor->scale, extractor->filter, extractor->sink, NULL) )
+	{
+		debug_error("failed to link elements of frame extractor\n");
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	g_signal_connect(G_OBJECT(extractor->src), "pad-added",
+		G_CALLBACK(__mmplayer_extractor_pad_added), extractor);
+
+	return MM_ERROR_NONE;
+
+ERROR:
+	/* elements are not added to bin yet */
+	if ( extractor->src )
+		gst_object_unref(GST_OBJECT(extractor->src));
+	if ( extractor->scale )
+		gst_object_unref(GST_OBJECT(extractor->scale));
+	if ( extractor->filter )
+		gst_object_unref(GST_OBJECT(extractor->filter));
+	if ( extractor->sink )
+		gst_object_unref(GST_OBJECT(extractor->sink));
+	if ( extractor->pipeline )
+		gst_object_unref(GST_OBJECT(extractor->pipeline));
+
+	memset(extractor, 0x00, sizeof(MMPlayerFrameExtractor));
+
+	return MM_ERROR_PLAYER_INTERNAL;
+}
+
+static void
+__mmplayer_extractor_destroy(MMPlayerFrameExtractor *extractor)
+{
+	return_if_fail ( extractor );
+
+	if ( extractor->pipeline )
+	{
+		gst_element_set_state(extractor->pipeline, GST_STATE_NULL);
+		gst_object_unref(GST_OBJECT(extractor->pipeline));
+	}
+
+	memset(extractor, 0x00, sizeof(MMPlayerFrameExtractor));
+}
+
+static int
+__mmplayer_extractor_get_frame(MMPlayerFrameExtractor *extractor, int position, int width, int height, gint timeout, MMPlayerVideoCapture *frame)
+{
+	GstBuffer *buffer = NULL;
+	guint src_stride = 0;
+	guint dst_stride = 0;
+	gint y = 0;
+
+	return_val_if_fail ( extractor && extractor->pipeline && frame, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	/* NOTE : key unit seek makes decoder to decode one key frame only,
+	 * which is enough for thumbnails and storyboards.
+	 */
+	if ( !gst_element_seek(extractor->pipeline, 1.0, GST_FORMAT_TIME,
+			( GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT ),
+			GST_SEEK_TYPE_SET, (gint64)position * GST_MSECOND,
+			GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE) )
+	{
+		debug_error("failed to seek to %d msec\n", position);
+		return MM_ERROR_PLAYER_SEEK;
+	}
+
+	if ( gst_element_get_state(extractor->pipeline, NULL, NULL, timeout * GST_SECOND) != GST_STATE_CHANGE_SUCCESS )
+	{
+		debug_error("failed to preroll at %d msec\n", position);
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	buffer = gst_app_sink_pull_preroll(GST_APP_SINK(extractor->sink));
+	if ( !buffer )
+	{
+		debug_error("no frame at %d msec\n", position);
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	/* rows of 24bit rgb buffer are aligned to 4 bytes in gstreamer */
+	src_stride = GST_ROUND_UP_4(width * 3);
+	dst_stride = width * 3;
+
+	if ( GST_BUFFER_SIZE(buffer) < src_stride * height )
+	{
+		debug_error("unexpected frame size %d\n", GST_BUFFER_SIZE(buffer));
+		gst_buffer_unref(buffer);
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	frame->data = (unsigned char*) g_try_malloc(dst_stride * height);
+	if ( !frame->data )
+	{
+		gst_buffer_unref(buffer);
+		return MM_ERROR_PLAYER_NO_FREE_SPACE;
+	}
+
+	for ( y = 0; y < height; y++ )
+		memcpy(frame->data + y * dst_stride, GST_BUFFER_DATA(buffer) + y * src_stride, dst_stride);
+
+	frame->size = dst_stride * height;
+	frame->fmt = MM_PLAYER_COLORSPACE_RGB888;
+
+	gst_buffer_unref(buffer);
+
+	return MM_ERROR_NONE;
+}
+
 static int
 __mm_player_convert_colorspace(mm_player_t* player, unsigned char* src_data, mm_util_img_format src_fmt, unsigned int src_w, unsigned int src_h, mm_util_img_format dst_fmt)
 {
@@ -547,255 +1406,119 @@ __mm_player_convert_colorspace(mm_player_t* player, unsigned char* src_data, mm_
 	return MM_ERROR_NONE;
 }
 
-/*
- * Get tiled address of position(x,y)
- *
- * @param x_size
- *   width of tiled[in]
- *
- * @param y_size
- *   height of tiled[in]
- *
- * @param x_pos
- *   x position of tield[in]
- *
- * @param src_size
- *   y position of tield[in]
- *
- * @return
- *   address of tiled data
- */
-static int
-__tile_4x2_read(int x_size, int y_size, int x_pos, int y_pos)
+static mm_util_img_format
+__mmplayer_get_util_format(MMPlayerVideoColorspace fmt)
 {
-    int pixel_x_m1, pixel_y_m1;
-    int roundup_x, roundup_y;
-    int linear_addr0, linear_addr1, bank_addr ;
-    int x_addr;
-    int trans_addr;
-
-    pixel_x_m1 = x_size -1;
-    pixel_y_m1 = y_size -1;
-
-    roundup_x = ((pixel_x_m1 >> 7) + 1);
-    roundup_y = ((pixel_x_m1 >> 6) + 1);
-
-    x_addr = x_pos >> 2;
-
-    if ((y_size <= y_pos+32) && ( y_pos < y_size) &&
-        (((pixel_y_m1 >> 5) & 0x1) == 0) && (((y_pos >> 5) & 0x1) == 0)) {
-        linear_addr0 = (((y_pos & 0x1f) <<4) | (x_addr & 0xf));
-        linear_addr1 = (((y_pos >> 6) & 0xff) * roundup_x + ((x_addr >> 6) & 0x3f));
-
-        if (((x_addr >> 5) & 0x1) == ((y_pos >> 5) & 0x1))
-            bank_addr = ((x_addr >> 4) & 0x1);
-        else
-            bank_addr = 0x2 | ((x_addr >> 4) & 0x1);
-    } else {
-        linear_addr0 = (((y_pos & 0x1f) << 4) | (x_addr & 0xf));
-        linear_addr1 = (((y_pos >> 6) & 0xff) * roundup_x + ((x_addr >> 5) & 0x7f));
-
-        if (((x_addr >> 5) & 0x1) == ((y_pos >> 5) & 0x1))
-            bank_addr = ((x_addr >> 4) & 0x1);
-        else
-            bank_addr = 0x2 | ((x_addr >> 4) & 0x1);
-    }
-
-    linear_addr0 = linear_addr0 << 2;
-    trans_addr = (linear_addr1 <<13) | (bank_addr << 11) | linear_addr0;
-
-    return trans_addr;
+	switch (fmt)
+	{
+		case MM_PLAYER_COLORSPACE_I420:
+			return MM_UTIL_IMG_FMT_I420;
+		case MM_PLAYER_COLORSPACE_NV12:
+			return MM_UTIL_IMG_FMT_NV12;
+		case MM_PLAYER_COLORSPACE_BGRA8888:
+			return MM_UTIL_IMG_FMT_BGRA8888;
+		case MM_PLAYER_COLORSPACE_RGB888:
+		default:
+			return MM_UTIL_IMG_FMT_RGB888;
+	}
 }
 
-/*
- * Converts tiled data to linear
- * Crops left, top, right, buttom
- * 1. Y of NV12T to Y of YUV420P
- * 2. Y of NV12T to Y of YUV420S
- * 3. UV of NV12T to UV of YUV420S
- *
- * @param yuv420_dest
- *   Y or UV plane address of YUV420[out]
- *
- * @param nv12t_src
- *   Y or UV plane address of NV12T[in]
- *
- * @param yuv420_width
- *   Width of YUV420[in]
- *
- * @param yuv420_height
- *   Y: Height of YUV420, UV: Height/2 of YUV420[in]
- *
- * @param left
- *   Crop size of left
- *
- * @param top
- *   Crop size of top
- *
- * @param right
- *   Crop size of right
- *
- * @param buttom
- *   Crop size of buttom
- */
 static void
-__csc_tiled_to_linear_crop(unsigned char *yuv420_dest, unsigned char *nv12t_src, int yuv420_width, int yuv420_height,
-                                int left, int top, int right, int buttom)
+__mmplayer_update_capture_param(mm_player_t* player)
+{
+	int fmt = MM_PLAYER_COLORSPACE_RGB888;
+
+	mm_attrs_get_int_by_name(player->attrs, "capture_format", &fmt);
+	mm_attrs_get_int_by_name(player->attrs, "capture_width", &player->capture_width);
+	mm_attrs_get_int_by_name(player->attrs, "capture_height", &player->capture_height);
+
+	/* tiled format is meaningful for hw codec only */
+	if (fmt == MM_PLAYER_COLORSPACE_NV12_TILED)
+	{
+		debug_warning("NV12 tiled can't be used for capture. RGB888 is used\n");
+		fmt = MM_PLAYER_COLORSPACE_RGB888;
+	}
+
+	player->capture_fmt = fmt;
+
+	debug_log("capture format: %d, size: %dx%d\n", player->capture_fmt, player->capture_width, player->capture_height);
+}
+
+/**
+  * Gets the size of captured image from "capture_width" and "capture_height".
+  * If one of them is 0, it's calculated from the other keeping aspect ratio.
+  * YUV formats are rounded down to even size for sub-sampled chroma.
+  */
+static void
+__mmplayer_get_capture_size(mm_player_t* player, int src_w, int src_h, int *dst_w, int *dst_h)
 {
-    int i, j;
-    int tiled_offset = 0, tiled_offset1 = 0;
-    int linear_offset = 0;
-    int temp1 = 0, temp2 = 0, temp3 = 0, temp4 = 0;
-
-    temp3 = yuv420_width-right;
-    temp1 = temp3-left;
-    /* real width is greater than or equal 256 */
-    if (temp1 >= 256) {
-        for (i=top; i<yuv420_height-buttom; i=i+1) {
-            j = left;
-            temp3 = (j>>8)<<8;
-            temp3 = temp3>>6;
-            temp4 = i>>5;
-            if (temp4 & 0x1) {
-                /* odd fomula: 2+x+(x>>2)<<2+x_block_num*(y-1) */
-                tiled_offset = temp4-1;
-                temp1 = ((yuv420_width+127)>>7)<<7;
-                tiled_offset = tiled_offset*(temp1>>6);
-                tiled_offset = tiled_offset+temp3;
-                tiled_offset = tiled_offset+2;
-                temp1 = (temp3>>2)<<2;
-                tiled_offset = tiled_offset+temp1;
-                tiled_offset = tiled_offset<<11;
-                tiled_offset1 = tiled_offset+2048*2;
-                temp4 = 8;
-            } else {
-                temp2 = ((yuv420_height+31)>>5)<<5;
-                if ((i+32)<temp2) {
-                    /* even1 fomula: x+((x+2)>>2)<<2+x_block_num*y */
-                    temp1 = temp3+2;
-                    temp1 = (temp1>>2)<<2;
-                    tiled_offset = temp3+temp1;
-                    temp1 = ((yuv420_width+127)>>7)<<7;
-                    tiled_offset = tiled_offset+temp4*(temp1>>6);
-                    tiled_offset = tiled_offset<<11;
-                    tiled_offset1 = tiled_offset+2048*6;
-                    temp4 = 8;
-                } else {
-                    /* even2 fomula: x+x_block_num*y */
-                    temp1 = ((yuv420_width+127)>>7)<<7;
-                    tiled_offset = temp4*(temp1>>6);
-                    tiled_offset = tiled_offset+temp3;
-                    tiled_offset = tiled_offset<<11;
-                    tiled_offset1 = tiled_offset+2048*2;
-                    temp4 = 4;
-                }
-            }
-
-            temp1 = i&0x1F;
-            tiled_offset = tiled_offset+64*(temp1);
-            tiled_offset1 = tiled_offset1+64*(temp1);
-            temp2 = yuv420_width-left-right;
-            linear_offset = temp2*(i-top);
-            temp3 = ((j+256)>>8)<<8;
-            temp3 = temp3-j;
-            temp1 = left&0x3F;
-            if (temp3 > 192) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset+temp1, 64-temp1);
-                temp2 = ((left+63)>>6)<<6;
-                temp3 = ((yuv420_width-right)>>6)<<6;
-                if (temp2 == temp3) {
-                    temp2 = yuv420_width-right-(64-temp1);
-                }
-                memcpy(yuv420_dest+linear_offset+64-temp1, nv12t_src+tiled_offset+2048, 64);
-                memcpy(yuv420_dest+linear_offset+128-temp1, nv12t_src+tiled_offset1, 64);
-                memcpy(yuv420_dest+linear_offset+192-temp1, nv12t_src+tiled_offset1+2048, 64);
-                linear_offset = linear_offset+256-temp1;
-            } else if (temp3 > 128) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset+2048+temp1, 64-temp1);
-                memcpy(yuv420_dest+linear_offset+64-temp1, nv12t_src+tiled_offset1, 64);
-                memcpy(yuv420_dest+linear_offset+128-temp1, nv12t_src+tiled_offset1+2048, 64);
-                linear_offset = linear_offset+192-temp1;
-            } else if (temp3 > 64) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset1+temp1, 64-temp1);
-                memcpy(yuv420_dest+linear_offset+64-temp1, nv12t_src+tiled_offset1+2048, 64);
-                linear_offset = linear_offset+128-temp1;
-            } else if (temp3 > 0) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset1+2048+temp1, 64-temp1);
-                linear_offset = linear_offset+64-temp1;
-            }
-
-            tiled_offset = tiled_offset+temp4*2048;
-            j = (left>>8)<<8;
-            j = j + 256;
-            temp2 = yuv420_width-right-256;
-            for (; j<=temp2; j=j+256) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
-                tiled_offset1 = tiled_offset1+temp4*2048;
-                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, 64);
-                memcpy(yuv420_dest+linear_offset+128, nv12t_src+tiled_offset1, 64);
-                tiled_offset = tiled_offset+temp4*2048;
-                memcpy(yuv420_dest+linear_offset+192, nv12t_src+tiled_offset1+2048, 64);
-                linear_offset = linear_offset+256;
-            }
-
-            tiled_offset1 = tiled_offset1+temp4*2048;
-            temp2 = yuv420_width-right-j;
-            if (temp2 > 192) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
-                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, 64);
-                memcpy(yuv420_dest+linear_offset+128, nv12t_src+tiled_offset1, 64);
-                memcpy(yuv420_dest+linear_offset+192, nv12t_src+tiled_offset1+2048, temp2-192);
-            } else if (temp2 > 128) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
-                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, 64);
-                memcpy(yuv420_dest+linear_offset+128, nv12t_src+tiled_offset1, temp2-128);
-            } else if (temp2 > 64) {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
-                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, temp2-64);
-            } else {
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, temp2);
-            }
-        }
-    } else if (temp1 >= 64) {
-        for (i=top; i<(yuv420_height-buttom); i=i+1) {
-            j = left;
-            tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
-            temp2 = ((j+64)>>6)<<6;
-            temp2 = temp2-j;
-            linear_offset = temp1*(i-top);
-            temp4 = j&0x3;
-            tiled_offset = tiled_offset+temp4;
-            memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, temp2);
-            linear_offset = linear_offset+temp2;
-            j = j+temp2;
-            if ((j+64) <= temp3) {
-                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
-                linear_offset = linear_offset+64;
-                j = j+64;
-            }
-            if ((j+64) <= temp3) {
-                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
-                linear_offset = linear_offset+64;
-                j = j+64;
-            }
-            if (j < temp3) {
-                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
-                temp2 = temp3-j;
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, temp2);
-            }
-        }
-    } else {
-        for (i=top; i<(yuv420_height-buttom); i=i+1) {
-            linear_offset = temp1*(i-top);
-            for (j=left; j<(yuv420_width-right); j=j+2) {
-                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
-                temp4 = j&0x3;
-                tiled_offset = tiled_offset+temp4;
-                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 2);
-                linear_offset = linear_offset+2;
-            }
-        }
-    }
+	int w = player->capture_width;
+	int h = player->capture_height;
+
+	if ( w <= 0 && h <= 0 )
+	{
+		w = src_w;
+		h = src_h;
+	}
+	else if ( w <= 0 )
+	{
+		w = (int)(((gint64)src_w * h) / src_h);
+	}
+	else if ( h <= 0 )
+	{
+		h = (int)(((gint64)src_h * w) / src_w);
+	}
+
+	if ( player->capture_fmt == MM_PLAYER_COLORSPACE_I420 ||
+		player->capture_fmt == MM_PLAYER_COLORSPACE_NV12 )
+	{
+		w &= ~0x1;
+		h &= ~0x1;
+	}
+
+	*dst_w = MAX(w, 2);
+	*dst_h = MAX(h, 2);
+}
+
+/**
+  * Converts and scales a frame to the requested capture format at once.
+  * The source can be NV12 tiled, NV12, I420 or 32bit BGRx.
+  */
+static int
+__mm_player_convert_frame(mm_player_t* player, MMPlayerMPlaneImage *src)
+{
+	MMPlayerCscParam param = {0, };
+	int ret = MM_ERROR_NONE;
+
+	return_val_if_fail(player && src, MM_ERROR_PLAYER_INTERNAL);
+	return_val_if_fail(src->w[0] > 0 && src->h[0] > 0, MM_ERROR_PLAYER_INTERNAL);
+
+	param.src = src;
+	param.dst_fmt = player->capture_fmt;
+	__mmplayer_get_capture_size(player, src->w[0], src->h[0], &param.dst_w, &param.dst_h);
+
+	player->capture.size = _mmplayer_csc_get_image_size(param.dst_fmt, param.dst_w, param.dst_h);
+
+	debug_log("%dx%d to %dx%d(fmt %d), dest size: %d\n",
+		src->w[0], src->h[0], param.dst_w, param.dst_h, param.dst_fmt, player->capture.size);
+
+	param.dst = (unsigned char*) g_try_malloc(player->capture.size);
+	if ( !param.dst )
+	{
+		debug_error("no free space to capture\n");
+		player->capture.size = 0;
+		return MM_ERROR_PLAYER_NO_FREE_SPACE;
+	}
+
+	ret = _mmplayer_csc_convert(&param);
+	if ( ret != MM_ERROR_NONE )
+	{
+		MMPLAYER_FREEIF(param.dst);
+		player->capture.size = 0;
+		return ret;
+	}
+
+	player->capture.data = param.dst;
+
+	return MM_ERROR_NONE;
 }
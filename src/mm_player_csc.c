@@ -0,0 +1,487 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <unistd.h>
+#include <mm_error.h>
+#include <mm_debug.h>
+
+#include "mm_player_csc.h"
+#include "mm_player_tile.h"
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_CSC_ROUND_UP_2(num)	(((num) + 1) & ~1)
+
+#define MMPLAYER_CSC_BAND_MAX		16
+#define MMPLAYER_CSC_BAND_MIN_LINES	64
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS for internal								|
+---------------------------------------------------------------------------*/
+/* conversion of a frame split into bands */
+typedef struct
+{
+	GMutex *lock;
+	GCond *cond;
+	int remaining;					/* bands not finished yet */
+} MMPlayerCscJob;
+
+/* a band of lines converted by a worker */
+typedef struct
+{
+	MMPlayerCscParam *param;
+	int first;
+	int last;
+	int ret;
+	MMPlayerCscJob *job;
+} MMPlayerCscBand;
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static int __csc_convert_lines(MMPlayerCscParam *param, int first, int last);
+static void __csc_convert_band(gpointer data, gpointer user_data);
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS:											|
+---------------------------------------------------------------------------*/
+/* worker pool for conversion shared by players in process */
+static GThreadPool *__csc_pool = NULL;
+static int __csc_pool_threads = 0;
+static int __csc_pool_users = 0;
+static GStaticMutex __csc_pool_lock = G_STATIC_MUTEX_INIT;
+static int __csc_pool_size = 0;			/* threads of pool. 0 for online cores less one */
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+int
+_mmplayer_csc_get_image_size(MMPlayerVideoColorspace fmt, int width, int height)
+{
+	switch (fmt)
+	{
+		case MM_PLAYER_COLORSPACE_I420:
+		case MM_PLAYER_COLORSPACE_NV12:
+			return (width * height * 3) / 2;
+		case MM_PLAYER_COLORSPACE_BGRA8888:
+			return width * height * 4;
+		case MM_PLAYER_COLORSPACE_RGB888:
+		default:
+			return width * height * 3;
+	}
+}
+
+#define CSC_CLIP(x)	((x) < 0 ? 0 : ((x) > 255 ? 255 : (x)))
+
+/* ITU-R BT.601 */
+#define CSC_YUV_TO_RGB(y, u, v, r, g, b) \
+do \
+{ \
+	int c_ = 298 * ((y) - 16) + 128; \
+	int d_ = (u) - 128; \
+	int e_ = (v) - 128; \
+	r = CSC_CLIP((c_ + 409 * e_) >> 8); \
+	g = CSC_CLIP((c_ - 100 * d_ - 208 * e_) >> 8); \
+	b = CSC_CLIP((c_ + 516 * d_) >> 8); \
+} while (0)
+
+#define CSC_RGB_TO_Y(r, g, b)	(((66 * (r) + 129 * (g) + 25 * (b) + 128) >> 8) + 16)
+#define CSC_RGB_TO_U(r, g, b)	(((-38 * (r) - 74 * (g) + 112 * (b) + 128) >> 8) + 128)
+#define CSC_RGB_TO_V(r, g, b)	(((112 * (r) - 94 * (g) - 18 * (b) + 128) >> 8) + 128)
+
+/*
+ * Converts lines of destination from first to last(exclusive)
+ * Source lines are picked by nearest neighbour and only the lines needed are detiled.
+ *
+ * @param param
+ *   source and destination of conversion[in]
+ *
+ * @param first
+ *   first line of destination. it should be even for YUV destination[in]
+ *
+ * @param last
+ *   next line of the last line to convert[in]
+ */
+static int
+__csc_convert_lines(MMPlayerCscParam *param, int first, int last)
+{
+	MMPlayerMPlaneImage *src = param->src;
+	unsigned char *y_line = NULL;
+	unsigned char *uv_line = NULL;
+	const unsigned char *y_src = NULL;
+	const unsigned char *u_src = NULL;
+	const unsigned char *v_src = NULL;
+	const unsigned char *rgb_src = NULL;
+	unsigned char *dst = NULL;
+	int src_w = src->w[0];
+	int src_h = src->h[0];
+	int dst_w = param->dst_w;
+	int dst_h = param->dst_h;
+	unsigned int x_step = ((unsigned int)src_w << 16) / dst_w;
+	int uv_step = 1;
+	int y_row = -1;
+	int uv_row = -1;
+	int i, j;
+
+	if (src->cs == MM_PLAYER_COLORSPACE_NV12_TILED)
+	{
+		/* detiling writes a byte more than odd width */
+		y_line = (unsigned char*) g_try_malloc(MMPLAYER_CSC_ROUND_UP_2(src_w));
+		uv_line = (unsigned char*) g_try_malloc(MMPLAYER_CSC_ROUND_UP_2(src_w));
+
+		if ( !y_line || !uv_line )
+		{
+			debug_error("no free space to detile\n");
+			g_free(y_line);
+			g_free(uv_line);
+			return MM_ERROR_PLAYER_NO_FREE_SPACE;
+		}
+	}
+
+	for (i = first; i < last; i++)
+	{
+		int sy = (int)(((gint64)i * src_h) / dst_h);
+		int r = 0, g = 0, b = 0;
+		int y = 0, u = 0, v = 0;
+
+		/* source line */
+		switch (src->cs)
+		{
+			case MM_PLAYER_COLORSPACE_NV12_TILED:
+				/* detile one line. tile lines of it are copied by simd kernel of this cpu */
+				if (sy != y_row)
+				{
+					_mmplayer_tile_to_linear_line(y_line, src->a[0], src_w, src_h, sy);
+					y_row = sy;
+				}
+
+				/* a chroma line is shared by two luma lines.
+				 * chroma plane has (src_w+1)/2 pairs and (src_h+1)/2 lines, so it's detiled by
+				 * rounded up size not to lose the last column and line of odd size.
+				 * tile layout is same for both since tiled width is aligned to 128.
+				 */
+				if (sy/2 != uv_row)
+				{
+					int uv_h = MMPLAYER_CSC_ROUND_UP_2(src_h) / 2;
+
+					_mmplayer_tile_to_linear_line(uv_line, src->a[1], MMPLAYER_CSC_ROUND_UP_2(src_w), uv_h, sy/2);
+					uv_row = sy/2;
+				}
+
+				y_src = y_line;
+				u_src = uv_line;
+				v_src = uv_line + 1;
+				uv_step = 2;
+				break;
+
+			case MM_PLAYER_COLORSPACE_I420:
+				y_src = (unsigned char*)src->a[0] + sy * src->s[0];
+				u_src = (unsigned char*)src->a[1] + (sy/2) * src->s[1];
+				v_src = (unsigned char*)src->a[2] + (sy/2) * src->s[2];
+				uv_step = 1;
+				break;
+
+			case MM_PLAYER_COLORSPACE_NV12:
+				y_src = (unsigned char*)src->a[0] + sy * src->s[0];
+				u_src = (unsigned char*)src->a[1] + (sy/2) * src->s[1];
+				v_src = u_src + 1;
+				uv_step = 2;
+				break;
+
+			default:
+				rgb_src = (unsigned char*)src->a[0] + sy * src->s[0];
+				break;
+		}
+
+		/* destination line */
+		switch (param->dst_fmt)
+		{
+			case MM_PLAYER_COLORSPACE_I420:
+			case MM_PLAYER_COLORSPACE_NV12:
+			{
+				unsigned char *u_dst = NULL;
+				unsigned char *v_dst = NULL;
+				int c_step = 1;
+
+				/* chroma is written on even lines only */
+				if ( !(i & 0x1) )
+				{
+					if (param->dst_fmt == MM_PLAYER_COLORSPACE_I420)
+					{
+						u_dst = param->dst + (dst_w * dst_h) + (i/2) * (dst_w/2);
+						v_dst = u_dst + (dst_w/2) * (dst_h/2);
+					}
+					else
+					{
+						u_dst = param->dst + (dst_w * dst_h) + (i/2) * dst_w;
+						v_dst = u_dst + 1;
+						c_step = 2;
+					}
+				}
+
+				dst = param->dst + i * dst_w;
+
+				for (j = 0; j < dst_w; j++)
+				{
+					int sx = (j * x_step) >> 16;
+
+					if (rgb_src)
+					{
+						b = rgb_src[sx * 4];
+						g = rgb_src[sx * 4 + 1];
+						r = rgb_src[sx * 4 + 2];
+						y = CSC_RGB_TO_Y(r, g, b);
+						u = CSC_RGB_TO_U(r, g, b);
+						v = CSC_RGB_TO_V(r, g, b);
+					}
+					else
+					{
+						y = y_src[sx];
+						u = u_src[(sx >> 1) * uv_step];
+						v = v_src[(sx >> 1) * uv_step];
+					}
+
+					dst[j] = y;
+
+					if ( u_dst && !(j & 0x1) )
+					{
+						u_dst[(j >> 1) * c_step] = u;
+						v_dst[(j >> 1) * c_step] = v;
+					}
+				}
+			}
+			break;
+
+			case MM_PLAYER_COLORSPACE_BGRA8888:
+			case MM_PLAYER_COLORSPACE_RGB888:
+			default:
+			{
+				int bgra = (param->dst_fmt == MM_PLAYER_COLORSPACE_BGRA8888);
+				int bpp = bgra ? 4 : 3;
+
+				dst = param->dst + i * dst_w * bpp;
+
+				for (j = 0; j < dst_w; j++)
+				{
+					int sx = (j * x_step) >> 16;
+
+					if (rgb_src)
+					{
+						b = rgb_src[sx * 4];
+						g = rgb_src[sx * 4 + 1];
+						r = rgb_src[sx * 4 + 2];
+					}
+					else
+					{
+						y = y_src[sx];
+						u = u_src[(sx >> 1) * uv_step];
+						v = v_src[(sx >> 1) * uv_step];
+						CSC_YUV_TO_RGB(y, u, v, r, g, b);
+					}
+
+					if (bgra)
+					{
+						dst[0] = b;
+						dst[1] = g;
+						dst[2] = r;
+						dst[3] = 0xff;
+					}
+					else
+					{
+						dst[0] = r;
+						dst[1] = g;
+						dst[2] = b;
+					}
+					dst += bpp;
+				}
+			}
+			break;
+		}
+	}
+
+	g_free(y_line);
+	g_free(uv_line);
+
+	return MM_ERROR_NONE;
+}
+
+/**
+  * Converts a band of lines in worker thread of the pool
+  */
+static void
+__csc_convert_band(gpointer data, gpointer user_data)
+{
+	MMPlayerCscBand *band = (MMPlayerCscBand *) data;
+	MMPlayerCscJob *job = band->job;
+
+	band->ret = __csc_convert_lines(band->param, band->first, band->last);
+
+	g_mutex_lock(job->lock);
+	if ( --job->remaining == 0 )
+		g_cond_signal(job->cond);
+	g_mutex_unlock(job->lock);
+}
+
+/**
+  * Splits a frame into bands of even lines and converts them in parallel.
+  * The calling thread converts the first band while the others are in the pool.
+  * Small frames are converted in the calling thread only.
+  */
+int
+_mmplayer_csc_convert(MMPlayerCscParam *param)
+{
+	MMPlayerCscBand bands[MMPLAYER_CSC_BAND_MAX];
+	MMPlayerCscJob job = {0, };
+	GError *err = NULL;
+	int count = 0;
+	int lines = 0;
+	int ret = MM_ERROR_NONE;
+	int i = 0;
+
+	count = MIN(__csc_pool_threads + 1, param->dst_h / MMPLAYER_CSC_BAND_MIN_LINES);
+	count = MIN(count, MMPLAYER_CSC_BAND_MAX);
+
+	if ( !__csc_pool || count < 2 )
+		return __csc_convert_lines(param, 0, param->dst_h);
+
+	/* bands should start on even line for sub-sampled chroma */
+	lines = MMPLAYER_CSC_ROUND_UP_2((param->dst_h + count - 1) / count);
+	count = (param->dst_h + lines - 1) / lines;
+
+	job.lock = g_mutex_new();
+	job.cond = g_cond_new();
+	job.remaining = count - 1;
+
+	for (i = 0; i < count; i++)
+	{
+		bands[i].param = param;
+		bands[i].first = i * lines;
+		bands[i].last = MIN(bands[i].first + lines, param->dst_h);
+		bands[i].ret = MM_ERROR_NONE;
+		bands[i].job = &job;
+	}
+
+	for (i = 1; i < count; i++)
+	{
+		g_thread_pool_push(__csc_pool, &bands[i], &err);
+
+		if (err)
+		{
+			/* convert it here instead */
+			debug_warning("failed to push band to pool. %s", err->message);
+			g_error_free(err);
+			err = NULL;
+
+			__csc_convert_band(&bands[i], NULL);
+		}
+	}
+
+	bands[0].ret = __csc_convert_lines(param, bands[0].first, bands[0].last);
+
+	g_mutex_lock(job.lock);
+	while (job.remaining > 0)
+		g_cond_wait(job.cond, job.lock);
+	g_mutex_unlock(job.lock);
+
+	g_mutex_free(job.lock);
+	g_cond_free(job.cond);
+
+	for (i = 0; i < count; i++)
+	{
+		if (bands[i].ret != MM_ERROR_NONE)
+		{
+			ret = bands[i].ret;
+			break;
+		}
+	}
+
+	debug_log("converted %d lines in %d bands\n", param->dst_h, count);
+
+	return ret;
+}
+
+/**
+  * The conversion pool is created by the first player and shared by all players.
+  * It has a thread less than online cores since the calling thread works too.
+  */
+void
+_mmplayer_csc_pool_ref(void)
+{
+	g_static_mutex_lock(&__csc_pool_lock);
+
+	if ( __csc_pool_users++ == 0 )
+	{
+		long threads = __csc_pool_size ? __csc_pool_size : sysconf(_SC_NPROCESSORS_ONLN) - 1;
+
+		if (threads > 0)
+		{
+			GError *err = NULL;
+
+			__csc_pool = g_thread_pool_new(__csc_convert_band, NULL, threads, FALSE, &err);
+			if (__csc_pool)
+			{
+				__csc_pool_threads = threads;
+				debug_log("conversion pool is created with %d threads", __csc_pool_threads);
+			}
+			else
+			{
+				debug_warning("failed to create conversion pool. %s", err ? err->message : "");
+				if (err)
+					g_error_free(err);
+			}
+		}
+	}
+
+	g_static_mutex_unlock(&__csc_pool_lock);
+}
+
+void
+_mmplayer_csc_pool_unref(void)
+{
+	g_static_mutex_lock(&__csc_pool_lock);
+
+	if ( __csc_pool_users > 0 && --__csc_pool_users == 0 && __csc_pool )
+	{
+		g_thread_pool_free(__csc_pool, FALSE, TRUE);
+		__csc_pool = NULL;
+		__csc_pool_threads = 0;
+		debug_log("conversion pool is released");
+	}
+
+	g_static_mutex_unlock(&__csc_pool_lock);
+}
+
+void
+_mmplayer_csc_set_pool_size(int threads)
+{
+	g_static_mutex_lock(&__csc_pool_lock);
+	__csc_pool_size = MAX(threads, 0);
+	g_static_mutex_unlock(&__csc_pool_lock);
+}
@@ -0,0 +1,235 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* converts capture frames in the calling thread only and with the shared pool,
+ * checks both give the same image and prints latency of each */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <mm_error.h>
+#include "mm_player_csc.h"
+
+typedef struct
+{
+	const char *name;
+	int width;
+	int height;
+}csc_test_size_t;
+
+typedef struct
+{
+	const char *name;
+	MMPlayerVideoColorspace src_fmt;
+	MMPlayerVideoColorspace dst_fmt;
+}csc_test_format_t;
+
+static const csc_test_size_t sizes[] =
+{
+	{ "720p", 1280, 720 },
+	{ "1080p", 1920, 1080 },
+	{ "2160p", 3840, 2160 },
+};
+
+static const csc_test_format_t formats[] =
+{
+	{ "NV12 tiled to RGB888", MM_PLAYER_COLORSPACE_NV12_TILED, MM_PLAYER_COLORSPACE_RGB888 },
+	{ "I420 to BGRA8888", MM_PLAYER_COLORSPACE_I420, MM_PLAYER_COLORSPACE_BGRA8888 },
+};
+
+#define CSC_TEST_SIZES		(sizeof(sizes) / sizeof(sizes[0]))
+#define CSC_TEST_FORMATS	(sizeof(formats) / sizeof(formats[0]))
+#define CSC_TEST_LOOPS		5
+
+static gint failed = 0;
+
+#define CSC_TEST_CHECK(expr) \
+do \
+{ \
+	if (!(expr)) \
+	{ \
+		fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		failed++; \
+	} \
+} while (0)
+
+static guint8 *
+csc_test_alloc (gsize size)
+{
+	guint8 *data = malloc (size);
+	gsize i = 0;
+
+	for (i = 0; i < size; i++)
+		data[i] = rand () & 0xff;
+
+	return data;
+}
+
+/* tiled plane is aligned to 128x32 tiles and a 8KB pair more */
+static gsize
+csc_test_tiled_size (int width, int height)
+{
+	return (((width + 127) / 128) * 128) * (((height + 31) / 32 + 1) * 32) + 8192;
+}
+
+static void
+csc_test_fill_source (MMPlayerMPlaneImage *image, MMPlayerVideoColorspace fmt, int width, int height)
+{
+	memset (image, 0, sizeof (MMPlayerMPlaneImage));
+
+	image->cs = fmt;
+	image->w[0] = width;
+	image->h[0] = height;
+
+	if (fmt == MM_PLAYER_COLORSPACE_NV12_TILED)
+	{
+		image->a[0] = csc_test_alloc (csc_test_tiled_size (width, height));
+		image->a[1] = csc_test_alloc (csc_test_tiled_size (width, (height + 1) / 2));
+	}
+	else
+	{
+		image->s[0] = width;
+		image->s[1] = image->s[2] = width / 2;
+		image->a[0] = csc_test_alloc (width * height);
+		image->a[1] = csc_test_alloc (width * height / 4);
+		image->a[2] = csc_test_alloc (width * height / 4);
+	}
+}
+
+static gdouble
+csc_test_now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static gdouble
+csc_test_convert (MMPlayerCscParam *param)
+{
+	gdouble start = 0;
+	int i = 0;
+
+	start = csc_test_now ();
+
+	for (i = 0; i < CSC_TEST_LOOPS; i++)
+		CSC_TEST_CHECK (_mmplayer_csc_convert (param) == MM_ERROR_NONE);
+
+	return (csc_test_now () - start) / CSC_TEST_LOOPS;
+}
+
+int
+main (int argc, char *argv[])
+{
+	MMPlayerMPlaneImage src;
+	MMPlayerCscParam param;
+	guint8 *single[CSC_TEST_FORMATS][CSC_TEST_SIZES];
+	gdouble single_msec[CSC_TEST_FORMATS][CSC_TEST_SIZES];
+	long cores = sysconf (_SC_NPROCESSORS_ONLN);
+	/* the pool has a thread less than cores. bands are checked with a few threads at least */
+	long threads = MAX (cores, 4);
+	guint f = 0;
+	guint s = 0;
+	int size = 0;
+
+	if (!g_thread_supported ())
+		g_thread_init (NULL);
+
+	srand (1);
+
+	/* no pool yet. every frame is converted in this thread */
+	for (f = 0; f < CSC_TEST_FORMATS; f++)
+	{
+		for (s = 0; s < CSC_TEST_SIZES; s++)
+		{
+			csc_test_fill_source (&src, formats[f].src_fmt, sizes[s].width, sizes[s].height);
+
+			size = _mmplayer_csc_get_image_size (formats[f].dst_fmt, sizes[s].width, sizes[s].height);
+			memset (&param, 0, sizeof (param));
+			param.src = &src;
+			param.dst_fmt = formats[f].dst_fmt;
+			param.dst_w = sizes[s].width;
+			param.dst_h = sizes[s].height;
+			param.dst = single[f][s] = malloc (size);
+
+			single_msec[f][s] = csc_test_convert (&param);
+
+			/* same source is generated again for the pool below */
+			free (src.a[0]);
+			free (src.a[1]);
+			free (src.a[2]);
+		}
+	}
+
+	_mmplayer_csc_set_pool_size (threads - 1);
+	_mmplayer_csc_pool_ref ();
+
+	printf ("%ld online cores, %ld threads\n", cores, threads);
+
+	srand (1);
+
+	for (f = 0; f < CSC_TEST_FORMATS; f++)
+	{
+		for (s = 0; s < CSC_TEST_SIZES; s++)
+		{
+			guint8 *parallel = NULL;
+			gdouble msec = 0;
+
+			csc_test_fill_source (&src, formats[f].src_fmt, sizes[s].width, sizes[s].height);
+
+			size = _mmplayer_csc_get_image_size (formats[f].dst_fmt, sizes[s].width, sizes[s].height);
+			memset (&param, 0, sizeof (param));
+			param.src = &src;
+			param.dst_fmt = formats[f].dst_fmt;
+			param.dst_w = sizes[s].width;
+			param.dst_h = sizes[s].height;
+			param.dst = parallel = malloc (size);
+
+			msec = csc_test_convert (&param);
+
+			/* bands are split on even lines, so the image is same */
+			CSC_TEST_CHECK (!memcmp (single[f][s], parallel, size));
+
+			printf ("%-20s %-5s : 1 thread %7.2f ms, %ld threads %7.2f ms\n",
+				formats[f].name, sizes[s].name, single_msec[f][s], threads, msec);
+
+			free (parallel);
+			free (single[f][s]);
+			free (src.a[0]);
+			free (src.a[1]);
+			free (src.a[2]);
+		}
+	}
+
+	_mmplayer_csc_pool_unref ();
+
+	if (failed)
+	{
+		fprintf (stderr, "%d checks failed\n", failed);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,577 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE	/* for accept4() */
+#endif
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include <mm_debug.h>
+#include <mm_error.h>
+#include "mm_player_frame_export.h"
+#include "mm_player_capture.h"
+#include "mm_player_utils.h"
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC	0x0001U
+#endif
+
+#define MMPLAYER_EXPORT_PAGE_SIZE	4096
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static gboolean __mmplayer_export_probe(GstPad *pad, GstBuffer *buffer, gpointer u_data);
+static void __mmplayer_export_accept(MMPlayerFrameExport *exporter);
+static void __mmplayer_export_disconnect(MMPlayerFrameExport *exporter);
+static void __mmplayer_export_read_release(MMPlayerFrameExport *exporter);
+static int __mmplayer_export_alloc(MMPlayerFrameExport *exporter, gsize frame_size);
+static int __mmplayer_export_send(MMPlayerFrameExport *exporter, MMPlayerExportFrameDesc *desc);
+static void __mmplayer_export_free(MMPlayerFrameExport *exporter);
+static int __mmplayer_export_memfd_create(const char *name);
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+int
+_mmplayer_start_frame_export(MMHandleType hplayer, const char *path, int slot_count)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerFrameExport *exporter = NULL;
+	struct sockaddr_un addr;
+	struct stat st;
+
+	debug_fenter();
+
+	return_val_if_fail(player && player->pipeline && player->frame_export_lock, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(path && strlen(path) > 0 && strlen(path) < sizeof(addr.sun_path), MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(slot_count > 0 && slot_count <= MM_PLAYER_EXPORT_SLOT_MAX, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	if (player->frame_export)
+	{
+		debug_warning("frame export is already started");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	/* check if video pipeline is linked or not */
+	if (!player->pipeline->videobin || !player->sent_bos)
+	{
+		debug_warning("not ready to export frames");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	exporter = g_try_new0(MMPlayerFrameExport, 1);
+	if ( !exporter )
+		return MM_ERROR_PLAYER_NO_FREE_SPACE;
+
+	exporter->listen_fd = -1;
+	exporter->client_fd = -1;
+	exporter->mem_fd = -1;
+	exporter->slot_count = slot_count;
+	exporter->path = g_strdup(path);
+
+	exporter->in_use = g_try_new0(gboolean, slot_count);
+	if ( !exporter->in_use )
+	{
+		__mmplayer_export_free(exporter);
+		return MM_ERROR_PLAYER_NO_FREE_SPACE;
+	}
+
+	/* consumer connects to this socket. frames are sent only while it's connected */
+	exporter->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (exporter->listen_fd < 0)
+	{
+		debug_error("failed to create socket. %s\n", strerror(errno));
+		goto ERROR;
+	}
+
+	memset(&addr, 0x00, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	g_strlcpy(addr.sun_path, path, sizeof(addr.sun_path));
+
+	/* remove stale socket of previous session. never remove other kind of file */
+	if (lstat(path, &st) == 0)
+	{
+		if (!S_ISSOCK(st.st_mode))
+		{
+			debug_error("%s exists and it's not a socket\n", path);
+			goto ERROR_NOT_BOUND;
+		}
+		unlink(path);
+	}
+
+	if (bind(exporter->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		debug_error("failed to bind %s. %s\n", path, strerror(errno));
+		goto ERROR_NOT_BOUND;
+	}
+
+	if (listen(exporter->listen_fd, 1) < 0)
+	{
+		debug_error("failed to listen on %s. %s\n", path, strerror(errno));
+		goto ERROR;
+	}
+
+	exporter->pad = gst_element_get_static_pad(player->pipeline->videobin[MMPLAYER_V_SINK].gst, "sink");
+
+	g_mutex_lock(player->frame_export_lock);
+	player->frame_export = exporter;
+	g_mutex_unlock(player->frame_export_lock);
+
+	exporter->probe_id = gst_pad_add_buffer_probe(exporter->pad,
+		G_CALLBACK(__mmplayer_export_probe), player);
+
+	debug_log("exporting frames on %s with %d slots\n", path, slot_count);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+
+ERROR_NOT_BOUND:
+	/* path is not ours. don't let free unlink it */
+	close(exporter->listen_fd);
+	exporter->listen_fd = -1;
+
+ERROR:
+	__mmplayer_export_free(exporter);
+
+	return MM_ERROR_PLAYER_INTERNAL;
+}
+
+int
+_mmplayer_stop_frame_export(MMHandleType hplayer)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerFrameExport *exporter = NULL;
+
+	debug_fenter();
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	if (!player->frame_export || !player->frame_export_lock)
+		return MM_ERROR_NONE;
+
+	/* NOTE : probe accesses it with the lock. so, it's safe to free it after detaching */
+	g_mutex_lock(player->frame_export_lock);
+	exporter = player->frame_export;
+	player->frame_export = NULL;
+	g_mutex_unlock(player->frame_export_lock);
+
+	if (exporter)
+	{
+		debug_log("frame export stopped. %d frames dropped\n", exporter->dropped);
+		__mmplayer_export_free(exporter);
+	}
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+/**
+  * Copies a frame into free slot and sends its descriptor to consumer.
+  * Socket is non-blocking, so the streaming thread never waits for consumer.
+  */
+static gboolean
+__mmplayer_export_probe(GstPad *pad, GstBuffer *buffer, gpointer u_data)
+{
+	mm_player_t* player = (mm_player_t*) u_data;
+	MMPlayerFrameExport *exporter = NULL;
+	MMPlayerExportFrameDesc desc;
+	MMPlayerMPlaneImage image;
+	unsigned char *dst = NULL;
+	gsize frame_size = 0;
+	int slot = -1;
+	int i = 0;
+
+	return_val_if_fail ( player && buffer, TRUE );
+
+	g_mutex_lock(player->frame_export_lock);
+
+	exporter = player->frame_export;
+	if ( !exporter )
+		goto EXIT;
+
+	if (exporter->client_fd < 0)
+	{
+		__mmplayer_export_accept(exporter);
+		if (exporter->client_fd < 0)
+			goto EXIT;
+	}
+
+	/* get slots back from consumer */
+	__mmplayer_export_read_release(exporter);
+	if (exporter->client_fd < 0)
+		goto EXIT;
+
+	if ( _mmplayer_get_image_from_buffer(buffer, &image) != MM_ERROR_NONE )
+		goto EXIT;
+
+	/* planes of tiled format are not in buffer data */
+	if (image.cs == MM_PLAYER_COLORSPACE_NV12_TILED)
+	{
+		for (i = 0; i < MM_PLAYER_IMGB_MPLANE_MAX && image.a[i]; i++)
+			frame_size += image.s[i] * image.e[i];
+	}
+	else
+	{
+		frame_size = GST_BUFFER_SIZE(buffer);
+	}
+
+	if (frame_size > exporter->slot_size)
+	{
+		if ( __mmplayer_export_alloc(exporter, frame_size) != MM_ERROR_NONE )
+			goto EXIT;
+	}
+
+	for (i = 0; i < exporter->slot_count; i++)
+	{
+		int candidate = (exporter->next_slot + i) % exporter->slot_count;
+
+		if ( !exporter->in_use[candidate] )
+		{
+			slot = candidate;
+			break;
+		}
+	}
+
+	if (slot < 0)
+	{
+		debug_log("no free slot. consumer is late\n");
+		exporter->dropped++;
+		goto EXIT;
+	}
+
+	memset(&desc, 0x00, sizeof(MMPlayerExportFrameDesc));
+
+	desc.slot = slot;
+	desc.generation = exporter->generation;
+	desc.offset = slot * exporter->slot_size;
+	desc.size = frame_size;
+	desc.format = image.cs;
+	desc.width = image.w[0];
+	desc.height = image.h[0];
+	desc.pts = GST_BUFFER_TIMESTAMP(buffer);
+
+	dst = exporter->mem + desc.offset;
+
+	if (image.cs == MM_PLAYER_COLORSPACE_NV12_TILED)
+	{
+		gsize offset = 0;
+
+		for (i = 0; i < MM_PLAYER_IMGB_MPLANE_MAX && image.a[i]; i++)
+		{
+			memcpy(dst + offset, image.a[i], image.s[i] * image.e[i]);
+
+			desc.plane_offset[i] = offset;
+			desc.stride[i] = image.s[i];
+			desc.elevation[i] = image.e[i];
+			offset += image.s[i] * image.e[i];
+		}
+		desc.planes = i;
+	}
+	else
+	{
+		memcpy(dst, GST_BUFFER_DATA(buffer), frame_size);
+
+		for (i = 0; i < MM_PLAYER_IMGB_MPLANE_MAX && image.a[i]; i++)
+		{
+			desc.plane_offset[i] = (unsigned char*)image.a[i] - GST_BUFFER_DATA(buffer);
+			desc.stride[i] = image.s[i];
+		}
+		desc.planes = i;
+	}
+
+	if ( __mmplayer_export_send(exporter, &desc) != MM_ERROR_NONE )
+	{
+		exporter->dropped++;
+		goto EXIT;
+	}
+
+	exporter->in_use[slot] = TRUE;
+	exporter->next_slot = (slot + 1) % exporter->slot_count;
+
+EXIT:
+	g_mutex_unlock(player->frame_export_lock);
+
+	return TRUE;
+}
+
+static void
+__mmplayer_export_accept(MMPlayerFrameExport *exporter)
+{
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+	int fd = accept4(exporter->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+	if (fd < 0)
+		return;
+
+	/* frames are exported as fd. only a process of same user can get them */
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+	{
+		debug_error("failed to get credential of consumer. %s\n", strerror(errno));
+		close(fd);
+		return;
+	}
+
+	if (cred.uid != getuid())
+	{
+		debug_error("consumer(pid %d, uid %d) is not allowed\n", cred.pid, cred.uid);
+		close(fd);
+		return;
+	}
+
+	exporter->client_fd = fd;
+
+	/* new consumer needs shared memory */
+	exporter->send_fd = TRUE;
+
+	debug_log("consumer is connected to %s\n", exporter->path);
+}
+
+static void
+__mmplayer_export_disconnect(MMPlayerFrameExport *exporter)
+{
+	int i = 0;
+
+	if (exporter->client_fd >= 0)
+	{
+		close(exporter->client_fd);
+		exporter->client_fd = -1;
+		debug_log("consumer is disconnected from %s\n", exporter->path);
+	}
+
+	/* slots of gone consumer can be reused */
+	for (i = 0; i < exporter->slot_count; i++)
+		exporter->in_use[i] = FALSE;
+}
+
+static void
+__mmplayer_export_read_release(MMPlayerFrameExport *exporter)
+{
+	MMPlayerExportFrameRelease release;
+	ssize_t len = 0;
+
+	while (exporter->client_fd >= 0)
+	{
+		len = recv(exporter->client_fd, &release, sizeof(release), MSG_DONTWAIT);
+
+		if (len == sizeof(release))
+		{
+			/* ignore slots of old shared memory */
+			if (release.generation == exporter->generation && release.slot < (unsigned int)exporter->slot_count)
+				exporter->in_use[release.slot] = FALSE;
+		}
+		else if (len == 0)
+		{
+			__mmplayer_export_disconnect(exporter);
+		}
+		else if (len < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				__mmplayer_export_disconnect(exporter);
+			break;
+		}
+	}
+}
+
+/**
+  * (Re)allocates shared memory of slots which can hold frame_size.
+  * Consumer gets new memfd with the next descriptor.
+  */
+static int
+__mmplayer_export_alloc(MMPlayerFrameExport *exporter, gsize frame_size)
+{
+	int i = 0;
+
+	if (exporter->mem)
+	{
+		munmap(exporter->mem, exporter->mem_size);
+		exporter->mem = NULL;
+	}
+
+	if (exporter->mem_fd >= 0)
+	{
+		close(exporter->mem_fd);
+		exporter->mem_fd = -1;
+	}
+
+	exporter->slot_size = (frame_size + MMPLAYER_EXPORT_PAGE_SIZE - 1) & ~(MMPLAYER_EXPORT_PAGE_SIZE - 1);
+	exporter->mem_size = exporter->slot_size * exporter->slot_count;
+
+	exporter->mem_fd = __mmplayer_export_memfd_create("mmplayer-frames");
+	if (exporter->mem_fd < 0)
+	{
+		debug_error("failed to create memfd. %s\n", strerror(errno));
+		goto ERROR;
+	}
+
+	if (ftruncate(exporter->mem_fd, exporter->mem_size) < 0)
+	{
+		debug_error("failed to resize memfd. %s\n", strerror(errno));
+		goto ERROR;
+	}
+
+	exporter->mem = mmap(NULL, exporter->mem_size, PROT_READ | PROT_WRITE, MAP_SHARED, exporter->mem_fd, 0);
+	if (exporter->mem == MAP_FAILED)
+	{
+		debug_error("failed to map memfd. %s\n", strerror(errno));
+		exporter->mem = NULL;
+		goto ERROR;
+	}
+
+	exporter->generation++;
+	exporter->send_fd = TRUE;
+	exporter->next_slot = 0;
+
+	for (i = 0; i < exporter->slot_count; i++)
+		exporter->in_use[i] = FALSE;
+
+	debug_log("%d slots of %d bytes are allocated\n", exporter->slot_count, (int)exporter->slot_size);
+
+	return MM_ERROR_NONE;
+
+ERROR:
+	if (exporter->mem_fd >= 0)
+	{
+		close(exporter->mem_fd);
+		exporter->mem_fd = -1;
+	}
+
+	exporter->slot_size = 0;
+	exporter->mem_size = 0;
+
+	return MM_ERROR_PLAYER_NO_FREE_SPACE;
+}
+
+static int
+__mmplayer_export_send(MMPlayerFrameExport *exporter, MMPlayerExportFrameDesc *desc)
+{
+	char control[CMSG_SPACE(sizeof(int))];
+	struct msghdr msg;
+	struct iovec iov;
+
+	memset(&msg, 0x00, sizeof(msg));
+
+	iov.iov_base = desc;
+	iov.iov_len = sizeof(MMPlayerExportFrameDesc);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+
+	/* memfd is attached to the first descriptor of each generation */
+	if (exporter->send_fd)
+	{
+		struct cmsghdr *cmsg = NULL;
+
+		memset(control, 0x00, sizeof(control));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(cmsg), &exporter->mem_fd, sizeof(int));
+	}
+
+	if (sendmsg(exporter->client_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			debug_log("consumer is busy. drop frame\n");
+			return MM_ERROR_PLAYER_NO_FREE_SPACE;
+		}
+
+		debug_warning("failed to send frame. %s\n", strerror(errno));
+		__mmplayer_export_disconnect(exporter);
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	exporter->send_fd = FALSE;
+
+	return MM_ERROR_NONE;
+}
+
+static void
+__mmplayer_export_free(MMPlayerFrameExport *exporter)
+{
+	return_if_fail ( exporter );
+
+	if (exporter->pad)
+	{
+		if (exporter->probe_id)
+			gst_pad_remove_buffer_probe(exporter->pad, exporter->probe_id);
+		gst_object_unref(exporter->pad);
+	}
+
+	if (exporter->client_fd >= 0)
+		close(exporter->client_fd);
+
+	if (exporter->listen_fd >= 0)
+	{
+		close(exporter->listen_fd);
+		unlink(exporter->path);
+	}
+
+	if (exporter->mem)
+		munmap(exporter->mem, exporter->mem_size);
+
+	if (exporter->mem_fd >= 0)
+		close(exporter->mem_fd);
+
+	MMPLAYER_FREEIF(exporter->in_use);
+	MMPLAYER_FREEIF(exporter->path);
+
+	g_free(exporter);
+}
+
+static int
+__mmplayer_export_memfd_create(const char *name)
+{
+#ifdef __NR_memfd_create
+	return syscall(__NR_memfd_create, name, MFD_CLOEXEC);
+#else
+	/* kernel headers are too old */
+	errno = ENOSYS;
+	return -1;
+#endif
+}
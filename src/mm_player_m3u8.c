@@ -27,23 +27,107 @@
  * - gst_m3u8_client_get_next_fragment is modified.
  * - gst_m3u8_client_check_next_fragment is added.
  * File name is changed to mm_player_m3u8.c
+ * For long live playlists,
+ * - gst_m3u8_update is rewritten to parse in single pass with table of tags.
+ * - media files are kept in array and relative uris share base of playlist.
+ * - media files of live playlist are kept over refresh by sequence number.
+ * - media files are indexed by sequence in ring and remaining duration is kept.
+ * - media files are allocated from arena of playlist and repeated strings are interned.
  */
 
 #include <stdlib.h>
 #include <errno.h>
+#include <limits.h>
 #include <glib.h>
 
 #include "mm_player_m3u8.h"
 #include <mm_debug.h>
 #include <string.h>
 
+#define GST_M3U8_KEY_SIZE 16
+#define GST_M3U8_FILE_RING_MIN 64
+#define GST_M3U8_ARENA_CHUNK_SIZE (16 * 1024)
+#define GST_M3U8_ARENA_ALIGN(size) (((size) + 7) & ~(gsize) 7)
+
+/* media files are expired in order of sequence, so a chunk is released at once
+ * when all the files in it are expired */
+struct _GstM3U8ArenaChunk
+{
+  GstM3U8ArenaChunk *next;
+  gsize size;
+  gsize used;
+  guint last_sequence;          /* the biggest sequence of files in this chunk */
+};
+
+#define GST_M3U8_ARENA_CHUNK_HEADER GST_M3U8_ARENA_ALIGN (sizeof (GstM3U8ArenaChunk))
+
+/* interned string follows its count in one block, which is the value of table */
+typedef struct
+{
+  guint count;                  /* objects using it */
+} GstM3U8String;
+
+/* state of a parsing pass. tags before uri line are kept until the uri comes */
+typedef struct
+{
+  GstM3U8 *self;
+  GstM3U8 *list;                /* variant playlist waiting for its uri */
+  gint duration;                /* EXTINF duration waiting for its uri, -1 if none */
+  const gchar *title;           /* points in playlist text */
+  const gchar *key_url;         /* key of following media files, interned */
+  gboolean has_iv;
+  guint8 iv[GST_M3U8_KEY_SIZE];
+
+  /* media files kept from last refresh */
+  guint known_first;            /* sequence of files[0] */
+  guint known_end;              /* sequence after the last one */
+  guint first;                  /* first sequence in this text */
+  gboolean has_first;
+} GstM3U8Parser;
+
+typedef void (*GstM3U8TagFunc) (GstM3U8Parser * parser, gchar * value);
+
+typedef struct
+{
+  const gchar *name;            /* without leading '#' */
+  gsize len;
+  GstM3U8TagFunc func;
+} GstM3U8Tag;
 
 static GstM3U8 *gst_m3u8_new (void);
 static void gst_m3u8_free (GstM3U8 * m3u8);
 static gboolean gst_m3u8_update (GstM3U8 * m3u8, gchar * data,
     gboolean * updated);
-static GstM3U8MediaFile *gst_m3u8_media_file_new (gchar * uri, gchar * title, gint duration,  gchar *key_url, gchar *IV, guint sequence);
-static void gst_m3u8_media_file_free (GstM3U8MediaFile * self);
+static GstM3U8MediaFile *gst_m3u8_media_file_new (GstM3U8 * self, const gchar * base,
+    const gchar * uri, const gchar * title, gint duration, const gchar * key_url,
+    const guint8 * IV, guint sequence);
+
+static void parse_extinf (GstM3U8Parser * parser, gchar * value);
+static void parse_key (GstM3U8Parser * parser, gchar * value);
+static void parse_target_duration (GstM3U8Parser * parser, gchar * value);
+static void parse_media_sequence (GstM3U8Parser * parser, gchar * value);
+static void parse_endlist (GstM3U8Parser * parser, gchar * value);
+static void parse_stream_inf (GstM3U8Parser * parser, gchar * value);
+static void parse_version (GstM3U8Parser * parser, gchar * value);
+static void parse_allow_cache (GstM3U8Parser * parser, gchar * value);
+static void parse_discontinuity (GstM3U8Parser * parser, gchar * value);
+static void parse_program_date_time (GstM3U8Parser * parser, gchar * value);
+
+#define GST_M3U8_TAG(name, func) { name, sizeof (name) - 1, func }
+
+/* frequent ones come first */
+static const GstM3U8Tag m3u8_tags[] = {
+  GST_M3U8_TAG ("EXTINF", parse_extinf),
+  GST_M3U8_TAG ("EXT-X-KEY", parse_key),
+  GST_M3U8_TAG ("EXT-X-DISCONTINUITY", parse_discontinuity),
+  GST_M3U8_TAG ("EXT-X-PROGRAM-DATE-TIME", parse_program_date_time),
+  GST_M3U8_TAG ("EXT-X-STREAM-INF", parse_stream_inf),
+  GST_M3U8_TAG ("EXT-X-TARGETDURATION", parse_target_duration),
+  GST_M3U8_TAG ("EXT-X-MEDIA-SEQUENCE", parse_media_sequence),
+  GST_M3U8_TAG ("EXT-X-ENDLIST", parse_endlist),
+  GST_M3U8_TAG ("EXT-X-VERSION", parse_version),
+  GST_M3U8_TAG ("EXT-X-ALLOW-CACHE", parse_allow_cache),
+};
 
 static GstM3U8 *
 gst_m3u8_new (void)
@@ -55,14 +139,296 @@ gst_m3u8_new (void)
   return m3u8;
 }
 
+static void
+gst_m3u8_file_ring_append (GstM3U8FileRing * ring, GstM3U8MediaFile * file)
+{
+  if (ring->len == ring->size) {
+    guint size = ring->size ? ring->size * 2 : GST_M3U8_FILE_RING_MIN;
+    GstM3U8MediaFile **data = g_new (GstM3U8MediaFile *, size);
+    guint i;
+
+    /* unwrap to the start of new one */
+    for (i = 0; i < ring->len; i++)
+      data[i] = gst_m3u8_file_ring_index (ring, i);
+
+    g_free (ring->data);
+    ring->data = data;
+    ring->size = size;
+    ring->head = 0;
+  }
+
+  ring->data[(ring->head + ring->len) & (ring->size - 1)] = file;
+  ring->len++;
+}
+
+/* drop files from the head */
+static void
+gst_m3u8_file_ring_expire (GstM3U8FileRing * ring, guint count)
+{
+  count = MIN (count, ring->len);
+
+  while (count--) {
+    ring->head = (ring->head + 1) & (ring->size - 1);
+    ring->len--;
+  }
+}
+
+/* drop files from the tail */
+static void
+gst_m3u8_file_ring_truncate (GstM3U8FileRing * ring, guint len)
+{
+  ring->len = MIN (ring->len, len);
+}
+
+static void
+gst_m3u8_file_ring_free (GstM3U8FileRing * ring)
+{
+  g_free (ring->data);
+  memset (ring, 0, sizeof (GstM3U8FileRing));
+}
+
+static gpointer
+gst_m3u8_arena_alloc (GstM3U8 * self, gsize size)
+{
+  GstM3U8ArenaChunk *chunk = self->arena_tail;
+  gpointer mem;
+
+  size = GST_M3U8_ARENA_ALIGN (size);
+
+  if (!chunk || chunk->used + size > chunk->size) {
+    gsize chunk_size = MAX (GST_M3U8_ARENA_CHUNK_SIZE, GST_M3U8_ARENA_CHUNK_HEADER + size);
+
+    chunk = g_malloc (chunk_size);
+    chunk->next = NULL;
+    chunk->size = chunk_size;
+    chunk->used = GST_M3U8_ARENA_CHUNK_HEADER;
+    chunk->last_sequence = 0;
+
+    if (self->arena_tail)
+      self->arena_tail->next = chunk;
+    else
+      self->arena_head = chunk;
+    self->arena_tail = chunk;
+  }
+
+  mem = (gchar *) chunk + chunk->used;
+  chunk->used += size;
+
+  return mem;
+}
+
+/* release chunks from the head which have no file of the sequence or later.
+ * stops at the first one in use, so files truncated from the tail are
+ * released later with their chunk */
+static void
+gst_m3u8_arena_release (GstM3U8 * self, gboolean all, guint sequence)
+{
+  GstM3U8ArenaChunk *chunk;
+
+  while ((chunk = self->arena_head) != NULL) {
+    if (!all && chunk->last_sequence >= sequence)
+      break;
+
+    self->arena_head = chunk->next;
+    g_free (chunk);
+  }
+
+  if (!self->arena_head)
+    self->arena_tail = NULL;
+}
+
+/* strings shared by many objects are kept once, with count of their users.
+ * each call takes a reference, which is dropped by gst_m3u8_unintern */
+static const gchar *
+gst_m3u8_intern (GstM3U8 * self, const gchar * str)
+{
+  GstM3U8String *interned;
+
+  if (!self->strings)
+    self->strings = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+
+  interned = g_hash_table_lookup (self->strings, str);
+  if (!interned) {
+    gsize size = strlen (str) + 1;
+
+    interned = g_malloc (sizeof (GstM3U8String) + size);
+    interned->count = 0;
+    memcpy (interned + 1, str, size);
+    g_hash_table_insert (self->strings, interned + 1, interned);
+  }
+
+  interned->count++;
+
+  return (const gchar *) (interned + 1);
+}
+
+/* rotated keys and dated directories of live playlist go with their last user */
+static void
+gst_m3u8_unintern (GstM3U8 * self, const gchar * str)
+{
+  GstM3U8String *interned;
+
+  if (!str || !self->strings)
+    return;
+
+  interned = g_hash_table_lookup (self->strings, str);
+  if (interned && !--interned->count)
+    g_hash_table_remove (self->strings, str);
+}
+
+/* key url and directory of absolute uri are interned for each file */
+static void
+gst_m3u8_release_file (GstM3U8 * self, GstM3U8MediaFile * file)
+{
+  gst_m3u8_unintern (self, file->key_url);
+
+  if (file->base != self->base_dir && file->base != self->base_root)
+    gst_m3u8_unintern (self, file->base);
+}
+
+/* drop count files from the head, with their strings */
+static void
+gst_m3u8_expire_files (GstM3U8 * self, guint count)
+{
+  guint i;
+
+  count = MIN (count, self->files.len);
+
+  for (i = 0; i < count; i++)
+    gst_m3u8_release_file (self, gst_m3u8_file_ring_index (&self->files, i));
+
+  gst_m3u8_file_ring_expire (&self->files, count);
+}
+
+/* O(1) as files are contiguous by sequence */
+static GstM3U8MediaFile *
+gst_m3u8_find_file (GstM3U8 * self, guint sequence)
+{
+  GstM3U8FileRing *ring = &self->files;
+  guint first;
+
+  if (!ring->len)
+    return NULL;
+
+  first = gst_m3u8_file_ring_index (ring, 0)->sequence;
+  if (sequence < first || sequence - first >= ring->len)
+    return NULL;
+
+  return gst_m3u8_file_ring_index (ring, sequence - first);
+}
+
+static void
+gst_m3u8_add_file (GstM3U8 * self, GstM3U8MediaFile * file)
+{
+  /* running sum of durations. remaining duration is the difference */
+  file->offset = self->duration_end;
+  self->duration_end += file->duration;
+
+  gst_m3u8_file_ring_append (&self->files, file);
+}
+
+static void
+gst_m3u8_truncate_files (GstM3U8 * self, guint len)
+{
+  GstM3U8FileRing *ring = &self->files;
+  guint i;
+
+  for (i = len; i < ring->len; i++)
+    gst_m3u8_release_file (self, gst_m3u8_file_ring_index (ring, i));
+
+  gst_m3u8_file_ring_truncate (ring, len);
+
+  if (!ring->len) {
+    gst_m3u8_arena_release (self, TRUE, 0);
+  } else {
+    GstM3U8MediaFile *last = gst_m3u8_file_ring_index (ring, ring->len - 1);
+    self->duration_end = last->offset + last->duration;
+  }
+}
+
+/* sum of durations of files from the sequence */
+static gint64
+gst_m3u8_get_remaining_duration (GstM3U8 * self, guint sequence)
+{
+  GstM3U8FileRing *ring = &self->files;
+  GstM3U8MediaFile *file;
+
+  if (!ring->len)
+    return 0;
+
+  file = gst_m3u8_file_ring_index (ring, 0);
+  if (sequence > file->sequence) {
+    file = gst_m3u8_find_file (self, sequence);
+    if (!file)
+      return 0;
+  }
+
+  return self->duration_end - file->offset;
+}
+
+/* scheme "://" */
+static gboolean
+uri_is_absolute (const gchar * uri)
+{
+  const gchar *p = uri;
+
+  if (!g_ascii_isalpha (*p))
+    return FALSE;
+
+  while (g_ascii_isalnum (*p) || *p == '+' || *p == '-' || *p == '.')
+    p++;
+
+  return (p[0] == ':' && p[1] == '/' && p[2] == '/');
+}
+
 static void
 gst_m3u8_set_uri (GstM3U8 * self, gchar * uri)
 {
+  gchar *slash;
+
   g_return_if_fail (self != NULL);
 
-  if (self->uri)
-    g_free (self->uri);
+  g_free (self->uri);
+  g_free (self->base_dir);
+  g_free (self->base_root);
   self->uri = uri;
+  self->base_dir = NULL;
+  self->base_root = NULL;
+
+  if (!uri)
+    return;
+
+  /* "scheme://host/dir/" for relative path and "scheme://host" for absolute path */
+  slash = strrchr (uri, '/');
+  if (slash)
+    self->base_dir = g_strndup (uri, slash - uri + 1);
+
+  slash = strstr (uri, "://");
+  if (slash) {
+    slash = strchr (slash + 3, '/');
+    self->base_root = slash ? g_strndup (uri, slash - uri) : g_strdup (uri);
+  }
+}
+
+/* returns shared base which is prepended to uri, NULL for absolute uri */
+static const gchar *
+gst_m3u8_get_base (GstM3U8 * self, const gchar * uri, gboolean * valid)
+{
+  *valid = TRUE;
+
+  if (uri_is_absolute (uri))
+    return NULL;
+
+  if (uri[0] == '/' && self->base_root)
+    return self->base_root;
+
+  if (uri[0] != '/' && self->base_dir)
+    return self->base_dir;
+
+  debug_warning ("uri not set, can't build a valid uri\n");
+  *valid = FALSE;
+
+  return NULL;
 }
 
 static void
@@ -71,139 +437,147 @@ gst_m3u8_free (GstM3U8 * self)
   g_return_if_fail (self != NULL);
 
   g_free (self->uri);
+  g_free (self->base_dir);
+  g_free (self->base_root);
   g_free (self->allowcache);
-  g_free (self->codecs);
 
-  g_list_foreach (self->files, (GFunc) gst_m3u8_media_file_free, NULL);
-  g_list_free (self->files);
+  gst_m3u8_file_ring_free (&self->files);
+  gst_m3u8_arena_release (self, TRUE, 0);
 
-  g_free (self->last_data);
   g_list_foreach (self->lists, (GFunc) gst_m3u8_free, NULL);
   g_list_free (self->lists);
 
+  /* after the lists, which have codecs in it */
+  if (self->strings)
+    g_hash_table_destroy (self->strings);
+
   g_free (self);
 }
 
+/* file and its strings are allocated in one block of arena of the playlist */
 static GstM3U8MediaFile *
-gst_m3u8_media_file_new (gchar * uri, gchar * title, gint duration,  gchar *key_url, gchar *IV, guint sequence)
+gst_m3u8_media_file_new (GstM3U8 * self, const gchar * base, const gchar * uri,
+    const gchar * title, gint duration, const gchar * key_url, const guint8 * IV,
+    guint sequence)
 {
   GstM3U8MediaFile *file;
+  gsize uri_size = strlen (uri) + 1;
+  gsize title_size = title ? strlen (title) + 1 : 0;
+  gchar *strings;
 
-  file = g_new0 (GstM3U8MediaFile, 1);
-  file->uri = uri;
-  file->title = title;
-  file->duration = duration;
-  file->sequence = sequence;
-  memset (file->key, 0x00, sizeof (file->key));
+  file = gst_m3u8_arena_alloc (self, sizeof (GstM3U8MediaFile) + uri_size + title_size);
+  self->arena_tail->last_sequence = MAX (self->arena_tail->last_sequence, sequence);
 
-  //g_print (" uri = %s  / ", uri);
+  memset (file, 0, sizeof (GstM3U8MediaFile));
+  strings = (gchar *) (file + 1);
+  file->uri = memcpy (strings, uri, uri_size);
+  if (title)
+    file->title = memcpy (strings + uri_size, title, title_size);
 
-  if (key_url != NULL)
-  {
-    file->key_url = g_strdup (key_url);
-  }
-  else
-    file->key_url = NULL;
+  file->base = base;
+  file->duration = duration;
+  file->sequence = sequence;
+  file->key_url = key_url;
 
   if (IV != NULL)
-  {
     memcpy (file->iv, IV, sizeof (file->iv));
-  }
+
   return file;
 }
 
-static void
-gst_m3u8_media_file_free (GstM3U8MediaFile * self)
+gchar *
+gst_m3u8_media_file_get_uri (const GstM3U8MediaFile * file)
 {
-  g_return_if_fail (self != NULL);
+  g_return_val_if_fail (file != NULL, NULL);
 
-  if (self->key_url)
-    g_free (self->key_url);
+  if (file->base)
+    return g_strconcat (file->base, file->uri, NULL);
 
-  g_free (self->title);
-  g_free (self->uri);
-  g_free (self);
+  return g_strdup (file->uri);
 }
 
-static gchar *
-gst_m3u8_getIV_from_mediasequence (GstM3U8 *self)
+/* IV is the sequence number in big endian when EXT-X-KEY doesn't have it */
+static void
+gst_m3u8_getIV_from_mediasequence (guint sequence, guint8 * IV)
 {
-  gchar *IV = NULL;
-  gint i = 0;
-  
-  IV = g_malloc0 (16);
-  if (NULL == IV)
-  {
-    debug_warning ("Failed to allocate memory...");
-    return NULL;
-  }
+  memset (IV, 0x00, GST_M3U8_KEY_SIZE);
 
-  if (self->mediasequence > INT_MAX)
-  {
-    debug_warning ("media sequnece is greater than INT_MAX...yet to handle");
-  }
-
-  IV [15] = (gchar)(self->mediasequence);
-  IV [14] = (gchar)(self->mediasequence >> 8);
-  IV [13] = (gchar)(self->mediasequence >> 16);
-  IV [12] = (gchar)(self->mediasequence >> 24);
-   
-  return IV;
+  IV[15] = (guint8) (sequence);
+  IV[14] = (guint8) (sequence >> 8);
+  IV[13] = (guint8) (sequence >> 16);
+  IV[12] = (guint8) (sequence >> 24);
 }
 
 static gboolean
 int_from_string (gchar * ptr, gchar ** endptr, gint * val, gint base)
 {
   gchar *end;
+  glong ret;
 
   g_return_val_if_fail (ptr != NULL, FALSE);
   g_return_val_if_fail (val != NULL, FALSE);
 
   errno = 0;
-  *val = strtol (ptr, &end, base);
-  if ((errno == ERANGE && (*val == LONG_MAX || *val == LONG_MIN))
-      || (errno != 0 && *val == 0)) {
-//    debug_warning (g_strerror (errno));
+  ret = strtol (ptr, &end, base);
+  if ((errno == ERANGE && (ret == LONG_MAX || ret == LONG_MIN))
+      || (errno != 0 && ret == 0) || ret > G_MAXINT || ret < G_MININT) {
     return FALSE;
   }
 
+  *val = (gint) ret;
+
   if (endptr)
     *endptr = end;
 
   return end != ptr;
 }
 
+/* [attribute=value,]* where value can be quoted string having ',' */
 static gboolean
 parse_attributes (gchar ** ptr, gchar ** a, gchar ** v)
 {
-  gchar *end, *p;
+  gchar *p;
 
   g_return_val_if_fail (ptr != NULL, FALSE);
-  g_return_val_if_fail (*ptr != NULL, FALSE);
   g_return_val_if_fail (a != NULL, FALSE);
   g_return_val_if_fail (v != NULL, FALSE);
 
-  /* [attribute=value,]* */
+  p = *ptr;
+  if (p == NULL)
+    return FALSE;
 
-  *a = *ptr;
-  end = p = g_utf8_strchr (*ptr, -1, ',');
-  if (end) {
-    do {
-      end = g_utf8_next_char (end);
-    } while (end && *end == ' ');
-    *p = '\0';
-  }
+  while (*p == ' ' || *p == ',')
+    p++;
 
-  *v = p = g_utf8_strchr (*ptr, -1, '=');
-  if (*v) {
-    *v = g_utf8_next_char (*v);
-    *p = '\0';
-  } else {
+  if (*p == '\0')
+    return FALSE;
+
+  *a = p;
+  while (*p && *p != '=' && *p != ',')
+    p++;
+
+  if (*p != '=') {
     debug_warning ("missing = after attribute\n");
     return FALSE;
   }
+  *p++ = '\0';
+
+  if (*p == '"') {
+    *v = ++p;
+    while (*p && *p != '"')
+      p++;
+    if (*p)
+      *p++ = '\0';
+  } else {
+    *v = p;
+  }
+
+  while (*p && *p != ',')
+    p++;
+  if (*p)
+    *p++ = '\0';
 
-  *ptr = end;
+  *ptr = p;
   return TRUE;
 }
 
@@ -222,18 +596,342 @@ gst_m3u8_compare_playlist_by_bitrate (gconstpointer a, gconstpointer b)
   return ((GstM3U8 *) (a))->bandwidth - ((GstM3U8 *) (b))->bandwidth;
 }
 
+/* next media file is already in files */
+static gboolean
+parser_next_is_known (GstM3U8Parser * parser)
+{
+  guint sequence = parser->self->mediasequence;
+
+  return (sequence >= parser->known_first && sequence < parser->known_end);
+}
+
+static void
+parse_extinf (GstM3U8Parser * parser, gchar * value)
+{
+  gchar *end = NULL;
+  gdouble duration;
+
+  /* <duration>,<title> */
+  duration = g_ascii_strtod (value, &end);
+  if (end == value || duration < 0) {
+    debug_warning ("Can't read EXTINF duration\n");
+    return;
+  }
+
+  parser->duration = (gint) duration;
+  if (parser->duration > parser->self->targetduration)
+    debug_warning ("EXTINF duration > TARGETDURATION\n");
+
+  /* copied to arena with the media file */
+  parser->title = NULL;
+  if (*end == ',' && end[1] != '\0')
+    parser->title = end + 1;
+}
+
+static gboolean
+parse_iv (const gchar * value, guint8 * IV)
+{
+  gint i;
+
+  /* 0x<32 hex digits> */
+  if (value[0] != '0' || (value[1] != 'x' && value[1] != 'X'))
+    return FALSE;
+
+  value += 2;
+  if (strlen (value) != GST_M3U8_KEY_SIZE * 2)
+    return FALSE;
+
+  for (i = 0; i < GST_M3U8_KEY_SIZE; i++) {
+    gint hi = g_ascii_xdigit_value (value[i * 2]);
+    gint lo = g_ascii_xdigit_value (value[i * 2 + 1]);
+
+    if (hi < 0 || lo < 0)
+      return FALSE;
+
+    IV[i] = (guint8) ((hi << 4) | lo);
+  }
+
+  return TRUE;
+}
+
+static void
+parse_key (GstM3U8Parser * parser, gchar * value)
+{
+  gchar *attr, *val;
+
+  /* a key applies until next EXT-X-KEY */
+  parser->has_iv = FALSE;
+
+  while (parse_attributes (&value, &attr, &val)) {
+    if (g_str_equal (attr, "METHOD")) {
+      if (g_str_equal (val, "NONE")) {
+        debug_log ("media files are not encrypted\n");
+        gst_m3u8_unintern (parser->self, parser->key_url);
+        parser->key_url = NULL;
+        return;
+      } else if (!g_str_equal (val, "AES-128")) {
+        debug_warning ("unsupported encryption method : %s\n", val);
+      }
+    } else if (g_str_equal (attr, "URI")) {
+      const gchar *base;
+      gboolean valid;
+
+      base = gst_m3u8_get_base (parser->self, val, &valid);
+      if (!valid)
+        continue;
+
+      /* usually one key is used for many media files */
+      gst_m3u8_unintern (parser->self, parser->key_url);
+      if (base) {
+        gchar *url = g_strconcat (base, val, NULL);
+        parser->key_url = gst_m3u8_intern (parser->self, url);
+        g_free (url);
+      } else {
+        parser->key_url = gst_m3u8_intern (parser->self, val);
+      }
+      debug_log ("AES-128 key url = %s\n", parser->key_url);
+    } else if (g_str_equal (attr, "IV")) {
+      parser->has_iv = parse_iv (val, parser->iv);
+      if (!parser->has_iv)
+        debug_warning ("Wrong IV : %s\n", val);
+    }
+  }
+}
+
+static void
+parse_target_duration (GstM3U8Parser * parser, gchar * value)
+{
+  gint val;
+
+  if (int_from_string (value, NULL, &val, 10))
+    parser->self->targetduration = val;
+}
+
+static void
+parse_media_sequence (GstM3U8Parser * parser, gchar * value)
+{
+  gint val;
+
+  if (int_from_string (value, NULL, &val, 10))
+    parser->self->mediasequence = val;
+}
+
+static void
+parse_endlist (GstM3U8Parser * parser, gchar * value)
+{
+  parser->self->endlist = TRUE;
+}
+
+static void
+parse_version (GstM3U8Parser * parser, gchar * value)
+{
+  gint val;
+
+  if (int_from_string (value, NULL, &val, 10))
+    parser->self->version = val;
+}
+
+static void
+parse_allow_cache (GstM3U8Parser * parser, gchar * value)
+{
+  g_free (parser->self->allowcache);
+  parser->self->allowcache = g_strdup (value);
+}
+
+static void
+parse_discontinuity (GstM3U8Parser * parser, gchar * value)
+{
+  /* nothing to keep. sequence gap is reported as discontinuity */
+}
+
+static void
+parse_program_date_time (GstM3U8Parser * parser, gchar * value)
+{
+  /* <YYYY-MM-DDThh:mm:ssZ> */
+}
+
+static void
+parse_stream_inf (GstM3U8Parser * parser, gchar * value)
+{
+  GstM3U8 *list;
+  gchar *v, *a;
+
+  if (parser->list != NULL) {
+    debug_warning ("Found a list without a uri..., dropping\n");
+    gst_m3u8_free (parser->list);
+  }
+
+  list = parser->list = gst_m3u8_new ();
+
+  while (parse_attributes (&value, &a, &v)) {
+    if (g_str_equal (a, "BANDWIDTH")) {
+      if (!int_from_string (v, NULL, &list->bandwidth, 10))
+        debug_warning ("Error while reading BANDWIDTH");
+    } else if (g_str_equal (a, "PROGRAM-ID")) {
+      if (!int_from_string (v, NULL, &list->program_id, 10))
+        debug_warning ("Error while reading PROGRAM-ID");
+    } else if (g_str_equal (a, "CODECS")) {
+      /* variants share a few codecs */
+      list->codecs = gst_m3u8_intern (parser->self, v);
+    } else if (g_str_equal (a, "RESOLUTION")) {
+      /* <width>x<height> */
+      if (!int_from_string (v, &v, &list->width, 10))
+        debug_warning ("Error while reading RESOLUTION width");
+      if (!v || (*v != 'x' && *v != 'X')) {
+        debug_warning ("Missing height\n");
+      } else {
+        v++;
+        if (!int_from_string (v, NULL, &list->height, 10))
+          debug_warning ("Error while reading RESOLUTION height");
+      }
+    }
+  }
+}
+
+static void
+parse_tag (GstM3U8Parser * parser, gchar * line)
+{
+  gchar *name = line + 1;       /* skip '#' */
+  gchar *value;
+  gsize len;
+  guint i;
+
+  value = strchr (name, ':');
+  if (value) {
+    len = value - name;
+    value++;
+  } else {
+    len = strlen (name);
+    value = name + len;
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (m3u8_tags); i++) {
+    if (m3u8_tags[i].len == len && !memcmp (m3u8_tags[i].name, name, len)) {
+      m3u8_tags[i].func (parser, value);
+      return;
+    }
+  }
+
+  debug_log ("Ignored line: %s\n", line);
+}
+
+static void
+parse_uri (GstM3U8Parser * parser, gchar * line)
+{
+  GstM3U8 *self = parser->self;
+  const gchar *base;
+  gboolean valid;
+
+  if (parser->duration < 0 && parser->list == NULL) {
+    debug_log ("%s: got line without EXTINF or EXTSTREAMINF, dropping\n", line);
+    return;
+  }
+
+  base = gst_m3u8_get_base (self, line, &valid);
+  if (!valid)
+    return;
+
+  if (parser->list != NULL) {
+    gchar *uri = base ? g_strconcat (base, line, NULL) : g_strdup (line);
+
+    if (g_list_find_custom (self->lists, uri, (GCompareFunc) _m3u8_compare_uri)) {
+      debug_log ("Already have a list with this URI\n");
+      gst_m3u8_free (parser->list);
+      g_free (uri);
+    } else {
+      gst_m3u8_set_uri (parser->list, uri);
+      parser->list->parent = self;
+      self->lists = g_list_append (self->lists, parser->list);
+    }
+    parser->list = NULL;
+  } else {
+    GstM3U8MediaFile *file;
+    guint8 IV[GST_M3U8_KEY_SIZE];
+    const guint8 *send_IV = NULL;
+    guint sequence = self->mediasequence;
+    gchar *name = line;
+    gchar *slash;
+
+    /* absolute uris mostly share directory too. keep it once like the base */
+    if (!base && (slash = strrchr (line, '/')) != NULL) {
+      gchar c = slash[1];
+
+      slash[1] = '\0';
+      base = gst_m3u8_intern (self, line);
+      slash[1] = c;
+      name = slash + 1;
+    }
+
+    if (!parser->has_first) {
+      parser->first = sequence;
+      parser->has_first = TRUE;
+
+      /* restarted from earlier sequence. nothing can be kept */
+      if (sequence < parser->known_first) {
+        debug_log ("sequence went back to %u from %u\n", sequence, parser->known_first);
+        gst_m3u8_truncate_files (self, 0);
+        parser->known_first = parser->known_end = 0;
+      }
+    }
+
+    if (parser_next_is_known (parser)) {
+      file = gst_m3u8_find_file (self, sequence);
+
+      if (file->base == base && g_str_equal (file->uri, name)) {
+        if (name != line)
+          gst_m3u8_unintern (self, base);
+        self->mediasequence++;
+        parser->duration = -1;
+        return;
+      }
+
+      /* it's not the one we have. the rest is parsed again */
+      debug_warning ("media file of sequence %u is changed\n", sequence);
+      gst_m3u8_truncate_files (self, sequence - parser->known_first);
+      parser->known_end = sequence;
+    }
+
+    if (parser->key_url) {
+      if (parser->has_iv) {
+        send_IV = parser->iv;
+      } else {
+        /* IV is not present in EXT-X-KEY tag. Prepare IV based on mediasequence */
+        gst_m3u8_getIV_from_mediasequence (self->mediasequence, IV);
+        send_IV = IV;
+      }
+    }
+
+    /* the file takes the reference of its directory above, and one of the key */
+    file = gst_m3u8_media_file_new (self, base, name, parser->title, parser->duration,
+        parser->key_url ? gst_m3u8_intern (self, parser->key_url) : NULL, send_IV,
+        self->mediasequence++);
+    parser->duration = -1;
+    parser->title = NULL;
+    gst_m3u8_add_file (self, file);
+  }
+}
+
+static void
+gst_m3u8_digest (const gchar * data, guint8 * digest)
+{
+  GChecksum *checksum;
+  gsize len = GST_M3U8_DIGEST_SIZE;
+
+  checksum = g_checksum_new (G_CHECKSUM_MD5);
+  g_checksum_update (checksum, (const guchar *) data, -1);
+  g_checksum_get_digest (checksum, digest, &len);
+  g_checksum_free (checksum);
+}
+
 /*
  * @data: a m3u8 playlist text data, taking ownership
  */
 static gboolean
 gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
 {
-  gint val, duration;
-  gchar *title, *end;
-  gboolean discontinuity;
-  GstM3U8 *list;
-  gchar  *key_url = NULL;
-  gchar *IV = NULL;
+  GstM3U8Parser parser;
+  guint8 digest[GST_M3U8_DIGEST_SIZE];
+  gchar *line, *next, *eol;
 
   g_return_val_if_fail (self != NULL, FALSE);
   g_return_val_if_fail (data != NULL, FALSE);
@@ -242,8 +940,9 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
   *updated = TRUE;
 
   /* check if the data changed since last update */
-  if (self->last_data && g_str_equal (self->last_data, data)) {
-    g_print ("\n\n\n\t\t ############ Playlist is the same as previous one ############\n\n\n\n");
+  gst_m3u8_digest (data, digest);
+  if (self->has_last_digest && !memcmp (self->last_digest, digest, sizeof (digest))) {
+    debug_log ("Playlist is the same as previous one\n");
     *updated = FALSE;
     g_free (data);
     return TRUE;
@@ -255,377 +954,67 @@ gst_m3u8_update (GstM3U8 * self, gchar * data, gboolean * updated)
     return FALSE;
   }
 
-  /* playlist has changed from last time.. update last_data */
-  g_free (self->last_data);
-  self->last_data = data;
+  /* playlist has changed from last time.. update digest */
+  memcpy (self->last_digest, digest, sizeof (digest));
+  self->has_last_digest = TRUE;
 
-  if (self->files) {
-    g_list_foreach (self->files, (GFunc) gst_m3u8_media_file_free, NULL);
-    g_list_free (self->files);
-    self->files = NULL;
+  memset (&parser, 0, sizeof (parser));
+  parser.self = self;
+  parser.duration = -1;
+
+  /* files still in the playlist are kept, and only new ones are parsed */
+  if (self->files.len) {
+    parser.known_first = gst_m3u8_file_ring_index (&self->files, 0)->sequence;
+    parser.known_end = parser.known_first + self->files.len;
   }
 
-  list = NULL;
-  duration = -1;
-  title = NULL;
-  key_url = NULL;
-  data += 7;
-  //data += 8;
-  while (TRUE) {
-	//g_print ("====================================\n");
-	//g_print ("data = [%s]\n", data);
-    end = g_utf8_strchr (data, -1, '\n');       /* FIXME: support \r\n */
-    if (end)
-      *end = '\0';
-
-    //g_print ("end = [%s]\n", end);
-
-
-    if (data[0] != '#') {
-      if (duration < 0 && list == NULL) {
-        debug_log ("%s: got line without EXTINF or EXTSTREAMINF, dropping\n", data);
-        goto next_line;
-      }
+  /* it's 0 when there's no EXT-X-MEDIA-SEQUENCE */
+  self->mediasequence = 0;
 
-      if (!gst_uri_is_valid (data)) {
-        gchar *slash;
-        if (!self->uri) {
-          debug_warning ("uri not set, can't build a valid uri\n");
-          goto next_line;
-        }
-        slash = g_utf8_strrchr (self->uri, -1, '/');
-        if (!slash) {
-          debug_warning ("Can't build a valid uri\n");
-          goto next_line;
-        }
-
-        *slash = '\0';
-        data = g_strdup_printf ("%s/%s", self->uri, data);
-        *slash = '/';
-      } else
-        data = g_strdup (data);
-
-      if (list != NULL) {
-        if (g_list_find_custom (self->lists, data,
-                (GCompareFunc) _m3u8_compare_uri)) {
-          debug_log ("Already have a list with this URI\n");
-          gst_m3u8_free (list);
-          g_free (data);
-        } else {
-          gst_m3u8_set_uri (list, data);
-          self->lists = g_list_append (self->lists, list);
-        }
-        list = NULL;
-      } else {
-        GstM3U8MediaFile *file;
-        gchar *send_IV = NULL;
-
-        if (key_url)	
-        {
-          debug_log ("AES-128 key url = %s", key_url);
-          if (NULL == IV)
-          {
-            /* IV is not present in EXT-X-KEY tag. Prepare IV based on mediasequence */
-            debug_log ("IV is not in EXT-X-KEY tag... generating from media_seq_num = %d", self->mediasequence);
-            send_IV = gst_m3u8_getIV_from_mediasequence (self);
-          }
-          else
-          {
-            send_IV = g_strdup (IV);   
-          }
-        }
-  
-        file =
-            gst_m3u8_media_file_new (data, title, duration, key_url, send_IV, self->mediasequence++);
-        duration = -1;
-        title = NULL;
-        g_free (send_IV);
-        self->files = g_list_append (self->files, file);
-      }
+  /* tokenize lines in place. both \n and \r\n are line ends */
+  for (line = data + 7; *line; line = next) {
+    eol = strchr (line, '\n');
+    if (eol) {
+      next = eol + 1;
+    } else {
+      eol = line + strlen (line);
+      next = eol;
+    }
 
-    } else if (g_str_has_prefix (data, "#EXT-X-ENDLIST")) {
-      self->endlist = TRUE;
-    } else if (g_str_has_prefix (data, "#EXT-X-VERSION:")) {
-      if (int_from_string (data + 15, &data, &val, 10))
-        self->version = val;
-    } else if (g_str_has_prefix (data, "#EXT-X-STREAM-INF:")) {
-      gchar *v, *a;
-
-      if (list != NULL) {
-        debug_warning ("Found a list without a uri..., dropping\n");
-        gst_m3u8_free (list);
-      }
+    if (eol > line && eol[-1] == '\r')
+      eol--;
+    *eol = '\0';
 
-      list = gst_m3u8_new ();
-      data = data + 18;
-      while (data && parse_attributes (&data, &a, &v)) {
-        if (g_str_equal (a, "BANDWIDTH")) {
-          if (!int_from_string (v, NULL, &list->bandwidth, 10))
-            debug_warning ("Error while reading BANDWIDTH");
-        } else if (g_str_equal (a, "PROGRAM-ID")) {
-          if (!int_from_string (v, NULL, &list->program_id, 10))
-            debug_warning ("Error while reading PROGRAM-ID");
-        } else if (g_str_equal (a, "CODECS")) {
-          g_free (list->codecs);
-          list->codecs = g_strdup (v);
-        } else if (g_str_equal (a, "RESOLUTION")) {
-          if (!int_from_string (v, &v, &list->width, 10))
-            debug_warning ("Error while reading RESOLUTION width");
-          if (!v || *v != '=') {
-            debug_warning ("Missing height\n");
-          } else {
-            v = g_utf8_next_char (v);
-            if (!int_from_string (v, NULL, &list->height, 10))
-              debug_warning ("Error while reading RESOLUTION height");
-          }
-        }
-      }
-    } else if (g_str_has_prefix (data, "#EXT-X-TARGETDURATION:")) {
-      if (int_from_string (data + 22, &data, &val, 10))
-        self->targetduration = val;
-	// g_print ("\n\n\t\t#########################\n");
-	 //g_print ("\t\tTarget duration = %d\n", val);
-	// g_print ("\n\n\t\t#########################\n");
-
-    } else if (g_str_has_prefix (data, "#EXT-X-MEDIA-SEQUENCE:")) {
-      if (int_from_string (data + 22, &data, &val, 10))
-        self->mediasequence = val;
-    } else if (g_str_has_prefix (data, "#EXT-X-DISCONTINUITY")) {
-      discontinuity = TRUE;
-    } else if (g_str_has_prefix (data, "#EXT-X-PROGRAM-DATE-TIME:")) {
-      /* <YYYY-MM-DDThh:mm:ssZ> */
-      debug_log ("FIXME parse date\n");
-    } else if (g_str_has_prefix (data, "#EXT-X-ALLOW-CACHE:")) {
-      g_free (self->allowcache);
-      self->allowcache = g_strdup (data + 19);
-    } else if (g_str_has_prefix (data, "#EXTINF:")) {
-      if (!int_from_string (data + 8, &data, &val, 10)) {
-        debug_warning ("Can't read EXTINF duration\n");
-        goto next_line;
-      }
-      duration = val;
-      if (duration > self->targetduration)
-        debug_warning ("EXTINF duration > TARGETDURATION\n");
-      if (!data || *data != ',')
-        goto next_line;
-      data = g_utf8_next_char (data);
-      if (data != end) {
-        g_free (title);
-        title = g_strdup (data);
-      }
-    }else if (g_str_has_prefix (data, "#EXT-X-KEY:")){
-      gchar *val, *attr;
-
-	
-      g_print ("\n\n Found EXT-X-KEY tag...\n\n");
-      /* handling encrypted content */
-	  
-      data = data + 11; /* skipping "#EXT-X-KEY:" tag */
-	  
-      while (data && parse_attributes (&data, &attr, &val)) 
-      {
-        if (g_str_equal (attr, "METHOD")) 
-        {
-          if (g_str_equal (val, "NONE"))
-          {
-            g_print ("Non encrypted file...and skipping current line and going to next line\n");
-            goto next_line;
-          }
-          else if (g_str_equal (val, "AES-128"))
-          {
-            /* media files are encrypted */
-            g_print ("media files are encrypted with AES-128");
-            // TODO: indicate in flag whether encrypted files or not
-          }
-        } 
-	 else if (g_str_equal (attr, "URI"))
-	 {
-	   gchar *end_dq = NULL;
-
-	   if (val ==  NULL)
-	   {
-	   	debug_error ("val is NULL");
-	   	break;
-	   }
-	   
-	   val = val + 1; /* eliminating first double quote in url */
-	   if (val ==  NULL)
-	   {
-	   	debug_error ("val is NULL");
-	   	break;
-	   }
-	   
-          end_dq = g_utf8_strrchr (val, -1, '"');
-          if (!end_dq)
-          {
-              debug_error ("end_dq is NULL");
-              break;
-          }
-
-          *end_dq = '\0';
-
-	   g_print ("Key URI = %s\n", val);
-
-          if (!gst_uri_is_valid (val)) 
-          {
-            gchar *slash;
-            if (!self->uri) 
-            {
-              debug_warning ("uri not set, can't build a valid uri");
-              goto next_line;
-            }
-            slash = g_utf8_strrchr (self->uri, -1, '/');
-            if (!slash) 
-            {
-              debug_warning ("Can't build a valid uri");
-              goto next_line;
-            }
-            *slash = '\0';
-            key_url = g_strdup_printf ("%s/%s", self->uri, val);
-            *slash = '/';
-          } 
-          else
-          {
-            key_url= g_strdup (val);
-          }
-	 }
-	 else if (g_str_equal (attr, "IV"))
-	 {
-	   gint iv_len = 0;
-	   gchar tmp_byte[3];
-	   gint tmp_val = 0;
-	   gint idx = 0;
-
-          if (IV)
-          {
-	     g_free (IV);
-            IV = NULL;
-          }
-		  
-          IV = g_malloc0 (16);
-	   if (NULL == IV)
-          {
-            debug_error ("Failed to allocate memory...\n");
-            return FALSE;
-          }
-	   
-	   /* eliminating 0x/0X prefix */
-	   val = val + 2;
-          iv_len = g_utf8_strlen(val, 0);
-          if (iv_len != 16)
-          {
-            debug_warning ("Wrong IV...");
-            return FALSE;
-          }
-	   
-	   while (iv_len)
-	   {
-	   	// TODO: val need to incremented I feel.. check again 
-            g_utf8_strncpy(tmp_byte, val, 2);
-            tmp_byte[2] = '\0';
-            tmp_val = 0;
-            if (!int_from_string (tmp_byte, NULL, &tmp_val, 16))
-              debug_warning ("Error while reading PROGRAM-ID");                    
-	     IV[idx] = tmp_val;	
-	     idx++;
-            iv_len = iv_len - 2;
-            val = val + 2;
-	   }
-	 }
-      }
+    if (line[0] == '\0')
+      continue;
 
-#if 0	  
-      if (g_str_has_prefix (data, "METHOD="))
-      {
-        data = data + 7;
-        if (g_str_has_prefix (data, "AES-128"))
-        {
-          g_print ("AES-128 encrypted media...\n\n");
-          data = data + 8;
-          if (g_str_has_prefix (data, "URI="))
-          {
-            gchar *dob_qu = NULL;
-            gchar  *tmp_key_url = NULL;
-
-            data = data+5;
-			
-            dob_qu = g_utf8_strrchr (data, -1, '"');
-            *dob_qu = '\0';
-			
-            tmp_key_url = g_strdup (data);
-            *dob_qu = '"';	
-            
-            g_print ("URI attribute = %s\n\n", tmp_key_url);
-			
-            if (!gst_uri_is_valid (tmp_key_url)) 
-            {
-              gchar *slash;
-              if (!self->uri) {
-                debug_warning ("uri not set, can't build a valid uri");
-                goto next_line;
-              }
-              slash = g_utf8_strrchr (self->uri, -1, '/');
-              if (!slash) 
-              {
-                debug_warning ("Can't build a valid uri");
-                goto next_line;
-              }
-
-              *slash = '\0';
-              key_url = g_strdup_printf ("%s/%s", self->uri, tmp_key_url);
-              *slash = '/';
-            } 
-            else
-              key_url = g_strdup (tmp_key_url);
-
-            g_print ("\n\n======= Final key url = %s\n\n\n\n", key_url); 
-
-            data = dob_qu;
-	     data = data + 2;
-		 
-            if ((g_str_has_prefix (data, "IV=0x")) && (g_str_has_prefix (data, "IV=0X")))
-            {
-              data = data + 5;
-              g_print ("\n\nSize of IV = %d\n\n", sizeof (data));
-              memcpy (IV, data, sizeof (IV));
-            }
-            else
-            {
-              g_print ("\n\n\n Need to generate IV from media sequence...\n\n");
-            }
-          }
-          else
-          {
-            g_print ("No URI specified...\n\n");
-            return FALSE;
-          }
-        }
-        else if (g_str_has_prefix (data, "NONE"))
-        {
-          g_print ("\n\nNot encrypted.....\n\n\n");
-        }
-        else
-        {
-          g_print ("\n\nUnknown EXT-X-KEY METHOD attri = %s\n\n", data);
-          return FALSE;
-        }
-      }
+    if (line[0] != '#')
+      parse_uri (&parser, line);
+    else if (g_str_has_prefix (line, "#EXT"))
+      parse_tag (&parser, line);
+    /* else comment */
+  }
 
-      else
-      {
-        g_print ("\n\nEXT-X-KEY without METHOD attribute...\n\n");
-        return FALSE;
-      }
-#endif
-    }
-    else {
-      debug_warning ("Ignored line: %s", data);
-    }
+  if (parser.list)
+    gst_m3u8_free (parser.list);
+  gst_m3u8_unintern (self, parser.key_url);
+  g_free (data);
 
-  next_line:
-    if (!end)
-      break;
-    data = g_utf8_next_char (end);      /* skip \n */
+  /* drop files which are not in the playlist anymore */
+  if (!parser.has_first) {
+    gst_m3u8_truncate_files (self, 0);
+  } else {
+    guint expired = 0;
+
+    if (parser.known_end > self->mediasequence)
+      gst_m3u8_truncate_files (self, self->mediasequence - parser.known_first);
+
+    while (expired < self->files.len &&
+        gst_m3u8_file_ring_index (&self->files, expired)->sequence < parser.first)
+      expired++;
+
+    gst_m3u8_expire_files (self, expired);
+    gst_m3u8_arena_release (self, !self->files.len, parser.first);
   }
 
   /* redorder playlists by bitrate */
@@ -684,13 +1073,9 @@ gst_m3u8_client_update (GstM3U8Client * self, gchar * data)
 
   m3u8 = self->current ? self->current : self->main;
 
- // g_print ("\n\n");
-
   if (!gst_m3u8_update (m3u8, data, &updated))
     return FALSE;
 
- // g_print ("\n\n");
-
   if (!updated) {
     self->update_failed_count++;
     return FALSE;
@@ -705,42 +1090,39 @@ gst_m3u8_client_update (GstM3U8Client * self, gchar * data)
     }
   }
 
-  if (m3u8->files && self->sequence == -1) {
-    self->sequence =
-        GST_M3U8_MEDIA_FILE (g_list_first (m3u8->files)->data)->sequence;
+  if (m3u8->files.len && self->sequence == -1) {
+    self->sequence = gst_m3u8_file_ring_index (&m3u8->files, 0)->sequence;
      debug_log ("Setting first sequence at %d", self->sequence);
   }
 
   return TRUE;
 }
 
-static gboolean
-_find_next (GstM3U8MediaFile * file, GstM3U8Client * client)
-{
-  debug_log ("Found fragment %d\n", file->sequence);
-  if (file->sequence >= client->sequence)
-    return FALSE;
-  return TRUE;
-}
-
 const GstM3U8MediaFile *
 gst_m3u8_client_get_next_fragment (GstM3U8Client * client,
     gboolean * discontinuity)
 {
-  GList *l;
-  GstM3U8MediaFile *file;
+  GstM3U8FileRing *files;
+  GstM3U8MediaFile *file = NULL;
 
   g_return_val_if_fail (client != NULL, NULL);
   g_return_val_if_fail (client->current != NULL, NULL);
   g_return_val_if_fail (discontinuity != NULL, NULL);
 
   debug_log ("Looking for fragment %d\n", client->sequence);
-  l = g_list_find_custom (client->current->files, client,
-      (GCompareFunc) _find_next);
-  if (l == NULL)
+
+  /* NOTE : sequence is not set yet if it's -1 */
+  files = &client->current->files;
+  if (!files->len || client->sequence < 0)
     return NULL;
 
-  file = GST_M3U8_MEDIA_FILE (l->data);
+  /* the first one if it's expired */
+  file = gst_m3u8_file_ring_index (files, 0);
+  if ((guint) client->sequence > file->sequence) {
+    file = gst_m3u8_find_file (client->current, client->sequence);
+    if (file == NULL)
+      return NULL;
+  }
 
   *discontinuity = client->sequence != file->sequence;
   client->sequence = file->sequence + 1;
@@ -757,12 +1139,8 @@ gst_m3u8_client_check_next_fragment (GstM3U8Client * client)
   g_return_val_if_fail (client != NULL, FALSE);
   g_return_val_if_fail (client->current != NULL, FALSE);
 
-  GList* cur = g_list_last (client->current->files);
-  while (cur && GST_M3U8_MEDIA_FILE(cur->data)->sequence >= client->sequence)
-  {
-	  left_duration += GST_M3U8_MEDIA_FILE(cur->data)->duration;
-	  cur = g_list_previous (cur);
-  }
+  if (client->sequence >= 0)
+    left_duration = (gint) gst_m3u8_get_remaining_duration (client->current, client->sequence);
 
   debug_log ("left duration = [%d], target duration[%d] * 3 = [%d]\n",
 		  left_duration, client->current->targetduration, client->current->targetduration*3);
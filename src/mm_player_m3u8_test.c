@@ -0,0 +1,378 @@
+/* GStreamer
+ * Copyright (C) 2010 Marc-Andre Lureau <marcandre.lureau@gmail.com>
+ * Copyright (C) 2010 Andoni Morales Alastruey <ylatuya@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* feeds generated playlists to the m3u8 client and checks what it keeps.
+ * heap retained by a 10,000 segment playlist is printed as benchmark */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "mm_player_m3u8.h"
+
+#define M3U8_TEST_SEGMENTS	10000
+#define M3U8_TEST_WINDOW	5
+#define M3U8_TEST_REFRESHES	1000
+#define M3U8_TEST_KEY_PERIOD	3		/* segments per key of live playlist */
+#define M3U8_TEST_DIR_PERIOD	10		/* segments per dated directory of live playlist */
+#define M3U8_TEST_DURATION(sequence)	(8 + (sequence) % 3)
+
+static gint failed = 0;
+
+#define M3U8_TEST_CHECK(expr) \
+do \
+{ \
+	if (!(expr)) \
+	{ \
+		fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		failed++; \
+	} \
+} while (0)
+
+static gsize
+m3u8_test_heap (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	return mallinfo2 ().uordblks;
+#else
+	return mallinfo ().uordblks;
+#endif
+}
+
+/* vod playlist of segments. absolute uris are under one cdn directory */
+static gchar *
+m3u8_test_vod (gint segments, gboolean absolute, gboolean key)
+{
+	GString *text = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:10\n#EXT-X-MEDIA-SEQUENCE:0\n");
+	gint i = 0;
+
+	if (key)
+		g_string_append (text, "#EXT-X-KEY:METHOD=AES-128,URI=\"https://keys.example.com/vod/key.bin\"\n");
+
+	for (i = 0; i < segments; i++)
+	{
+		g_string_append_printf (text, "#EXTINF:10,segment %d\n", i);
+
+		if (absolute)
+			g_string_append_printf (text, "https://cdn.example.com/vod/movie/hd/segment_%05d.ts\n", i);
+		else
+			g_string_append_printf (text, "segment_%05d.ts\n", i);
+	}
+
+	g_string_append (text, "#EXT-X-ENDLIST\n");
+
+	return g_string_free (text, FALSE);
+}
+
+/* live window from first. keys rotate and directories are dated */
+static gchar *
+m3u8_test_live (guint first)
+{
+	GString *text = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:10\n");
+	guint sequence = 0;
+
+	g_string_append_printf (text, "#EXT-X-MEDIA-SEQUENCE:%u\n", first);
+
+	for (sequence = first; sequence < first + M3U8_TEST_WINDOW; sequence++)
+	{
+		if (sequence == first || sequence % M3U8_TEST_KEY_PERIOD == 0)
+			g_string_append_printf (text, "#EXT-X-KEY:METHOD=AES-128,URI=\"https://keys.example.com/live/%u.key\"\n",
+				sequence / M3U8_TEST_KEY_PERIOD);
+
+		g_string_append_printf (text, "#EXTINF:10,\nhttps://cdn.example.com/live/%u/segment_%u.ts\n",
+			sequence / M3U8_TEST_DIR_PERIOD, sequence);
+	}
+
+	return g_string_free (text, FALSE);
+}
+
+static void
+m3u8_test_memory (const gchar *name, gboolean absolute, gboolean key)
+{
+	GstM3U8Client *client = NULL;
+	GstM3U8 *m3u8 = NULL;
+	gchar *text = NULL;
+	gsize heap = 0;
+
+	/* text is freed by update, so it's not counted */
+	heap = m3u8_test_heap ();
+	text = m3u8_test_vod (M3U8_TEST_SEGMENTS, absolute, key);
+	client = gst_m3u8_client_new ("https://cdn.example.com/vod/movie/hd/index.m3u8");
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, text));
+	heap = m3u8_test_heap () - heap;
+
+	m3u8 = client->current;
+	M3U8_TEST_CHECK (m3u8->files.len == M3U8_TEST_SEGMENTS);
+
+	/* one directory for absolute uris and one key */
+	M3U8_TEST_CHECK ((m3u8->strings ? g_hash_table_size (m3u8->strings) : 0) == (absolute ? 1 : 0) + (key ? 1 : 0));
+
+	printf ("%d segments, %-24s : %.2f MB\n", M3U8_TEST_SEGMENTS, name, heap / (1024.0 * 1024.0));
+
+	gst_m3u8_client_free (client);
+}
+
+/* interned strings of expired files are released */
+static void
+m3u8_test_live_strings (void)
+{
+	GstM3U8Client *client = gst_m3u8_client_new ("https://cdn.example.com/live/index.m3u8");
+	GstM3U8 *m3u8 = NULL;
+	guint first = 0;
+	guint i = 0;
+
+	for (first = 0; first < M3U8_TEST_REFRESHES; first++)
+	{
+		M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_live (first)));
+		m3u8 = client->current;
+
+		M3U8_TEST_CHECK (m3u8->files.len == M3U8_TEST_WINDOW);
+
+		/* keys and directories of the window only */
+		M3U8_TEST_CHECK (g_hash_table_size (m3u8->strings) <= 2 * (M3U8_TEST_WINDOW / M3U8_TEST_KEY_PERIOD + 2));
+	}
+
+	for (i = 0; i < m3u8->files.len; i++)
+	{
+		const GstM3U8MediaFile *file = gst_m3u8_file_ring_index (&m3u8->files, i);
+		gchar *key = g_strdup_printf ("https://keys.example.com/live/%u.key", file->sequence / M3U8_TEST_KEY_PERIOD);
+		gchar *uri = g_strdup_printf ("https://cdn.example.com/live/%u/segment_%u.ts",
+			file->sequence / M3U8_TEST_DIR_PERIOD, file->sequence);
+		gchar *file_uri = gst_m3u8_media_file_get_uri (file);
+
+		M3U8_TEST_CHECK (file->key_url && !strcmp (file->key_url, key));
+		M3U8_TEST_CHECK (!strcmp (file_uri, uri));
+
+		g_free (file_uri);
+		g_free (uri);
+		g_free (key);
+	}
+
+	gst_m3u8_client_free (client);
+}
+
+/* file of sequence by ring, as the client doesn't export lookup */
+static const GstM3U8MediaFile *
+m3u8_test_find (GstM3U8 * m3u8, guint sequence)
+{
+	guint first = 0;
+
+	if (!m3u8->files.len)
+		return NULL;
+
+	first = gst_m3u8_file_ring_index (&m3u8->files, 0)->sequence;
+	if (sequence < first || sequence - first >= m3u8->files.len)
+		return NULL;
+
+	return gst_m3u8_file_ring_index (&m3u8->files, sequence - first);
+}
+
+/* window of relative uris. uris from changed on are replaced */
+static gchar *
+m3u8_test_window (guint first, guint count, guint changed)
+{
+	GString *text = g_string_new ("#EXTM3U\n#EXT-X-TARGETDURATION:10\n");
+	guint sequence = 0;
+
+	g_string_append_printf (text, "#EXT-X-MEDIA-SEQUENCE:%u\n", first);
+
+	for (sequence = first; sequence < first + count; sequence++)
+	{
+		g_string_append_printf (text, "#EXTINF:%u,segment %u\nsegment_%u%s.ts\n",
+			M3U8_TEST_DURATION (sequence), sequence, sequence, sequence >= changed ? "_b" : "");
+	}
+
+	return g_string_free (text, FALSE);
+}
+
+/* files are the window, and offsets run on without a hole */
+static void
+m3u8_test_check_window (GstM3U8 * m3u8, guint first, guint count, guint changed)
+{
+	const GstM3U8MediaFile *file = NULL;
+	const GstM3U8MediaFile *prev = NULL;
+	guint i = 0;
+
+	M3U8_TEST_CHECK (m3u8->files.len == count);
+
+	for (i = 0; i < m3u8->files.len && i < count; i++)
+	{
+		gchar *uri = g_strdup_printf ("https://cdn.example.com/live/segment_%u%s.ts",
+			first + i, first + i >= changed ? "_b" : "");
+		gchar *file_uri = NULL;
+
+		file = gst_m3u8_file_ring_index (&m3u8->files, i);
+		file_uri = gst_m3u8_media_file_get_uri (file);
+
+		M3U8_TEST_CHECK (file->sequence == first + i);
+		M3U8_TEST_CHECK (file->duration == M3U8_TEST_DURATION (first + i));
+		M3U8_TEST_CHECK (!strcmp (file_uri, uri));
+		M3U8_TEST_CHECK (m3u8_test_find (m3u8, first + i) == file);
+
+		if (prev)
+			M3U8_TEST_CHECK (file->offset == prev->offset + prev->duration);
+
+		prev = file;
+		g_free (file_uri);
+		g_free (uri);
+	}
+
+	M3U8_TEST_CHECK (m3u8_test_find (m3u8, first + count) == NULL);
+	if (first)
+		M3U8_TEST_CHECK (m3u8_test_find (m3u8, first - 1) == NULL);
+}
+
+/* files still in the window are kept as they are, and fragments follow on */
+static void
+m3u8_test_sliding_window (void)
+{
+	GstM3U8Client *client = gst_m3u8_client_new ("https://cdn.example.com/live/index.m3u8");
+	const GstM3U8MediaFile *kept = NULL;
+	const GstM3U8MediaFile *file = NULL;
+	GstM3U8 *m3u8 = NULL;
+	gboolean discontinuity = FALSE;
+	guint first = 0;
+	guint count = 0;
+
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (0, M3U8_TEST_WINDOW, G_MAXUINT)));
+	m3u8 = client->current;
+
+	/* window grows over the ring and shrinks again */
+	file = gst_m3u8_client_get_next_fragment (client, &discontinuity);
+	M3U8_TEST_CHECK (file && file->sequence == 0 && !discontinuity);
+
+	for (first = 1; first < M3U8_TEST_REFRESHES; first++)
+	{
+		count = M3U8_TEST_WINDOW + (first % 40 < 20 ? first % 40 : 40 - first % 40) * 3;
+		kept = m3u8_test_find (m3u8, first + 1);
+
+		M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (first, count, G_MAXUINT)));
+		m3u8_test_check_window (m3u8, first, count, G_MAXUINT);
+
+		if (kept)
+			M3U8_TEST_CHECK (m3u8_test_find (m3u8, first + 1) == kept);
+
+		file = gst_m3u8_client_get_next_fragment (client, &discontinuity);
+		M3U8_TEST_CHECK (file && file->sequence == first && !discontinuity);
+	}
+
+	/* same text is not parsed again */
+	M3U8_TEST_CHECK (!gst_m3u8_client_update (client, m3u8_test_window (first - 1, count, G_MAXUINT)));
+	m3u8_test_check_window (m3u8, first - 1, count, G_MAXUINT);
+
+	/* sequences skipped by a late refresh are reported */
+	first += 2 * count;
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (first, M3U8_TEST_WINDOW, G_MAXUINT)));
+	m3u8_test_check_window (m3u8, first, M3U8_TEST_WINDOW, G_MAXUINT);
+
+	file = gst_m3u8_client_get_next_fragment (client, &discontinuity);
+	M3U8_TEST_CHECK (file && file->sequence == first && discontinuity);
+
+	gst_m3u8_client_free (client);
+}
+
+/* files before the changed one are kept, and the rest is parsed again */
+static void
+m3u8_test_uri_change (void)
+{
+	GstM3U8Client *client = gst_m3u8_client_new ("https://cdn.example.com/live/index.m3u8");
+	const GstM3U8MediaFile *before = NULL;
+	const GstM3U8MediaFile *file = NULL;
+	GstM3U8 *m3u8 = NULL;
+	gint64 offset = 0;
+
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (100, 10, G_MAXUINT)));
+	m3u8 = client->current;
+	m3u8_test_check_window (m3u8, 100, 10, G_MAXUINT);
+
+	before = m3u8_test_find (m3u8, 104);
+	offset = m3u8_test_find (m3u8, 105)->offset;
+
+	/* 105 has new uri. window also slides by one */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (101, 10, 105)));
+	m3u8_test_check_window (m3u8, 101, 10, 105);
+
+	M3U8_TEST_CHECK (m3u8_test_find (m3u8, 104) == before);
+	file = m3u8_test_find (m3u8, 105);
+	M3U8_TEST_CHECK (file && file->offset == offset);
+
+	/* changed back at the last one */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (101, 10, 110)));
+	m3u8_test_check_window (m3u8, 101, 10, 110);
+	M3U8_TEST_CHECK (m3u8_test_find (m3u8, 104) == before);
+
+	/* the first one changes */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (101, 10, 101)));
+	m3u8_test_check_window (m3u8, 101, 10, 101);
+
+	gst_m3u8_client_free (client);
+}
+
+/* restarted stream. nothing of old window is kept */
+static void
+m3u8_test_sequence_back (void)
+{
+	GstM3U8Client *client = gst_m3u8_client_new ("https://cdn.example.com/live/index.m3u8");
+	GstM3U8 *m3u8 = NULL;
+
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (500, 10, G_MAXUINT)));
+	m3u8 = client->current;
+	m3u8_test_check_window (m3u8, 500, 10, G_MAXUINT);
+
+	/* overlaps old window in part */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (495, 10, 495)));
+	m3u8_test_check_window (m3u8, 495, 10, 495);
+
+	/* far back, and strings of old files are released */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (0, M3U8_TEST_WINDOW, G_MAXUINT)));
+	m3u8_test_check_window (m3u8, 0, M3U8_TEST_WINDOW, G_MAXUINT);
+	M3U8_TEST_CHECK ((m3u8->strings ? g_hash_table_size (m3u8->strings) : 0) == 0);
+
+	/* and goes on from there */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, m3u8_test_window (2, M3U8_TEST_WINDOW, G_MAXUINT)));
+	m3u8_test_check_window (m3u8, 2, M3U8_TEST_WINDOW, G_MAXUINT);
+
+	/* empty playlist drops all */
+	M3U8_TEST_CHECK (gst_m3u8_client_update (client, g_strdup ("#EXTM3U\n#EXT-X-TARGETDURATION:10\n")));
+	M3U8_TEST_CHECK (m3u8->files.len == 0);
+
+	gst_m3u8_client_free (client);
+}
+
+int
+main (int argc, char *argv[])
+{
+	m3u8_test_memory ("relative uris, clear", FALSE, FALSE);
+	m3u8_test_memory ("relative uris, AES-128", FALSE, TRUE);
+	m3u8_test_memory ("absolute uris, clear", TRUE, FALSE);
+	m3u8_test_memory ("absolute uris, AES-128", TRUE, TRUE);
+
+	m3u8_test_live_strings ();
+	m3u8_test_sliding_window ();
+	m3u8_test_uri_change ();
+	m3u8_test_sequence_back ();
+
+	if (failed)
+	{
+		fprintf (stderr, "%d checks failed\n", failed);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,962 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <string.h>
+
+#include <mm_debug.h>
+#include <mm_error.h>
+#include <mm_attrs.h>
+#include "mm_player_pcm.h"
+#include "mm_player_ini.h"
+#include "mm_player_utils.h"
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_PCM_CHUNK_MAX			65536
+#define MMPLAYER_PCM_RING_CHUNKS		8		/* ring keeps this many chunks at least */
+#define MMPLAYER_PCM_S16_SIZE			2
+
+#define MMPLAYER_PCM_SEGMENT_MAX		8
+#define MMPLAYER_PCM_SEGMENT_MIN_MSEC	10000	/* don't split range into segments shorter than this */
+#define MMPLAYER_PCM_POLL_MSEC			100
+#define MMPLAYER_PCM_SEGMENT_QUEUE_MAX	(1024 * 1024)	/* bytes decoded ahead of delivery per segment */
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS for internal								|
+---------------------------------------------------------------------------*/
+/* a segment of pcm extraction. each segment is decoded by its own pipeline */
+typedef struct
+{
+	GstElement *pipeline;
+	GstElement *conv;
+	GAsyncQueue *queue;			/* decoded buffers waiting for delivery */
+	GMutex *lock;
+	GCond *cond;				/* signaled when queued bytes are delivered */
+	guint queued;				/* bytes in queue */
+	gboolean flushing;			/* decoder doesn't wait for delivery any more */
+
+	gint64 start;				/* range of segment in nsec */
+	gint64 end;
+	guint64 first;				/* range of segment in samples */
+	guint64 last;
+	guint64 next;				/* next sample to deliver */
+} MMPlayerPcmSegment;
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static gpointer __mmplayer_pcm_batch_thread(gpointer data);
+static gboolean __mmplayer_pcm_batch_alloc(MMPlayerPcmBatch *batch, GstBuffer *buffer);
+static void __mmplayer_pcm_batch_deliver(MMPlayerPcmBatch *batch, guint frames);
+static void __mmplayer_pcm_batch_free(MMPlayerPcmBatch *batch);
+static int __mmplayer_pcm_segment_create(MMPlayerPcmSegment *segment, const gchar *uri, int samplerate, int channels, int depth);
+static void __mmplayer_pcm_segment_destroy(MMPlayerPcmSegment *segment);
+static void __mmplayer_pcm_segment_pad_added(GstElement *element, GstPad *pad, gpointer data);
+static void __mmplayer_pcm_segment_handoff(GstElement *fakesink, GstBuffer *buffer, GstPad *pad, gpointer data);
+static int __mmplayer_pcm_segment_preroll(MMPlayerPcmSegment *segment, gint timeout);
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+int
+_mmplayer_set_pcm_batch(MMHandleType hplayer, int chunk_frames, MMPlayerPcmFormat format, int planar)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	debug_fenter();
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(chunk_frames >= 0 && chunk_frames <= MMPLAYER_PCM_CHUNK_MAX, MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(format == MM_PLAYER_PCM_FORMAT_S16 || format == MM_PLAYER_PCM_FORMAT_F32, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	if (player->pcm_batch)
+	{
+		debug_warning("can't change batch while audio stream is delivered");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	player->pcm_batch_frames = chunk_frames;
+	player->pcm_batch_format = format;
+	player->pcm_batch_planar = planar ? TRUE : FALSE;
+
+	debug_log("pcm batch : %d frames, format %d, planar %d\n", chunk_frames, format, planar);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_get_pcm_batch_stat(MMHandleType hplayer, MMPlayerPcmBatchStat *stat)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	return_val_if_fail(player && player->pcm_batch_lock, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(stat, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	g_mutex_lock(player->pcm_batch_lock);
+
+	if (player->pcm_batch)
+	{
+		MMPlayerPcmBatch *batch = player->pcm_batch;
+
+		g_mutex_lock(batch->lock);
+		stat->delivered_frames = batch->stat.delivered_frames;
+		g_mutex_unlock(batch->lock);
+
+		stat->overruns = (unsigned int)g_atomic_int_get((gint *)&batch->stat.overruns);
+		stat->dropped_frames = (unsigned int)g_atomic_int_get((gint *)&batch->stat.dropped_frames);
+	}
+	else
+	{
+		*stat = player->pcm_batch_stat;
+	}
+
+	g_mutex_unlock(player->pcm_batch_lock);
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_start_pcm_batch(mm_player_t* player)
+{
+	MMPlayerPcmBatch *batch = NULL;
+
+	debug_fenter();
+
+	return_val_if_fail(player && player->pcm_batch_lock, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(player->audio_stream_cb && player->pcm_batch_frames > 0, MM_ERROR_PLAYER_INTERNAL);
+
+	if (player->pcm_batch)
+		return MM_ERROR_NONE;
+
+	batch = g_try_new0(MMPlayerPcmBatch, 1);
+	if ( !batch )
+		return MM_ERROR_PLAYER_NO_FREE_SPACE;
+
+	batch->chunk_frames = player->pcm_batch_frames;
+	batch->format = player->pcm_batch_format;
+	batch->planar = player->pcm_batch_planar;
+	batch->callback = player->audio_stream_cb;
+	batch->user_param = player->audio_stream_cb_user_param;
+
+	batch->lock = g_mutex_new();
+	batch->cond = g_cond_new();
+	if ( !batch->lock || !batch->cond )
+		goto ERROR;
+
+	batch->thread = g_thread_create(__mmplayer_pcm_batch_thread, (gpointer)batch, TRUE, NULL);
+	if ( !batch->thread )
+	{
+		debug_error("failed to create pcm delivery thread\n");
+		goto ERROR;
+	}
+
+	g_mutex_lock(player->pcm_batch_lock);
+	memset(&player->pcm_batch_stat, 0x00, sizeof(MMPlayerPcmBatchStat));
+	player->pcm_batch = batch;
+	g_mutex_unlock(player->pcm_batch_lock);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+
+ERROR:
+	__mmplayer_pcm_batch_free(batch);
+
+	return MM_ERROR_PLAYER_INTERNAL;
+}
+
+void
+_mmplayer_stop_pcm_batch(mm_player_t* player, gboolean flush)
+{
+	MMPlayerPcmBatch *batch = NULL;
+
+	debug_fenter();
+
+	return_if_fail(player);
+
+	if (!player->pcm_batch || !player->pcm_batch_lock)
+		return;
+
+	/* NOTE : probe doesn't take the lock. caller should make sure that
+	 * streaming thread doesn't push any more. (EOS, probe removed or pipeline stopped)
+	 */
+	g_mutex_lock(player->pcm_batch_lock);
+	batch = player->pcm_batch;
+	player->pcm_batch = NULL;
+	g_mutex_unlock(player->pcm_batch_lock);
+
+	g_mutex_lock(batch->lock);
+	g_atomic_int_set(&batch->flush, flush);
+	g_atomic_int_set(&batch->exit, TRUE);
+	g_cond_signal(batch->cond);
+	g_mutex_unlock(batch->lock);
+
+	debug_log("waiting for pcm delivery thread exit\n");
+	g_thread_join(batch->thread);
+	batch->thread = NULL;
+
+	g_mutex_lock(player->pcm_batch_lock);
+	player->pcm_batch_stat = batch->stat;
+	g_mutex_unlock(player->pcm_batch_lock);
+
+	debug_log("pcm batch stopped. %llu frames delivered, %u overruns, %u frames dropped\n",
+		batch->stat.delivered_frames, batch->stat.overruns, batch->stat.dropped_frames);
+
+	__mmplayer_pcm_batch_free(batch);
+
+	debug_fleave();
+}
+
+/**
+  * Decodes the range with separated pipelines which are not synchronized to clock.
+  * The range is split into segments decoded in parallel, and buffers of each segment
+  * are queued until all the segments before it are delivered. Buffers are trimmed
+  * at sample boundary of segment, so that stitched stream has no gap or overlap.
+  */
+int
+_mmplayer_extract_pcm(MMHandleType hplayer, int start_msec, int end_msec, int segment_count,
+	mm_player_audio_stream_callback callback, mm_player_pcm_progress_callback progress_callback, void *user_param)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerPcmSegment segments[MMPLAYER_PCM_SEGMENT_MAX];
+	MMPlayerPcmSegment *segment = NULL;
+	GstFormat fmt = GST_FORMAT_TIME;
+	gint64 duration = 0;
+	gint64 range = 0;
+	gchar *uri = NULL;
+	int samplerate = 0;
+	int channels = 0;
+	int depth = 0;
+	gint timeout = 0;
+	guint64 total = 0;
+	guint64 delivered = 0;
+	int percent = 0;
+	int ret = MM_ERROR_NONE;
+	int i = 0;
+
+	debug_fenter();
+
+	return_val_if_fail(player && player->attrs, MM_ERROR_PLAYER_NOT_INITIALIZED);
+	return_val_if_fail(callback, MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(start_msec >= 0 && end_msec >= 0, MM_ERROR_COMMON_INVALID_ARGUMENT);
+	return_val_if_fail(end_msec == 0 || start_msec < end_msec, MM_ERROR_COMMON_INVALID_ARGUMENT);
+
+	memset(segments, 0x00, sizeof(segments));
+
+	segment_count = CLAMP(segment_count, 1, MMPLAYER_PCM_SEGMENT_MAX);
+
+	mm_attrs_multiple_get(player->attrs,
+		NULL,
+		"profile_uri", &uri,
+		"pcm_extraction_samplerate", &samplerate,
+		"pcm_extraction_channels", &channels,
+		"pcm_extraction_depth", &depth,
+		NULL);
+
+	if ( !uri || !gst_uri_is_valid(uri) )
+	{
+		debug_error("invalid uri to extract pcm\n");
+		return MM_ERROR_PLAYER_INVALID_URI;
+	}
+
+	if ( samplerate <= 0 || channels <= 0 || depth <= 0 )
+	{
+		debug_error("invalid pcm format. rate %d, channels %d, depth %d\n", samplerate, channels, depth);
+		return MM_ERROR_COMMON_INVALID_ARGUMENT;
+	}
+
+	timeout = PLAYER_INI()->localplayback_state_change_timeout;
+
+	/* first segment tells the duration */
+	ret = __mmplayer_pcm_segment_create(&segments[0], uri, samplerate, channels, depth);
+	if ( ret == MM_ERROR_NONE )
+		ret = __mmplayer_pcm_segment_preroll(&segments[0], timeout);
+	if ( ret != MM_ERROR_NONE )
+		goto ERROR;
+
+	if ( !gst_element_query_duration(segments[0].pipeline, &fmt, &duration) || duration <= 0 )
+	{
+		debug_warning("failed to get duration. extracting without segments\n");
+		duration = 0;
+		segment_count = 1;
+	}
+
+	if ( duration && end_msec == 0 )
+		end_msec = GST_TIME_AS_MSECONDS(duration);
+
+	if ( duration && (start_msec >= end_msec || end_msec > GST_TIME_AS_MSECONDS(duration)) )
+	{
+		debug_error("invalid range [%d ~ %d] for duration %lld msec\n", start_msec, end_msec, GST_TIME_AS_MSECONDS(duration));
+		ret = MM_ERROR_COMMON_INVALID_ARGUMENT;
+		goto ERROR;
+	}
+
+	/* range is unknown if neither end nor duration is given */
+	range = end_msec ? (gint64)(end_msec - start_msec) * GST_MSECOND : 0;
+	if ( range > 0 )
+		segment_count = MIN(segment_count, MAX(1, (end_msec - start_msec) / MMPLAYER_PCM_SEGMENT_MIN_MSEC));
+	else
+		segment_count = 1;
+
+	debug_log("extracting pcm [%d ~ %d] msec with %d segments\n", start_msec, end_msec, segment_count);
+
+	for ( i = 0; i < segment_count; i++ )
+	{
+		segment = &segments[i];
+
+		if ( i > 0 )
+		{
+			ret = __mmplayer_pcm_segment_create(segment, uri, samplerate, channels, depth);
+			if ( ret == MM_ERROR_NONE )
+				ret = __mmplayer_pcm_segment_preroll(segment, timeout);
+			if ( ret != MM_ERROR_NONE )
+				goto ERROR;
+		}
+
+		segment->start = (gint64)start_msec * GST_MSECOND + range * i / segment_count;
+		segment->end = (range > 0) ? ((gint64)start_msec * GST_MSECOND + range * (i + 1) / segment_count) : -1;
+
+		/* boundaries of neighbouring segments are the same sample */
+		segment->first = gst_util_uint64_scale_round(segment->start, samplerate, GST_SECOND);
+		segment->last = (segment->end < 0) ? G_MAXUINT64 : gst_util_uint64_scale_round(segment->end, samplerate, GST_SECOND);
+		segment->next = segment->first;
+
+		if ( segment->last != G_MAXUINT64 )
+			total += segment->last - segment->first;
+
+		if ( !gst_element_seek(segment->pipeline, 1.0, GST_FORMAT_TIME,
+				( GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE ),
+				GST_SEEK_TYPE_SET, segment->start,
+				(segment->end < 0) ? GST_SEEK_TYPE_NONE : GST_SEEK_TYPE_SET, segment->end) )
+		{
+			debug_error("failed to seek segment %d to %lld nsec\n", i, segment->start);
+			ret = MM_ERROR_PLAYER_SEEK;
+			goto ERROR;
+		}
+
+		/* no sink is synchronized to clock, so it runs as fast as decoder can */
+		gst_element_set_state(segment->pipeline, GST_STATE_PLAYING);
+	}
+
+	/* deliver segments in order. later segments keep decoding meanwhile */
+	for ( i = 0; i < segment_count; i++ )
+	{
+		GstBus *bus = NULL;
+		GstMessage *msg = NULL;
+		GstBuffer *buffer = NULL;
+		GTimeVal abs_timeout;
+		gint idle_msec = 0;
+		gboolean eos = FALSE;
+
+		segment = &segments[i];
+		bus = gst_pipeline_get_bus(GST_PIPELINE(segment->pipeline));
+
+		while ( TRUE )
+		{
+			g_get_current_time(&abs_timeout);
+			g_time_val_add(&abs_timeout, MMPLAYER_PCM_POLL_MSEC * 1000);
+
+			/* sink posts EOS after rendering the last buffer. so, queue is drained after EOS */
+			buffer = eos ? (GstBuffer *)g_async_queue_try_pop(segment->queue)
+						: (GstBuffer *)g_async_queue_timed_pop(segment->queue, &abs_timeout);
+
+			if ( buffer )
+			{
+				GstStructure *str = GST_BUFFER_CAPS(buffer) ? gst_caps_get_structure(GST_BUFFER_CAPS(buffer), 0) : NULL;
+				gint width = 0;
+				guint frame_size = 0;
+				guint64 offset = segment->next;
+				guint64 frames = 0;
+				guint64 from = 0;
+				guint64 to = 0;
+
+				if ( str )
+					gst_structure_get_int(str, "width", &width);
+				frame_size = channels * ((width ? width : depth) / 8);
+
+				if ( frame_size )
+				{
+					frames = GST_BUFFER_SIZE(buffer) / frame_size;
+
+					if ( GST_BUFFER_TIMESTAMP_IS_VALID(buffer) )
+						offset = gst_util_uint64_scale_round(GST_BUFFER_TIMESTAMP(buffer), samplerate, GST_SECOND);
+
+					from = MAX(offset, segment->next);
+					to = MIN(offset + frames, segment->last);
+
+					if ( to > from )
+					{
+						callback((void *)(GST_BUFFER_DATA(buffer) + (from - offset) * frame_size),
+							(int)((to - from) * frame_size), user_param);
+
+						segment->next = to;
+						delivered += to - from;
+					}
+				}
+
+				g_mutex_lock(segment->lock);
+				segment->queued -= GST_BUFFER_SIZE(buffer);
+				g_cond_signal(segment->cond);
+				g_mutex_unlock(segment->lock);
+
+				gst_buffer_unref(buffer);
+				idle_msec = 0;
+
+				if ( progress_callback && total && (int)(delivered * 100 / total) > percent )
+				{
+					percent = (int)(delivered * 100 / total);
+					progress_callback((int)gst_util_uint64_scale(delivered, 1000, samplerate),
+						end_msec - start_msec, user_param);
+				}
+
+				continue;
+			}
+
+			if ( eos )
+				break;
+
+			msg = gst_bus_pop_filtered(bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+			if ( msg )
+			{
+				if ( GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR )
+				{
+					debug_error("error while decoding segment %d\n", i);
+					ret = MM_ERROR_PLAYER_INTERNAL;
+				}
+				else
+				{
+					eos = TRUE;
+				}
+
+				gst_message_unref(msg);
+
+				if ( ret != MM_ERROR_NONE )
+					break;
+
+				continue;
+			}
+
+			idle_msec += MMPLAYER_PCM_POLL_MSEC;
+			if ( idle_msec > timeout * 1000 )
+			{
+				debug_error("segment %d is not decoded for %d sec\n", i, timeout);
+				ret = MM_ERROR_PLAYER_INTERNAL;
+				break;
+			}
+		}
+
+		gst_object_unref(bus);
+
+		if ( ret != MM_ERROR_NONE )
+			goto ERROR;
+
+		/* release decoder of the segment as soon as possible */
+		__mmplayer_pcm_segment_destroy(segment);
+	}
+
+	/* samples at the edges can be short by rounding */
+	if ( progress_callback && total && percent < 100 )
+		progress_callback(end_msec - start_msec, end_msec - start_msec, user_param);
+
+	debug_log("%llu frames of pcm extracted\n", delivered);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+
+ERROR:
+	for ( i = 0; i < MMPLAYER_PCM_SEGMENT_MAX; i++ )
+		__mmplayer_pcm_segment_destroy(&segments[i]);
+
+	return ret;
+}
+
+/**
+  * Copies decoded frames into the ring. It never takes a lock except waking up
+  * delivery thread which is waiting for a chunk.
+  */
+void
+_mmplayer_push_pcm_batch(mm_player_t* player, GstBuffer *buffer)
+{
+	MMPlayerPcmBatch *batch = player->pcm_batch;
+	guint8 *data = GST_BUFFER_DATA(buffer);
+	guint size = GST_BUFFER_SIZE(buffer);
+	guint frame_size = 0;
+	guint frames = 0;
+	guint head = 0;
+	guint tail = 0;
+	guint offset = 0;
+	guint count = 0;
+
+	if ( !batch || !data || !size )
+		return;
+
+	if ( !batch->ring && !batch->passthrough )
+	{
+		if ( !__mmplayer_pcm_batch_alloc(batch, buffer) )
+			batch->passthrough = TRUE;
+	}
+
+	if (batch->passthrough)
+	{
+		batch->callback((void *)data, size, batch->user_param);
+		return;
+	}
+
+	frame_size = batch->channels * MMPLAYER_PCM_S16_SIZE;
+	frames = size / frame_size;
+
+	/* head is written by this thread only */
+	head = (guint)g_atomic_int_get(&batch->head);
+	tail = (guint)g_atomic_int_get(&batch->tail);
+
+	if (batch->ring_frames - (head - tail) < frames)
+	{
+		/* drop whole buffer rather than cutting it, so that delivered stream has only gaps */
+		g_atomic_int_inc((gint *)&batch->stat.overruns);
+		g_atomic_int_add((gint *)&batch->stat.dropped_frames, frames);
+		return;
+	}
+
+	offset = head & (batch->ring_frames - 1);
+	count = MIN(frames, batch->ring_frames - offset);
+
+	memcpy(batch->ring + offset * frame_size, data, count * frame_size);
+	if (count < frames)
+		memcpy(batch->ring, data + count * frame_size, (frames - count) * frame_size);
+
+	/* publish frames. it's a full barrier, so delivery thread sees the data before head */
+	g_atomic_int_set(&batch->head, (gint)(head + frames));
+
+	if ( (head + frames - tail) >= (guint)batch->chunk_frames && g_atomic_int_get(&batch->waiting) )
+	{
+		g_mutex_lock(batch->lock);
+		g_cond_signal(batch->cond);
+		g_mutex_unlock(batch->lock);
+	}
+}
+
+/**
+  * Takes stream format from caps of the first buffer and allocates ring for it.
+  * Only native endian S16 is batched, others are delivered as they are.
+  */
+static gboolean
+__mmplayer_pcm_batch_alloc(MMPlayerPcmBatch *batch, GstBuffer *buffer)
+{
+	GstCaps *caps = GST_BUFFER_CAPS(buffer);
+	GstStructure *str = NULL;
+	gint width = 0;
+	gint endianness = G_BYTE_ORDER;
+	gboolean is_signed = TRUE;
+	guint ring_frames = 1;
+	guint min_frames = 0;
+
+	if ( !caps )
+	{
+		debug_warning("no caps on audio buffer. deliver it directly\n");
+		return FALSE;
+	}
+
+	str = gst_caps_get_structure(caps, 0);
+	if ( !str || !gst_structure_has_name(str, "audio/x-raw-int") )
+	{
+		debug_warning("not raw int audio. deliver it directly\n");
+		return FALSE;
+	}
+
+	gst_structure_get_int(str, "width", &width);
+	gst_structure_get_int(str, "endianness", &endianness);
+	gst_structure_get_boolean(str, "signed", &is_signed);
+	gst_structure_get_int(str, "channels", &batch->channels);
+	gst_structure_get_int(str, "rate", &batch->rate);
+
+	if (width != 16 || endianness != G_BYTE_ORDER || !is_signed || batch->channels <= 0)
+	{
+		debug_warning("width %d, endianness %d, signed %d, channels %d is not supported. deliver it directly\n",
+			width, endianness, is_signed, batch->channels);
+		return FALSE;
+	}
+
+	/* at least a second, so that short hiccup of callback doesn't make overrun */
+	min_frames = MAX((guint)batch->chunk_frames * MMPLAYER_PCM_RING_CHUNKS, (guint)batch->rate);
+	while (ring_frames < min_frames)
+		ring_frames <<= 1;
+
+	batch->ring = g_try_malloc(ring_frames * batch->channels * MMPLAYER_PCM_S16_SIZE);
+	batch->chunk = g_try_malloc(batch->chunk_frames * batch->channels * sizeof(gfloat));
+	if ( !batch->ring || !batch->chunk )
+	{
+		debug_error("failed to alloc pcm ring\n");
+		MMPLAYER_FREEIF(batch->ring);
+		MMPLAYER_FREEIF(batch->chunk);
+		return FALSE;
+	}
+
+	batch->ring_frames = ring_frames;
+
+	debug_log("pcm ring : %u frames of %d channels, %d Hz\n", ring_frames, batch->channels, batch->rate);
+
+	return TRUE;
+}
+
+/**
+  * Converts frames at tail into chunk and calls callback with it.
+  * Tail is moved before calling callback, so producer can reuse the space meanwhile.
+  */
+static void
+__mmplayer_pcm_batch_deliver(MMPlayerPcmBatch *batch, guint frames)
+{
+	guint tail = (guint)g_atomic_int_get(&batch->tail);
+	guint mask = batch->ring_frames - 1;
+	int channels = batch->channels;
+	int sample_size = (batch->format == MM_PLAYER_PCM_FORMAT_F32) ? sizeof(gfloat) : MMPLAYER_PCM_S16_SIZE;
+	gint16 *src = NULL;
+	guint i = 0;
+	int c = 0;
+
+	for (i = 0; i < frames; i++)
+	{
+		src = (gint16 *)(batch->ring + ((tail + i) & mask) * channels * MMPLAYER_PCM_S16_SIZE);
+
+		if (batch->format == MM_PLAYER_PCM_FORMAT_F32)
+		{
+			gfloat *dst = (gfloat *)batch->chunk;
+
+			for (c = 0; c < channels; c++)
+				dst[batch->planar ? (c * frames + i) : (i * channels + c)] = src[c] / 32768.0f;
+		}
+		else if (batch->planar)
+		{
+			gint16 *dst = (gint16 *)batch->chunk;
+
+			for (c = 0; c < channels; c++)
+				dst[c * frames + i] = src[c];
+		}
+		else
+		{
+			memcpy(batch->chunk + i * channels * MMPLAYER_PCM_S16_SIZE, src, channels * MMPLAYER_PCM_S16_SIZE);
+		}
+	}
+
+	g_atomic_int_set(&batch->tail, (gint)(tail + frames));
+
+	batch->callback((void *)batch->chunk, frames * channels * sample_size, batch->user_param);
+
+	g_mutex_lock(batch->lock);
+	batch->stat.delivered_frames += frames;
+	g_mutex_unlock(batch->lock);
+}
+
+static gpointer
+__mmplayer_pcm_batch_thread(gpointer data)
+{
+	MMPlayerPcmBatch *batch = (MMPlayerPcmBatch *) data;
+	guint avail = 0;
+
+	debug_log("pcm delivery thread started\n");
+
+	while (TRUE)
+	{
+		avail = (guint)g_atomic_int_get(&batch->head) - (guint)g_atomic_int_get(&batch->tail);
+
+		if ( g_atomic_int_get(&batch->exit) && !g_atomic_int_get(&batch->flush) )
+			break;
+
+		if ( avail >= (guint)batch->chunk_frames )
+		{
+			__mmplayer_pcm_batch_deliver(batch, batch->chunk_frames);
+			continue;
+		}
+
+		/* the last chunk of stream */
+		if ( avail && g_atomic_int_get(&batch->flush) )
+		{
+			__mmplayer_pcm_batch_deliver(batch, avail);
+			continue;
+		}
+
+		g_mutex_lock(batch->lock);
+
+		if ( g_atomic_int_get(&batch->exit) )
+		{
+			g_mutex_unlock(batch->lock);
+			break;
+		}
+
+		/* producer checks waiting after publishing head, so checking head again
+		 * after setting waiting doesn't miss the signal.
+		 */
+		g_atomic_int_set(&batch->waiting, TRUE);
+
+		avail = (guint)g_atomic_int_get(&batch->head) - (guint)g_atomic_int_get(&batch->tail);
+		if ( avail < (guint)batch->chunk_frames )
+			g_cond_wait(batch->cond, batch->lock);
+
+		g_atomic_int_set(&batch->waiting, FALSE);
+
+		g_mutex_unlock(batch->lock);
+	}
+
+	debug_log("pcm delivery thread finished\n");
+
+	return NULL;
+}
+
+static void
+__mmplayer_pcm_batch_free(MMPlayerPcmBatch *batch)
+{
+	if ( !batch )
+		return;
+
+	if (batch->lock)
+		g_mutex_free(batch->lock);
+
+	if (batch->cond)
+		g_cond_free(batch->cond);
+
+	MMPLAYER_FREEIF(batch->ring);
+	MMPLAYER_FREEIF(batch->chunk);
+
+	g_free(batch);
+}
+
+/**
+  * PCM SEGMENT
+  * - uridecodebin ! audioconvert ! audioresample ! capsfilter ! fakesink
+  */
+static int
+__mmplayer_pcm_segment_create(MMPlayerPcmSegment *segment, const gchar *uri, int samplerate, int channels, int depth)
+{
+	GstElement *resampler = NULL;
+	GstElement *filter = NULL;
+	GstElement *sink = NULL;
+	GstElement *src = NULL;
+	GstCaps *caps = NULL;
+
+	return_val_if_fail ( segment && uri, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	segment->queue = g_async_queue_new();
+	segment->lock = g_mutex_new();
+	segment->cond = g_cond_new();
+	segment->pipeline = gst_pipeline_new("pcm_extractor");
+	src = gst_element_factory_make("uridecodebin", "pcm_extractor_src");
+	segment->conv = gst_element_factory_make("audioconvert", "pcm_extractor_conv");
+	resampler = gst_element_factory_make("audioresample", "pcm_extractor_resampler");
+	filter = gst_element_factory_make("capsfilter", "pcm_extractor_filter");
+	sink = gst_element_factory_make("fakesink", "pcm_extractor_sink");
+
+	if ( !segment->queue || !segment->lock || !segment->cond || !segment->pipeline || !src || !segment->conv ||
+		!resampler || !filter || !sink )
+	{
+		debug_error("failed to create elements of pcm extractor\n");
+		goto ERROR;
+	}
+
+	g_object_set(G_OBJECT(src), "uri", uri, NULL);
+
+	/* same output with pcm extraction of player */
+	caps = gst_caps_new_simple ("audio/x-raw-int",
+				"rate", G_TYPE_INT, samplerate,
+				"channels", G_TYPE_INT, channels,
+				"depth", G_TYPE_INT, depth,
+				NULL);
+	g_object_set(G_OBJECT(filter), "caps", caps, NULL);
+	gst_caps_unref(caps);
+
+	g_object_set(G_OBJECT(sink), "sync", FALSE, "signal-handoffs", TRUE, NULL);
+
+	gst_bin_add_many(GST_BIN(segment->pipeline), src, segment->conv, resampler, filter, sink, NULL);
+
+	if ( !GST_ELEMENT_LINK_MANY(segment->conv, resampler, filter, sink, NULL) )
+	{
+		debug_error("failed to link elements of pcm extractor\n");
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	g_signal_connect(G_OBJECT(src), "pad-added",
+		G_CALLBACK(__mmplayer_pcm_segment_pad_added), segment);
+	g_signal_connect(G_OBJECT(sink), "handoff",
+		G_CALLBACK(__mmplayer_pcm_segment_handoff), segment);
+
+	return MM_ERROR_NONE;
+
+ERROR:
+	/* elements are not added to bin yet */
+	if ( src )
+		gst_object_unref(GST_OBJECT(src));
+	if ( segment->conv )
+		gst_object_unref(GST_OBJECT(segment->conv));
+	if ( resampler )
+		gst_object_unref(GST_OBJECT(resampler));
+	if ( filter )
+		gst_object_unref(GST_OBJECT(filter));
+	if ( sink )
+		gst_object_unref(GST_OBJECT(sink));
+	if ( segment->pipeline )
+		gst_object_unref(GST_OBJECT(segment->pipeline));
+	if ( segment->queue )
+		g_async_queue_unref(segment->queue);
+	if ( segment->lock )
+		g_mutex_free(segment->lock);
+	if ( segment->cond )
+		g_cond_free(segment->cond);
+
+	memset(segment, 0x00, sizeof(MMPlayerPcmSegment));
+
+	return MM_ERROR_PLAYER_INTERNAL;
+}
+
+static void
+__mmplayer_pcm_segment_destroy(MMPlayerPcmSegment *segment)
+{
+	GstBuffer *buffer = NULL;
+
+	return_if_fail ( segment );
+
+	/* decoder waiting for delivery is released to be stopped */
+	if ( segment->lock )
+	{
+		g_mutex_lock(segment->lock);
+		segment->flushing = TRUE;
+		g_cond_broadcast(segment->cond);
+		g_mutex_unlock(segment->lock);
+	}
+
+	if ( segment->pipeline )
+	{
+		gst_element_set_state(segment->pipeline, GST_STATE_NULL);
+		gst_object_unref(GST_OBJECT(segment->pipeline));
+	}
+
+	if ( segment->queue )
+	{
+		while ( (buffer = (GstBuffer *)g_async_queue_try_pop(segment->queue)) )
+			gst_buffer_unref(buffer);
+
+		g_async_queue_unref(segment->queue);
+	}
+
+	if ( segment->lock )
+		g_mutex_free(segment->lock);
+	if ( segment->cond )
+		g_cond_free(segment->cond);
+
+	memset(segment, 0x00, sizeof(MMPlayerPcmSegment));
+}
+
+static int
+__mmplayer_pcm_segment_preroll(MMPlayerPcmSegment *segment, gint timeout)
+{
+	return_val_if_fail ( segment && segment->pipeline, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	gst_element_set_state(segment->pipeline, GST_STATE_PAUSED);
+	if ( gst_element_get_state(segment->pipeline, NULL, NULL, timeout * GST_SECOND) != GST_STATE_CHANGE_SUCCESS )
+	{
+		debug_error("failed to preroll pcm extractor\n");
+		return MM_ERROR_PLAYER_INTERNAL;
+	}
+
+	return MM_ERROR_NONE;
+}
+
+static void
+__mmplayer_pcm_segment_pad_added(GstElement *element, GstPad *pad, gpointer data)
+{
+	MMPlayerPcmSegment *segment = (MMPlayerPcmSegment *) data;
+	GstCaps *caps = NULL;
+	GstStructure *str = NULL;
+	GstElement *fakesink = NULL;
+	GstPad *sinkpad = NULL;
+	const gchar *name = NULL;
+
+	return_if_fail ( segment && pad );
+
+	caps = gst_pad_get_caps(pad);
+	if ( !caps )
+		return;
+
+	str = gst_caps_get_structure(caps, 0);
+	name = str ? gst_structure_get_name(str) : NULL;
+
+	sinkpad = gst_element_get_static_pad(segment->conv, "sink");
+
+	if ( name && g_str_has_prefix(name, "audio/x-raw") && !gst_pad_is_linked(sinkpad) )
+	{
+		debug_log("linking audio pad to pcm extractor\n");
+		if ( GST_PAD_LINK(pad, sinkpad) != GST_PAD_LINK_OK )
+			debug_error("failed to link audio pad to pcm extractor\n");
+	}
+	else
+	{
+		/* other streams are not needed. drop them not to block demuxer */
+		gst_object_unref(sinkpad);
+		sinkpad = NULL;
+
+		fakesink = gst_element_factory_make("fakesink", NULL);
+		if ( fakesink )
+		{
+			g_object_set(G_OBJECT(fakesink), "sync", FALSE, "async", FALSE, NULL);
+			gst_bin_add(GST_BIN(segment->pipeline), fakesink);
+			gst_element_sync_state_with_parent(fakesink);
+
+			sinkpad = gst_element_get_static_pad(fakesink, "sink");
+			GST_PAD_LINK(pad, sinkpad);
+		}
+	}
+
+	if ( sinkpad )
+		gst_object_unref(sinkpad);
+
+	gst_caps_unref(caps);
+}
+
+static void
+__mmplayer_pcm_segment_handoff(GstElement *fakesink, GstBuffer *buffer, GstPad *pad, gpointer data)
+{
+	MMPlayerPcmSegment *segment = (MMPlayerPcmSegment *) data;
+
+	/* delivered by extracting thread in order of segments. decoder of later segment
+	 * waits here till earlier ones are delivered, not to keep whole range in memory */
+	g_mutex_lock(segment->lock);
+
+	while ( segment->queued >= MMPLAYER_PCM_SEGMENT_QUEUE_MAX && !segment->flushing )
+		g_cond_wait(segment->cond, segment->lock);
+
+	if ( !segment->flushing )
+	{
+		segment->queued += GST_BUFFER_SIZE(buffer);
+		g_async_queue_push(segment->queue, gst_buffer_ref(buffer));
+	}
+
+	g_mutex_unlock(segment->lock);
+}
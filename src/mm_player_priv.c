@@ -43,6 +43,11 @@
 #include "mm_player_ini.h"
 #include "mm_player_attrs.h"
 #include "mm_player_capture.h"
+#include "mm_player_frame_export.h"
+#include "mm_player_pcm.h"
+#include "mm_player_audio_analysis.h"
+#include "mm_player_audio_eq.h"
+#include "mm_player_audio_fade.h"
 
 /*===========================================================================================
 |																							|
@@ -73,6 +78,8 @@
 #define MM_VOLUME_FACTOR_MAX				1.0
 
 #define MM_PLAYER_FADEOUT_TIME_DEFAULT	700000 // 700 msec
+#define MM_PLAYER_FADE_WAIT_MARGIN		200 // msec. fade can be delayed by buffers on the way
+#define MM_PLAYER_SINK_DRAIN_MARGIN		100 // msec. old audio sink is released after playing out
 
 #define MM_PLAYER_MPEG_VNAME				"mpegversion"
 #define MM_PLAYER_DIVX_VNAME				"divxversion"
@@ -99,6 +106,12 @@ gulong ahs_appsrc_cb_probe_id = 0;
 /*---------------------------------------------------------------------------
 |    LOCAL DATA TYPE DEFINITIONS:											|
 ---------------------------------------------------------------------------*/
+/* video frame given to application. it may be released after the session is gone */
+typedef struct
+{
+	MMPlayerVideoFrame frame;	/* should be the first */
+	gint session;			/* video_frame_session when it's leased */
+} MMPlayerVideoFrameLease;
 
 /*---------------------------------------------------------------------------
 |    GLOBAL VARIABLE DEFINITIONS:											|
@@ -150,6 +163,9 @@ static int		__mmplayer_gst_set_state (mm_player_t* player, GstElement * pipeline
 gboolean __mmplayer_post_message(mm_player_t* player, enum MMMessageType msgtype, MMMessageParamType* param);
 static gboolean	__mmplayer_gst_extract_tag_from_msg(mm_player_t* player, GstMessage *msg);
 int		__mmplayer_switch_audio_sink (mm_player_t* player);
+static void	__mmplayer_set_audio_sink_property(mm_player_t* player, GstElement* sink);
+static void	__mmplayer_audio_sink_switch_attach(mm_player_t* player);
+static void	__mmplayer_audio_sink_switch_release(mm_player_t* player);
 static gboolean __mmplayer_gst_remove_fakesink(mm_player_t* player, MMPlayerGstElement* fakesink);
 static int		__mmplayer_check_state(mm_player_t* player, enum PlayerCommandState command);
 static gboolean __mmplayer_audio_stream_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data);
@@ -202,8 +218,11 @@ static int __mmplayer_set_pcm_extraction(mm_player_t* player);
 static gboolean __mmplayer_can_extract_pcm( mm_player_t* player );
 
 /*fadeout */
+static void __mmplayer_start_sound_fadedown(mm_player_t* player, unsigned int time);
 static void __mmplayer_do_sound_fadedown(mm_player_t* player, unsigned int time);
 static void __mmplayer_undo_sound_fadedown(mm_player_t* player);
+static void __mmplayer_fade_on_state_change(mm_player_t* player, gboolean fade_in);
+static void __mmplayer_audio_fade_done(GstElement *fade, gdouble gain, gpointer data);
 
 static void 	__mmplayer_add_new_caps(GstPad* pad, GParamSpec* unused, gpointer data);
 static void __mmplayer_set_unlinked_mime_type(mm_player_t* player, GstCaps *caps);
@@ -507,6 +526,49 @@ int width, int height, gpointer data) // @
     	}
 }
 
+static void
+__mmplayer_video_frame_handoff(GstElement *element, GstBuffer *buffer, GstPad *pad, gpointer data)
+{
+	mm_player_t* player = (mm_player_t*)data;
+	MMPlayerVideoFrameLease *lease = NULL;
+	MMPlayerVideoFrame *frame = NULL;
+
+	return_if_fail ( player && buffer );
+
+	if ( !player->video_frame_cb )
+		return;
+
+	/* NOTE : decoder can't reuse buffers while they are leased.
+	 * so, frames are dropped if application holds too many of them.
+	 */
+	if ( g_atomic_int_get(&player->video_frame_leases) >= player->video_frame_max_leases )
+	{
+		debug_warning("%d frames are leased already. drop it\n", player->video_frame_max_leases);
+		return;
+	}
+
+	lease = g_try_new0(MMPlayerVideoFrameLease, 1);
+	if ( !lease )
+		return;
+
+	frame = &lease->frame;
+	lease->session = g_atomic_int_get(&player->video_frame_session);
+
+	if ( _mmplayer_get_image_from_buffer(buffer, &frame->image) != MM_ERROR_NONE )
+	{
+		g_free(lease);
+		return;
+	}
+
+	if ( GST_BUFFER_TIMESTAMP_IS_VALID(buffer) )
+		frame->timestamp = GST_TIME_AS_MSECONDS(GST_BUFFER_TIMESTAMP(buffer));
+
+	frame->priv = gst_buffer_ref(buffer);
+	g_atomic_int_inc(&player->video_frame_leases);
+
+	player->video_frame_cb(frame, player->video_frame_cb_user_param);
+}
+
 gboolean
 _mmplayer_update_content_attrs(mm_player_t* player) // @
 {
@@ -1380,6 +1442,11 @@ __mmplayer_gst_callback(GstBus *bus, GstMessage *msg, gpointer data) // @
 				/* release audio callback */
 				gst_pad_remove_buffer_probe (pad, player->audio_cb_probe_id);
 				player->audio_cb_probe_id = 0;
+				gst_object_unref (pad);
+
+				/* deliver the rest of batched stream */
+				_mmplayer_stop_pcm_batch(player, TRUE);
+
 				/* audio callback should be free because it can be called even though probe remove.*/
 				player->audio_stream_cb = NULL;
 				player->audio_stream_cb_user_param = NULL;
@@ -1664,10 +1731,24 @@ __mmplayer_gst_callback(GstBus *bus, GstMessage *msg, gpointer data) // @
 		case GST_MESSAGE_CLOCK_LOST:
 			{
 				GstClock *clock = NULL;
+				GstClock *used_clock = NULL;
 				gst_message_parse_clock_lost (msg, &clock);
 				debug_log("GST_MESSAGE_CLOCK_LOST : %s\n", (clock ? GST_OBJECT_NAME (clock) : "NULL"));
 				g_print ("GST_MESSAGE_CLOCK_LOST : %s\n", (clock ? GST_OBJECT_NAME (clock) : "NULL"));
 
+				/* clock of switched audio sink is replaced already. nothing to select again */
+				used_clock = gst_element_get_clock (player->pipeline->mainbin[MMPLAYER_M_PIPE].gst);
+				if (used_clock)
+				{
+					gst_object_unref (used_clock);
+
+					if (clock && clock != used_clock)
+					{
+						debug_log ("lost clock is not in use\n");
+						break;
+					}
+				}
+
 				if (PLAYER_INI()->provide_clock)
 				{
 					debug_log ("Provide clock is TRUE, do pause->resume\n");
@@ -2477,6 +2558,10 @@ _mmplayer_update_video_param(mm_player_t* player) // @
 	/* update display surface */
 	__mmplayer_set_videosink_type(player);
 
+	/* frames are leased to application as they are */
+	if ( player->video_frame_cb )
+		return MM_ERROR_NONE;
+
 	/* check video stream callback is used */
 	if( player->use_video_stream )
 	{
@@ -3037,6 +3122,22 @@ __mmplayer_gst_create_audio_pipeline(mm_player_t* player)
 			g_object_set(G_OBJECT (audiobin[MMPLAYER_A_VOL].gst), "mute", player->sound.mute, NULL);
 		}
 
+		/* for sample accurate fade on top of volume */
+		{
+			GstElementFactory *fade_factory = gst_element_factory_find(MMPLAYER_AUDIO_FADE_FACTORY);
+
+			if ( fade_factory )
+			{
+				gst_object_unref( fade_factory );
+				MMPLAYER_CREATE_ELEMENT(audiobin, MMPLAYER_A_FADE, MMPLAYER_AUDIO_FADE_FACTORY, "audiofade", TRUE);
+				_mmplayer_audio_fade_set_done_func(audiobin[MMPLAYER_A_FADE].gst, __mmplayer_audio_fade_done, player);
+			}
+			else
+			{
+				debug_warning("fade element is not available\n");
+			}
+		}
+
 		/* NOTE : streaming doesn't need capsfilter and sound effect*/
 		if ( ! MMPLAYER_IS_RTSP_STREAMING( player ) )
 		{
@@ -3058,60 +3159,29 @@ __mmplayer_gst_create_audio_pipeline(mm_player_t* player)
 			/* audio filter. if enabled */
 			if ( PLAYER_INI()->use_audio_filter_preset || PLAYER_INI()->use_audio_filter_custom )
 			{
-				MMPLAYER_CREATE_ELEMENT(audiobin, MMPLAYER_A_FILTER, "soundalive", "audiofilter", TRUE);
+				GstElementFactory *filter_factory = gst_element_factory_find("soundalive");
+
+				/* use built-in equalizer when sound effect plugin is not installed */
+				if ( filter_factory )
+				{
+					gst_object_unref( filter_factory );
+					MMPLAYER_CREATE_ELEMENT(audiobin, MMPLAYER_A_FILTER, "soundalive", "audiofilter", TRUE);
+				}
+				else
+				{
+					debug_warning("soundalive is not available. use built-in equalizer\n");
+					MMPLAYER_CREATE_ELEMENT(audiobin, MMPLAYER_A_FILTER, MMPLAYER_AUDIO_EQ_FACTORY, "audiofilter", TRUE);
+				}
 			}
 		}
 		/* create audio sink */
 		MMPLAYER_CREATE_ELEMENT(audiobin, MMPLAYER_A_SINK, PLAYER_INI()->name_of_audiosink,
 			"audiosink", link_audio_sink_now);
 
-		/* sync on */
-		if (MMPLAYER_IS_RTSP_STREAMING (player) )
-			g_object_set (G_OBJECT (audiobin[MMPLAYER_A_SINK].gst), "sync", FALSE, NULL); 	/* sync off */
-		else
-			g_object_set (G_OBJECT (audiobin[MMPLAYER_A_SINK].gst), "sync", TRUE, NULL); 	/* sync on */
-
-		/* qos on */
-		g_object_set (G_OBJECT (audiobin[MMPLAYER_A_SINK].gst), "qos", TRUE, NULL); 	/* qos on */
-
-		/* FIXIT : using system clock. isn't there another way? */
-		g_object_set (G_OBJECT (audiobin[MMPLAYER_A_SINK].gst), "provide-clock", PLAYER_INI()->provide_clock,  NULL);
+		__mmplayer_set_audio_sink_property( player, audiobin[MMPLAYER_A_SINK].gst );
 
 		__mmplayer_add_sink( player, audiobin[MMPLAYER_A_SINK].gst );
 
-	        if(player->audio_buffer_cb)
-	        {
-	            g_object_set(audiobin[MMPLAYER_A_SINK].gst, "audio-handle", player->audio_buffer_cb_user_param, NULL);
-	            g_object_set(audiobin[MMPLAYER_A_SINK].gst, "audio-callback", player->audio_buffer_cb, NULL);
-	        }
-
-		if ( g_strrstr(PLAYER_INI()->name_of_audiosink, "avsysaudiosink") )
-		{
-			gint volume_type = 0;
-			gint audio_route = 0;
-			gint sound_priority = FALSE;
-			gint is_spk_out_only = 0;
-
-			/* set volume table
-			 * It should be set after player creation through attribute.
-			 * But, it can not be changed during playing.
-			 */
-			mm_attrs_get_int_by_name(attrs, "sound_volume_type", &volume_type);			
-			mm_attrs_get_int_by_name(attrs, "sound_route", &audio_route);
-			mm_attrs_get_int_by_name(attrs, "sound_priority", &sound_priority);
-			mm_attrs_get_int_by_name(attrs, "sound_spk_out_only", &is_spk_out_only);
-
-			g_object_set(audiobin[MMPLAYER_A_SINK].gst,
-								"volumetype", volume_type,
-								"audio-route", audio_route,
-								"priority", sound_priority,
-								"user-route", is_spk_out_only,
-								NULL);
-
-			debug_log("audiosink property status...volume type:%d, route:%d, priority=%d, user-route=%d\n",
-				volume_type, audio_route, sound_priority, is_spk_out_only);
-		}
-
 		/* Antishock can be enabled when player is resumed by soundCM.
 		 * But, it's not used in MMS, setting and etc.
 		 * Because, player start seems like late.
@@ -3222,6 +3292,13 @@ __mmplayer_gst_create_audio_pipeline(mm_player_t* player)
 		}
 	}
 
+	/* to switch audio sink while playing */
+	if ( ! player->is_sound_extraction )
+		__mmplayer_audio_sink_switch_attach(player);
+
+	/* level and spectrum analysis. if enabled */
+	_mmplayer_attach_audio_analyzer(player);
+
 	/* done. free allocated variables */
 	MMPLAYER_FREEIF( device_name );
 	g_list_free(element_bucket);
@@ -3289,13 +3366,652 @@ __mmplayer_audio_stream_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data)
 	gint size;
 	guint8 *data;
 
+	if (player->pcm_batch)
+	{
+		_mmplayer_push_pcm_batch(player, buffer);
+		return TRUE;
+	}
+
 	data = GST_BUFFER_DATA(buffer);
 	size = GST_BUFFER_SIZE(buffer);
 
 	if (player->audio_stream_cb && size && data)
 		player->audio_stream_cb((void *)data, size, player->audio_stream_cb_user_param);
 
-	return TRUE;
+	return TRUE;
+}
+
+static void
+__mmplayer_set_audio_sink_property(mm_player_t* player, GstElement* sink)
+{
+	MMHandleType attrs = 0;
+
+	debug_fenter();
+
+	return_if_fail ( player && sink );
+
+	attrs = MMPLAYER_GET_ATTRS(player);
+
+	/* sync on */
+	if (MMPLAYER_IS_RTSP_STREAMING (player) )
+		g_object_set (G_OBJECT (sink), "sync", FALSE, NULL); 	/* sync off */
+	else
+		g_object_set (G_OBJECT (sink), "sync", TRUE, NULL); 	/* sync on */
+
+	/* qos on */
+	g_object_set (G_OBJECT (sink), "qos", TRUE, NULL); 	/* qos on */
+
+	/* FIXIT : using system clock. isn't there another way? */
+	g_object_set (G_OBJECT (sink), "provide-clock", PLAYER_INI()->provide_clock,  NULL);
+
+	if(player->audio_buffer_cb)
+	{
+		g_object_set(sink, "audio-handle", player->audio_buffer_cb_user_param, NULL);
+		g_object_set(sink, "audio-callback", player->audio_buffer_cb, NULL);
+	}
+
+	if ( g_strrstr(PLAYER_INI()->name_of_audiosink, "avsysaudiosink") )
+	{
+		gint volume_type = 0;
+		gint audio_route = 0;
+		gint sound_priority = FALSE;
+		gint is_spk_out_only = 0;
+
+		/* set volume table
+		 * It should be set after player creation through attribute.
+		 * To change it during playing, switch audio sink.
+		 */
+		mm_attrs_get_int_by_name(attrs, "sound_volume_type", &volume_type);
+		mm_attrs_get_int_by_name(attrs, "sound_route", &audio_route);
+		mm_attrs_get_int_by_name(attrs, "sound_priority", &sound_priority);
+		mm_attrs_get_int_by_name(attrs, "sound_spk_out_only", &is_spk_out_only);
+
+		g_object_set(sink,
+							"volumetype", volume_type,
+							"audio-route", audio_route,
+							"priority", sound_priority,
+							"user-route", is_spk_out_only,
+							NULL);
+
+		debug_log("audiosink property status...volume type:%d, route:%d, priority=%d, user-route=%d\n",
+			volume_type, audio_route, sound_priority, is_spk_out_only);
+	}
+
+	debug_fleave();
+}
+
+static gboolean
+__mmplayer_audio_sink_event_probe (GstPad *pad, GstEvent *event, gpointer u_data)
+{
+	mm_player_t* player = (mm_player_t*) u_data;
+	MMPlayerAudioSinkSwitch *sw = &player->audiosink_switch;
+
+	switch ( GST_EVENT_TYPE(event) )
+	{
+		case GST_EVENT_FLUSH_STOP:
+		{
+			g_mutex_lock(player->audiosink_switch_lock);
+			gst_segment_init(&sw->segment, GST_FORMAT_TIME);
+			sw->has_segment = FALSE;
+			sw->last_stop = GST_CLOCK_TIME_NONE;
+			g_mutex_unlock(player->audiosink_switch_lock);
+		}
+		break;
+
+		case GST_EVENT_NEWSEGMENT:
+		{
+			gboolean update = FALSE;
+			gdouble rate = 1.0, applied_rate = 1.0;
+			GstFormat format = GST_FORMAT_UNDEFINED;
+			gint64 start = 0, stop = 0, time = 0;
+
+			gst_event_parse_new_segment_full(event, &update, &rate, &applied_rate, &format, &start, &stop, &time);
+
+			if ( format != GST_FORMAT_TIME )
+				break;
+
+			/* keep it as sink does. accumulated running time is kept too */
+			g_mutex_lock(player->audiosink_switch_lock);
+			gst_segment_set_newsegment_full(&sw->segment, update, rate, applied_rate, format, start, stop, time);
+			sw->has_segment = TRUE;
+			g_mutex_unlock(player->audiosink_switch_lock);
+		}
+		break;
+
+		default:
+		break;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+__mmplayer_audio_sink_buffer_probe (GstPad *pad, GstBuffer *buffer, gpointer u_data)
+{
+	mm_player_t* player = (mm_player_t*) u_data;
+	MMPlayerAudioSinkSwitch *sw = &player->audiosink_switch;
+	GstClockTime timestamp = GST_BUFFER_TIMESTAMP(buffer);
+	GstClockTime start = GST_CLOCK_TIME_NONE;
+	GstClockTime stop = GST_CLOCK_TIME_NONE;
+
+	if ( !GST_CLOCK_TIME_IS_VALID(timestamp) )
+		return TRUE;
+
+	g_mutex_lock(player->audiosink_switch_lock);
+
+	if ( sw->has_segment )
+	{
+		gst_segment_set_last_stop(&sw->segment, GST_FORMAT_TIME, timestamp);
+
+		start = gst_segment_to_running_time(&sw->segment, GST_FORMAT_TIME, timestamp);
+
+		if ( GST_BUFFER_DURATION_IS_VALID(buffer) )
+			stop = gst_segment_to_running_time(&sw->segment, GST_FORMAT_TIME, timestamp + GST_BUFFER_DURATION(buffer));
+		else
+			stop = start;
+
+		/* running time decreases in reverse playback */
+		if ( GST_CLOCK_TIME_IS_VALID(start) && GST_CLOCK_TIME_IS_VALID(stop) )
+			sw->last_stop = MAX(start, stop);
+	}
+
+	/* first buffer to new sink */
+	if ( sw->measuring && GST_CLOCK_TIME_IS_VALID(start) )
+	{
+		GstElement *pipeline = player->pipeline->mainbin[MMPLAYER_M_PIPE].gst;
+		GstClock *clock = gst_element_get_clock(pipeline);
+		GstClockTime arrival = start;
+		GstClockTime render = 0;
+
+		if ( clock )
+		{
+			GstClockTime now = gst_clock_get_time(clock);
+			GstClockTime base_time = gst_element_get_base_time(pipeline);
+
+			if ( now > base_time )
+				arrival = now - base_time;
+
+			gst_object_unref(clock);
+		}
+
+		/* sound starts when it's on time or when it arrives if it's late */
+		render = MAX(start, arrival);
+
+		if ( GST_CLOCK_TIME_IS_VALID(sw->switch_stop) && render > sw->switch_stop )
+			sw->gap_usec = (gint)((render - sw->switch_stop) / GST_USECOND);
+		else
+			sw->gap_usec = 0;
+
+		sw->measuring = FALSE;
+
+		debug_log("audio sink switch gap : %d usec\n", sw->gap_usec);
+	}
+
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	return TRUE;
+}
+
+/* NOTE : Base time follows clock on PAUSED -> PLAYING of pipeline only.
+ * So, it's set to all the elements here to keep running time with new clock.
+ */
+static void
+__mmplayer_set_base_time_recursive(GstElement* pipeline, GstClockTime base_time)
+{
+	GstIterator* iter = NULL;
+	GstElement* item = NULL;
+	gboolean done = FALSE;
+
+	gst_element_set_base_time(pipeline, base_time);
+
+	iter = gst_bin_iterate_recurse(GST_BIN(pipeline));
+	if ( !iter )
+		return;
+
+	while (!done)
+	{
+		switch ( gst_iterator_next (iter, (gpointer)&item) )
+		{
+			case GST_ITERATOR_OK:
+				gst_element_set_base_time(item, base_time);
+				gst_object_unref(item);
+				break;
+			case GST_ITERATOR_RESYNC:
+				gst_iterator_resync(iter);
+				break;
+			case GST_ITERATOR_ERROR:
+			case GST_ITERATOR_DONE:
+				done = TRUE;
+				break;
+		}
+	}
+
+	gst_iterator_free(iter);
+}
+
+/* If old sink provides the clock of pipeline, it stops with the sink. Then, pipeline should
+ * select clock again through PAUSED and PLAYING, and it makes sound stop. To avoid it, system
+ * clock takes over keeping running time and old sink is not the provider anymore. Audio sink
+ * provides clock again on next resume.
+ */
+static void
+__mmplayer_audio_sink_handover_clock(mm_player_t* player, GstElement* old_sink)
+{
+	GstElement *pipeline = player->pipeline->mainbin[MMPLAYER_M_PIPE].gst;
+	GstClock *clock = NULL;
+	GstClock *sink_clock = NULL;
+
+	clock = gst_element_get_clock(pipeline);
+	sink_clock = gst_element_provide_clock(old_sink);
+
+	if ( clock && clock == sink_clock )
+	{
+		GstClock *system_clock = gst_system_clock_obtain();
+		GstClockTime base_time = gst_element_get_base_time(pipeline);
+		GstClockTime running_time = 0;
+		GstClockTime now = gst_clock_get_time(clock);
+
+		if ( now > base_time )
+			running_time = now - base_time;
+
+		gst_element_set_clock(pipeline, system_clock);
+		__mmplayer_set_base_time_recursive(pipeline, gst_clock_get_time(system_clock) - running_time);
+
+		debug_log("system clock takes over from old audio sink. running time : %"GST_TIME_FORMAT"\n",
+			GST_TIME_ARGS(running_time));
+
+		gst_object_unref(system_clock);
+	}
+
+	if ( clock )
+		gst_object_unref(clock);
+
+	if ( sink_clock )
+		gst_object_unref(sink_clock);
+}
+
+static gboolean
+__mmplayer_audio_sink_drain_done(gpointer u_data)
+{
+	mm_player_t* player = (mm_player_t*) u_data;
+	MMPlayerAudioSinkSwitch *sw = NULL;
+	gboolean route_pending = FALSE;
+
+	return_val_if_fail ( player, FALSE );
+
+	sw = &player->audiosink_switch;
+
+	g_mutex_lock(player->audiosink_switch_lock);
+
+	sw->drain_timer = 0;
+
+	if ( sw->old_sink && player->pipeline && player->pipeline->audiobin )
+	{
+		debug_log("releasing old audio sink\n");
+
+		gst_element_set_state(sw->old_sink, GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(player->pipeline->audiobin[MMPLAYER_A_BIN].gst), sw->old_sink);
+	}
+	sw->old_sink = NULL;
+
+	route_pending = sw->route_pending;
+	sw->route_pending = FALSE;
+
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	if ( route_pending )
+		_mmplayer_update_audio_route(player);
+
+	return FALSE;
+}
+
+/* it's called on streaming thread between buffers */
+static void
+__mmplayer_audio_sink_blocked(GstPad* pad, gboolean blocked, gpointer u_data)
+{
+	mm_player_t* player = (mm_player_t*) u_data;
+	MMPlayerAudioSinkSwitch *sw = NULL;
+	MMPlayerGstElement *audiobin = NULL;
+	GstElement *pipeline = NULL;
+	GstElement *old_sink = NULL;
+	GstElement *new_sink = NULL;
+	GstPad *old_sinkpad = NULL;
+	GstPad *new_sinkpad = NULL;
+	GstClock *clock = NULL;
+	GstClockTime drain = 0;
+	GList *item = NULL;
+	gboolean async = TRUE;
+
+	/* called again when it's unblocked */
+	if ( !blocked )
+		return;
+
+	return_if_fail ( player && player->pipeline && player->pipeline->audiobin );
+
+	sw = &player->audiosink_switch;
+	audiobin = player->pipeline->audiobin;
+	pipeline = player->pipeline->mainbin[MMPLAYER_M_PIPE].gst;
+
+	g_mutex_lock(player->audiosink_switch_lock);
+
+	new_sink = sw->new_sink;
+	old_sink = audiobin[MMPLAYER_A_SINK].gst;
+	sw->new_sink = NULL;
+
+	if ( !new_sink )
+		goto UNBLOCK;
+
+	old_sinkpad = gst_element_get_static_pad(old_sink, "sink");
+	new_sinkpad = gst_element_get_static_pad(new_sink, "sink");
+
+	gst_pad_unlink(pad, old_sinkpad);
+
+	if ( gst_pad_link(pad, new_sinkpad) != GST_PAD_LINK_OK )
+	{
+		debug_error("failed to link new audio sink. keep current one\n");
+
+		gst_pad_link(pad, old_sinkpad);
+
+		gst_element_set_state(new_sink, GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(audiobin[MMPLAYER_A_BIN].gst), new_sink);
+
+		goto UNBLOCK;
+	}
+
+	/* old sink has sound till the end of last buffer */
+	clock = gst_element_get_clock(pipeline);
+	if ( clock && GST_CLOCK_TIME_IS_VALID(sw->last_stop) )
+	{
+		GstClockTime now = gst_clock_get_time(clock);
+		GstClockTime base_time = gst_element_get_base_time(pipeline);
+
+		if ( now > base_time && sw->last_stop > now - base_time )
+			drain = sw->last_stop - (now - base_time);
+	}
+	if ( clock )
+		gst_object_unref(clock);
+
+	__mmplayer_audio_sink_handover_clock(player, old_sink);
+
+	/* new sink follows running time of pipeline */
+	clock = gst_element_get_clock(pipeline);
+	if ( clock )
+	{
+		gst_element_set_clock(new_sink, clock);
+		gst_object_unref(clock);
+	}
+	gst_element_set_base_time(new_sink, gst_element_get_base_time(pipeline));
+
+	/* sink gets segment just once. give it the same one including accumulated running time */
+	if ( sw->has_segment )
+	{
+		GstSegment *segment = &sw->segment;
+
+		if ( segment->accum > 0 )
+		{
+			/* accumulated by the duration of this one when next segment comes */
+			gst_pad_send_event(new_sinkpad, gst_event_new_new_segment_full(FALSE, 1.0, 1.0,
+				GST_FORMAT_TIME, 0, segment->accum, 0));
+		}
+
+		gst_pad_send_event(new_sinkpad, gst_event_new_new_segment_full(FALSE, segment->rate,
+			segment->applied_rate, GST_FORMAT_TIME, segment->start, segment->stop, segment->time));
+	}
+
+	gst_element_sync_state_with_parent(new_sink);
+
+	g_object_get(old_sink, "async", &async, NULL);
+	g_object_set(new_sink, "async", async, NULL);
+
+	audiobin[MMPLAYER_A_SINK].gst = new_sink;
+
+	item = g_list_find(player->sink_elements, old_sink);
+	if ( item )
+		item->data = new_sink;
+
+	/* measured by the first buffer to new sink */
+	sw->switch_stop = sw->last_stop;
+	sw->gap_usec = -1;
+	sw->measuring = TRUE;
+
+	/* old sink plays out its ring buffer and it's released. it's out of state changes of
+	 * pipeline meanwhile, or it would wait for preroll which never comes on pause or stop */
+	gst_element_set_locked_state(old_sink, TRUE);
+	g_object_set(old_sink, "async", FALSE, NULL);
+	sw->old_sink = old_sink;
+	sw->drain_timer = g_timeout_add((guint)(drain / GST_MSECOND) + MM_PLAYER_SINK_DRAIN_MARGIN,
+		__mmplayer_audio_sink_drain_done, player);
+
+	debug_log("audio sink is switched. old sink plays out %"GST_TIME_FORMAT"\n", GST_TIME_ARGS(drain));
+
+UNBLOCK:
+	if ( old_sinkpad )
+		gst_object_unref(old_sinkpad);
+
+	if ( new_sinkpad )
+		gst_object_unref(new_sinkpad);
+
+	gst_pad_set_blocked_async(pad, FALSE, __mmplayer_audio_sink_blocked, player);
+
+	g_mutex_unlock(player->audiosink_switch_lock);
+}
+
+static void
+__mmplayer_audio_sink_switch_attach(mm_player_t* player)
+{
+	MMPlayerAudioSinkSwitch *sw = NULL;
+	GstPad *sinkpad = NULL;
+
+	debug_fenter();
+
+	return_if_fail ( player && player->pipeline && player->pipeline->audiobin );
+	return_if_fail ( player->pipeline->audiobin[MMPLAYER_A_SINK].gst );
+
+	sw = &player->audiosink_switch;
+
+	sinkpad = gst_element_get_static_pad(player->pipeline->audiobin[MMPLAYER_A_SINK].gst, "sink");
+	if ( !sinkpad )
+	{
+		debug_error("failed to get sink pad of audio sink\n");
+		return;
+	}
+
+	g_mutex_lock(player->audiosink_switch_lock);
+
+	sw->pad = gst_pad_get_peer(sinkpad);
+	if ( sw->pad )
+	{
+		gst_segment_init(&sw->segment, GST_FORMAT_TIME);
+		sw->has_segment = FALSE;
+		sw->last_stop = GST_CLOCK_TIME_NONE;
+
+		sw->event_probe_id = gst_pad_add_event_probe(sw->pad,
+			G_CALLBACK(__mmplayer_audio_sink_event_probe), player);
+		sw->buffer_probe_id = gst_pad_add_buffer_probe(sw->pad,
+			G_CALLBACK(__mmplayer_audio_sink_buffer_probe), player);
+	}
+	else
+	{
+		debug_error("audio sink is not linked\n");
+	}
+
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	gst_object_unref(sinkpad);
+
+	debug_fleave();
+}
+
+/* NOTE : it should be called after streaming is stopped */
+static void
+__mmplayer_audio_sink_switch_release(mm_player_t* player)
+{
+	MMPlayerAudioSinkSwitch *sw = NULL;
+
+	debug_fenter();
+
+	return_if_fail ( player && player->audiosink_switch_lock );
+
+	sw = &player->audiosink_switch;
+
+	g_mutex_lock(player->audiosink_switch_lock);
+
+	if ( sw->drain_timer )
+		g_source_remove(sw->drain_timer);
+	sw->drain_timer = 0;
+
+	/* draining one doesn't follow state of pipeline */
+	if ( sw->old_sink )
+		gst_element_set_state(sw->old_sink, GST_STATE_NULL);
+
+	/* sinks which are not linked are released with pipeline */
+	sw->new_sink = NULL;
+	sw->old_sink = NULL;
+	sw->measuring = FALSE;
+
+	if ( sw->pad )
+	{
+		gst_pad_remove_event_probe(sw->pad, sw->event_probe_id);
+		gst_pad_remove_buffer_probe(sw->pad, sw->buffer_probe_id);
+		gst_object_unref(sw->pad);
+	}
+	sw->pad = NULL;
+	sw->event_probe_id = 0;
+	sw->buffer_probe_id = 0;
+	sw->has_segment = FALSE;
+	sw->route_pending = FALSE;
+
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	debug_fleave();
+}
+
+int
+__mmplayer_switch_audio_sink (mm_player_t* player)
+{
+	MMPlayerGstElement *audiobin = NULL;
+	MMPlayerAudioSinkSwitch *sw = NULL;
+	GstElement *new_sink = NULL;
+	int ret = MM_ERROR_NONE;
+
+	debug_fenter();
+
+	return_val_if_fail ( player && player->pipeline && player->audiosink_switch_lock, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	audiobin = player->pipeline->audiobin;
+	sw = &player->audiosink_switch;
+
+	if ( !audiobin || !audiobin[MMPLAYER_A_SINK].gst || !sw->pad )
+	{
+		debug_error("audio sink is not created or not linked\n");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	g_mutex_lock(player->audiosink_switch_lock);
+
+	if ( sw->new_sink || sw->old_sink )
+	{
+		debug_error("previous switch is not finished yet\n");
+		ret = MM_ERROR_PLAYER_INVALID_STATE;
+		goto ERROR;
+	}
+
+	new_sink = gst_element_factory_make(PLAYER_INI()->name_of_audiosink, NULL);
+	if ( !new_sink )
+	{
+		debug_error("failed to create %s\n", PLAYER_INI()->name_of_audiosink);
+		ret = MM_ERROR_PLAYER_INTERNAL;
+		goto ERROR;
+	}
+
+	__mmplayer_set_audio_sink_property(player, new_sink);
+
+	/* no preroll. it gets buffers on time when it's linked */
+	g_object_set(G_OBJECT(new_sink), "async", FALSE, NULL);
+
+	if ( !gst_bin_add(GST_BIN(audiobin[MMPLAYER_A_BIN].gst), new_sink) )
+	{
+		debug_error("failed to add new audio sink to audiobin\n");
+		gst_object_unref(new_sink);
+		ret = MM_ERROR_PLAYER_INTERNAL;
+		goto ERROR;
+	}
+
+	/* device is opened while current sink keeps playing */
+	if ( gst_element_set_state(new_sink, GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE )
+	{
+		debug_error("failed to prepare new audio sink\n");
+		gst_element_set_state(new_sink, GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(audiobin[MMPLAYER_A_BIN].gst), new_sink);
+		ret = MM_ERROR_PLAYER_INTERNAL;
+		goto ERROR;
+	}
+
+	sw->new_sink = new_sink;
+
+	/* linked between buffers. see __mmplayer_audio_sink_blocked() */
+	gst_pad_set_blocked_async(sw->pad, TRUE, __mmplayer_audio_sink_blocked, player);
+
+	debug_log("waiting audio sink to be switched\n");
+
+ERROR:
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	debug_fleave();
+
+	return ret;
+}
+
+/**
+  * Applies route attributes to audio sink.
+  * Sink which has opened device is switched, so sound moves to new route without re-preroll.
+  */
+int
+_mmplayer_update_audio_route(mm_player_t* player)
+{
+	MMPlayerGstElement *audiobin = NULL;
+	MMPlayerAudioSinkSwitch *sw = NULL;
+	GstState state = GST_STATE_VOID_PENDING;
+	gboolean switching = FALSE;
+
+	debug_fenter();
+
+	return_val_if_fail ( player && player->audiosink_switch_lock, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	/* route is set when audio sink is created */
+	if ( player->is_sound_extraction || !player->pipeline || !player->pipeline->audiobin ||
+		!player->pipeline->audiobin[MMPLAYER_A_SINK].gst )
+		return MM_ERROR_NONE;
+
+	audiobin = player->pipeline->audiobin;
+	sw = &player->audiosink_switch;
+
+	/* device is not opened yet */
+	gst_element_get_state(audiobin[MMPLAYER_A_SINK].gst, &state, NULL, 0);
+	if ( state < GST_STATE_PAUSED )
+	{
+		__mmplayer_set_audio_sink_property(player, audiobin[MMPLAYER_A_SINK].gst);
+		return MM_ERROR_NONE;
+	}
+
+	/* new sink of current switch may have old route. switched again when it's done */
+	g_mutex_lock(player->audiosink_switch_lock);
+	switching = ( sw->new_sink || sw->old_sink );
+	if ( switching )
+		sw->route_pending = TRUE;
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	if ( switching )
+	{
+		debug_log("audio route is changed while switching audio sink. it's switched again after that\n");
+		return MM_ERROR_NONE;
+	}
+
+	debug_log("audio route is changed. switching audio sink\n");
+
+	debug_fleave();
+
+	return __mmplayer_switch_audio_sink(player);
 }
 
 gboolean
@@ -3370,7 +4086,21 @@ __mmplayer_gst_create_video_pipeline(mm_player_t* player, GstCaps* caps)
 	mm_player_get_attribute(player, &err_name, "display_surface_use_multi", &use_multi_surface, NULL);
 	player->use_multi_surface = use_multi_surface;
 
-    	if( player->use_video_stream ) // video stream callack, so send raw video data to application
+	if ( player->video_frame_cb ) // lease decoded frames to application without conversion
+	{
+		debug_log("using fakesink for video frame lease\n");
+
+		MMPLAYER_CREATE_ELEMENT(videobin, MMPLAYER_V_SINK, "fakesink", "videosink", TRUE);
+
+		g_object_set (G_OBJECT (videobin[MMPLAYER_V_SINK].gst), "signal-handoffs", TRUE, "sync", TRUE, NULL);
+
+		MMPLAYER_SIGNAL_CONNECT( player,
+									 videobin[MMPLAYER_V_SINK].gst,
+									 "handoff",
+									 G_CALLBACK(__mmplayer_video_frame_handoff),
+									 player );
+	}
+    	else if( player->use_video_stream ) // video stream callack, so send raw video data to application
     	{
 		GstStructure *str = NULL;
 		guint32 fourcc = 0;
@@ -4903,6 +5633,10 @@ __mmplayer_gst_destroy_pipeline(mm_player_t* player) // @
 	player->pending_seek.format = MM_PLAYER_POS_FORMAT_TIME;
 	player->pending_seek.pos = 0;
 
+	/* continuous capture and frame export are attached to video sink */
+	_mmplayer_stop_continuous_capture((MMHandleType)player);
+	_mmplayer_stop_frame_export((MMHandleType)player);
+
 	if (ahs_appsrc_cb_probe_id )
 	{
 		GstPad *pad = NULL;
@@ -4976,6 +5710,11 @@ __mmplayer_gst_destroy_pipeline(mm_player_t* player) // @
 				return MM_ERROR_PLAYER_INTERNAL;
 			}
 
+			/* streaming threads are stopped. it's safe to release ring of audio stream */
+			_mmplayer_stop_pcm_batch(player, FALSE);
+			_mmplayer_detach_audio_analyzer(player);
+			__mmplayer_audio_sink_switch_release(player);
+
 			debug_log("pipeline status before unrefering pipeline\n");
 			__mmplayer_dump_pipeline_state( player );
 
@@ -5077,6 +5816,15 @@ static int __gst_unrealize(mm_player_t* player) // @
 	player->video_stream_cb = NULL;
 	player->video_stream_cb_user_param = NULL;
 
+	player->video_frame_cb = NULL;
+	player->video_frame_cb_user_param = NULL;
+
+	/* frames of this session don't count for next one even if they are released later */
+	if ( g_atomic_int_get(&player->video_frame_leases) )
+		debug_warning("%d video frames are not released\n", g_atomic_int_get(&player->video_frame_leases));
+	g_atomic_int_inc(&player->video_frame_session);
+	g_atomic_int_set(&player->video_frame_leases, 0);
+
 	player->audio_stream_cb = NULL;
 	player->audio_stream_cb_user_param = NULL;
 
@@ -5264,8 +6012,87 @@ static int __gst_start(mm_player_t* player) // @
 	return ret;
 }
 
+/* time is in usec. fade element ramps gain down on audio thread, sink mutes with its own fade if fade element is not available */
+static void __mmplayer_start_sound_fadedown(mm_player_t* player, unsigned int time)
+{
+	GstElement *fade = NULL;
+
+	debug_fenter();
+
+	return_if_fail(player
+		&& player->pipeline
+		&& player->pipeline->audiobin
+		&& player->pipeline->audiobin[MMPLAYER_A_SINK].gst);
+
+	fade = player->pipeline->audiobin[MMPLAYER_A_FADE].gst;
+
+	if ( !fade )
+		g_object_set(G_OBJECT(player->pipeline->audiobin[MMPLAYER_A_SINK].gst), "mute", 2, NULL);
+	else if ( MMPLAYER_CURRENT_STATE(player) != MM_PLAYER_STATE_PLAYING )
+		_mmplayer_audio_fade_set_gain(fade, 0.0); /* no buffer to fade */
+	else
+		_mmplayer_audio_fade_start(fade, 0.0, time / 1000, MM_PLAYER_FADE_CURVE_EXPONENTIAL);
+
+	debug_fleave();
+}
+
+/* fade element is upstream of sink. wait until the end of fade is heard, not just processed */
+static void __mmplayer_audio_fade_wait_playout(mm_player_t* player, GstElement *fade, unsigned int timeout_msec)
+{
+	GstElement *sink = NULL;
+	GstClock *clock = NULL;
+	GstQuery *query = NULL;
+	GstClockTime end_time = GST_CLOCK_TIME_NONE;
+	GstClockTime latency = 0;
+	GstClockTime min_latency = 0;
+	GstClockTime now = 0;
+	GstClockTime until = 0;
+	gboolean live = FALSE;
+
+	return_if_fail(player && player->pipeline && fade);
+
+	if ( ! _mmplayer_audio_fade_wait(fade, timeout_msec) )
+		return;
+
+	sink = player->pipeline->audiobin[MMPLAYER_A_SINK].gst;
+
+	query = gst_query_new_latency();
+	if ( sink && gst_element_query(sink, query) )
+	{
+		gst_query_parse_latency(query, &live, &min_latency, NULL);
+		if ( live )
+			latency = min_latency;
+	}
+	gst_query_unref(query);
+
+	end_time = _mmplayer_audio_fade_get_end_time(fade);
+	clock = gst_element_get_clock(player->pipeline->mainbin[MMPLAYER_M_PIPE].gst);
+
+	if ( clock && GST_CLOCK_TIME_IS_VALID(end_time) )
+	{
+		/* the last faded sample is rendered at base time + running time + latency */
+		until = gst_element_get_base_time(player->pipeline->mainbin[MMPLAYER_M_PIPE].gst) + end_time + latency;
+		now = gst_clock_get_time(clock);
+		latency = ( until > now ) ? until - now : 0;
+	}
+
+	if ( clock )
+		gst_object_unref(clock);
+
+	/* never block longer than the fade itself if clock is odd */
+	latency = MIN(latency, (GstClockTime)timeout_msec * GST_MSECOND);
+
+	if ( latency )
+	{
+		debug_log("wait %"G_GUINT64_FORMAT" msec more for sink to play out fade\n", GST_TIME_AS_MSECONDS(latency));
+		usleep(GST_TIME_AS_USECONDS(latency));
+	}
+}
+
 static void __mmplayer_do_sound_fadedown(mm_player_t* player, unsigned int time)
 {
+	GstElement *fade = NULL;
+
 	debug_fenter();
 	
 	return_if_fail(player 
@@ -5273,9 +6100,14 @@ static void __mmplayer_do_sound_fadedown(mm_player_t* player, unsigned int time)
 		&& player->pipeline->audiobin
 		&& player->pipeline->audiobin[MMPLAYER_A_SINK].gst);
 
-	g_object_set(G_OBJECT(player->pipeline->audiobin[MMPLAYER_A_SINK].gst), "mute", 2, NULL);
-	
-	usleep(time);
+	__mmplayer_start_sound_fadedown(player, time);
+
+	fade = player->pipeline->audiobin[MMPLAYER_A_FADE].gst;
+
+	if ( fade )
+		__mmplayer_audio_fade_wait_playout(player, fade, time / 1000 + MM_PLAYER_FADE_WAIT_MARGIN);
+	else
+		usleep(time);
 
 	debug_fleave();
 }
@@ -5284,21 +6116,77 @@ static void __mmplayer_undo_sound_fadedown(mm_player_t* player)
 {
 	debug_fenter();
 	
-	return_if_fail(player 
+	return_if_fail(player
 		&& player->pipeline
 		&& player->pipeline->audiobin
 		&& player->pipeline->audiobin[MMPLAYER_A_SINK].gst);
-	
-	g_object_set(G_OBJECT(player->pipeline->audiobin[MMPLAYER_A_SINK].gst), "mute", 0, NULL);	
+
+	if ( player->pipeline->audiobin[MMPLAYER_A_FADE].gst )
+		_mmplayer_audio_fade_set_gain(player->pipeline->audiobin[MMPLAYER_A_FADE].gst, 1.0);
+	else
+		g_object_set(G_OBJECT(player->pipeline->audiobin[MMPLAYER_A_SINK].gst), "mute", 0, NULL);
 
 	debug_fleave();
 }
 
+/* fade out before pausing, and in after resuming if "sound_fade_time" is set */
+static void __mmplayer_fade_on_state_change(mm_player_t* player, gboolean fade_in)
+{
+	MMHandleType attrs = 0;
+	GstElement *fade = NULL;
+	int fade_time = 0;
+
+	return_if_fail(player && player->pipeline);
+
+	if ( !player->pipeline->audiobin || !player->pipeline->audiobin[MMPLAYER_A_FADE].gst )
+		return;
+
+	fade = player->pipeline->audiobin[MMPLAYER_A_FADE].gst;
+
+	attrs = MMPLAYER_GET_ATTRS(player);
+	if ( attrs )
+		mm_attrs_get_int_by_name(attrs, "sound_fade_time", &fade_time);
+
+	if ( fade_in )
+	{
+		/* gain is left at zero by fading out of pause */
+		if ( fade_time )
+		{
+			_mmplayer_audio_fade_set_gain(fade, 0.0);
+			_mmplayer_audio_fade_start(fade, 1.0, fade_time, MM_PLAYER_FADE_CURVE_EXPONENTIAL);
+		}
+		else
+		{
+			_mmplayer_audio_fade_set_gain(fade, 1.0);
+		}
+	}
+	else if ( fade_time && MMPLAYER_CURRENT_STATE(player) == MM_PLAYER_STATE_PLAYING )
+	{
+		debug_log("fade out for %d msec\n", fade_time);
+
+		_mmplayer_audio_fade_start(fade, 0.0, fade_time, MM_PLAYER_FADE_CURVE_EXPONENTIAL);
+		__mmplayer_audio_fade_wait_playout(player, fade, fade_time + MM_PLAYER_FADE_WAIT_MARGIN);
+	}
+}
+
+static void __mmplayer_audio_fade_done(GstElement *fade, gdouble gain, gpointer data)
+{
+	mm_player_t* player = (mm_player_t*) data;
+
+	return_if_fail(player);
+
+	debug_log("volume fade done. gain(%f)\n", gain);
+
+	if ( player->volume_fade_cb )
+		player->volume_fade_cb((float)gain, player->volume_fade_cb_user_param);
+}
+
 static int __gst_stop(mm_player_t* player) // @
 {
 	GstStateChangeReturn change_ret = GST_STATE_CHANGE_SUCCESS;
 	MMHandleType attrs = 0;
 	gboolean fadewown = FALSE;
+	gint fade_time = 0;
 	gboolean rewind = FALSE;
 	gint timeout = 0;
 	int ret = MM_ERROR_NONE;
@@ -5318,10 +6206,14 @@ static int __gst_stop(mm_player_t* player) // @
 	}
 
 	mm_attrs_get_int_by_name(attrs,"sound_fadedown", &fadewown);
+	mm_attrs_get_int_by_name(attrs,"sound_fade_time", &fade_time);
 
 	/* enable fadedown */
-	if (fadewown)
-		__mmplayer_do_sound_fadedown(player, MM_PLAYER_FADEOUT_TIME_DEFAULT);
+	if (fadewown || fade_time)
+	{
+		fadewown = TRUE;
+		__mmplayer_do_sound_fadedown(player, fade_time ? fade_time * 1000 : MM_PLAYER_FADEOUT_TIME_DEFAULT);
+	}
 
 	/* Just set state to PAUESED and the rewind. it's usual player behavior. */
 	timeout = MMPLAYER_STATE_CHANGE_TIMEOUT ( player );
@@ -6119,7 +7011,7 @@ gboolean _asm_lazy_pause(gpointer *data)
 
 	/* unset mute */
 	if (player->pipeline && player->pipeline->audiobin)
-		g_object_set(G_OBJECT(player->pipeline->audiobin[MMPLAYER_A_SINK].gst), "mute", 0, NULL);
+		__mmplayer_undo_sound_fadedown(player);
 
 	player->sm.by_asm_cb = 0; //should be reset here
 
@@ -6218,7 +7110,7 @@ __mmplayer_asm_callback(int handle, ASM_event_sources_t event_src, ASM_sound_com
 				lazy_pause = TRUE; // return as soon as possible, for fast start of other app
 
 				if ( player->pipeline->audiobin && player->pipeline->audiobin[MMPLAYER_A_SINK].gst )
-					g_object_set( player->pipeline->audiobin[MMPLAYER_A_SINK].gst, "mute", 2, NULL);
+					__mmplayer_start_sound_fadedown(player, LAZY_PAUSE_TIMEOUT_MSEC * 1000);
 
 				player->lazy_pause_event_id = g_timeout_add(LAZY_PAUSE_TIMEOUT_MSEC, (GSourceFunc)_asm_lazy_pause, (gpointer)player);
 				debug_log ("set lazy pause timer (id=[%d], timeout=[%d ms])", player->lazy_pause_event_id, LAZY_PAUSE_TIMEOUT_MSEC);
@@ -6308,6 +7200,31 @@ _mmplayer_create_player(MMHandleType handle) // @
 		goto ERROR;
 	}
 
+	/* create frame export lock */
+	player->frame_export_lock = g_mutex_new();
+	if ( ! player->frame_export_lock )
+	{
+		debug_critical("Cannot create frame export lock\n");
+		goto ERROR;
+	}
+
+	/* create pcm batch lock */
+	player->pcm_batch_lock = g_mutex_new();
+	if ( ! player->pcm_batch_lock )
+	{
+		debug_critical("Cannot create pcm batch lock\n");
+		goto ERROR;
+	}
+
+	/* create audio sink switch lock */
+	player->audiosink_switch_lock = g_mutex_new();
+	if ( ! player->audiosink_switch_lock )
+	{
+		debug_critical("Cannot create audio sink switch lock\n");
+		goto ERROR;
+	}
+	player->audiosink_switch.gap_usec = -1;
+
 	/* create repeat mutex */
 	player->repeat_thread_mutex = g_mutex_new();
 	if ( ! player->repeat_thread_mutex )
@@ -6439,6 +7356,18 @@ ERROR:
 		g_mutex_free( player->fsink_lock );
 	player->fsink_lock = NULL;
 
+	if ( player->frame_export_lock )
+		g_mutex_free( player->frame_export_lock );
+	player->frame_export_lock = NULL;
+
+	if ( player->pcm_batch_lock )
+		g_mutex_free( player->pcm_batch_lock );
+	player->pcm_batch_lock = NULL;
+
+	if ( player->audiosink_switch_lock )
+		g_mutex_free( player->audiosink_switch_lock );
+	player->audiosink_switch_lock = NULL;
+
 	/* free thread */
 	if ( player->repeat_thread_cond &&
 		 player->repeat_thread_mutex &&
@@ -6554,6 +7483,17 @@ __mmplayer_gstreamer_init(void) // @
 		}
 	);
 
+	/* built-in elements */
+	if ( ! _mmplayer_audio_eq_register() )
+	{
+		debug_warning("built-in equalizer is not available\n");
+	}
+
+	if ( ! _mmplayer_audio_fade_register() )
+	{
+		debug_warning("fade element is not available\n");
+	}
+
 	/* release */
 	for ( i = 0; i < *argc; i++ )
 	{
@@ -6678,6 +7618,17 @@ _mmplayer_destroy(MMHandleType handle) // @
 	if ( player->fsink_lock )
 		g_mutex_free( player->fsink_lock );
 
+	if ( player->frame_export_lock )
+		g_mutex_free( player->frame_export_lock );
+
+	if ( player->pcm_batch_lock )
+		g_mutex_free( player->pcm_batch_lock );
+
+	if ( player->audiosink_switch_lock )
+		g_mutex_free( player->audiosink_switch_lock );
+
+	_mmplayer_release_audio_analyzer( player );
+
 	if ( player->msg_cb_lock )
 		g_mutex_free( player->msg_cb_lock );
 
@@ -6719,6 +7670,19 @@ __mmplayer_init_extended_streaming(mm_player_t* player)
 				debug_error ("failed to initialize ahs player\n");
 				ret = MM_ERROR_PLAYER_NO_FREE_SPACE;
 			}
+			else
+			{
+				int prefetch_count = AHS_DEFAULT_PREFETCH_COUNT;
+				int prefetch_buffer_size = AHS_DEFAULT_PREFETCH_BUFFER_SIZE;
+				int key_cache_ttl = 0;
+
+				mm_attrs_get_int_by_name (player->attrs, "streaming_prefetch_count", &prefetch_count);
+				mm_attrs_get_int_by_name (player->attrs, "streaming_prefetch_buffer_size", &prefetch_buffer_size);
+				mm_attrs_get_int_by_name (player->attrs, "streaming_key_cache_ttl", &key_cache_ttl);
+
+				__mm_player_ahs_set_prefetch (player->ahs_player, prefetch_count, (guint)prefetch_buffer_size);
+				__mm_player_ahs_set_key_cache_ttl (player->ahs_player, (guint)key_cache_ttl);
+			}
 		}
 	}
 #endif
@@ -7094,6 +8058,155 @@ _mmplayer_get_mute(MMHandleType hplayer, int* pmute) // @
 	return MM_ERROR_NONE;
 }
 
+int
+_mmplayer_set_volume_fade(MMHandleType hplayer, float gain, int duration_msec, MMPlayerFadeCurve curve)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	debug_fenter();
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	if ( gain < 0.0 || gain > 1.0 || duration_msec < 0 ||
+		( curve != MM_PLAYER_FADE_CURVE_LINEAR && curve != MM_PLAYER_FADE_CURVE_EXPONENTIAL ) )
+	{
+		debug_error("invalid fade. gain(%f), duration(%d), curve(%d)\n", gain, duration_msec, curve);
+		return MM_ERROR_COMMON_INVALID_ARGUMENT;
+	}
+
+	/* NOTE : fade element is not created for pcm extraction */
+	if ( !player->pipeline || !player->pipeline->audiobin || !player->pipeline->audiobin[MMPLAYER_A_FADE].gst )
+	{
+		debug_error("fade element is not created\n");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	_mmplayer_audio_fade_start(player->pipeline->audiobin[MMPLAYER_A_FADE].gst, gain, duration_msec, curve);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_set_volume_fade_cb(MMHandleType hplayer, mm_player_volume_fade_callback callback, void *user_param)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	debug_fenter();
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	player->volume_fade_cb = callback;
+	player->volume_fade_cb_user_param = user_param;
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_switch_audio_sink(MMHandleType hplayer)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	int ret = MM_ERROR_NONE;
+
+	debug_fenter();
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+
+	/* NOTE : there's no audio sink for pcm extraction */
+	if ( player->is_sound_extraction )
+	{
+		debug_error("audio sink is not used for pcm extraction\n");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	ret = __mmplayer_switch_audio_sink(player);
+
+	debug_fleave();
+
+	return ret;
+}
+
+int
+_mmplayer_get_audio_sink_switch_gap(MMHandleType hplayer, int *gap_usec)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	debug_fenter();
+
+	return_val_if_fail ( player && player->audiosink_switch_lock, MM_ERROR_PLAYER_NOT_INITIALIZED );
+	return_val_if_fail ( gap_usec, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	g_mutex_lock(player->audiosink_switch_lock);
+	*gap_usec = player->audiosink_switch.gap_usec;
+	g_mutex_unlock(player->audiosink_switch_lock);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_get_streaming_throughput(MMHandleType hplayer, MMPlayerStreamingThroughput *throughput)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	guint download = 0;
+	guint decrypt = 0;
+
+	debug_fenter();
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+	return_val_if_fail ( throughput, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	if ( !player->ahs_player )
+		return MM_ERROR_PLAYER_NO_OP;
+
+	if ( !__mm_player_ahs_get_throughput(player->ahs_player, &download, &decrypt) )
+		return MM_ERROR_PLAYER_INTERNAL;
+
+	throughput->download = download;
+	throughput->decrypt = decrypt;
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_get_streaming_abr_log(MMHandleType hplayer, MMPlayerStreamingAbrDecision *decisions, int max, int *count)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	ahs_abr_decision_t log[AHS_ABR_LOG_MAX];
+	int i = 0;
+
+	debug_fenter();
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+	return_val_if_fail ( decisions && max > 0 && count, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	if ( !player->ahs_player )
+		return MM_ERROR_PLAYER_NO_OP;
+
+	*count = __mm_player_ahs_get_abr_log(player->ahs_player, log, MIN(max, AHS_ABR_LOG_MAX));
+
+	for ( i = 0; i < *count; i++ )
+	{
+		decisions[i].segment = log[i].segment;
+		decisions[i].throughput = log[i].throughput;
+		decisions[i].estimate = log[i].estimate;
+		decisions[i].buffer_msec = log[i].buffer_msec;
+		decisions[i].from_bandwidth = log[i].from_bandwidth;
+		decisions[i].to_bandwidth = log[i].to_bandwidth;
+		decisions[i].reason = (MMPlayerStreamingAbrReason) log[i].reason;	/* same order */
+	}
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
 int
 _mmplayer_set_videostream_cb(MMHandleType hplayer, mm_player_video_stream_callback callback, void *user_param) // @
 {
@@ -7114,6 +8227,49 @@ _mmplayer_set_videostream_cb(MMHandleType hplayer, mm_player_video_stream_callba
 	return MM_ERROR_NONE;
 }
 
+int
+_mmplayer_set_video_frame_cb(MMHandleType hplayer, mm_player_video_frame_callback callback, int max_leases, void *user_param)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+
+	debug_fenter();
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+	return_val_if_fail ( callback, MM_ERROR_COMMON_INVALID_ARGUMENT );
+	return_val_if_fail ( max_leases > 0 && max_leases <= MM_PLAYER_VIDEO_FRAME_LEASE_MAX, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	player->video_frame_cb = callback;
+	player->video_frame_cb_user_param = user_param;
+	player->video_frame_max_leases = max_leases;
+
+	debug_log("video frame cb : %p, max leases : %d\n", player->video_frame_cb, max_leases);
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+int
+_mmplayer_release_video_frame(MMHandleType hplayer, MMPlayerVideoFrame *frame)
+{
+	mm_player_t* player = (mm_player_t*) hplayer;
+	MMPlayerVideoFrameLease *lease = (MMPlayerVideoFrameLease*) frame;
+
+	return_val_if_fail ( player, MM_ERROR_PLAYER_NOT_INITIALIZED );
+	return_val_if_fail ( frame && frame->priv, MM_ERROR_COMMON_INVALID_ARGUMENT );
+
+	/* give the buffer back to decoder */
+	gst_buffer_unref( GST_BUFFER(frame->priv) );
+	frame->priv = NULL;
+
+	if ( lease->session == g_atomic_int_get(&player->video_frame_session) )
+		g_atomic_int_add(&player->video_frame_leases, -1);
+
+	g_free(lease);
+
+	return MM_ERROR_NONE;
+}
+
 int
 _mmplayer_set_audiostream_cb(MMHandleType hplayer, mm_player_audio_stream_callback callback, void *user_param) // @
 {
@@ -7455,6 +8611,9 @@ _mmplayer_pause(MMHandleType hplayer) // @
 		player->last_position = pos_msec;
 	}
 
+	/* fade out if it's set */
+	__mmplayer_fade_on_state_change( player, FALSE );
+
 	/* pause pipeline */
 	ret = __gst_pause( player, FALSE );
 
@@ -7500,6 +8659,11 @@ _mmplayer_resume(MMHandleType hplayer)
 	{
 		debug_error("failed to resume player.\n");
 	}
+	else
+	{
+		/* fade in if it's set */
+		__mmplayer_fade_on_state_change( player, TRUE );
+	}
 
 
 	debug_fleave();
@@ -8477,6 +9641,13 @@ static gboolean __mmplayer_configure_audio_callback(mm_player_t* player)
 				return FALSE;
 			}
 
+			/* deliver stream in chunks from separated thread */
+			if ( player->pcm_batch_frames > 0 &&
+				_mmplayer_start_pcm_batch(player) != MM_ERROR_NONE )
+			{
+				debug_warning("failed to start pcm batch. stream is delivered directly\n");
+			}
+
 			player->audio_cb_probe_id = gst_pad_add_buffer_probe (pad,
 				G_CALLBACK (__mmplayer_audio_stream_probe), player);
 
@@ -25,6 +25,7 @@
 #include "mm_player_priv.h"
 #include <mm_sound.h>
 
+static void __mmplayer_sound_filter_hold(GstElement *filter_element, gboolean hold);
 
 int
 mm_player_get_foreach_present_supported_filter_type(MMHandleType player, MMAudioFilterType filter_type, mmplayer_supported_sound_filter_cb foreach_cb, void *user_data)
@@ -148,7 +149,9 @@ __mmplayer_set_harmony_filter(mm_player_t *player, GstElement *filter_element)
 			}
 			else
 			{
-				memset (ext_filter_level_list, 0, PLAYER_INI()->audio_filter_custom_ext_num);
+				memset (ext_filter_level_list, 0, sizeof(gint)*PLAYER_INI()->audio_filter_custom_ext_num);
+				/* keep it to reuse for next apply. freed with player */
+				player->audio_filter_info.custom_ext_level_for_plugin = ext_filter_level_list;
 			}
 		}
 
@@ -321,6 +324,8 @@ _mmplayer_sound_filter_preset_apply(mm_player_t *player, MMAudioFilterPresetType
 			}
 		}
 
+		__mmplayer_sound_filter_hold(filter_element, TRUE);
+
 		/* set filter output mode as SPEAKER or EARPHONE */
 		g_object_set(filter_element, "filter-output-mode", output_type, NULL);
 		debug_log("filter-output-mode = %d (0:spk,1:ear)\n", output_type);
@@ -341,6 +346,7 @@ _mmplayer_sound_filter_preset_apply(mm_player_t *player, MMAudioFilterPresetType
 		g_object_set(filter_element, "filter-action", MM_AUDIO_FILTER_TYPE_PRESET, NULL);
 		debug_log("filter-action = %d\n", MM_AUDIO_FILTER_TYPE_PRESET);
 
+		__mmplayer_sound_filter_hold(filter_element, FALSE);
 	}
 	debug_fleave();
 
@@ -397,11 +403,16 @@ _mmplayer_sound_filter_custom_apply(mm_player_t *player)
 			}
 		}
 
+		__mmplayer_sound_filter_hold(filter_element, TRUE);
+
 		/* set filter output mode as SPEAKER or EARPHONE */
 		g_object_set(filter_element, "filter-output-mode", output_type, NULL);
 		debug_log("filter output mode = %d(0:spk,1:ear)\n", output_type);
 
 		result = __mmplayer_set_harmony_filter(player, filter_element);
+
+		__mmplayer_sound_filter_hold(filter_element, FALSE);
+
 		if ( result )
 		{
 			debug_error("_set_harmony_filter() failed(%x)\n", result);
@@ -517,6 +528,15 @@ mm_player_sound_filter_preset_apply(MMHandleType hplayer, MMAudioFilterPresetTyp
 		return MM_ERROR_PLAYER_SOUND_EFFECT_NOT_SUPPORTED_FILTER;
 	}
 
+	if ( player->sound_filter_batch )
+	{
+		debug_log("preset(%d) is staged\n", type);
+		player->sound_filter_staged = TRUE;
+		player->sound_filter_staged_type = MM_AUDIO_FILTER_TYPE_PRESET;
+		player->sound_filter_staged_preset = type;
+		return MM_ERROR_NONE;
+	}
+
 	result = _mmplayer_sound_filter_preset_apply(player, type);
 
 	return result;
@@ -538,6 +558,14 @@ mm_player_sound_filter_custom_apply(MMHandleType hplayer)
 		return MM_ERROR_NOT_SUPPORT_API;
 	}
 
+	if ( player->sound_filter_batch )
+	{
+		debug_log("custom filter is staged\n");
+		player->sound_filter_staged = TRUE;
+		player->sound_filter_staged_type = MM_AUDIO_FILTER_TYPE_CUSTOM;
+		return MM_ERROR_NONE;
+	}
+
 	result = _mmplayer_sound_filter_custom_apply(player);
 
 	return result;
@@ -559,6 +587,13 @@ mm_player_sound_filter_bypass (MMHandleType hplayer)
 		debug_error("sound filter(preset/custom) is not suppported\n");
 		return MM_ERROR_NOT_SUPPORT_API;
 	}
+	if ( player->sound_filter_batch )
+	{
+		debug_log("bypass is staged\n");
+		player->sound_filter_staged = TRUE;
+		player->sound_filter_staged_type = MM_AUDIO_FILTER_TYPE_NONE;
+		return MM_ERROR_NONE;
+	}
 	if ( !player->pipeline || !player->pipeline->audiobin )
 	{
 		debug_warning("filter element is not created yet.\n");
@@ -882,3 +917,84 @@ mm_player_sound_filter_custom_set_level_eq_from_list(MMHandleType hplayer, int *
 
 	return result;
 }
+
+
+int
+mm_player_sound_filter_begin_update(MMHandleType hplayer)
+{
+	mm_player_t* player = (mm_player_t*)hplayer;
+	debug_fenter();
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	if ( !PLAYER_INI()->use_audio_filter_preset && !PLAYER_INI()->use_audio_filter_custom )
+	{
+		debug_error("sound filter(preset/custom) is not suppported\n");
+		return MM_ERROR_NOT_SUPPORT_API;
+	}
+
+	player->sound_filter_batch = TRUE;
+	player->sound_filter_staged = FALSE;
+
+	debug_fleave();
+
+	return MM_ERROR_NONE;
+}
+
+
+int
+mm_player_sound_filter_commit_update(MMHandleType hplayer)
+{
+	mm_player_t* player = (mm_player_t*)hplayer;
+	int result = MM_ERROR_NONE;
+	debug_fenter();
+
+	return_val_if_fail(player, MM_ERROR_PLAYER_NOT_INITIALIZED);
+
+	if ( !player->sound_filter_batch )
+	{
+		debug_error("sound filter update is not started\n");
+		return MM_ERROR_PLAYER_INVALID_STATE;
+	}
+
+	player->sound_filter_batch = FALSE;
+
+	if ( !player->sound_filter_staged )
+	{
+		debug_log("nothing to commit\n");
+		return MM_ERROR_NONE;
+	}
+
+	player->sound_filter_staged = FALSE;
+
+	/* only the last request is applied */
+	switch ( player->sound_filter_staged_type )
+	{
+		case MM_AUDIO_FILTER_TYPE_PRESET:
+			result = _mmplayer_sound_filter_preset_apply(player, player->sound_filter_staged_preset);
+			break;
+
+		case MM_AUDIO_FILTER_TYPE_CUSTOM:
+			result = _mmplayer_sound_filter_custom_apply(player);
+			break;
+
+		default:
+			result = mm_player_sound_filter_bypass(hplayer);
+			break;
+	}
+
+	debug_fleave();
+
+	return result;
+}
+
+
+/* built-in equalizer takes a group of property changes at once. soundalive doesn't have it */
+static void
+__mmplayer_sound_filter_hold(GstElement *filter_element, gboolean hold)
+{
+	if ( g_object_class_find_property(G_OBJECT_GET_CLASS(filter_element), "hold-update") )
+	{
+		g_object_set(filter_element, "hold-update", hold, NULL);
+	}
+}
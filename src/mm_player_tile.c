@@ -0,0 +1,518 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*===========================================================================================
+|																							|
+|  INCLUDE FILES																			|
+|  																							|
+========================================================================================== */
+#include <string.h>
+#include <pthread.h>
+
+#include "mm_player_tile.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+/* kernels are built with target attribute and used only if cpu has it */
+#include <immintrin.h>
+#define MMPLAYER_TILE_USE_X86
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MMPLAYER_TILE_USE_NEON
+#endif
+
+/*---------------------------------------------------------------------------
+|    LOCAL #defines:														|
+---------------------------------------------------------------------------*/
+#define MMPLAYER_TILE_LINE_SIZE		64
+#define MMPLAYER_TILE_LINE_CHUNK_MAX	(MMPLAYER_TILE_LINE_WIDTH_MAX / MMPLAYER_TILE_LINE_SIZE)
+
+/* copies count tile lines of 64 bytes at offsets of src into contiguous dst */
+typedef void (*MMPlayerTileCopyFunc)(unsigned char *dst, const unsigned char *src, const int *offsets, int count);
+
+/*---------------------------------------------------------------------------
+|    LOCAL FUNCTION PROTOTYPES:												|
+---------------------------------------------------------------------------*/
+static int __tile_4x2_read(int x_size, int y_size, int x_pos, int y_pos);
+static void __tile_copy_c(unsigned char *dst, const unsigned char *src, const int *offsets, int count);
+#ifdef MMPLAYER_TILE_USE_X86
+static void __tile_copy_sse2(unsigned char *dst, const unsigned char *src, const int *offsets, int count);
+static void __tile_copy_avx2(unsigned char *dst, const unsigned char *src, const int *offsets, int count);
+#endif
+#ifdef MMPLAYER_TILE_USE_NEON
+static void __tile_copy_neon(unsigned char *dst, const unsigned char *src, const int *offsets, int count);
+#endif
+static void __tile_select_kernel(void);
+
+/*---------------------------------------------------------------------------
+|    LOCAL VARIABLE DEFINITIONS:											|
+---------------------------------------------------------------------------*/
+static pthread_once_t __tile_kernel_once = PTHREAD_ONCE_INIT;
+static MMPlayerTileKernel __tile_kernel = MM_PLAYER_TILE_KERNEL_C;
+static MMPlayerTileCopyFunc __tile_copy = __tile_copy_c;
+
+/*===========================================================================================
+|																							|
+|  FUNCTION DEFINITIONS																		|
+|  																							|
+========================================================================================== */
+void
+_mmplayer_tile_to_linear_line(unsigned char *dst, const unsigned char *src, int width, int height, int y)
+{
+	int offsets[MMPLAYER_TILE_LINE_CHUNK_MAX + 1];
+	int chunks = width / MMPLAYER_TILE_LINE_SIZE;
+	int tail = width % MMPLAYER_TILE_LINE_SIZE;
+	int i = 0;
+
+	if (width <= 0 || y < 0 || y >= height)
+		return;
+
+	if (width > MMPLAYER_TILE_LINE_WIDTH_MAX)
+	{
+		_mmplayer_tile_to_linear_crop(dst, (unsigned char *)src, width, height, 0, y, 0, height - y - 1);
+		return;
+	}
+
+	pthread_once(&__tile_kernel_once, __tile_select_kernel);
+
+	/* address of each tile line is computed once, then kernel copies them at once */
+	for (i = 0; i < chunks + (tail ? 1 : 0); i++)
+		offsets[i] = __tile_4x2_read(width, height, i * MMPLAYER_TILE_LINE_SIZE, y);
+
+	if (chunks)
+		__tile_copy(dst, src, offsets, chunks);
+
+	if (tail)
+		memcpy(dst + chunks * MMPLAYER_TILE_LINE_SIZE, src + offsets[chunks], tail);
+}
+
+gboolean
+_mmplayer_tile_set_kernel(MMPlayerTileKernel kernel)
+{
+	pthread_once(&__tile_kernel_once, __tile_select_kernel);
+
+	switch (kernel)
+	{
+		case MM_PLAYER_TILE_KERNEL_AUTO:
+			__tile_select_kernel();
+			return TRUE;
+
+		case MM_PLAYER_TILE_KERNEL_C:
+			__tile_copy = __tile_copy_c;
+			break;
+
+#ifdef MMPLAYER_TILE_USE_X86
+		case MM_PLAYER_TILE_KERNEL_SSE2:
+			if (!__builtin_cpu_supports("sse2"))
+				return FALSE;
+			__tile_copy = __tile_copy_sse2;
+			break;
+
+		case MM_PLAYER_TILE_KERNEL_AVX2:
+			if (!__builtin_cpu_supports("avx2"))
+				return FALSE;
+			__tile_copy = __tile_copy_avx2;
+			break;
+#endif
+
+#ifdef MMPLAYER_TILE_USE_NEON
+		case MM_PLAYER_TILE_KERNEL_NEON:
+			__tile_copy = __tile_copy_neon;
+			break;
+#endif
+
+		default:
+			return FALSE;
+	}
+
+	__tile_kernel = kernel;
+
+	return TRUE;
+}
+
+MMPlayerTileKernel
+_mmplayer_tile_get_kernel(void)
+{
+	pthread_once(&__tile_kernel_once, __tile_select_kernel);
+
+	return __tile_kernel;
+}
+
+/*
+ * Select the best kernel of this cpu
+ * AVX2 or SSE2 on x86 by cpuid, and NEON on ARM if it's built for.
+ */
+static void
+__tile_select_kernel(void)
+{
+#if defined(MMPLAYER_TILE_USE_X86)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2"))
+	{
+		__tile_copy = __tile_copy_avx2;
+		__tile_kernel = MM_PLAYER_TILE_KERNEL_AVX2;
+		return;
+	}
+
+	if (__builtin_cpu_supports("sse2"))
+	{
+		__tile_copy = __tile_copy_sse2;
+		__tile_kernel = MM_PLAYER_TILE_KERNEL_SSE2;
+		return;
+	}
+#elif defined(MMPLAYER_TILE_USE_NEON)
+	__tile_copy = __tile_copy_neon;
+	__tile_kernel = MM_PLAYER_TILE_KERNEL_NEON;
+	return;
+#endif
+
+	__tile_copy = __tile_copy_c;
+	__tile_kernel = MM_PLAYER_TILE_KERNEL_C;
+}
+
+static void
+__tile_copy_c(unsigned char *dst, const unsigned char *src, const int *offsets, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+		memcpy(dst + i * MMPLAYER_TILE_LINE_SIZE, src + offsets[i], MMPLAYER_TILE_LINE_SIZE);
+}
+
+#ifdef MMPLAYER_TILE_USE_X86
+/* NOTE : tiles are aligned to the plane, which may not be. so, unaligned access is used */
+__attribute__((target("sse2")))
+static void
+__tile_copy_sse2(unsigned char *dst, const unsigned char *src, const int *offsets, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		const __m128i *s = (const __m128i *)(src + offsets[i]);
+		__m128i *d = (__m128i *)(dst + i * MMPLAYER_TILE_LINE_SIZE);
+		__m128i x0 = _mm_loadu_si128(s);
+		__m128i x1 = _mm_loadu_si128(s + 1);
+		__m128i x2 = _mm_loadu_si128(s + 2);
+		__m128i x3 = _mm_loadu_si128(s + 3);
+
+		_mm_storeu_si128(d, x0);
+		_mm_storeu_si128(d + 1, x1);
+		_mm_storeu_si128(d + 2, x2);
+		_mm_storeu_si128(d + 3, x3);
+	}
+}
+
+__attribute__((target("avx2")))
+static void
+__tile_copy_avx2(unsigned char *dst, const unsigned char *src, const int *offsets, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		const __m256i *s = (const __m256i *)(src + offsets[i]);
+		__m256i *d = (__m256i *)(dst + i * MMPLAYER_TILE_LINE_SIZE);
+		__m256i y0 = _mm256_loadu_si256(s);
+		__m256i y1 = _mm256_loadu_si256(s + 1);
+
+		_mm256_storeu_si256(d, y0);
+		_mm256_storeu_si256(d + 1, y1);
+	}
+}
+#endif
+
+#ifdef MMPLAYER_TILE_USE_NEON
+static void
+__tile_copy_neon(unsigned char *dst, const unsigned char *src, const int *offsets, int count)
+{
+	int i = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		const uint8_t *s = src + offsets[i];
+		uint8_t *d = dst + i * MMPLAYER_TILE_LINE_SIZE;
+		uint8x16_t q0 = vld1q_u8(s);
+		uint8x16_t q1 = vld1q_u8(s + 16);
+		uint8x16_t q2 = vld1q_u8(s + 32);
+		uint8x16_t q3 = vld1q_u8(s + 48);
+
+		vst1q_u8(d, q0);
+		vst1q_u8(d + 16, q1);
+		vst1q_u8(d + 32, q2);
+		vst1q_u8(d + 48, q3);
+	}
+}
+#endif
+
+/*
+ * Get tiled address of position(x,y)
+ *
+ * @param x_size
+ *   width of tiled[in]
+ *
+ * @param y_size
+ *   height of tiled[in]
+ *
+ * @param x_pos
+ *   x position of tield[in]
+ *
+ * @param src_size
+ *   y position of tield[in]
+ *
+ * @return
+ *   address of tiled data
+ */
+static int
+__tile_4x2_read(int x_size, int y_size, int x_pos, int y_pos)
+{
+    int pixel_x_m1, pixel_y_m1;
+    int roundup_x, roundup_y;
+    int linear_addr0, linear_addr1, bank_addr ;
+    int x_addr;
+    int trans_addr;
+
+    pixel_x_m1 = x_size -1;
+    pixel_y_m1 = y_size -1;
+
+    roundup_x = ((pixel_x_m1 >> 7) + 1);
+    roundup_y = ((pixel_x_m1 >> 6) + 1);
+
+    x_addr = x_pos >> 2;
+
+    if ((y_size <= y_pos+32) && ( y_pos < y_size) &&
+        (((pixel_y_m1 >> 5) & 0x1) == 0) && (((y_pos >> 5) & 0x1) == 0)) {
+        linear_addr0 = (((y_pos & 0x1f) <<4) | (x_addr & 0xf));
+        linear_addr1 = (((y_pos >> 6) & 0xff) * roundup_x + ((x_addr >> 6) & 0x3f));
+
+        if (((x_addr >> 5) & 0x1) == ((y_pos >> 5) & 0x1))
+            bank_addr = ((x_addr >> 4) & 0x1);
+        else
+            bank_addr = 0x2 | ((x_addr >> 4) & 0x1);
+    } else {
+        linear_addr0 = (((y_pos & 0x1f) << 4) | (x_addr & 0xf));
+        linear_addr1 = (((y_pos >> 6) & 0xff) * roundup_x + ((x_addr >> 5) & 0x7f));
+
+        if (((x_addr >> 5) & 0x1) == ((y_pos >> 5) & 0x1))
+            bank_addr = ((x_addr >> 4) & 0x1);
+        else
+            bank_addr = 0x2 | ((x_addr >> 4) & 0x1);
+    }
+
+    linear_addr0 = linear_addr0 << 2;
+    trans_addr = (linear_addr1 <<13) | (bank_addr << 11) | linear_addr0;
+
+    return trans_addr;
+}
+
+/*
+ * Converts tiled data to linear
+ * Crops left, top, right, buttom
+ * 1. Y of NV12T to Y of YUV420P
+ * 2. Y of NV12T to Y of YUV420S
+ * 3. UV of NV12T to UV of YUV420S
+ *
+ * @param yuv420_dest
+ *   Y or UV plane address of YUV420[out]
+ *
+ * @param nv12t_src
+ *   Y or UV plane address of NV12T[in]
+ *
+ * @param yuv420_width
+ *   Width of YUV420[in]
+ *
+ * @param yuv420_height
+ *   Y: Height of YUV420, UV: Height/2 of YUV420[in]
+ *
+ * @param left
+ *   Crop size of left
+ *
+ * @param top
+ *   Crop size of top
+ *
+ * @param right
+ *   Crop size of right
+ *
+ * @param buttom
+ *   Crop size of buttom
+ */
+void
+_mmplayer_tile_to_linear_crop(unsigned char *yuv420_dest, unsigned char *nv12t_src, int yuv420_width, int yuv420_height,
+                                int left, int top, int right, int buttom)
+{
+    int i, j;
+    int tiled_offset = 0, tiled_offset1 = 0;
+    int linear_offset = 0;
+    int temp1 = 0, temp2 = 0, temp3 = 0, temp4 = 0;
+
+    temp3 = yuv420_width-right;
+    temp1 = temp3-left;
+    /* real width is greater than or equal 256 */
+    if (temp1 >= 256) {
+        for (i=top; i<yuv420_height-buttom; i=i+1) {
+            j = left;
+            temp3 = (j>>8)<<8;
+            temp3 = temp3>>6;
+            temp4 = i>>5;
+            if (temp4 & 0x1) {
+                /* odd fomula: 2+x+(x>>2)<<2+x_block_num*(y-1) */
+                tiled_offset = temp4-1;
+                temp1 = ((yuv420_width+127)>>7)<<7;
+                tiled_offset = tiled_offset*(temp1>>6);
+                tiled_offset = tiled_offset+temp3;
+                tiled_offset = tiled_offset+2;
+                temp1 = (temp3>>2)<<2;
+                tiled_offset = tiled_offset+temp1;
+                tiled_offset = tiled_offset<<11;
+                tiled_offset1 = tiled_offset+2048*2;
+                temp4 = 8;
+            } else {
+                temp2 = ((yuv420_height+31)>>5)<<5;
+                if ((i+32)<temp2) {
+                    /* even1 fomula: x+((x+2)>>2)<<2+x_block_num*y */
+                    temp1 = temp3+2;
+                    temp1 = (temp1>>2)<<2;
+                    tiled_offset = temp3+temp1;
+                    temp1 = ((yuv420_width+127)>>7)<<7;
+                    tiled_offset = tiled_offset+temp4*(temp1>>6);
+                    tiled_offset = tiled_offset<<11;
+                    tiled_offset1 = tiled_offset+2048*6;
+                    temp4 = 8;
+                } else {
+                    /* even2 fomula: x+x_block_num*y */
+                    temp1 = ((yuv420_width+127)>>7)<<7;
+                    tiled_offset = temp4*(temp1>>6);
+                    tiled_offset = tiled_offset+temp3;
+                    tiled_offset = tiled_offset<<11;
+                    tiled_offset1 = tiled_offset+2048*2;
+                    temp4 = 4;
+                }
+            }
+
+            temp1 = i&0x1F;
+            tiled_offset = tiled_offset+64*(temp1);
+            tiled_offset1 = tiled_offset1+64*(temp1);
+            temp2 = yuv420_width-left-right;
+            linear_offset = temp2*(i-top);
+            temp3 = ((j+256)>>8)<<8;
+            temp3 = temp3-j;
+            temp1 = left&0x3F;
+            if (temp3 > 192) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset+temp1, 64-temp1);
+                temp2 = ((left+63)>>6)<<6;
+                temp3 = ((yuv420_width-right)>>6)<<6;
+                if (temp2 == temp3) {
+                    temp2 = yuv420_width-right-(64-temp1);
+                }
+                memcpy(yuv420_dest+linear_offset+64-temp1, nv12t_src+tiled_offset+2048, 64);
+                memcpy(yuv420_dest+linear_offset+128-temp1, nv12t_src+tiled_offset1, 64);
+                memcpy(yuv420_dest+linear_offset+192-temp1, nv12t_src+tiled_offset1+2048, 64);
+                linear_offset = linear_offset+256-temp1;
+            } else if (temp3 > 128) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset+2048+temp1, 64-temp1);
+                memcpy(yuv420_dest+linear_offset+64-temp1, nv12t_src+tiled_offset1, 64);
+                memcpy(yuv420_dest+linear_offset+128-temp1, nv12t_src+tiled_offset1+2048, 64);
+                linear_offset = linear_offset+192-temp1;
+            } else if (temp3 > 64) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset1+temp1, 64-temp1);
+                memcpy(yuv420_dest+linear_offset+64-temp1, nv12t_src+tiled_offset1+2048, 64);
+                linear_offset = linear_offset+128-temp1;
+            } else if (temp3 > 0) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset1+2048+temp1, 64-temp1);
+                linear_offset = linear_offset+64-temp1;
+            }
+
+            tiled_offset = tiled_offset+temp4*2048;
+            j = (left>>8)<<8;
+            j = j + 256;
+            temp2 = yuv420_width-right-256;
+            for (; j<=temp2; j=j+256) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
+                tiled_offset1 = tiled_offset1+temp4*2048;
+                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, 64);
+                memcpy(yuv420_dest+linear_offset+128, nv12t_src+tiled_offset1, 64);
+                tiled_offset = tiled_offset+temp4*2048;
+                memcpy(yuv420_dest+linear_offset+192, nv12t_src+tiled_offset1+2048, 64);
+                linear_offset = linear_offset+256;
+            }
+
+            tiled_offset1 = tiled_offset1+temp4*2048;
+            temp2 = yuv420_width-right-j;
+            if (temp2 > 192) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
+                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, 64);
+                memcpy(yuv420_dest+linear_offset+128, nv12t_src+tiled_offset1, 64);
+                memcpy(yuv420_dest+linear_offset+192, nv12t_src+tiled_offset1+2048, temp2-192);
+            } else if (temp2 > 128) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
+                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, 64);
+                memcpy(yuv420_dest+linear_offset+128, nv12t_src+tiled_offset1, temp2-128);
+            } else if (temp2 > 64) {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
+                memcpy(yuv420_dest+linear_offset+64, nv12t_src+tiled_offset+2048, temp2-64);
+            } else {
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, temp2);
+            }
+        }
+    } else if (temp1 >= 64) {
+        for (i=top; i<(yuv420_height-buttom); i=i+1) {
+            j = left;
+            tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
+            temp2 = ((j+64)>>6)<<6;
+            temp2 = temp2-j;
+            linear_offset = temp1*(i-top);
+            temp4 = j&0x3;
+            tiled_offset = tiled_offset+temp4;
+            memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, temp2);
+            linear_offset = linear_offset+temp2;
+            j = j+temp2;
+            if ((j+64) <= temp3) {
+                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
+                linear_offset = linear_offset+64;
+                j = j+64;
+            }
+            if ((j+64) <= temp3) {
+                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 64);
+                linear_offset = linear_offset+64;
+                j = j+64;
+            }
+            if (j < temp3) {
+                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
+                temp2 = temp3-j;
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, temp2);
+            }
+        }
+    } else {
+        for (i=top; i<(yuv420_height-buttom); i=i+1) {
+            linear_offset = temp1*(i-top);
+            for (j=left; j<(yuv420_width-right); j=j+2) {
+                tiled_offset = __tile_4x2_read(yuv420_width, yuv420_height, j, i);
+                temp4 = j&0x3;
+                tiled_offset = tiled_offset+temp4;
+                memcpy(yuv420_dest+linear_offset, nv12t_src+tiled_offset, 2);
+                linear_offset = linear_offset+2;
+            }
+        }
+    }
+}
@@ -0,0 +1,210 @@
+/*
+ * libmm-player
+ *
+ * Copyright (c) 2000 - 2011 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: JongHyuk Choi <jhchoi.choi@samsung.com>, YeJin Cho <cho.yejin@samsung.com>,
+ * Seungbae Shin <seungbae.shin@samsung.com>, YoungHwan An <younghwan_.an@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/* detiles random NV12 tiled planes line by line with every kernel this cpu has,
+ * and checks each line is same as crop of the line. then times them on 1080p */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mm_player_tile.h"
+
+typedef struct
+{
+	gint width;
+	gint height;
+}tile_test_size_t;
+
+static const tile_test_size_t sizes[] =
+{
+	{ 32, 20 },
+	{ 64, 32 },
+	{ 65, 33 },
+	{ 127, 63 },
+	{ 176, 144 },
+	{ 321, 241 },
+	{ 640, 360 },
+	{ 1279, 719 },
+	{ 1920, 1080 },
+	{ 1920, 540 },		/* UV of 1080p */
+	{ 3840, 2160 },
+};
+
+#define TILE_TEST_SIZES		(sizeof(sizes) / sizeof(sizes[0]))
+#define TILE_TEST_LOOPS		20
+
+static const char *kernel_names[MM_PLAYER_TILE_KERNEL_NUM] = { "auto", "c", "sse2", "avx2", "neon" };
+
+static gint failed = 0;
+
+#define TILE_TEST_CHECK(expr) \
+do \
+{ \
+	if (!(expr)) \
+	{ \
+		fprintf (stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		failed++; \
+	} \
+} while (0)
+
+/* tiles are 64x32 in 8KB pairs. plane is bigger than width x height, so allocates by last tile */
+static guint8 *
+tile_test_alloc_plane (gint width, gint height)
+{
+	guint size = (((width + 127) / 128) * 128) * (((height + 31) / 32 + 1) * 32) + 8192;
+	guint8 *plane = malloc (size);
+	guint i = 0;
+
+	for (i = 0; i < size; i++)
+		plane[i] = rand () & 0xff;
+
+	return plane;
+}
+
+static gdouble
+tile_test_now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void
+tile_test_bit_exact (MMPlayerTileKernel kernel)
+{
+	guint i = 0;
+	gint y = 0;
+
+	for (i = 0; i < TILE_TEST_SIZES; i++)
+	{
+		gint width = sizes[i].width;
+		gint height = sizes[i].height;
+		guint8 *plane = tile_test_alloc_plane (width, height);
+		/* crop can write a byte more than odd width */
+		guint8 *expected = malloc (width + 64);
+		guint8 *line = malloc (width + 64);
+		gint mismatch = 0;
+
+		for (y = 0; y < height; y++)
+		{
+			memset (line, 0xa5, width + 64);
+			_mmplayer_tile_to_linear_crop (expected, plane, width, height, 0, y, 0, height - y - 1);
+			_mmplayer_tile_to_linear_line (line, plane, width, height, y);
+
+			if (memcmp (expected, line, width))
+				mismatch++;
+
+			/* no write past the line */
+			if (line[width] != 0xa5)
+				mismatch++;
+		}
+
+		if (mismatch)
+			fprintf (stderr, "%s : %dx%d has %d bad lines\n", kernel_names[kernel], width, height, mismatch);
+
+		TILE_TEST_CHECK (mismatch == 0);
+
+		free (line);
+		free (expected);
+		free (plane);
+	}
+}
+
+/* whole 1080p frame, Y and UV */
+static gdouble
+tile_test_time (gboolean use_crop)
+{
+	gint width = 1920;
+	gint height = 1080;
+	guint8 *y_plane = tile_test_alloc_plane (width, height);
+	guint8 *uv_plane = tile_test_alloc_plane (width, height / 2);
+	guint8 *frame = malloc (width * height * 3 / 2 + 64);
+	gdouble start = 0;
+	gint i = 0;
+	gint y = 0;
+
+	start = tile_test_now ();
+
+	for (i = 0; i < TILE_TEST_LOOPS; i++)
+	{
+		if (use_crop)
+		{
+			_mmplayer_tile_to_linear_crop (frame, y_plane, width, height, 0, 0, 0, 0);
+			_mmplayer_tile_to_linear_crop (frame + width * height, uv_plane, width, height / 2, 0, 0, 0, 0);
+			continue;
+		}
+
+		for (y = 0; y < height; y++)
+			_mmplayer_tile_to_linear_line (frame + y * width, y_plane, width, height, y);
+
+		for (y = 0; y < height / 2; y++)
+			_mmplayer_tile_to_linear_line (frame + width * height + y * width, uv_plane, width, height / 2, y);
+	}
+
+	start = (tile_test_now () - start) / TILE_TEST_LOOPS;
+
+	free (frame);
+	free (uv_plane);
+	free (y_plane);
+
+	return start;
+}
+
+int
+main (int argc, char *argv[])
+{
+	MMPlayerTileKernel kernel = MM_PLAYER_TILE_KERNEL_AUTO;
+
+	srand (1);
+
+	kernel = _mmplayer_tile_get_kernel ();
+	TILE_TEST_CHECK (kernel > MM_PLAYER_TILE_KERNEL_AUTO && kernel < MM_PLAYER_TILE_KERNEL_NUM);
+	printf ("auto selected : %s\n", kernel_names[kernel]);
+
+	printf ("1080p crop : %.3f ms\n", tile_test_time (TRUE));
+
+	for (kernel = MM_PLAYER_TILE_KERNEL_C; kernel < MM_PLAYER_TILE_KERNEL_NUM; kernel++)
+	{
+		if (!_mmplayer_tile_set_kernel (kernel))
+		{
+			printf ("%s : not available\n", kernel_names[kernel]);
+			continue;
+		}
+
+		TILE_TEST_CHECK (_mmplayer_tile_get_kernel () == kernel);
+
+		tile_test_bit_exact (kernel);
+		printf ("1080p line %s : %.3f ms\n", kernel_names[kernel], tile_test_time (FALSE));
+	}
+
+	TILE_TEST_CHECK (_mmplayer_tile_set_kernel (MM_PLAYER_TILE_KERNEL_AUTO));
+
+	if (failed)
+	{
+		fprintf (stderr, "%d checks failed\n", failed);
+		return 1;
+	}
+
+	return 0;
+}